@@ -22,6 +22,7 @@
 #include "BridgeConfig.h"
 #include "ConfigManager.h"
 #include "BridgeDevice.h"
+#include "DeviceProperty.h"
 #include "AllJoynHelper.h"
 #include "BridgeLog.h"
 #include "BridgeUtils.h"
@@ -57,6 +58,27 @@ DsbBridge^ DsbBridge::SingleInstance()
     return g_TheOneOnlyInstance;
 }
 
+// Traces the property Get/Set traffic the devices handled since the bridge started,
+// with the requests still waiting for the adapter
+static void LogDevicePropertyStatistics()
+{
+    DevicePropertyStatistics stats = DeviceProperty::GetStatistics();
+    String^ statsString;
+
+    FormatString(statsString,
+        L"Device properties: %I64u gets (%I64u coalesced, avg %I64u ms), %I64u sets (avg %I64u ms), %I64u failed, max %I64u ms, %u gets and %u sets pending",
+        stats.gets,
+        stats.coalescedGets,
+        stats.gets ? stats.totalGetLatencyMsec / stats.gets : 0,
+        stats.sets,
+        stats.sets ? stats.totalSetLatencyMsec / stats.sets : 0,
+        stats.failures,
+        stats.maxLatencyMsec,
+        stats.getsInFlight,
+        stats.setsInFlight);
+    BridgeLog::Instance()->LogInfo(statsString);
+}
+
 DsbBridge::DsbBridge(IAdapter^ adapter)
     : m_adapter(adapter),
     m_hThread(NULL),
@@ -272,6 +294,8 @@ int32 DsbBridge::ShutdownInternal()
     BridgeLog::Instance()->LogEnter(__FUNCTIONW__);
     HRESULT hr = S_OK;
 
+    LogDevicePropertyStatistics();
+
     this->m_configManager.Shutdown();
     if (this->m_adapter != nullptr)
     {
@@ -42,6 +42,11 @@ static const DWORD FIRST_UNIQUE_ID = 1;
 static const string BASE_INTERFACE_NAME = ".interface_";
 static const uint32_t SESSION_LINK_TIMEOUT = 30;        // seconds
 
+// Property Get/Set callbacks wait for the adapter on their dispatch thread,
+// this is how many of them can be pending while other messages still get
+// dispatched (AllJoyn's default is 4)
+static const uint32_t BUS_CONCURRENCY = 16;
+
 BridgeDevice::BridgeDevice()
     : m_device(nullptr),
     m_AJBusAttachment(NULL),
@@ -206,6 +211,7 @@ void BridgeDevice::Shutdown()
         delete var.second;
     }
     m_deviceProperties.clear();
+    m_devicePropertiesByAdapterProperty.clear();
 
     // shutdown main device interface
     if (nullptr != m_deviceMain)
@@ -317,6 +323,7 @@ QStatus BridgeDevice::CreateDeviceProperties()
             goto leave;
         }
         m_deviceProperties.insert(std::make_pair(*deviceProperty->GetPathName(), deviceProperty));
+        m_devicePropertiesByAdapterProperty.insert(std::make_pair(tempProperty, deviceProperty));
         m_about.AddObject(deviceProperty->GetBusObject(), deviceProperty->GetPropertyInterface()->GetInterfaceDescription());
 
         deviceProperty = nullptr;
@@ -359,7 +366,7 @@ QStatus BridgeDevice::InitializeAllJoyn()
 
     // create the bus attachment
     AllJoynHelper::EncodeStringForAppName(DsbBridge::SingleInstance()->GetAdapter()->ExposedApplicationName, appName);
-    m_AJBusAttachment = alljoyn_busattachment_create(appName.c_str(), QCC_TRUE);
+    m_AJBusAttachment = alljoyn_busattachment_create_concurrency(appName.c_str(), QCC_TRUE, BUS_CONCURRENCY);
     if (NULL == m_AJBusAttachment)
     {
         status = ER_OUT_OF_MEMORY;
@@ -809,13 +816,10 @@ void BridgeDevice::HandleCOVSignal(IAdapterSignal ^ signal)
     if (adapterProperty != nullptr && newValue != nullptr)
     {
         // get the property that has changed
-        for (auto val : m_deviceProperties)
+        auto index = m_devicePropertiesByAdapterProperty.find(adapterProperty);
+        if (m_devicePropertiesByAdapterProperty.end() != index)
         {
-            if (val.second->GetAdapterProperty() == adapterProperty)
-            {
-                val.second->EmitSignalCOV(newValue, m_activeSessions);
-                break;
-            }
+            index->second->EmitSignalCOV(newValue, m_activeSessions);
         }
     }
 }
@@ -839,12 +843,10 @@ std::string BridgeDevice::GetBusObjectPath(_In_ IAdapterProperty ^adapterPropert
     std::string busObjectPath;
 
     // find exposed bus object path from IAdapterProperty
-    for (auto val : m_deviceProperties)
+    auto index = m_devicePropertiesByAdapterProperty.find(adapterProperty);
+    if (m_devicePropertiesByAdapterProperty.end() != index)
     {
-        if (val.second->GetAdapterProperty() == adapterProperty)
-        {
-            busObjectPath = *(val.second->GetPathName());
-        }
+        busObjectPath = *(index->second->GetPathName());
     }
     return busObjectPath;
 }
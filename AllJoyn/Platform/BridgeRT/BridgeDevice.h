@@ -17,7 +17,9 @@
 #pragma once
 
 #include <vector>
+#include <unordered_map>
 #include "AdapterConstants.h"
+#include "BridgeUtils.h"
 #include "BridgeAuthHandler.h"
 #include "AllJoynAbout.h"
 #include "AllJoynAboutIcon.h"
@@ -109,6 +111,10 @@ namespace BridgeRT
         // list of device properties
         std::map<std::string, DeviceProperty *> m_deviceProperties;
 
+        // same device properties, indexed by the adapter property they expose so that
+        // COV signals are dispatched without going through the whole list
+        std::unordered_map<IAdapterProperty ^, DeviceProperty *, HandleHash<IAdapterProperty ^>> m_devicePropertiesByAdapterProperty;
+
         // list of AllJoyn interfaces that a device property can expose
         std::vector<PropertyInterface *>    m_propertyInterfaces;
 
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <mutex>
+#include <functional>
 
 namespace BridgeRT
 {
@@ -26,6 +27,16 @@ namespace BridgeRT
 
     typedef std::lock_guard<std::recursive_mutex> AutoLock;
 
+    // Hash of a WinRT object handle, for unordered containers keyed by object identity
+    template<typename _THandle>
+    struct HandleHash
+    {
+        size_t operator()(_THandle handle) const
+        {
+            return std::hash<void *>()(reinterpret_cast<IInspectable *>(handle));
+        }
+    };
+
     template<typename _TDest>
     inline _TDest ConvertTo(const wchar_t* wStrSrc)
     {
@@ -34,6 +34,9 @@ using namespace BridgeRT;
 using namespace std;
 using namespace Windows::Foundation;
 
+DevicePropertyStatistics DeviceProperty::s_statistics = {};
+std::mutex DeviceProperty::s_statisticsLock;
+
 DeviceProperty::DeviceProperty()
     : m_deviceProperty(nullptr),
     m_parent(nullptr),
@@ -153,6 +156,7 @@ void DeviceProperty::Shutdown()
     m_parent = nullptr;
     m_AJBusObjectPath.clear();
     m_AJpropertyAdapterValuePairs.clear();
+    m_AJpropertiesByAdapterValue.clear();
 }
 
 QStatus BridgeRT::DeviceProperty::PairAjProperties()
@@ -178,8 +182,9 @@ QStatus BridgeRT::DeviceProperty::PairAjProperties()
         {
             if (ajProperty->IsSameType(*adapterAttr))
             {
-                AJpropertyAdapterValuePair tempPair = { ajProperty, *adapterAttr };
+                AJpropertyAdapterValuePair tempPair = { ajProperty, *adapterAttr, std::make_shared<PropertyAccess<IAdapterValue ^>>() };
                 m_AJpropertyAdapterValuePairs.insert(std::make_pair(*ajProperty->GetName(), tempPair));
+                m_AJpropertiesByAdapterValue.insert(std::make_pair((*adapterAttr)->Value, ajProperty));
                 paired = true;
                 break;
             }
@@ -202,12 +207,11 @@ leave:
 QStatus AJ_CALL DeviceProperty::GetProperty(_In_ const void* context, _In_z_ const char* ifcName, _In_z_ const char* propName, _Out_ alljoyn_msgarg val)
 {
     QStatus status = ER_OK;
-    uint32 adapterStatus = ERROR_SUCCESS;
     DeviceProperty *deviceProperty = nullptr;
     IAdapterAttribute ^adapterAttr = nullptr;
-    IAdapterValue ^adapterValue = nullptr;
     AllJoynProperty *ajProperty = nullptr;
-    IAdapterIoRequest^ request;
+    ULONGLONG startTime = 0;
+    bool coalesced = false;
 
     UNREFERENCED_PARAMETER(ifcName);
 
@@ -227,27 +231,74 @@ QStatus AJ_CALL DeviceProperty::GetProperty(_In_ const void* context, _In_z_ con
 
     ajProperty = index->second.ajProperty;
     adapterAttr = index->second.adapterAttr;
-    adapterValue = adapterAttr->Value;
+    startTime = StartOperation(true);
+
+    // the adapter can take a while to answer, let the bus dispatch other
+    // messages (e.g. requests for other properties) meanwhile
+    alljoyn_busattachment_enableconcurrentcallbacks(deviceProperty->m_parent->GetBusAttachment());
+
+    // get value of adapter value (or share the read in progress) and build
+    // alljoyn response to get before a Set can change the value
+    index->second.access->Get(
+        [deviceProperty, adapterAttr](IAdapterValue ^&value)
+        {
+            return deviceProperty->ReadAdapterValue(adapterAttr, value);
+        },
+        [&status, val](uint32 adapterStatus, IAdapterValue ^const &value)
+        {
+            if (ERROR_SUCCESS != adapterStatus)
+            {
+                status = ER_OS_ERROR;
+                return;
+            }
+            status = AllJoynHelper::SetMsgArg(value, val);
+        },
+        &coalesced);
+    if (coalesced)
+    {
+        std::lock_guard<std::mutex> statsLock(s_statisticsLock);
+        s_statistics.coalescedGets++;
+    }
+
+leave:
+    if (ER_BUS_NO_SUCH_PROPERTY != status)
+    {
+        CompleteOperation(true, startTime, ER_OK == status);
+    }
+    return status;
+}
+
+uint32 DeviceProperty::ReadAdapterValue(IAdapterAttribute ^adapterAttr, IAdapterValue ^&adapterValue)
+{
+    uint32 adapterStatus = ERROR_SUCCESS;
+    IAdapterIoRequest^ request;
 
-    // get value of adapter value
-    adapterStatus = DsbBridge::SingleInstance()->GetAdapter()->GetPropertyValue(deviceProperty->m_deviceProperty, adapterValue->Name, &adapterValue, &request);
+    adapterValue = adapterAttr->Value;
+    adapterStatus = DsbBridge::SingleInstance()->GetAdapter()->GetPropertyValue(m_deviceProperty, adapterValue->Name, &adapterValue, &request);
     if (ERROR_IO_PENDING == adapterStatus &&
         nullptr != request)
     {
         // wait for completion
         adapterStatus = request->Wait(WAIT_TIMEOUT_FOR_ADAPTER_OPERATION);
     }
-    if (ERROR_SUCCESS != adapterStatus)
+
+    return adapterStatus;
+}
+
+uint32 DeviceProperty::WriteAdapterValue(IAdapterValue ^adapterValue)
+{
+    uint32 adapterStatus = ERROR_SUCCESS;
+    IAdapterIoRequest^ request;
+
+    adapterStatus = DsbBridge::SingleInstance()->GetAdapter()->SetPropertyValue(m_deviceProperty, adapterValue, &request);
+    if (ERROR_IO_PENDING == adapterStatus &&
+        nullptr != request)
     {
-        status = ER_OS_ERROR;
-        goto leave;
+        // wait for completion
+        adapterStatus = request->Wait(WAIT_TIMEOUT_FOR_ADAPTER_OPERATION);
     }
 
-    // build alljoyn response to get
-    status = AllJoynHelper::SetMsgArg(adapterValue, val);
-
-leave:
-    return status;
+    return adapterStatus;
 }
 
 QStatus AJ_CALL DeviceProperty::SetProperty(_In_ const void* context, _In_z_ const char* ifcName, _In_z_ const char* propName, _In_ alljoyn_msgarg val)
@@ -258,7 +309,7 @@ QStatus AJ_CALL DeviceProperty::SetProperty(_In_ const void* context, _In_z_ con
     IAdapterAttribute^ adapterAttr = nullptr;
     IAdapterValue ^adapterValue = nullptr;
     AllJoynProperty *ajProperty = nullptr;
-    IAdapterIoRequest^ request;
+    ULONGLONG startTime = 0;
 
     UNREFERENCED_PARAMETER(ifcName);
 
@@ -279,22 +330,25 @@ QStatus AJ_CALL DeviceProperty::SetProperty(_In_ const void* context, _In_z_ con
     ajProperty = index->second.ajProperty;
     adapterAttr = index->second.adapterAttr;
     adapterValue = adapterAttr->Value;
+    startTime = StartOperation(false);
+
+    alljoyn_busattachment_enableconcurrentcallbacks(deviceProperty->m_parent->GetBusAttachment());
 
-    // update IAdapterValue from AllJoyn message
-    status = AllJoynHelper::GetAdapterValue(adapterValue, val);
+    // the adapter value is shared by all the requests of this property,
+    // update it from AllJoyn message and set it in adapter in one go
+    adapterStatus = index->second.access->Set([&status, deviceProperty, adapterValue, val]() -> uint32
+    {
+        status = AllJoynHelper::GetAdapterValue(adapterValue, val);
+        if (ER_OK != status)
+        {
+            return ERROR_SUCCESS;
+        }
+        return deviceProperty->WriteAdapterValue(adapterValue);
+    });
     if (ER_OK != status)
     {
         goto leave;
     }
-
-    // set value in adapter
-    adapterStatus = DsbBridge::SingleInstance()->GetAdapter()->SetPropertyValue(deviceProperty->m_deviceProperty, adapterValue, &request);
-    if (ERROR_IO_PENDING == adapterStatus &&
-        nullptr != request)
-    {
-        // wait for completion
-        adapterStatus = request->Wait(WAIT_TIMEOUT_FOR_ADAPTER_OPERATION);
-    }
     if (ERROR_ACCESS_DENIED == adapterStatus)
     {
         status = ER_BUS_PROPERTY_ACCESS_DENIED;
@@ -307,14 +361,67 @@ QStatus AJ_CALL DeviceProperty::SetProperty(_In_ const void* context, _In_z_ con
     }
 
 leave:
+    if (ER_BUS_NO_SUCH_PROPERTY != status)
+    {
+        CompleteOperation(false, startTime, ER_OK == status);
+    }
     return status;
 }
 
+DevicePropertyStatistics DeviceProperty::GetStatistics()
+{
+    std::lock_guard<std::mutex> lock(s_statisticsLock);
+    return s_statistics;
+}
+
+ULONGLONG DeviceProperty::StartOperation(bool isGet)
+{
+    std::lock_guard<std::mutex> lock(s_statisticsLock);
+
+    if (isGet)
+    {
+        s_statistics.getsInFlight++;
+    }
+    else
+    {
+        s_statistics.setsInFlight++;
+    }
+    return GetTickCount64();
+}
+
+void DeviceProperty::CompleteOperation(bool isGet, ULONGLONG startTime, bool succeeded)
+{
+    ULONGLONG latency = GetTickCount64() - startTime;
+    std::lock_guard<std::mutex> lock(s_statisticsLock);
+
+    if (isGet)
+    {
+        s_statistics.getsInFlight--;
+        s_statistics.gets++;
+        s_statistics.totalGetLatencyMsec += latency;
+    }
+    else
+    {
+        s_statistics.setsInFlight--;
+        s_statistics.sets++;
+        s_statistics.totalSetLatencyMsec += latency;
+    }
+    if (!succeeded)
+    {
+        s_statistics.failures++;
+    }
+    if (latency > s_statistics.maxLatencyMsec)
+    {
+        s_statistics.maxLatencyMsec = latency;
+    }
+}
+
 void DeviceProperty::EmitSignalCOV(IAdapterValue ^newValue, const std::vector<alljoyn_sessionid>& sessionIds)
 {
     QStatus status = ER_OK;
     alljoyn_msgarg msgArg = NULL;
-    auto valuePair = m_AJpropertyAdapterValuePairs.end();
+    AllJoynProperty *ajProperty = nullptr;
+    auto index = m_AJpropertiesByAdapterValue.end();
 
     // sanity check
     if (nullptr == newValue)
@@ -322,15 +429,25 @@ void DeviceProperty::EmitSignalCOV(IAdapterValue ^newValue, const std::vector<al
         goto leave;
     }
 
-    // get AllJoyn property that match with IAdapterValue that has changed
-    for (valuePair = m_AJpropertyAdapterValuePairs.begin(); valuePair != m_AJpropertyAdapterValuePairs.end(); valuePair++)
+    // get AllJoyn property that match with IAdapterValue that has changed,
+    // adapters usually signal the very value object they exposed
+    index = m_AJpropertiesByAdapterValue.find(newValue);
+    if (m_AJpropertiesByAdapterValue.end() != index)
     {
-        if (valuePair->second.adapterAttr->Value->Name == newValue->Name)
+        ajProperty = index->second;
+    }
+    else
+    {
+        for (auto &valuePair : m_AJpropertyAdapterValuePairs)
         {
-            break;
+            if (valuePair.second.adapterAttr->Value->Name == newValue->Name)
+            {
+                ajProperty = valuePair.second.ajProperty;
+                break;
+            }
         }
     }
-    if (valuePair == m_AJpropertyAdapterValuePairs.end())
+    if (nullptr == ajProperty)
     {
         // can't find any Alljoyn property that correspond to IAdapterValue
         goto leave;
@@ -355,7 +472,7 @@ void DeviceProperty::EmitSignalCOV(IAdapterValue ^newValue, const std::vector<al
 		// emit property change
 		alljoyn_busobject_emitpropertychanged(m_AJBusObject,
 			m_propertyInterface->GetInterfaceName()->c_str(),
-			valuePair->second.ajProperty->GetName()->c_str(),
+			ajProperty->GetName()->c_str(),
 			msgArg, sessionId);
 	}
 
@@ -16,6 +16,12 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "BridgeUtils.h"
+#include "PropertyAccess.h"
+
 namespace BridgeRT
 {
     ref class BridgeDevice;
@@ -26,8 +32,26 @@ namespace BridgeRT
     {
         AllJoynProperty *ajProperty;
         IAdapterAttribute ^adapterAttr;
+        std::shared_ptr<PropertyAccess<IAdapterValue ^>> access;
     } AJpropertyAdapterValuePair;
 
+    //
+    // Property Get/Set traffic handled by all device properties of the bridge.
+    // Latencies are measured from the AllJoyn callback to the adapter completion.
+    //
+    typedef struct
+    {
+        DWORD getsInFlight;
+        DWORD setsInFlight;
+        ULONGLONG gets;
+        ULONGLONG coalescedGets;    // gets served by a read already in progress
+        ULONGLONG sets;
+        ULONGLONG failures;
+        ULONGLONG totalGetLatencyMsec;
+        ULONGLONG totalSetLatencyMsec;
+        ULONGLONG maxLatencyMsec;
+    } DevicePropertyStatistics;
+
     class DeviceProperty
     {
     public:
@@ -55,8 +79,14 @@ namespace BridgeRT
             return m_deviceProperty;
         }
 
+        static DevicePropertyStatistics GetStatistics();
+
     private:
         QStatus PairAjProperties();
+        uint32 ReadAdapterValue(_In_ IAdapterAttribute ^adapterAttr, _Out_ IAdapterValue ^&adapterValue);
+        uint32 WriteAdapterValue(_In_ IAdapterValue ^adapterValue);
+        static ULONGLONG StartOperation(bool isGet);
+        static void CompleteOperation(bool isGet, ULONGLONG startTime, bool succeeded);
 
         static QStatus AJ_CALL GetProperty(_In_ const void* context, _In_z_ const char* ifcName, _In_z_ const char* propName, _Out_ alljoyn_msgarg val);
         static QStatus AJ_CALL SetProperty(_In_ const void* context, _In_z_ const char* ifcName, _In_z_ const char* propName, _In_ alljoyn_msgarg val);
@@ -76,7 +106,13 @@ namespace BridgeRT
         // with its corresponding device instance (adapter value)
         std::map<std::string, AJpropertyAdapterValuePair> m_AJpropertyAdapterValuePairs;
 
+        // AllJoyn property of each adapter value above, to find the one a COV signal refers to
+        std::unordered_map<IAdapterValue ^, AllJoynProperty *, HandleHash<IAdapterValue ^>> m_AJpropertiesByAdapterValue;
+
         std::string m_AJBusObjectPath;
+
+        static DevicePropertyStatistics s_statistics;
+        static std::mutex s_statisticsLock;
     };
 }
 
@@ -0,0 +1,162 @@
+//
+// Copyright (c) 2015, Microsoft Corporation
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR
+// IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace BridgeRT
+{
+    //
+    // Orders the Get and Set requests of one AllJoyn property:
+    // - the adapter is called for one request at a time, and the reply of a
+    //   Get is built from its value before another request can change it,
+    // - Gets that arrive while a read is in progress wait for that read and
+    //   reply with its value instead of issuing their own,
+    // - Gets that arrive after a Set started never share a read that started
+    //   before it.
+    //
+    // _TValue is what a read returns (IAdapterValue ^ in the bridge).
+    //
+    template<typename _TValue>
+    class PropertyAccess
+    {
+    public:
+        PropertyAccess() {}
+
+        //
+        //  Routine Description:
+        //      Reads the property, or waits for the read already in progress.
+        //
+        //  Arguments:
+        //
+        //      read - uint32_t (_TValue &value), reads the property from the adapter
+        //
+        //      reply - void (uint32_t status, const _TValue &value), called with
+        //          the result of the read this Get is served by
+        //
+        //      coalesced - set to true if this Get shared another one's read
+        //
+        //  Return Value:
+        //
+        //      The status of the read.
+        //
+        template<typename _TRead, typename _TReply>
+        uint32_t Get(_TRead read, _TReply reply, _Out_opt_ bool *coalesced = nullptr)
+        {
+            std::shared_ptr<PendingRead> pending;
+
+            if (nullptr != coalesced)
+            {
+                *coalesced = false;
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(m_pendingLock);
+                if (m_pendingRead)
+                {
+                    pending = m_pendingRead;
+                    if (nullptr != coalesced)
+                    {
+                        *coalesced = true;
+                    }
+                    m_readCompleted.wait(lock, [&pending] { return pending->completed; });
+                }
+                else
+                {
+                    pending = std::make_shared<PendingRead>();
+                    m_pendingRead = pending;
+                }
+            }
+
+            std::lock_guard<std::mutex> accessLock(m_accessLock);
+
+            if (!pending->completed)
+            {
+                // this Get issues the read
+                _TValue value = _TValue();
+                uint32_t status = read(value);
+
+                {
+                    std::lock_guard<std::mutex> lock(m_pendingLock);
+                    pending->completed = true;
+                    pending->status = status;
+                    pending->value = value;
+
+                    // a Set may already have detached this read
+                    if (m_pendingRead == pending)
+                    {
+                        m_pendingRead.reset();
+                    }
+                }
+                m_readCompleted.notify_all();
+            }
+
+            reply(pending->status, pending->value);
+            return pending->status;
+        }
+
+        //
+        //  Routine Description:
+        //      Writes the property.
+        //
+        //  Arguments:
+        //
+        //      write - uint32_t (), writes the property to the adapter
+        //
+        //  Return Value:
+        //
+        //      The status of the write.
+        //
+        template<typename _TWrite>
+        uint32_t Set(_TWrite write)
+        {
+            {
+                // a read started before this Set could return the old value,
+                // so Gets that arrive from now on must not join it
+                std::lock_guard<std::mutex> lock(m_pendingLock);
+                m_pendingRead.reset();
+            }
+
+            std::lock_guard<std::mutex> accessLock(m_accessLock);
+            return write();
+        }
+
+    private:
+        PropertyAccess(const PropertyAccess &);
+        PropertyAccess &operator=(const PropertyAccess &);
+
+        struct PendingRead
+        {
+            PendingRead() : completed(false), status(0), value() {}
+
+            bool completed;
+            uint32_t status;
+            _TValue value;
+        };
+
+        // held while the adapter is called and the reply is built
+        std::mutex m_accessLock;
+
+        // guards m_pendingRead and the PendingRead it points to
+        std::mutex m_pendingLock;
+        std::condition_variable m_readCompleted;
+        std::shared_ptr<PendingRead> m_pendingRead;
+    };
+}
@@ -0,0 +1,316 @@
+//
+// Copyright (c) 2015, Microsoft Corporation
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR
+// IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+
+//
+// Change of value storms on a bridge device exposing 10 to 10,000 points.
+// Each point is a device property, the benchmark hands a COV signal per point
+// to BridgeDevice::AdapterSignalHandler in a scattered order and prints the
+// time per signal, and the time BridgeDevice::GetBusObjectPath takes to find
+// the same points. Both go through the device's index of adapter properties,
+// so the times should stay flat as the number of points grows.
+// Not a pass/fail test. The device is exposed on the local AllJoyn router, so
+// the AllJoyn Router Service must be running.
+//
+
+#include "pch.h"
+
+#include <chrono>
+#include <cstdio>
+
+#include "Bridge.h"
+#include "BridgeDevice.h"
+
+using namespace Platform;
+using namespace Platform::Collections;
+using namespace Windows::Foundation;
+
+using namespace BridgeRT;
+using namespace std;
+
+static const int SIGNALS_PER_RUN = 100000;
+
+//
+// Minimal adapter objects, a device is a list of single attribute points
+// that all signal their changes through one COV signal
+//
+ref class BenchValue sealed : IAdapterValue
+{
+public:
+    BenchValue(String^ name, Object^ data) : m_name(name), m_data(data) {}
+
+    virtual property String^ Name
+    {
+        String^ get() { return m_name; }
+    }
+    virtual property Object^ Data
+    {
+        Object^ get() { return m_data; }
+        void set(Object^ newData) { m_data = newData; }
+    }
+
+private:
+    String^ m_name;
+    Object^ m_data;
+};
+
+ref class BenchAttribute sealed : IAdapterAttribute
+{
+public:
+    BenchAttribute(IAdapterValue^ value) : m_value(value), m_annotations(ref new AnnotationMap()) {}
+
+    virtual property IAdapterValue^ Value
+    {
+        IAdapterValue^ get() { return m_value; }
+    }
+    virtual property IAnnotationMap^ Annotations
+    {
+        IAnnotationMap^ get() { return m_annotations; }
+    }
+    virtual property E_ACCESS_TYPE Access
+    {
+        E_ACCESS_TYPE get() { return E_ACCESS_TYPE::ACCESS_READ; }
+    }
+    virtual property SignalBehavior COVBehavior
+    {
+        SignalBehavior get() { return SignalBehavior::Always; }
+    }
+
+private:
+    IAdapterValue^ m_value;
+    IAnnotationMap^ m_annotations;
+};
+
+ref class BenchProperty sealed : IAdapterProperty
+{
+public:
+    BenchProperty(String^ name, IAdapterAttribute^ attribute) : m_name(name), m_attributes(ref new AdapterAttributeVector())
+    {
+        m_attributes->Append(attribute);
+    }
+
+    virtual property String^ Name
+    {
+        String^ get() { return m_name; }
+    }
+    virtual property String^ InterfaceHint
+    {
+        String^ get() { return L""; }
+    }
+    virtual property IAdapterAttributeVector^ Attributes
+    {
+        IAdapterAttributeVector^ get() { return m_attributes; }
+    }
+
+private:
+    String^ m_name;
+    AdapterAttributeVector^ m_attributes;
+};
+
+ref class BenchSignal sealed : IAdapterSignal
+{
+public:
+    BenchSignal(String^ name) : m_name(name), m_params(ref new AdapterValueVector()) {}
+
+    virtual property String^ Name
+    {
+        String^ get() { return m_name; }
+    }
+    virtual property IAdapterValueVector^ Params
+    {
+        IAdapterValueVector^ get() { return m_params; }
+    }
+
+private:
+    String^ m_name;
+    AdapterValueVector^ m_params;
+};
+
+ref class BenchDevice sealed : IAdapterDevice
+{
+public:
+    BenchDevice(String^ name) :
+        m_name(name),
+        m_properties(ref new AdapterPropertyVector()),
+        m_methods(ref new AdapterMethodVector()),
+        m_signals(ref new AdapterSignalVector())
+    {
+        m_signals->Append(ref new BenchSignal(Constants::CHANGE_OF_VALUE_SIGNAL));
+    }
+
+    virtual property String^ Name { String^ get() { return m_name; } }
+    virtual property String^ Vendor { String^ get() { return L"Microsoft"; } }
+    virtual property String^ Model { String^ get() { return L"COV storm"; } }
+    virtual property String^ Version { String^ get() { return L"1.0"; } }
+    virtual property String^ FirmwareVersion { String^ get() { return L"1.0"; } }
+    virtual property String^ SerialNumber { String^ get() { return m_name; } }
+    virtual property String^ Description { String^ get() { return L"Bridge COV storm benchmark device"; } }
+    virtual property IAdapterPropertyVector^ Properties { IAdapterPropertyVector^ get() { return m_properties; } }
+    virtual property IAdapterMethodVector^ Methods { IAdapterMethodVector^ get() { return m_methods; } }
+    virtual property IAdapterSignalVector^ Signals { IAdapterSignalVector^ get() { return m_signals; } }
+    virtual property IAdapterIcon^ Icon { IAdapterIcon^ get() { return nullptr; } }
+
+internal:
+    void AddProperty(IAdapterProperty^ property)
+    {
+        m_properties->Append(property);
+    }
+
+private:
+    String^ m_name;
+    AdapterPropertyVector^ m_properties;
+    AdapterMethodVector^ m_methods;
+    AdapterSignalVector^ m_signals;
+};
+
+//
+// Adapter the bridge devices look up through DsbBridge::SingleInstance(),
+// the benchmark hands signals to the devices itself
+//
+ref class BenchAdapter sealed : IAdapter
+{
+public:
+    virtual property String^ Vendor { String^ get() { return L"Microsoft"; } }
+    virtual property String^ AdapterName { String^ get() { return L"COV Storm Benchmark"; } }
+    virtual property String^ Version { String^ get() { return L"1.0"; } }
+    virtual property String^ ExposedAdapterPrefix { String^ get() { return L"com.microsoft"; } }
+    virtual property String^ ExposedApplicationName { String^ get() { return L"CovStormBenchmark"; } }
+    virtual property Guid ExposedApplicationGuid
+    {
+        Guid get() { return Guid(0x6a0b3c7e, 0x2d41, 0x4f0e, 0x9b, 0x63, 0x1e, 0x5a, 0x7c, 0x02, 0x94, 0xd8); }
+    }
+    virtual property IAdapterSignalVector^ Signals
+    {
+        IAdapterSignalVector^ get() { return ref new AdapterSignalVector(); }
+    }
+
+    virtual uint32 SetConfiguration(_In_ const Array<byte>^ ConfigurationData) { return ERROR_NOT_SUPPORTED; }
+    virtual uint32 GetConfiguration(_Out_ Array<byte>^* ConfigurationDataPtr) { return ERROR_NOT_SUPPORTED; }
+    virtual uint32 Initialize() { return ERROR_SUCCESS; }
+    virtual uint32 Shutdown() { return ERROR_SUCCESS; }
+
+    virtual uint32 EnumDevices(
+        _In_ ENUM_DEVICES_OPTIONS Options,
+        _Out_ IAdapterDeviceVector^* DeviceListPtr,
+        _Out_opt_ IAdapterIoRequest^* RequestPtr)
+    {
+        *DeviceListPtr = ref new AdapterDeviceVector();
+        return ERROR_SUCCESS;
+    }
+    virtual uint32 GetProperty(_Inout_ IAdapterProperty^ Property, _Out_opt_ IAdapterIoRequest^* RequestPtr) { return ERROR_NOT_SUPPORTED; }
+    virtual uint32 SetProperty(_In_ IAdapterProperty^ Property, _Out_opt_ IAdapterIoRequest^* RequestPtr) { return ERROR_NOT_SUPPORTED; }
+    virtual uint32 GetPropertyValue(
+        _In_ IAdapterProperty^ Property,
+        _In_ String^ AttributeName,
+        _Out_ IAdapterValue^* ValuePtr,
+        _Out_opt_ IAdapterIoRequest^* RequestPtr)
+    {
+        return ERROR_NOT_SUPPORTED;
+    }
+    virtual uint32 SetPropertyValue(
+        _In_ IAdapterProperty^ Property,
+        _In_ IAdapterValue^ Value,
+        _Out_opt_ IAdapterIoRequest^* RequestPtr)
+    {
+        return ERROR_NOT_SUPPORTED;
+    }
+    virtual uint32 CallMethod(_Inout_ IAdapterMethod^ Method, _Out_opt_ IAdapterIoRequest^* RequestPtr) { return ERROR_NOT_SUPPORTED; }
+    virtual uint32 RegisterSignalListener(
+        _In_ IAdapterSignal^ Signal,
+        _In_ IAdapterSignalListener^ Listener,
+        _In_opt_ Object^ ListenerContext)
+    {
+        return ERROR_SUCCESS;
+    }
+    virtual uint32 UnregisterSignalListener(_In_ IAdapterSignal^ Signal, _In_ IAdapterSignalListener^ Listener) { return ERROR_SUCCESS; }
+};
+
+template<typename _TCall>
+static double TimePerCall(int points, _TCall call)
+{
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < SIGNALS_PER_RUN; i++)
+    {
+        // scatter the points so that consecutive signals do not hit neighbours
+        call((int)(((long long)i * 7919) % points));
+    }
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / SIGNALS_PER_RUN;
+}
+
+static void CovStorm(int points)
+{
+    BenchDevice^ device = ref new BenchDevice(L"Storm" + points.ToString());
+    vector<IAdapterProperty^> properties;
+    vector<IAdapterSignal^> signals;
+
+    for (int i = 0; i < points; i++)
+    {
+        IAdapterValue^ value = ref new BenchValue(L"Value", PropertyValue::CreateInt32(i));
+        IAdapterProperty^ property = ref new BenchProperty(L"Point" + i.ToString(), ref new BenchAttribute(value));
+        device->AddProperty(property);
+        properties.push_back(property);
+
+        // COV signal of this point, as an adapter raises it when the value changes
+        BenchSignal^ signal = ref new BenchSignal(Constants::CHANGE_OF_VALUE_SIGNAL);
+        signal->Params->Append(ref new BenchValue(Constants::COV__PROPERTY_HANDLE, property));
+        signal->Params->Append(ref new BenchValue(Constants::COV__ATTRIBUTE_HANDLE, value));
+        signals.push_back(signal);
+    }
+
+    BridgeDevice^ bridgeDevice = ref new BridgeDevice();
+    QStatus status = bridgeDevice->Initialize(device);
+    if (ER_OK != status)
+    {
+        printf("%6d points: device initialization failed (%s)\n", points, QCC_StatusText(status));
+        return;
+    }
+
+    double perSignal = TimePerCall(points, [&](int point)
+    {
+        bridgeDevice->AdapterSignalHandler(signals[point], nullptr);
+    });
+    int misses = 0;
+    double perLookup = TimePerCall(points, [&](int point)
+    {
+        misses += bridgeDevice->GetBusObjectPath(properties[point]).empty();
+    });
+
+    printf("%6d points: COV signal %8.1f ns, bus object path %8.1f ns%s\n",
+        points, perSignal, perLookup, misses ? " (unexpected misses)" : "");
+
+    bridgeDevice->Shutdown();
+}
+
+[MTAThread]
+int main(Array<String^>^ args)
+{
+    QStatus status = alljoyn_init();
+    if (ER_OK != status)
+    {
+        printf("alljoyn_init failed (%s)\n", QCC_StatusText(status));
+        return 1;
+    }
+
+    // the bridge devices reach the adapter through the bridge instance
+    DsbBridge^ bridge = ref new DsbBridge(ref new BenchAdapter());
+
+    CovStorm(10);
+    CovStorm(100);
+    CovStorm(1000);
+    CovStorm(10000);
+
+    alljoyn_shutdown();
+    return 0;
+}
@@ -0,0 +1,224 @@
+//
+// Copyright (c) 2015, Microsoft Corporation
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR
+// IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+
+//
+// Concurrent Get and Set requests on one property, as DeviceProperty issues
+// them once the bus dispatches property callbacks concurrently.
+// PropertyAccessTest.vcxproj builds it with the adapter solutions. PropertyAccess.h
+// only needs the standard library, so it also builds on its own:
+//
+//     cl /EHsc /I.. PropertyAccessTest.cpp
+//     g++ -std=c++11 -pthread -I.. PropertyAccessTest.cpp
+//
+
+#ifndef _Out_opt_
+#define _Out_opt_
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "PropertyAccess.h"
+
+using namespace BridgeRT;
+
+static int s_failures = 0;
+
+#define CHECK(_condition_) \
+    if (!(_condition_)) \
+    { \
+        printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #_condition_); \
+        s_failures++; \
+    }
+
+//
+// Stands in for an adapter property. Its value is two fields that a write
+// updates one after the other, so an unordered Get sees them differ.
+//
+struct TestProperty
+{
+    TestProperty() : first(0), second(0), callsInAdapter(0), maxCallsInAdapter(0), reads(0) {}
+
+    void Enter()
+    {
+        int calls = ++callsInAdapter;
+        int max = maxCallsInAdapter;
+        while (calls > max && !maxCallsInAdapter.compare_exchange_weak(max, calls))
+        {
+        }
+    }
+
+    uint32_t Read(int &value, int delayMsec)
+    {
+        Enter();
+        reads++;
+        int a = first;
+        std::this_thread::sleep_for(std::chrono::milliseconds(delayMsec));
+        int b = second;
+        callsInAdapter--;
+        value = (a == b) ? a : -1;
+        return 0;
+    }
+
+    uint32_t Write(int value, int delayMsec)
+    {
+        Enter();
+        first = value;
+        std::this_thread::sleep_for(std::chrono::milliseconds(delayMsec));
+        second = value;
+        callsInAdapter--;
+        return 0;
+    }
+
+    volatile int first;
+    volatile int second;
+    std::atomic<int> callsInAdapter;
+    std::atomic<int> maxCallsInAdapter;
+    std::atomic<int> reads;
+};
+
+static void ConcurrentGetAndSet()
+{
+    PropertyAccess<int> access;
+    TestProperty property;
+    std::atomic<int> tornValues(0);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < 4; t++)
+    {
+        threads.push_back(std::thread([&]
+        {
+            for (int i = 0; i < 50; i++)
+            {
+                access.Get(
+                    [&](int &value) { return property.Read(value, 1); },
+                    [&](uint32_t, const int &value)
+                    {
+                        if (value < 0)
+                        {
+                            tornValues++;
+                        }
+                    });
+            }
+        }));
+    }
+    for (int t = 0; t < 2; t++)
+    {
+        threads.push_back(std::thread([&, t]
+        {
+            for (int i = 1; i <= 50; i++)
+            {
+                access.Set([&] { return property.Write(t * 1000 + i, 1); });
+            }
+        }));
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    CHECK(0 == tornValues);
+    CHECK(1 == property.maxCallsInAdapter);
+    CHECK(property.first == property.second);
+}
+
+static void GetsShareReadInProgress()
+{
+    PropertyAccess<int> access;
+    TestProperty property;
+    std::atomic<int> coalescedGets(0);
+    std::vector<std::thread> threads;
+
+    property.first = property.second = 7;
+    for (int t = 0; t < 8; t++)
+    {
+        threads.push_back(std::thread([&]
+        {
+            bool coalesced = false;
+            int result = 0;
+            access.Get(
+                [&](int &value) { return property.Read(value, 100); },
+                [&](uint32_t, const int &value) { result = value; },
+                &coalesced);
+            CHECK(7 == result);
+            if (coalesced)
+            {
+                coalescedGets++;
+            }
+        }));
+        if (0 == t)
+        {
+            // let the first Get start its read
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    CHECK(property.reads + coalescedGets == 8);
+    CHECK(property.reads < 8);
+}
+
+static void GetAfterSetDoesNotShareOlderRead()
+{
+    PropertyAccess<int> access;
+    TestProperty property;
+    int staleResult = 0;
+    int freshResult = 0;
+
+    property.first = property.second = 1;
+    std::thread staleGet([&]
+    {
+        access.Get(
+            [&](int &value) { return property.Read(value, 100); },
+            [&](uint32_t, const int &value) { staleResult = value; });
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    std::thread set([&]
+    {
+        access.Set([&] { return property.Write(2, 1); });
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    bool coalesced = true;
+    access.Get(
+        [&](int &value) { return property.Read(value, 1); },
+        [&](uint32_t, const int &value) { freshResult = value; },
+        &coalesced);
+
+    staleGet.join();
+    set.join();
+
+    CHECK(1 == staleResult);
+    CHECK(!coalesced);
+    CHECK(2 == freshResult);
+}
+
+int main()
+{
+    ConcurrentGetAndSet();
+    GetsShareReadInProgress();
+    GetAfterSetDoesNotShareOlderRead();
+
+    printf("%s\n", s_failures ? "FAILED" : "PASSED");
+    return s_failures ? 1 : 0;
+}
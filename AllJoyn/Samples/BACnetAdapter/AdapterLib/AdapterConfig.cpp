@@ -47,6 +47,7 @@ using namespace std;
     #define BACNET_STACK_XML_BBMD_IP_ADDR L"BBMD_IPAddress"
     #define BACNET_STACK_XML_BBMD_IP_PORT L"BBMD_Port"
     #define BACNET_STACK_XML_REQUEST_PRIORITY L"RequestPriority"
+    #define BACNET_STACK_XML_MAX_DEVICE_REQUESTS L"MaxDeviceRequests"
     #define BACNET_STACK_XML_NETWORK_INTERFACE L"NetworkInterface"
     #define BACNET_STACK_XML_DEV_INSTANCE_MIN L"DeviceInstanceMin"
     #define BACNET_STACK_XML_DEV_INSTANCE_MAX L"DeviceInstanceMax"
@@ -57,6 +58,10 @@ using namespace std;
     // Sample device filter token
     #define BACNET_DEVICE_FILTER_TOKEN_SAMPLE   L"Device_Model_Filter_Token"
 
+#define GENERAL_CFG_XML_VALUE_CACHE_ELEMENT L"ValueCache"
+    #define GENERAL_CFG_XML_VALUE_CACHE_MAX_AGE L"MaxAgeMsec"
+    #define GENERAL_CFG_XML_VALUE_CACHE_COV_MAX_AGE L"CovMaxAgeMsec"
+
 //
 // AdapterConfig.
 // Description:
@@ -73,9 +78,12 @@ AdapterConfig::AdapterConfig()
     , BbmdIpAddress(BACNET_DEF_BBMD_IP_ADDR)
     , BbmdTimetoliveSeconds(BACNET_DEF_BBMD_TTL)
     , RequestPriority(BACNET_DEF_REQUEST_PRIORITY)
+    , MaxDeviceRequests(BACNET_DEF_MAX_DEVICE_REQUESTS)
     , RxPacketTimeoutMsec(BACNET_PACKET_TIMEOUT_MSEC)
     , DeviceDiscoveryIntervalMin(DEVICE_DISCOVERY_DEF_INTERVAL_MIN)
     , DeviceDiscoveryIdleTimeMsec(DEVICE_DISCOVERY_DEF_IDLE_MSEC)
+    , ValueCacheMaxAgeMsec(VALUE_CACHE_DEF_MAX_AGE_MSEC)
+    , ValueCacheCovMaxAgeMsec(VALUE_CACHE_DEF_COV_MAX_AGE_MSEC)
 {
     this->isValid = true;
 
@@ -352,6 +360,19 @@ AdapterConfig::fromXml(XmlDocument^ XmlDoc)
                 tempConfig.RequestPriority = UINT8(requestPriority);
             }
 
+            // Max requests per device (optional)
+            stackAttr = stackAttributes->GetNamedItem(BACNET_STACK_XML_MAX_DEVICE_REQUESTS);
+            if (stackAttr != nullptr)
+            {
+                UINT32 maxDeviceRequests = stoul(stackAttr->NodeValue->ToString()->Data());
+                if ((maxDeviceRequests == 0) ||
+                    (maxDeviceRequests > BACNET_MAX_DEVICE_REQUESTS))
+                {
+                    return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+                }
+                tempConfig.MaxDeviceRequests = maxDeviceRequests;
+            }
+
             // Min device instance
             stackAttr = stackAttributes->GetNamedItem(BACNET_STACK_XML_DEV_INSTANCE_MIN);
             if (stackAttr == nullptr)
@@ -407,6 +428,28 @@ AdapterConfig::fromXml(XmlDocument^ XmlDoc)
 
         } // Allowed device list
 
+        // Value cache (optional)
+        {
+            XmlElement^ valueCacheElement = dynamic_cast<XmlElement^>(rootElement->SelectSingleNode(GENERAL_CFG_XML_VALUE_CACHE_ELEMENT));
+            if (valueCacheElement != nullptr)
+            {
+                IXmlNode^ maxAgeAttr = valueCacheElement->Attributes->GetNamedItem(GENERAL_CFG_XML_VALUE_CACHE_MAX_AGE);
+                if (maxAgeAttr == nullptr)
+                {
+                    return HRESULT_FROM_WIN32(ERROR_BAD_FORMAT);
+                }
+                tempConfig.ValueCacheMaxAgeMsec = stoul(maxAgeAttr->NodeValue->ToString()->Data());
+
+                // Optional
+                IXmlNode^ covMaxAgeAttr = valueCacheElement->Attributes->GetNamedItem(GENERAL_CFG_XML_VALUE_CACHE_COV_MAX_AGE);
+                if (covMaxAgeAttr != nullptr)
+                {
+                    tempConfig.ValueCacheCovMaxAgeMsec = stoul(covMaxAgeAttr->NodeValue->ToString()->Data());
+                }
+            }
+
+        } // Value cache
+
         *this = tempConfig;
         this->isValid = true;
     }
@@ -459,6 +502,16 @@ AdapterConfig::toXml(XmlDocument^& XmlDoc)
                 stackElement->SetAttribute(BACNET_STACK_XML_REQUEST_PRIORITY, prioritytStr);
             }
 
+            // Max requests per device
+            {
+                String^ maxDeviceRequestsStr;
+                if (FormatString(maxDeviceRequestsStr, L"%d", this->MaxDeviceRequests) == -1)
+                {
+                    return HRESULT_FROM_WIN32(ERROR_NOT_ENOUGH_MEMORY);
+                }
+                stackElement->SetAttribute(BACNET_STACK_XML_MAX_DEVICE_REQUESTS, maxDeviceRequestsStr);
+            }
+
             // Device instance min/max
             {
                 String^ devInstaceStr;
@@ -498,6 +551,27 @@ AdapterConfig::toXml(XmlDocument^& XmlDoc)
             adapterConfigElement->AppendChild(allowedDevicesElement);
         }
 
+        // Value cache
+        {
+            XmlElement^ valueCacheElement = XmlDoc->CreateElement(GENERAL_CFG_XML_VALUE_CACHE_ELEMENT);
+
+            String^ maxAgeStr;
+            if (FormatString(maxAgeStr, L"%u", this->ValueCacheMaxAgeMsec) == -1)
+            {
+                return HRESULT_FROM_WIN32(ERROR_NOT_ENOUGH_MEMORY);
+            }
+            valueCacheElement->SetAttribute(GENERAL_CFG_XML_VALUE_CACHE_MAX_AGE, maxAgeStr);
+
+            String^ covMaxAgeStr;
+            if (FormatString(covMaxAgeStr, L"%u", this->ValueCacheCovMaxAgeMsec) == -1)
+            {
+                return HRESULT_FROM_WIN32(ERROR_NOT_ENOUGH_MEMORY);
+            }
+            valueCacheElement->SetAttribute(GENERAL_CFG_XML_VALUE_CACHE_COV_MAX_AGE, covMaxAgeStr);
+
+            adapterConfigElement->AppendChild(valueCacheElement);
+        }
+
         XmlDoc->AppendChild(adapterConfigElement);
     }
     catch (Exception^ e)
@@ -29,6 +29,10 @@
 #define BACNET_DEF_MAX_DEVICE_INSTANCE  INT32(-1)
 #define BACNET_DEF_REQUEST_PRIORITY     BACNET_REQUEST_PRIORITY_MANUAL_OPERATOR
 
+// Max number of confirmed requests in flight per device, and its valid range
+#define BACNET_DEF_MAX_DEVICE_REQUESTS  UINT32(4)
+#define BACNET_MAX_DEVICE_REQUESTS      UINT32(255) // The stack transactions count
+
 // Valid priority value range (1..16)
 #define BACNET_REQUEST_PRIORITY_HIGHEST         UINT8(1)    // Highest request priority
 #define BACNET_REQUEST_PRIORITY_LOWEST          UINT8(16)   // Lowest request priority
@@ -40,6 +44,14 @@
 // Default device discovery idle time (mSec)
 #define DEVICE_DISCOVERY_DEF_IDLE_MSEC      DWORD(1000)
 
+// Default max age of a cached present value (mSec), 0 disables
+// caching of points that we do not have a COV subscription for.
+#define VALUE_CACHE_DEF_MAX_AGE_MSEC        DWORD(0)
+
+// Default max age of a cached present value (mSec) of points
+// we have a COV subscription for.
+#define VALUE_CACHE_DEF_COV_MAX_AGE_MSEC    DWORD(60 * 1000)
+
 // Default request timeout
 #if _DEBUG || DBG
     #define DEF_IO_REQ_TIMEOUT_MSEC     DWORD(20000)
@@ -99,6 +111,13 @@ public:
     //
     uint8               RequestPriority;
 
+    //
+    // The max number of confirmed requests we keep
+    // in flight (pending response) to a single device.
+    // Valid range is from 1 to 255.
+    //
+    uint32              MaxDeviceRequests;
+
     //
     // UDP/IP port number (0..65534) used for Foreign
     // Device Registration.  Defaults to 47808 (0xBAC0).
@@ -147,6 +166,21 @@ public:
     //
     std::vector<Platform::String^> AllowedDeviceList;
 
+    //
+    // The max age (mSec) of a cached present value, for points we do not
+    // have an active COV subscription for.
+    // 0 means such points are always read from the device.
+    //
+    uint32              ValueCacheMaxAgeMsec;
+
+    //
+    // The max age (mSec) of a cached present value, for points we have an
+    // active COV subscription for.
+    // The notifications keep these up to date, the value is still read from
+    // the device once it is this old in case the subscription was lost.
+    //
+    uint32              ValueCacheCovMaxAgeMsec;
+
 
     //******************************************************************************************************
     //
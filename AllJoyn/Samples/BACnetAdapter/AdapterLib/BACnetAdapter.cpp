@@ -48,6 +48,8 @@ namespace AdapterLib
     //
     BACnetAdapter::BACnetAdapter()
         : deviceDiscoveryThread(this, &BACnetAdapter::deviceDiscoveryThreadEntry)
+        , valueCacheHits(0)
+        , valueCacheMisses(0)
     {
         Windows::ApplicationModel::Package^ package = Windows::ApplicationModel::Package::Current;
         Windows::ApplicationModel::PackageId^ packageId = package->Id;
@@ -337,9 +339,35 @@ namespace AdapterLib
 
         try
         {
-            *ValuePtr = ref new BACnetAdapterValue(dynamic_cast<BACnetAdapterValue^>(attribute->Value));
+            bool isPresentValue = attribute == adapterProperty->GetAttributeByPropertyId(PROP_PRESENT_VALUE);
 
-            return device->ReadPropertyAttribute(adapterProperty, ValuePtr, RequestPtr);
+            *ValuePtr = adapterProperty->CopyAttributeValue(attribute);
+
+            if (!isPresentValue)
+            {
+                return device->ReadPropertyAttribute(adapterProperty, ValuePtr, RequestPtr);
+            }
+
+            //
+            // Present value is served from the cache if it is fresh enough,
+            // with a longer max age if we have a COV subscription for it.
+            //
+            if (adapterProperty->IsPresentValueCached(
+                    this->adapterConfig.ValueCacheMaxAgeMsec,
+                    this->adapterConfig.ValueCacheCovMaxAgeMsec))
+            {
+                ::InterlockedIncrement64(&this->valueCacheHits);
+                return ERROR_SUCCESS;
+            }
+            ::InterlockedIncrement64(&this->valueCacheMisses);
+
+            uint32 status = device->ReadPropertyAttribute(adapterProperty, ValuePtr, RequestPtr);
+            if (status == ERROR_SUCCESS)
+            {
+                (void)adapterProperty->UpdatePresentValue(*ValuePtr);
+            }
+
+            return status;
         }
         catch (OutOfMemoryException^)
         {
@@ -586,6 +614,15 @@ namespace AdapterLib
     }
 
 
+    _Use_decl_annotations_
+    void
+    BACnetAdapter::GetValueCacheStatistics(BACNET_VALUE_CACHE_STATISTICS* StatisticsPtr)
+    {
+        StatisticsPtr->Hits = UINT64(::InterlockedCompareExchange64(&this->valueCacheHits, 0, 0));
+        StatisticsPtr->Misses = UINT64(::InterlockedCompareExchange64(&this->valueCacheMisses, 0, 0));
+    }
+
+
     uint32
     BACnetAdapter::createSignals()
     {
@@ -822,6 +859,15 @@ namespace AdapterLib
                             BACNET_PROPERTY_ID(EventParameters->AsSetValueAck.BACnetPorpertyId),
                             EventParameters->AsSetValueAck.CurrentValue
                             );
+
+        //
+        // The present value is the highest priority command, which may not
+        // be the one we just wrote, so the next read goes to the device.
+        //
+        if (EventParameters->AsSetValueAck.BACnetPorpertyId == PROP_PRESENT_VALUE)
+        {
+            adapterProperty->InvalidatePresentValue();
+        }
     }
 
 } // namespace AdapterLib
\ No newline at end of file
@@ -28,6 +28,24 @@ namespace AdapterLib
     static const std::wstring cAdapterName = L"BACnet Bridge";
     static const std::wstring cDomainPrefix = L"com";
 
+    //
+    // BACNET_VALUE_CACHE_STATISTICS:
+    //  Present value cache statistics.
+    //
+    struct BACNET_VALUE_CACHE_STATISTICS
+    {
+        // Present value reads served from the cache
+        UINT64  Hits;
+
+        // Present value reads that went to the device
+        UINT64  Misses;
+
+        BACNET_VALUE_CACHE_STATISTICS()
+        {
+            RtlZeroMemory(this, sizeof(*this));
+        }
+    };
+
     //
     // BACnetAdapter class.
     // Description:
@@ -158,6 +176,8 @@ namespace AdapterLib
     internal:
         bool IsAllowedDevice(Platform::String^ DeviceModelName);
 
+        void GetValueCacheStatistics(_Out_ BACNET_VALUE_CACHE_STATISTICS* StatisticsPtr);
+
     protected private:
         uint32 createSignals();
 
@@ -239,6 +259,10 @@ namespace AdapterLib
 
         // Adapter configuration
         AdapterConfig adapterConfig;
+
+        // Present value cache hit/miss counters
+        volatile LONG64 valueCacheHits;
+        volatile LONG64 valueCacheMisses;
     };
 
 } // namespace AdapterLib
\ No newline at end of file
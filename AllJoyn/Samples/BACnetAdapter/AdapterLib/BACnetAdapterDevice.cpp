@@ -27,6 +27,23 @@ using namespace Windows::Foundation::Collections;
 
 using namespace BridgeRT;
 
+
+//
+// The estimated size of a single property in a ReadPropertyMultiple
+// response, used for fitting a request to the device max APDU.
+//
+#ifndef RPM_ESTIMATED_PROPERTY_SIZE
+    #define RPM_ESTIMATED_PROPERTY_SIZE 32
+#endif
+
+//
+// The number of objects, or object list entries, we read
+// together during device discovery.
+//
+#ifndef DISCOVERY_BATCH_SIZE
+    #define DISCOVERY_BATCH_SIZE 32
+#endif
+
 namespace AdapterLib
 {
     //
@@ -373,6 +390,8 @@ namespace AdapterLib
     BACnetAdapterProperty::BACnetAdapterProperty(String^ Name, BridgeRT::IAdapterDevice^ ParentObject, String^ ifHint)
         : name(Name)
         , parent(ParentObject)
+        , presentValueTime(0)
+        , isCovActive(false)
     {
         BACnetAdapterDevice^ adapter = dynamic_cast<BACnetAdapterDevice^>(ParentObject);
         std::wstring adapterPrefix(adapter->Parent->ExposedAdapterPrefix->Data());
@@ -384,6 +403,8 @@ namespace AdapterLib
     BACnetAdapterProperty::BACnetAdapterProperty(ULONG BACnetObjectId, BridgeRT::IAdapterDevice^ ParentObject, String^ ifHint)
         : parent(ParentObject)
         , objectId(BACnetObjectId)
+        , presentValueTime(0)
+        , isCovActive(false)
     {
         BACnetAdapterDevice^ adapter = dynamic_cast<BACnetAdapterDevice^>(ParentObject);
         std::wstring adapterPrefix(adapter->Parent->ExposedAdapterPrefix->Data());
@@ -398,6 +419,8 @@ namespace AdapterLib
         , attributes(Other->attributes)
         , objectId(Other->objectId)
         , interfaceHint(Other->interfaceHint)
+        , presentValueTime(0)
+        , isCovActive(false)
     {
     }
 
@@ -456,6 +479,8 @@ namespace AdapterLib
             return ERROR_NOT_ENOUGH_MEMORY;
         }
 
+        AutoLock sync(this->lock);
+
         uint32 status = dynamic_cast<BACnetAdapterValue^>(attribute->Value)->Set(Value);
         if (status == ERROR_SUCCESS)
         {
@@ -478,6 +503,8 @@ namespace AdapterLib
             throw ref new InvalidArgumentException(L"Incompatible DSB Properties");
         }
 
+        AutoLock sync(this->lock);
+
         for (uint32 attrInx = 0; attrInx < otherAttributes->Size; ++attrInx)
         {
             BACnetAdapterValue^ attr = static_cast<BACnetAdapterValue^>(this->attributes[attrInx]->Value);
@@ -520,7 +547,103 @@ namespace AdapterLib
             return ERROR_INTERNAL_ERROR;
         }
 
-        return currentValue->Set(PresetValue);
+        AutoLock sync(this->lock);
+
+        uint32 status = currentValue->Set(PresetValue);
+        if (status == ERROR_SUCCESS)
+        {
+            this->presentValueTime = ::GetTickCount64();
+        }
+
+        return status;
+    }
+
+
+    BACnetAdapterValue^
+    BACnetAdapterProperty::CopyAttributeValue(BACnetAdapterAttribute^ Attribute)
+    {
+        AutoLock sync(this->lock);
+
+        return ref new BACnetAdapterValue(dynamic_cast<BACnetAdapterValue^>(Attribute->Value));
+    }
+
+
+    bool
+    BACnetAdapterProperty::IsPresentValueCached(ULONGLONG MaxAgeMsec, ULONGLONG CovMaxAgeMsec)
+    {
+        AutoLock sync(this->lock);
+
+        if (this->presentValueTime == 0)
+        {
+            return false;
+        }
+
+        //
+        // With a COV subscription the value is kept up to date by the
+        // notifications, but a subscription the device dropped, or that
+        // lapsed, sends none, so the value is still read back from the
+        // device every CovMaxAgeMsec.
+        //
+        ULONGLONG maxAgeMsec = MaxAgeMsec;
+        if (this->isCovActive && (CovMaxAgeMsec > maxAgeMsec))
+        {
+            maxAgeMsec = CovMaxAgeMsec;
+        }
+
+        return (::GetTickCount64() - this->presentValueTime) < maxAgeMsec;
+    }
+
+
+    uint32
+    BACnetAdapterProperty::UpdatePresentValue(IAdapterValue^ PresentValue)
+    {
+        IAdapterValue^ presentValue = this->GetPresentValue();
+        if (presentValue == nullptr)
+        {
+            DSB_ASSERT(FALSE);
+            return ERROR_INTERNAL_ERROR;
+        }
+
+        BACnetAdapterValue^ currentValue = dynamic_cast<BACnetAdapterValue^>(presentValue);
+        if (currentValue == nullptr)
+        {
+            DSB_ASSERT(FALSE);
+            return ERROR_INTERNAL_ERROR;
+        }
+
+        AutoLock sync(this->lock);
+
+        uint32 status = currentValue->Set(PresentValue);
+        if (status == ERROR_SUCCESS)
+        {
+            this->presentValueTime = ::GetTickCount64();
+        }
+
+        return status;
+    }
+
+
+    void
+    BACnetAdapterProperty::InvalidatePresentValue()
+    {
+        AutoLock sync(this->lock);
+
+        this->presentValueTime = 0;
+    }
+
+
+    void
+    BACnetAdapterProperty::SetCovActive(bool IsCovActive)
+    {
+        AutoLock sync(this->lock);
+
+        this->isCovActive = IsCovActive;
+
+        //
+        // Do not trust a value we had before subscribing, the device
+        // sends the current value right after the subscription is made.
+        //
+        this->presentValueTime = 0;
     }
 
 
@@ -591,6 +714,34 @@ namespace AdapterLib
     }
 
 
+    //
+    // PROPERTY_READ_BATCH:
+    //  The attributes of one or more DSB properties (BACnet objects),
+    //  read from the device together.
+    //
+    struct PROPERTY_READ_BATCH
+    {
+        struct PROPERTY_READ
+        {
+            BACnetAdapterProperty^ Property;
+
+            // If we are creating the property, or updating it
+            bool IsNewProperty;
+
+            // The property attribute reads
+            size_t FirstRead;
+            size_t ReadCount;
+        };
+
+        std::vector<PROPERTY_READ> Properties;
+
+        // Attribute reads, with the associated attributes and read status
+        std::vector<BACNET_OBJECT_PROPERTY_DESCRIPTOR> Reads;
+        std::vector<BACnetAdapterAttribute^> Attributes;
+        std::vector<DWORD> ReadStatus;
+    };
+
+
     //
     // BACnetAdapterDevice.
     // Description:
@@ -599,6 +750,7 @@ namespace AdapterLib
     BACnetAdapterDevice::BACnetAdapterDevice(String^ Name, BACnetAdapter^ ParentObject)
         : name(Name)
         , parent(ParentObject)
+        , maxPropertiesPerRead(0)
     {
         // Used only for signature spec
     }
@@ -606,6 +758,7 @@ namespace AdapterLib
 
     BACnetAdapterDevice::BACnetAdapterDevice(BACnetAdapter^ ParentObject)
         : parent(ParentObject)
+        , maxPropertiesPerRead(0)
     {
         this->bacnetAdapter = dynamic_cast<BACnetAdapter^>(ParentObject);
         DSB_ASSERT(this->bacnetAdapter != nullptr);
@@ -625,6 +778,18 @@ namespace AdapterLib
         this->vendorId = VendorId;
         this->stackInterface = StackInterface;
 
+        //
+        // Size ReadPropertyMultiple requests to the device max APDU,
+        // if we do not know it yet, we use ReadProperty.
+        //
+        UINT32 maxApdu;
+        if (this->stackInterface->GetDeviceMaxApdu(DeviceId, &maxApdu) == ERROR_SUCCESS)
+        {
+            AutoLock sync(this->lock);
+
+            this->maxPropertiesPerRead = maxApdu / RPM_ESTIMATED_PROPERTY_SIZE;
+        }
+
         try
         {
             //
@@ -708,23 +873,14 @@ namespace AdapterLib
         IAdapterIoRequest^* RequestPtr
         )
     {
-        uint32 status = ERROR_SUCCESS;
-        BACNET_ADAPTER_OBJECT_ID bacnetObjectId(PropertyObjectId);
-        const BACNET_ADAPTER_OBJECT_DESCRIPTOR* objectDescPtr = GetObjectDescriptor(BACNET_OBJECT_TYPE(bacnetObjectId.Bits.Type));
         BACnetAdapterProperty^ bacnetAdapterProperty = dynamic_cast<BACnetAdapterProperty^>(adapterProperty);
-        bool isNewProperty;
+        PROPERTY_READ_BATCH propertyReadBatch;
 
         if (RequestPtr != nullptr)
         {
             *RequestPtr = nullptr;
         }
 
-        if (objectDescPtr == nullptr)
-        {
-            // An unsupported object. move on...
-            return ERROR_NOT_SUPPORTED;
-        }
-
         if (this->stackInterface == nullptr)
         {
             return ERROR_NOT_READY;
@@ -735,11 +891,51 @@ namespace AdapterLib
             return ERROR_INVALID_HANDLE;
         }
 
+        uint32 status = this->prepareReadProperty(PropertyObjectId, bacnetAdapterProperty, propertyReadBatch);
+        if (status != ERROR_SUCCESS)
+        {
+            return status;
+        }
+
+        return this->readPropertyBatch(propertyReadBatch);
+    }
+
+
+    //
+    //  Routine Description:
+    //      prepareReadProperty() adds the common attributes to a new DSB property
+    //      (BACnet object), and adds the reads of all the attributes we get from
+    //      the device to the given batch.
+    //      The attributes are added to the property by completeReadProperty(),
+    //      once the batch was read.
+    //
+    _Use_decl_annotations_
+    uint32
+    BACnetAdapterDevice::prepareReadProperty(
+        ULONG PropertyObjectId,
+        BACnetAdapterProperty^ Property,
+        PROPERTY_READ_BATCH& Batch
+        )
+    {
+        uint32 status = ERROR_SUCCESS;
+        BACNET_ADAPTER_OBJECT_ID bacnetObjectId(PropertyObjectId);
+        const BACNET_ADAPTER_OBJECT_DESCRIPTOR* objectDescPtr = GetObjectDescriptor(BACNET_OBJECT_TYPE(bacnetObjectId.Bits.Type));
+        PROPERTY_READ_BATCH::PROPERTY_READ propertyRead;
+
+        if (objectDescPtr == nullptr)
+        {
+            // An unsupported object. move on...
+            return ERROR_NOT_SUPPORTED;
+        }
+
         //
         // If we are creating an new property (Attributes.size() == 0),
         // or updating an existing property ((Attributes.size() != 0).
         //
-        isNewProperty = adapterProperty->Attributes->Size == 0;
+        propertyRead.Property = Property;
+        propertyRead.IsNewProperty = Property->Attributes->Size == 0;
+        propertyRead.FirstRead = Batch.Reads.size();
+        propertyRead.ReadCount = 0;
 
         try
         {
@@ -748,15 +944,15 @@ namespace AdapterLib
             //
 
             // PROP_OBJECT_TYPE string
-            if (isNewProperty)
+            if (propertyRead.IsNewProperty)
             {
                 auto attribute = ref new BACnetAdapterAttribute(
                                                         ref new String(AdapterLib::ToString(PROP_OBJECT_TYPE)),
-                                                        bacnetAdapterProperty,
+                                                        Property,
                                                         ref new String(AdapterLib::ToString(BACNET_OBJECT_TYPE(bacnetObjectId.Bits.Type)))
                                                         );
 
-                bacnetAdapterProperty += attribute;
+                Property += attribute;
             }
 
             //
@@ -764,19 +960,19 @@ namespace AdapterLib
             // We can add it to the list of attributes and read it from 
             // the device, but since we have it we can just manually add it.
             //
-            if (isNewProperty)
+            if (propertyRead.IsNewProperty)
             {
                 auto attribute = ref new BACnetAdapterAttribute(
                                                         ref new String(AdapterLib::ToString(PROP_OBJECT_IDENTIFIER)),
-                                                        bacnetAdapterProperty,
+                                                        Property,
                                                         PropertyValue::CreateUInt32(PropertyObjectId)
                                                         );
 
-                bacnetAdapterProperty += attribute;
+                Property += attribute;
             }
 
             //
-            // Read and add all required attributes for the this DSB property (BACnet object)
+            // Queue the reads of all required attributes for the this DSB property (BACnet object)
             //
 
             for (UINT attrInx = 0; attrInx < ARRAYSIZE(objectDescPtr->AttributeDescriptors); ++attrInx)
@@ -800,12 +996,12 @@ namespace AdapterLib
                 //
                 BACnetAdapterAttribute^ attribute;
 
-                if (isNewProperty)
+                if (propertyRead.IsNewProperty)
                 {
                     // Creating a new property...
                     attribute = ref new BACnetAdapterAttribute(
                                             ref new String(AdapterLib::ToString(BACNET_PROPERTY_ID(bacnetAttrDescDsec->Id))),
-                                            bacnetAdapterProperty
+                                            Property
                                             );
                     attribute->Access = bacnetAttrDescDsec->Access;
                     attribute->COVBehavior = bacnetAttrDescDsec->COVBehavior;
@@ -815,7 +1011,7 @@ namespace AdapterLib
                 else
                 {
                     // We are updating an existing property...
-                    attribute = dynamic_cast<BACnetAdapterAttribute^>(bacnetAdapterProperty->Attributes->GetAt(attrInx));
+                    attribute = dynamic_cast<BACnetAdapterAttribute^>(Property->Attributes->GetAt(attrInx));
                 }
 
                 BACNET_OBJECT_PROPERTY_DESCRIPTOR propAttrDesc;
@@ -826,10 +1022,53 @@ namespace AdapterLib
                 propAttrDesc.Params.AssociatedAdapterValue = dynamic_cast<BACnetAdapterValue^>(attribute->Value);
                 propAttrDesc.ValueIndex = BACNET_ARRAY_ALL;
 
-                status = this->stackInterface->ReadObjectProperty(
-                                                &propAttrDesc,
-                                                nullptr, nullptr, nullptr
-                                                );
+                Batch.Reads.push_back(propAttrDesc);
+                Batch.Attributes.push_back(attribute);
+                ++propertyRead.ReadCount;
+
+            } // More attributes to read
+
+            Batch.Properties.push_back(propertyRead);
+        }
+        catch (std::bad_alloc)
+        {
+            status = ERROR_NOT_ENOUGH_MEMORY;
+        }
+        catch (OutOfMemoryException^)
+        {
+            status = ERROR_NOT_ENOUGH_MEMORY;
+        }
+
+        return status;
+    }
+
+
+    //
+    //  Routine Description:
+    //      completeReadProperty() adds the attributes read from the device
+    //      to a DSB property prepared by prepareReadProperty().
+    //
+    _Use_decl_annotations_
+    uint32
+    BACnetAdapterDevice::completeReadProperty(
+        const PROPERTY_READ_BATCH& Batch,
+        size_t PropertyInx
+        )
+    {
+        uint32 status = ERROR_SUCCESS;
+        const PROPERTY_READ_BATCH::PROPERTY_READ& propertyRead = Batch.Properties[PropertyInx];
+        BACnetAdapterProperty^ bacnetAdapterProperty = propertyRead.Property;
+
+        try
+        {
+            for (size_t readInx = propertyRead.FirstRead;
+                 readInx < (propertyRead.FirstRead + propertyRead.ReadCount);
+                 ++readInx)
+            {
+                BACnetAdapterAttribute^ attribute = Batch.Attributes[readInx];
+                BACNET_PROPERTY_ID propertyId = Batch.Reads[readInx].PropertyId;
+
+                status = Batch.ReadStatus[readInx];
                 if (status != ERROR_SUCCESS)
                 {
                     if (status != ERROR_NOT_FOUND)
@@ -845,7 +1084,7 @@ namespace AdapterLib
                     continue;
                 }
 
-                if (bacnetAttrDescDsec->Id == PROP_OBJECT_NAME)
+                if (propertyId == PROP_OBJECT_NAME)
                 {
                     IPropertyValue^ ipv = dynamic_cast<IPropertyValue^>(attribute->Value->Data);
                     DSB_ASSERT(ipv != nullptr);
@@ -855,7 +1094,7 @@ namespace AdapterLib
 
                 status = BACnetAdapterValue::TranslateAttributeValue(
                                             dynamic_cast<BACnetAdapterValue^>(attribute->Value),
-                                            bacnetAttrDescDsec->Id,
+                                            propertyId,
                                             true // From BACnet
                                             );
                 if (status == ERROR_NOT_FOUND)
@@ -870,12 +1109,12 @@ namespace AdapterLib
                 }
 
                 // Add the read attribute to the DSB property
-                if (isNewProperty)
+                if (propertyRead.IsNewProperty)
                 {
                     bacnetAdapterProperty += attribute;
                 }
 
-            } // More attributes to read
+            } // More attributes
         }
         catch (std::bad_alloc)
         {
@@ -892,6 +1131,174 @@ namespace AdapterLib
 
         return status;
     }
+
+
+    _Use_decl_annotations_
+    uint32
+    BACnetAdapterDevice::readPropertyBatch(
+        PROPERTY_READ_BATCH& Batch
+        )
+    {
+        uint32 status = ERROR_SUCCESS;
+
+        try
+        {
+            Batch.ReadStatus.resize(Batch.Reads.size());
+        }
+        catch (std::bad_alloc)
+        {
+            return ERROR_NOT_ENOUGH_MEMORY;
+        }
+
+        if (Batch.Reads.size() != 0)
+        {
+            status = this->readObjectProperties(&Batch.Reads[0], &Batch.ReadStatus[0], Batch.Reads.size());
+            if (status != ERROR_SUCCESS)
+            {
+                return status;
+            }
+        }
+
+        for (size_t propInx = 0; propInx < Batch.Properties.size(); ++propInx)
+        {
+            status = this->completeReadProperty(Batch, propInx);
+            if (status != ERROR_SUCCESS)
+            {
+                break;
+            }
+        }
+
+        return status;
+    }
+
+
+    UINT32
+    BACnetAdapterDevice::getMaxPropertiesPerRead()
+    {
+        AutoLock sync(this->lock);
+
+        return this->maxPropertiesPerRead;
+    }
+
+
+    //
+    //  Routine Description:
+    //      reduceMaxPropertiesPerRead() lowers the ReadPropertyMultiple request
+    //      size after a device failed a request. Concurrent reads may report
+    //      failures of larger requests later, these never raise it back.
+    //
+    _Use_decl_annotations_
+    void
+    BACnetAdapterDevice::reduceMaxPropertiesPerRead(UINT32 MaxPropertiesPerRead)
+    {
+        AutoLock sync(this->lock);
+
+        if (MaxPropertiesPerRead < this->maxPropertiesPerRead)
+        {
+            this->maxPropertiesPerRead = MaxPropertiesPerRead;
+        }
+    }
+
+
+    //
+    //  Routine Description:
+    //      readObjectProperties() reads a list of object properties from the device,
+    //      using ReadPropertyMultiple requests when the device supports them.
+    //      Since the stack does not support segmentation, a request is limited to
+    //      maxPropertiesPerRead properties, which is estimated from the device max APDU,
+    //      and is reduced when a device aborts a request whose response does not fit.
+    //
+    //  Return Value:
+    //      - ERROR_SUCCESS: The properties were read, the status of each
+    //          property read is returned in ReadStatusPtr.
+    //      - The status of the first failed property read.
+    //
+    _Use_decl_annotations_
+    uint32
+    BACnetAdapterDevice::readObjectProperties(
+        BACNET_OBJECT_PROPERTY_DESCRIPTOR* ObjectPropDescsPtr,
+        DWORD* ReadStatusPtr,
+        size_t Count
+        )
+    {
+        size_t readInx = 0;
+
+        while (readInx < Count)
+        {
+            UINT32 batchSize = 1;
+            UINT32 maxBatchSize = this->getMaxPropertiesPerRead();
+            bool isBatchRead = false;
+
+            if (maxBatchSize > 1)
+            {
+                batchSize = (Count - readInx) < maxBatchSize ?
+                                UINT32(Count - readInx) : maxBatchSize;
+            }
+
+            if (batchSize > 1)
+            {
+                DWORD status = this->stackInterface->ReadObjectPropertyMultiple(
+                                                        &ObjectPropDescsPtr[readInx],
+                                                        &ReadStatusPtr[readInx],
+                                                        batchSize,
+                                                        nullptr, nullptr, nullptr
+                                                        );
+                switch (status)
+                {
+                case ERROR_SUCCESS:
+                    isBatchRead = true;
+                    break;
+
+                case ERROR_REQUEST_ABORTED:
+                    //
+                    // The response probably did not fit in the device
+                    // max APDU, retry with smaller requests.
+                    //
+                    this->reduceMaxPropertiesPerRead(batchSize / 2);
+                    continue;
+
+                case ERROR_REQUEST_REFUSED:
+                    // The device does not support ReadPropertyMultiple
+                    this->reduceMaxPropertiesPerRead(0);
+                    continue;
+
+                default:
+                    //
+                    // The device failed the whole request, for instance
+                    // when one of the objects is unknown, read the properties
+                    // one at a time.
+                    //
+                    break;
+                }
+            }
+
+            for (size_t descInx = readInx; descInx < (readInx + batchSize); ++descInx)
+            {
+                //
+                // Read the properties that were not read by ReadPropertyMultiple,
+                // or were missing from the response.
+                //
+                if (isBatchRead && (ReadStatusPtr[descInx] != ERROR_NO_DATA))
+                {
+                    continue;
+                }
+
+                ReadStatusPtr[descInx] = this->stackInterface->ReadObjectProperty(
+                                                                &ObjectPropDescsPtr[descInx],
+                                                                nullptr, nullptr, nullptr
+                                                                );
+                if ((ReadStatusPtr[descInx] != ERROR_SUCCESS) &&
+                    (ReadStatusPtr[descInx] != ERROR_NOT_FOUND))
+                {
+                    return ReadStatusPtr[descInx];
+                }
+            }
+
+            readInx += batchSize;
+        }
+
+        return ERROR_SUCCESS;
+    }
     
 
     _Use_decl_annotations_
@@ -1071,6 +1478,8 @@ namespace AdapterLib
     BACnetAdapterDevice::readDeviceInformation()
     {
         uint32 status = ERROR_SUCCESS;
+        std::vector<BACNET_OBJECT_PROPERTY_DESCRIPTOR> deviceObjPropDescs;
+        std::vector<DWORD> readStatus;
 
         //
         // Get the BACnet object descriptor that
@@ -1091,58 +1500,82 @@ namespace AdapterLib
         //
         // 1) We start with the device information
         //
-        for (int attrInx = 0; attrInx < ARRAYSIZE(bacnetObjectDescPtr->AttributeDescriptors); ++attrInx)
+        try
         {
-            const BACNET_ADAPTER_ATTRIBUTE_DESCRIPTOR* bacnetAttrDescDsec =
-                &bacnetObjectDescPtr->AttributeDescriptors[attrInx];
-
-            if (bacnetAttrDescDsec->Id == BACNET_ADAPTER_LAST_ATTRIBUTE)
+            for (int attrInx = 0; attrInx < ARRAYSIZE(bacnetObjectDescPtr->AttributeDescriptors); ++attrInx)
             {
-                break;
-            }
+                const BACNET_ADAPTER_ATTRIBUTE_DESCRIPTOR* bacnetAttrDescDsec =
+                    &bacnetObjectDescPtr->AttributeDescriptors[attrInx];
 
-            if (!bacnetAttrDescDsec->IsReadFromDevice)
-            {
-                continue;
-            }
+                if (bacnetAttrDescDsec->Id == BACNET_ADAPTER_LAST_ATTRIBUTE)
+                {
+                    break;
+                }
 
-            //
-            // Read the next attributes
-            //
-            BACnetAdapterValue^ attribute = ref new BACnetAdapterValue(
-                                                    ref new String (AdapterLib::ToString(bacnetAttrDescDsec->Id)), 
-                                                    this
-                                                    );
+                if (!bacnetAttrDescDsec->IsReadFromDevice)
+                {
+                    continue;
+                }
 
-            BACNET_OBJECT_PROPERTY_DESCRIPTOR deviceObjPropDesc;
-            deviceObjPropDesc.DeviceId = this->deviceId;
-            deviceObjPropDesc.ObjectInstance = this->deviceId;
-            deviceObjPropDesc.ObjectType = OBJECT_DEVICE;
-            deviceObjPropDesc.PropertyId = bacnetAttrDescDsec->Id;
-            deviceObjPropDesc.Params.AssociatedAdapterValue = attribute;
-            deviceObjPropDesc.ValueIndex = BACNET_ARRAY_ALL;
-
-            status = this->stackInterface->ReadObjectProperty(
-                                            &deviceObjPropDesc,
-                                            nullptr, nullptr, nullptr
-                                            );
+                //
+                // Queue the next attribute read
+                //
+                BACnetAdapterValue^ attribute = ref new BACnetAdapterValue(
+                                                        ref new String (AdapterLib::ToString(bacnetAttrDescDsec->Id)), 
+                                                        this
+                                                        );
+
+                BACNET_OBJECT_PROPERTY_DESCRIPTOR deviceObjPropDesc;
+                deviceObjPropDesc.DeviceId = this->deviceId;
+                deviceObjPropDesc.ObjectInstance = this->deviceId;
+                deviceObjPropDesc.ObjectType = OBJECT_DEVICE;
+                deviceObjPropDesc.PropertyId = bacnetAttrDescDsec->Id;
+                deviceObjPropDesc.Params.AssociatedAdapterValue = attribute;
+                deviceObjPropDesc.ValueIndex = BACNET_ARRAY_ALL;
+
+                deviceObjPropDescs.push_back(deviceObjPropDesc);
+
+            } // More device attributes to read
+
+            readStatus.resize(deviceObjPropDescs.size());
+        }
+        catch (std::bad_alloc)
+        {
+            status = ERROR_NOT_ENOUGH_MEMORY;
+            goto done;
+        }
+
+        if (deviceObjPropDescs.size() != 0)
+        {
+            status = this->readObjectProperties(&deviceObjPropDescs[0], &readStatus[0], deviceObjPropDescs.size());
             if (status != ERROR_SUCCESS)
             {
                 goto done;
             }
+        }
 
-            status = this->storeAttribute(attribute, bacnetAttrDescDsec->Id);
+        for (size_t readInx = 0; readInx < deviceObjPropDescs.size(); ++readInx)
+        {
+            status = readStatus[readInx];
             if (status != ERROR_SUCCESS)
             {
                 goto done;
             }
 
-        } // More device attributes to read
+            status = this->storeAttribute(
+                            deviceObjPropDescs[readInx].Params.AssociatedAdapterValue,
+                            deviceObjPropDescs[readInx].PropertyId
+                            );
+            if (status != ERROR_SUCCESS)
+            {
+                goto done;
+            }
+        }
 
         //
         // We do PROP_OBJECT_LIST as a special case,
         // since the stack does not support segmentation,
-        // and we need to read each list member separately.
+        // and we need to read the list members separately.
         //
         status = this->readObjectList();
 
@@ -1157,6 +1590,8 @@ namespace AdapterLib
     {
         uint32 status = ERROR_SUCCESS;
         BACNET_OBJECT_PROPERTY_DESCRIPTOR deviceObjPropDesc;
+        std::vector<BACNET_OBJECT_PROPERTY_DESCRIPTOR> deviceObjPropDescs;
+        std::vector<DWORD> readStatus;
 
         this->objectIdentifiers.clear();
 
@@ -1200,38 +1635,57 @@ namespace AdapterLib
             } // Read object list size
 
             //
-            // Read object identifiers
+            // Read object identifiers, DISCOVERY_BATCH_SIZE
+            // array elements at a time.
             //
-            for (UINT32 objIdInx = 0; objIdInx < UINT32(this->objectIdentifiers.size()); ++objIdInx)
+            deviceObjPropDescs.reserve(DISCOVERY_BATCH_SIZE);
+            readStatus.resize(DISCOVERY_BATCH_SIZE);
+
+            for (UINT32 firstObjIdInx = 0;
+                 firstObjIdInx < UINT32(this->objectIdentifiers.size());
+                 firstObjIdInx += DISCOVERY_BATCH_SIZE)
             {
-                BACnetAdapterValue^ objectIdValue = ref new BACnetAdapterValue(nullptr, this);
+                deviceObjPropDescs.clear();
 
-                deviceObjPropDesc.DeviceId = this->deviceId;
-                deviceObjPropDesc.ObjectInstance = this->deviceId;
-                deviceObjPropDesc.ObjectType = OBJECT_DEVICE;
-                deviceObjPropDesc.PropertyId = PROP_OBJECT_LIST;
-                deviceObjPropDesc.Params.AssociatedAdapterValue = objectIdValue;
-                deviceObjPropDesc.ValueIndex = objIdInx + 1; // Get the n<th> array element
+                for (UINT32 objIdInx = firstObjIdInx;
+                     (objIdInx < UINT32(this->objectIdentifiers.size())) && (objIdInx < (firstObjIdInx + DISCOVERY_BATCH_SIZE));
+                     ++objIdInx)
+                {
+                    deviceObjPropDesc.DeviceId = this->deviceId;
+                    deviceObjPropDesc.ObjectInstance = this->deviceId;
+                    deviceObjPropDesc.ObjectType = OBJECT_DEVICE;
+                    deviceObjPropDesc.PropertyId = PROP_OBJECT_LIST;
+                    deviceObjPropDesc.Params.AssociatedAdapterValue = ref new BACnetAdapterValue(nullptr, this);
+                    deviceObjPropDesc.ValueIndex = objIdInx + 1; // Get the n<th> array element
+
+                    deviceObjPropDescs.push_back(deviceObjPropDesc);
+                }
 
-                status = this->stackInterface->ReadObjectProperty(
-                                                    &deviceObjPropDesc,
-                                                    nullptr, nullptr, nullptr
-                                                    );
+                status = this->readObjectProperties(&deviceObjPropDescs[0], &readStatus[0], deviceObjPropDescs.size());
                 if (status != ERROR_SUCCESS)
                 {
                     goto done;
                 }
 
-                IPropertyValue^ ipv = dynamic_cast<IPropertyValue^>(objectIdValue->Data);
-                if (ipv == nullptr)
+                for (size_t readInx = 0; readInx < deviceObjPropDescs.size(); ++readInx)
                 {
-                    DSB_ASSERT(FALSE);
+                    status = readStatus[readInx];
+                    if (status != ERROR_SUCCESS)
+                    {
+                        goto done;
+                    }
 
-                    status = ERROR_INVALID_DATA;
-                    goto done;
-                }
+                    IPropertyValue^ ipv = dynamic_cast<IPropertyValue^>(deviceObjPropDescs[readInx].Params.AssociatedAdapterValue->Data);
+                    if (ipv == nullptr)
+                    {
+                        DSB_ASSERT(FALSE);
 
-                this->objectIdentifiers[objIdInx] = ULONG(ipv->GetUInt32());
+                        status = ERROR_INVALID_DATA;
+                        goto done;
+                    }
+
+                    this->objectIdentifiers[firstObjIdInx + readInx] = ULONG(ipv->GetUInt32());
+                }
 
             } // More object identifiers
         }
@@ -1257,41 +1711,65 @@ namespace AdapterLib
     {
         uint32 status = ERROR_SUCCESS;
 
-        for (UINT objInx = 0; objInx < UINT(this->objectIdentifiers.size()); ++objInx)
+        //
+        // Read the objects DISCOVERY_BATCH_SIZE at a time, so attributes
+        // of different objects can share a ReadPropertyMultiple request.
+        //
+        for (UINT firstObjInx = 0;
+             firstObjInx < UINT(this->objectIdentifiers.size());
+             firstObjInx += DISCOVERY_BATCH_SIZE)
         {
-            BACNET_ADAPTER_OBJECT_ID objectId(this->objectIdentifiers[objInx]);
+            PROPERTY_READ_BATCH propertyReadBatch;
 
-            if (objectId.Bits.Type == OBJECT_DEVICE)
+            for (UINT objInx = firstObjInx;
+                 (objInx < UINT(this->objectIdentifiers.size())) && (objInx < (firstObjInx + DISCOVERY_BATCH_SIZE));
+                 ++objInx)
             {
-                continue;
-            }
+                BACNET_ADAPTER_OBJECT_ID objectId(this->objectIdentifiers[objInx]);
 
-            const wchar_t* wszIfHint = AdapterLib::ToString(BACNET_OBJECT_TYPE(objectId.Bits.Type));
-            if (wszIfHint == nullptr)
-            {
-                continue;
-            }
-            BACnetAdapterProperty^ newProperty = ref new BACnetAdapterProperty(objectId.Ulong, this, StringReference(wszIfHint) + objectId.Bits.Instance.ToString());
+                if (objectId.Bits.Type == OBJECT_DEVICE)
+                {
+                    continue;
+                }
 
-            status = this->ReadProperty(objectId.Ulong, newProperty, nullptr);
-            if (status != ERROR_SUCCESS)
-            {
-                if (status != ERROR_NOT_SUPPORTED)
+                const wchar_t* wszIfHint = AdapterLib::ToString(BACNET_OBJECT_TYPE(objectId.Bits.Type));
+                if (wszIfHint == nullptr)
                 {
-                    goto done;
+                    continue;
                 }
+                BACnetAdapterProperty^ newProperty = ref new BACnetAdapterProperty(objectId.Ulong, this, StringReference(wszIfHint) + objectId.Bits.Instance.ToString());
 
-                // An unsupported object. move on...
-                status = ERROR_SUCCESS;
-                continue;
+                status = this->prepareReadProperty(objectId.Ulong, newProperty, propertyReadBatch);
+                if (status != ERROR_SUCCESS)
+                {
+                    if (status != ERROR_NOT_SUPPORTED)
+                    {
+                        goto done;
+                    }
+
+                    // An unsupported object. move on...
+                    status = ERROR_SUCCESS;
+                    continue;
+                }
+            }
+
+            status = this->readPropertyBatch(propertyReadBatch);
+            if (status != ERROR_SUCCESS)
+            {
+                goto done;
             }
 
             try
             {
-                this->propertyMap.insert(std::pair<ULONG, BACnetAdapterProperty^>(objectId.Ulong, newProperty));
+                for (auto& propertyRead : propertyReadBatch.Properties)
+                {
+                    BACnetAdapterProperty^ newProperty = propertyRead.Property;
+
+                    this->propertyMap.insert(std::pair<ULONG, BACnetAdapterProperty^>(newProperty->GetBACnetObjectId(), newProperty));
 
-                // Finally add the property to the device
-                this->properties.push_back(std::move(newProperty));
+                    // Finally add the property to the device
+                    this->properties.push_back(std::move(newProperty));
+                }
             }
             catch (std::bad_alloc)
             {
@@ -1419,6 +1897,15 @@ namespace AdapterLib
                 }
 
                 subscription.IsActive = IsSubscribe;
+
+                if (subscription.SignalDescriptor.Cov.PropId == PROP_PRESENT_VALUE)
+                {
+                    BACnetAdapterProperty^ covProperty = this->GetPropertyByObjectId(subscription.SignalDescriptor.Cov.ObjectId);
+                    if (covProperty != nullptr)
+                    {
+                        covProperty->SetCovActive(IsSubscribe);
+                    }
+                }
                 break;
 
             } // BACnetAdapterSignalTypeValueChanged
@@ -146,6 +146,19 @@ namespace AdapterLib
         BridgeRT::IAdapterValue^ GetPresentValue();
         uint32 SetPresentValue(const BACNET_APPLICATION_DATA_VALUE& PresetValue);
 
+        // A copy of an attribute value, consistent with concurrent updates
+        BACnetAdapterValue^ CopyAttributeValue(BACnetAdapterAttribute^ Attribute);
+
+        //
+        // Present value cache:
+        // The cached present value is valid for MaxAgeMsec since it was last
+        // refreshed, or for CovMaxAgeMsec while we hold a COV subscription for it.
+        //
+        bool IsPresentValueCached(ULONGLONG MaxAgeMsec, ULONGLONG CovMaxAgeMsec);
+        uint32 UpdatePresentValue(BridgeRT::IAdapterValue^ PresentValue);
+        void InvalidatePresentValue();
+        void SetCovActive(bool IsCovActive);
+
         BACnetAdapterAttribute^ GetAttributeByName(Platform::String^ AttributeName);
         BACnetAdapterAttribute^ GetAttributeByPropertyId(BACNET_PROPERTY_ID PropertyId);
         uint32 SetAttributeByPropertyId(_In_ BACNET_PROPERTY_ID PropertyId, _In_ const BACNET_APPLICATION_DATA_VALUE& Value);
@@ -165,6 +178,18 @@ namespace AdapterLib
 
         // The BACnet object ID
         ULONG objectId;
+
+        // When the present value was last refreshed (0 if not cached),
+        // guarded by lock
+        ULONGLONG presentValueTime;
+
+        // If we have an active COV subscription for the present value,
+        // guarded by lock
+        bool isCovActive;
+
+        // Sync object, the attribute values are updated by the BACnet
+        // stack thread and by concurrent Get/Set requests
+        std::recursive_mutex lock;
     };
 
     //
@@ -321,6 +346,8 @@ namespace AdapterLib
     //
     ref class BACnetAdapter;
     ref class BACnetInterface;
+    struct BACNET_OBJECT_PROPERTY_DESCRIPTOR;
+    struct PROPERTY_READ_BATCH;
     ref class BACnetAdapterDevice : BridgeRT::IAdapterDevice,
                                     BridgeRT::IAdapterDeviceLightingService,
                                     BridgeRT::IAdapterDeviceControlPanel
@@ -462,6 +489,25 @@ namespace AdapterLib
         uint32 readObjectList();
         uint32 readObjects();
 
+        uint32 prepareReadProperty(
+                _In_ ULONG PropertyObjectId,
+                _In_ BACnetAdapterProperty^ Property,
+                _Inout_ PROPERTY_READ_BATCH& Batch
+                );
+        uint32 completeReadProperty(
+                _In_ const PROPERTY_READ_BATCH& Batch,
+                _In_ size_t PropertyInx
+                );
+        uint32 readPropertyBatch(_Inout_ PROPERTY_READ_BATCH& Batch);
+        uint32 readObjectProperties(
+                _Inout_updates_(Count) BACNET_OBJECT_PROPERTY_DESCRIPTOR* ObjectPropDescsPtr,
+                _Out_writes_(Count) DWORD* ReadStatusPtr,
+                _In_ size_t Count
+                );
+
+        UINT32 getMaxPropertiesPerRead();
+        void reduceMaxPropertiesPerRead(_In_ UINT32 MaxPropertiesPerRead);
+
         uint32 subscribeForSignals();
 
         uint32 storeAttribute(
@@ -513,6 +559,15 @@ namespace AdapterLib
         // The vendor identifier
         UINT16 vendorId;
 
+        //
+        // The max number of properties we read with a single
+        // ReadPropertyMultiple request, based on the device max APDU.
+        // 0 if the device does not support ReadPropertyMultiple.
+        // Protected by 'lock', reads of different objects can run
+        // concurrently and reduce it.
+        //
+        UINT32 maxPropertiesPerRead;
+
         // The associated objects device identifiers
         std::vector<ULONG> objectIdentifiers;
 
@@ -41,5 +41,6 @@
 #include "tsm.h"
 #include "bvlc.h"
 #include "bip.h"
+#include "bacctx.h"
 
 #pragma prefast(pop)
@@ -41,6 +41,7 @@ namespace AdapterLib
         IoType_StartDeviceDiscovery,
         IoType_ReadDeviceInfo,
         IoType_ReadProperty,
+        IoType_ReadPropertyMultiple,
         IoType_WriteProperty,
         IoType_SubscribeCOV,
         IoType_UnsubscribeCOV,
@@ -66,6 +67,34 @@ namespace AdapterLib
     };
 
 
+    //
+    // StackContextScope:
+    //  Binds the interface stack context to the calling thread, for the
+    //  lifetime of the object, and restores the previous binding.
+    //  Every thread that calls into the stack on behalf of the interface
+    //  must bind its context first.
+    //
+    class StackContextScope
+    {
+    public:
+        StackContextScope(BACNET_STACK_CONTEXT* ContextPtr)
+            : prevContextPtr(bacctx_set(ContextPtr))
+        {
+        }
+
+        ~StackContextScope()
+        {
+            bacctx_set(this->prevContextPtr);
+        }
+
+    private:
+        StackContextScope(const StackContextScope&);
+        StackContextScope& operator=(const StackContextScope&);
+
+        BACNET_STACK_CONTEXT* prevContextPtr;
+    };
+
+
     //
     // BACnetServiceHandlers class.
     // Description:
@@ -124,6 +153,13 @@ namespace AdapterLib
             _In_ BACNET_CONFIRMED_SERVICE_ACK_DATA* ServiceDataPtr
             );
 
+        static void ReadPropertyMultipleAck_Handler(
+            _In_count_(ServiceLen) UINT8* ServiceRequestPtr,
+            _In_ UINT16 ServiceLen,
+            _In_ BACNET_ADDRESS* SrcAddressPtr,
+            _In_ BACNET_CONFIRMED_SERVICE_ACK_DATA* ServiceDataPtr
+            );
+
         static void WritePropertyAck_Handler(
             _In_ BACNET_ADDRESS* SrcAddressPtr,
             _In_ uint8_t InvokeId
@@ -225,6 +261,12 @@ namespace AdapterLib
             &BACnetServiceHandlers::ReadPropertyAck_Handler
             );
 
+        // Read Property Multiple ACK handler
+        apdu_set_confirmed_ack_handler(
+            SERVICE_CONFIRMED_READ_PROP_MULTIPLE,
+            &BACnetServiceHandlers::ReadPropertyMultipleAck_Handler
+            );
+
         // Write Property ACK handler
         apdu_set_confirmed_simple_ack_handler(
             SERVICE_CONFIRMED_WRITE_PROPERTY,
@@ -262,6 +304,10 @@ namespace AdapterLib
             SERVICE_CONFIRMED_READ_PROPERTY,
             &BACnetServiceHandlers::Error_Handler
             );
+        apdu_set_error_handler(
+            SERVICE_CONFIRMED_READ_PROP_MULTIPLE,
+            &BACnetServiceHandlers::Error_Handler
+            );
         apdu_set_error_handler(
             SERVICE_CONFIRMED_WRITE_PROPERTY,
             &BACnetServiceHandlers::Error_Handler
@@ -301,6 +347,11 @@ namespace AdapterLib
             nullptr
             );
 
+        apdu_set_confirmed_ack_handler(
+            SERVICE_CONFIRMED_READ_PROP_MULTIPLE,
+            nullptr
+            );
+
         apdu_set_confirmed_simple_ack_handler(
             SERVICE_CONFIRMED_WRITE_PROPERTY,
             nullptr
@@ -333,6 +384,10 @@ namespace AdapterLib
             SERVICE_CONFIRMED_READ_PROPERTY,
             nullptr
             );
+        apdu_set_error_handler(
+            SERVICE_CONFIRMED_READ_PROP_MULTIPLE,
+            nullptr
+            );
         apdu_set_abort_handler(
             nullptr
             );
@@ -482,7 +537,11 @@ namespace AdapterLib
                         );
         if (length != -1)
         {
-            address_add(deviceIdDescPtr->DeviceId, maxApdu, SrcAddressPtr);
+            {
+                AutoLock sync(thisPtr->stackInterface->addressCacheLock);
+
+                address_add(deviceIdDescPtr->DeviceId, maxApdu, SrcAddressPtr);
+            }
 
             thisPtr->stackInterface->addDevice(deviceIdDescPtr);
         }
@@ -608,6 +667,171 @@ namespace AdapterLib
     }
 
 
+    _Use_decl_annotations_
+    void
+    BACnetServiceHandlers::ReadPropertyMultipleAck_Handler(
+        UINT8* ServiceRequestPtr,
+        UINT16 ServiceLen,
+        BACNET_ADDRESS* SrcAddressPtr,
+        BACNET_CONFIRMED_SERVICE_ACK_DATA* ServiceDataPtr
+        )
+    {
+        DWORD status = ERROR_GEN_FAILURE;
+        BACnetServiceHandlers* thisPtr = BACnetServiceHandlers::Instance();
+        BACnetIoRequest^ ioRequest;
+        BACnetAdapterIoRequest::IO_PARAMETERS ioReqParams;
+        const BACNET_OBJECT_PROPERTY_DESCRIPTOR* objPropDescPtr = nullptr;
+        DWORD* readStatusPtr = nullptr;
+        UINT32 descCount = 0;
+        UINT32 nextDescInx = 0;
+        BACNET_READ_ACCESS_DATA* readAccessDataPtr = nullptr;
+        int length = 0;
+
+        UNREFERENCED_PARAMETER(SrcAddressPtr);
+
+        if ((thisPtr == nullptr) || (thisPtr->stackInterface == nullptr))
+        {
+            DSB_ASSERT(FALSE);
+            goto done;
+        }
+
+        // First get the IO request associated with the 'read property multiple' request
+        ioRequest = thisPtr->stackInterface->getStackPendingRequest(UINT32(ServiceDataPtr->invoke_id));
+        if (ioRequest == nullptr)
+        {
+            //
+            // Request may have been canceled
+            //
+            goto done;
+        }
+
+        // Get access to the caller parameters
+        ioRequest->GetIoParameters(&ioReqParams);
+
+        descCount = UINT32(ioReqParams.InputBufferSize / sizeof(BACNET_OBJECT_PROPERTY_DESCRIPTOR));
+
+        DSB_ASSERT(ioReqParams.OutputBufferSize == descCount * sizeof(DWORD));
+
+        objPropDescPtr = static_cast<const BACNET_OBJECT_PROPERTY_DESCRIPTOR*>(ioReqParams.InputBufferPtr);
+        readStatusPtr = static_cast<DWORD*>(ioReqParams.OutputBufferPtr);
+
+        //
+        // Properties that are missing from the ACK are
+        // left for the caller to read separately.
+        //
+        for (UINT32 descInx = 0; descInx < descCount; ++descInx)
+        {
+            readStatusPtr[descInx] = ERROR_NO_DATA;
+        }
+
+        //
+        // Decode the 'read property multiple' data.
+        // The stack allocates the result lists, we free them when done.
+        //
+        readAccessDataPtr = static_cast<BACNET_READ_ACCESS_DATA*>(calloc(1, sizeof(BACNET_READ_ACCESS_DATA)));
+        if (readAccessDataPtr == nullptr)
+        {
+            status = ERROR_NOT_ENOUGH_MEMORY;
+            goto done;
+        }
+
+        length = rpm_ack_decode_service_request(ServiceRequestPtr, ServiceLen, readAccessDataPtr);
+        if (length <= 0)
+        {
+            status = ERROR_BAD_FORMAT;
+            goto done;
+        }
+
+        for (BACNET_READ_ACCESS_DATA* objectDataPtr = readAccessDataPtr;
+             objectDataPtr != nullptr;
+             objectDataPtr = objectDataPtr->next)
+        {
+            for (BACNET_PROPERTY_REFERENCE* propRefPtr = objectDataPtr->listOfProperties;
+                 propRefPtr != nullptr;
+                 propRefPtr = propRefPtr->next)
+            {
+                //
+                // Results come back in request order, so the matching
+                // descriptor is normally the one following the last match.
+                //
+                UINT32 descInx = descCount;
+                for (UINT32 searchInx = 0; searchInx < descCount; ++searchInx)
+                {
+                    UINT32 candidateInx = (nextDescInx + searchInx) % descCount;
+
+                    const BACNET_OBJECT_PROPERTY_DESCRIPTOR* descPtr = &objPropDescPtr[candidateInx];
+                    if ((readStatusPtr[candidateInx] == ERROR_NO_DATA) &&
+                        (descPtr->ObjectType == objectDataPtr->object_type) &&
+                        (descPtr->ObjectInstance == objectDataPtr->object_instance) &&
+                        (descPtr->PropertyId == propRefPtr->propertyIdentifier) &&
+                        (descPtr->ValueIndex == propRefPtr->propertyArrayIndex))
+                    {
+                        descInx = candidateInx;
+                        break;
+                    }
+                }
+                if (descInx == descCount)
+                {
+                    continue;
+                }
+                nextDescInx = (descInx + 1) % descCount;
+
+                BACnetAdapterValue^ adapterValue = objPropDescPtr[descInx].Params.AssociatedAdapterValue;
+                if (adapterValue == nullptr)
+                {
+                    readStatusPtr[descInx] = ERROR_INVALID_HANDLE;
+                }
+                else if (propRefPtr->value == nullptr)
+                {
+                    // A property access error
+                    readStatusPtr[descInx] = GetWin32Code(BACNET_ERROR_CODE(propRefPtr->error.error_code));
+                }
+                else
+                {
+                    readStatusPtr[descInx] = adapterValue->FromBACnet(*propRefPtr->value);
+                }
+
+            } // More properties
+
+        } // More objects
+
+        status = ERROR_SUCCESS;
+
+    done:
+
+        while (readAccessDataPtr != nullptr)
+        {
+            BACNET_READ_ACCESS_DATA* objectDataPtr = readAccessDataPtr;
+            BACNET_PROPERTY_REFERENCE* propRefPtr = objectDataPtr->listOfProperties;
+
+            while (propRefPtr != nullptr)
+            {
+                BACNET_PROPERTY_REFERENCE* nextPropRefPtr = propRefPtr->next;
+                BACNET_APPLICATION_DATA_VALUE* valuePtr = propRefPtr->value;
+
+                while (valuePtr != nullptr)
+                {
+                    BACNET_APPLICATION_DATA_VALUE* nextValuePtr = valuePtr->next;
+
+                    free(valuePtr);
+                    valuePtr = nextValuePtr;
+                }
+
+                free(propRefPtr);
+                propRefPtr = nextPropRefPtr;
+            }
+
+            readAccessDataPtr = objectDataPtr->next;
+            free(objectDataPtr);
+        }
+
+        if (ioRequest != nullptr)
+        {
+            ioRequest->Complete(status, 0);
+        }
+    }
+
+
     _Use_decl_annotations_
     void
     BACnetServiceHandlers::WritePropertyAck_Handler(
@@ -790,12 +1014,20 @@ namespace AdapterLib
             , txThread(this, &BACnetInterface::txThreadEntry)
             , notifyThread(this, &BACnetInterface::notifyThreadEntry)
     {
+        bacctx_init(&this->stackContext);
+
+        this->txWindowEvent = ::CreateEventEx(nullptr, nullptr, 0, EVENT_MODIFY_STATE | SYNCHRONIZE);
     }
 
 
     BACnetInterface::~BACnetInterface()
     {
         BACnetInterface::Shutdown();
+
+        if (this->txWindowEvent != nullptr)
+        {
+            ::CloseHandle(this->txWindowEvent);
+        }
     }
 
 
@@ -816,9 +1048,16 @@ namespace AdapterLib
         std::string networkInterface = ConvertTo<std::string>(ConfigInfo.NetworkInterface);
         const char* networkInterfaceSz = networkInterface.empty() ? nullptr : networkInterface.c_str();
         std::string bbmdAddress = ConvertTo<std::string>(ConfigInfo.BbmdIpAddress);
+        StackContextScope stackContextScope(&this->stackContext);
 
         this->notificationListener = NotificationListener;
 
+        if (this->txWindowEvent == nullptr)
+        {
+            status = ERROR_NOT_ENOUGH_MEMORY;
+            goto done;
+        }
+
         //
         // Get the broadcast address
         //
@@ -847,7 +1086,11 @@ namespace AdapterLib
         // Set our BACnet services handlers
         this->serviceHandlersPtr->Register(this);
 
-        address_init();
+        {
+            AutoLock sync(this->addressCacheLock);
+
+            address_init();
+        }
 
         // Initialize the data link layer
         if (!datalink_init((char*)networkInterfaceSz))
@@ -910,6 +1153,7 @@ namespace AdapterLib
     BACnetInterface::Shutdown()
     {
         DWORD status = ERROR_SUCCESS;
+        StackContextScope stackContextScope(&this->stackContext);
 
         // Stop the threads
         this->notifyThread.Stop();
@@ -951,6 +1195,18 @@ namespace AdapterLib
             ioReq->Complete(ERROR_CANCELLED, 0);
         }
 
+        // Clean all deferred requests
+        for (auto& deviceTxWindow : this->deviceTxWindows)
+        {
+            for (BACnetIoRequest^ ioReq : deviceTxWindow.second.Deferred)
+            {
+                ioReq->Complete(ERROR_CANCELLED, 0);
+            }
+        }
+        this->deviceTxWindows.clear();
+        this->txStatistics.PendingRequests = 0;
+        this->txStatistics.DeferredRequests = 0;
+
         this->isValid = false;
 
         return status;
@@ -1049,6 +1305,51 @@ namespace AdapterLib
     }
 
 
+    //
+    //  Routine Description:
+    //      ReadObjectPropertyMultiple() reads a batch of object properties
+    //      from a single device with one ReadPropertyMultiple request.
+    //      The request completes successfully when the device acknowledged the
+    //      batch, the result of each individual property is returned in ReadStatusPtr:
+    //      - ERROR_SUCCESS: The associated adapter value was updated.
+    //      - ERROR_NO_DATA: The property was missing from the device response.
+    //      - The property access error reported by the device.
+    //
+    //      Since the stack does not support segmentation, the caller needs to keep
+    //      the response within the device max APDU (see GetDeviceMaxApdu()),
+    //      a device that cannot fit the response aborts the request.
+    //
+    _Use_decl_annotations_
+    DWORD
+    BACnetInterface::ReadObjectPropertyMultiple(
+        const BACNET_OBJECT_PROPERTY_DESCRIPTOR* ObjectPropDescsPtr,
+        DWORD* ReadStatusPtr,
+        UINT32 Count,
+        BACnetAdapterIoRequest::COMPLETE_REQUEST_HANDLER CompletionRoutinePtr,
+        PVOID ContextPtr,
+        IAdapterIoRequest^* adapterIoRequestPtr
+        )
+    {
+        if ((Count == 0) || (ObjectPropDescsPtr == nullptr) || (ReadStatusPtr == nullptr))
+        {
+            return ERROR_INVALID_PARAMETER;
+        }
+
+        //
+        // Set IO parameters
+        //
+        BACnetAdapterIoRequest::IO_PARAMETERS ioParams;
+        ioParams.Type = IoType_ReadPropertyMultiple;
+        ioParams.InputBufferPtr = ObjectPropDescsPtr;
+        ioParams.InputBufferSize = DWORD(Count * sizeof(BACNET_OBJECT_PROPERTY_DESCRIPTOR));
+        ioParams.OutputBufferPtr = ReadStatusPtr;
+        ioParams.OutputBufferSize = DWORD(Count * sizeof(DWORD));
+
+        // Create and submit the IO request
+        return this->doIo(&ioParams, CompletionRoutinePtr, ContextPtr, adapterIoRequestPtr);
+    }
+
+
     _Use_decl_annotations_
     DWORD
     BACnetInterface::WriteObjectProperty(
@@ -1109,6 +1410,45 @@ namespace AdapterLib
     }
 
 
+    _Use_decl_annotations_
+    DWORD
+    BACnetInterface::GetDeviceMaxApdu(
+        UINT32 DeviceId,
+        UINT32* MaxApduPtr
+        )
+    {
+        BACNET_ADDRESS deviceAddress;
+        unsigned maxApdu = 0;
+
+        *MaxApduPtr = 0;
+
+        StackContextScope stackContextScope(&this->stackContext);
+        AutoLock sync(this->addressCacheLock);
+
+        if (!address_get_by_device(DeviceId, &maxApdu, &deviceAddress))
+        {
+            return ERROR_DEVICE_NOT_AVAILABLE;
+        }
+
+        // We cannot receive more than our own max APDU either
+        *MaxApduPtr = UINT32((maxApdu < MAX_APDU) ? maxApdu : MAX_APDU);
+
+        return ERROR_SUCCESS;
+    }
+
+
+    _Use_decl_annotations_
+    void
+    BACnetInterface::GetTxStatistics(
+        BACNET_TX_STATISTICS* StatisticsPtr
+        )
+    {
+        AutoLock sync(this->pendingStackRequestsLock);
+
+        *StatisticsPtr = this->txStatistics;
+    }
+
+
     _Use_decl_annotations_
     bool
     BACnetInterface::addDevice(BACNET_DEVICE_ID* newDeviceIdPtr)
@@ -1308,17 +1648,27 @@ namespace AdapterLib
 
         if (iter == this->pendingStackRequests.end())
         {
+            //
+            // A late response to a request we gave up on, the stack
+            // releases its invoke ID once we return.
+            //
+            this->retiredInvokeIds.erase(RequestId);
+
             return nullptr;
         }
 
         BACnetIoRequest^ ioReq = iter->second;
 
-        this->pendingStackRequests.erase(iter);
+        this->removeStackPendingRequest(iter, ERROR_SUCCESS);
 
         return ioReq;
     }
 
 
+    //
+    // putStackPendingRequest() is called with pendingStackRequestsLock held,
+    // right after the request was sent.
+    //
     uint32
     BACnetInterface::putStackPendingRequest(UINT32 RequestId, BACnetIoRequest^ Request)
     {
@@ -1339,35 +1689,276 @@ namespace AdapterLib
 
                 status = ERROR_DUPLICATE_TAG;
             }
+            else
+            {
+                this->deviceTxWindows[Request->DeviceId].PendingCount++;
+            }
         }
         catch (std::bad_alloc)
         {
+            this->pendingStackRequests.erase(RequestId);
+
             status = ERROR_NOT_ENOUGH_MEMORY;
         }
 
+        if (status == ERROR_SUCCESS)
+        {
+            Request->SentTime = ::GetTickCount64();
+
+            this->txStatistics.SentRequests++;
+            this->txStatistics.PendingRequests++;
+            if (this->txStatistics.PendingRequests > this->txStatistics.PeakPendingRequests)
+            {
+                this->txStatistics.PeakPendingRequests = this->txStatistics.PendingRequests;
+            }
+        }
+
         return status;
     }
 
 
+    //
+    // delStackPendingRequest() is called when we give up on a request,
+    // Status is ERROR_CANCELLED if it was cancelled.
+    //
     uint32
-    BACnetInterface::delStackPendingRequest(BACnetIoRequest^ Request)
+    BACnetInterface::delStackPendingRequest(BACnetIoRequest^ Request, DWORD Status)
     {
+        StackContextScope stackContextScope(&this->stackContext);
         AutoLock sync(this->pendingStackRequestsLock);
 
-        for (auto iter = this->pendingStackRequests.begin();
-             iter != this->pendingStackRequests.end();
-             iter++)
+        //
+        // Requests are keyed by their invoke ID, the invoke ID may have
+        // been reused by now, so make sure it is the same request.
+        //
+        auto iter = this->pendingStackRequests.find(Request->InvokeId);
+
+        if ((iter == this->pendingStackRequests.end()) || (iter->second != Request))
         {
-            BACnetIoRequest^ ioReq = iter->second;
+            return ERROR_NOT_FOUND;
+        }
+
+        //
+        // The device may still respond, and if the invoke ID was reused by
+        // then, the response would complete the new request. So the stack
+        // transaction is not released here, but by the RX thread, once a
+        // response can no longer arrive (we do not run the stack TSM timer).
+        //
+        try
+        {
+            this->retiredInvokeIds[Request->InvokeId] = ::GetTickCount64();
+        }
+        catch (std::bad_alloc)
+        {
+            tsm_free_invoke_id(UINT8(Request->InvokeId));
+        }
 
-            if (ioReq == Request)
+        this->removeStackPendingRequest(iter, Status);
+
+        return ERROR_SUCCESS;
+    }
+
+
+    //
+    // bindDeviceAddress() looks up the device in the stack address cache,
+    // and adds a bind request entry for it if it is not there yet.
+    // The TX thread calls it while the RX thread adds devices to the cache.
+    //
+    bool
+    BACnetInterface::bindDeviceAddress(UINT32 DeviceId, unsigned* MaxApduPtr, BACNET_ADDRESS* AddressPtr)
+    {
+        AutoLock sync(this->addressCacheLock);
+
+        return address_bind_request(DeviceId, MaxApduPtr, AddressPtr);
+    }
+
+
+    //
+    // releaseRetiredInvokeIds() is called by the RX thread, it releases the
+    // stack transactions of requests we gave up on, once a late response is
+    // no longer expected: after the stack APDU timeout and retries.
+    //
+    void
+    BACnetInterface::releaseRetiredInvokeIds()
+    {
+        AutoLock sync(this->pendingStackRequestsLock);
+
+        if (this->retiredInvokeIds.empty())
+        {
+            return;
+        }
+
+        ULONGLONG now = ::GetTickCount64();
+        ULONGLONG holdMsec = ULONGLONG(apdu_timeout()) * (apdu_retries() + 1);
+        bool isReleased = false;
+
+        for (auto iter = this->retiredInvokeIds.begin(); iter != this->retiredInvokeIds.end(); )
+        {
+            if ((now - iter->second) < holdMsec)
             {
-                this->pendingStackRequests.erase(iter);
-                return ERROR_SUCCESS;
+                ++iter;
+                continue;
             }
+
+            tsm_free_invoke_id(UINT8(iter->first));
+            iter = this->retiredInvokeIds.erase(iter);
+            isReleased = true;
         }
 
-        return ERROR_NOT_FOUND;
+        // Let the TX thread send the deferred requests that wait for a transaction
+        if (isReleased && (this->txStatistics.DeferredRequests != 0))
+        {
+            ::SetEvent(this->txWindowEvent);
+        }
+    }
+
+
+    //
+    // removeStackPendingRequest() is called with pendingStackRequestsLock held,
+    // it releases the request slot in the device transaction window.
+    // Status is ERROR_SUCCESS if the device responded, otherwise why we gave up.
+    //
+    void
+    BACnetInterface::removeStackPendingRequest(std::unordered_map<UINT32, BACnetIoRequest^>::iterator Iter, DWORD Status)
+    {
+        BACnetIoRequest^ ioReq = Iter->second;
+
+        this->pendingStackRequests.erase(Iter);
+
+        auto windowIter = this->deviceTxWindows.find(ioReq->DeviceId);
+        if (windowIter != this->deviceTxWindows.end())
+        {
+            DSB_ASSERT(windowIter->second.PendingCount != 0);
+
+            windowIter->second.PendingCount--;
+        }
+
+        this->txStatistics.PendingRequests--;
+
+        if (Status == ERROR_SUCCESS)
+        {
+            ULONGLONG latencyMsec = ::GetTickCount64() - ioReq->SentTime;
+
+            this->txStatistics.CompletedRequests++;
+            this->txStatistics.TotalLatencyMsec += latencyMsec;
+            if (latencyMsec > this->txStatistics.MaxLatencyMsec)
+            {
+                this->txStatistics.MaxLatencyMsec = UINT32(latencyMsec);
+            }
+        }
+        else if (Status == ERROR_CANCELLED)
+        {
+            this->txStatistics.CancelledRequests++;
+        }
+        else
+        {
+            this->txStatistics.TimedOutRequests++;
+        }
+
+        // Let the TX thread send the next deferred request
+        if (this->txStatistics.DeferredRequests != 0)
+        {
+            ::SetEvent(this->txWindowEvent);
+        }
+    }
+
+
+    //
+    // admitRequest() checks if a confirmed request can be sent now. 
+    // If the device already has MaxDeviceRequests requests pending response,
+    // or we are out of stack transactions, the request is deferred, and sent
+    // by the TX thread once a pending request is removed.
+    // Requests of a device are sent in the order they were submitted.
+    //
+    bool
+    BACnetInterface::admitRequest(BACnetIoRequest^ Request)
+    {
+        AutoLock sync(this->pendingStackRequestsLock);
+
+        try
+        {
+            DEVICE_TX_WINDOW& deviceTxWindow = this->deviceTxWindows[Request->DeviceId];
+
+            if (deviceTxWindow.Deferred.empty() &&
+                (deviceTxWindow.PendingCount < this->configInfo.MaxDeviceRequests) &&
+                tsm_transaction_available())
+            {
+                return true;
+            }
+
+            deviceTxWindow.Deferred.push_back(Request);
+        }
+        catch (std::bad_alloc)
+        {
+            // Do not hold the request
+            return true;
+        }
+
+        this->txStatistics.DeferredRequests++;
+        if (this->txStatistics.DeferredRequests > this->txStatistics.PeakDeferredRequests)
+        {
+            this->txStatistics.PeakDeferredRequests = this->txStatistics.DeferredRequests;
+        }
+
+        return false;
+    }
+
+
+    BACnetIoRequest^
+    BACnetInterface::getNextDeferredRequest()
+    {
+        AutoLock sync(this->pendingStackRequestsLock);
+
+        if ((this->txStatistics.DeferredRequests == 0) || !tsm_transaction_available())
+        {
+            return nullptr;
+        }
+
+        for (auto& deviceTxWindow : this->deviceTxWindows)
+        {
+            DEVICE_TX_WINDOW& window = deviceTxWindow.second;
+
+            if (!window.Deferred.empty() &&
+                (window.PendingCount < this->configInfo.MaxDeviceRequests))
+            {
+                BACnetIoRequest^ ioReq = window.Deferred.front();
+
+                window.Deferred.pop_front();
+                this->txStatistics.DeferredRequests--;
+
+                return ioReq;
+            }
+        }
+
+        return nullptr;
+    }
+
+
+    bool
+    BACnetInterface::delDeferredRequest(BACnetIoRequest^ Request)
+    {
+        AutoLock sync(this->pendingStackRequestsLock);
+
+        auto windowIter = this->deviceTxWindows.find(Request->DeviceId);
+        if (windowIter == this->deviceTxWindows.end())
+        {
+            return false;
+        }
+
+        std::deque<BACnetIoRequest^>& deferred = windowIter->second.Deferred;
+
+        for (auto iter = deferred.begin(); iter != deferred.end(); iter++)
+        {
+            if (*iter == Request)
+            {
+                deferred.erase(iter);
+                this->txStatistics.DeferredRequests--;
+
+                return true;
+            }
+        }
+
+        return false;
     }
 
 
@@ -1379,6 +1970,8 @@ namespace AdapterLib
     DWORD
     BACnetInterface::rxThreadEntry()
     {
+        StackContextScope stackContextScope(&this->stackContext);
+
         this->rxThread.SetStartStatus(ERROR_SUCCESS);
 
         //
@@ -1400,6 +1993,8 @@ namespace AdapterLib
             {
                 npdu_handler(&srcAddress, &rxBuffer[0], pduLength);
             }
+
+            this->releaseRetiredInvokeIds();
         }
 
         return ERROR_SUCCESS;
@@ -1414,7 +2009,13 @@ namespace AdapterLib
     DWORD
     BACnetInterface::txThreadEntry()
     {
-        HANDLE events[2] = { this->txThread.GetStopEvent(), this->txThreadWorkQueue.GetNotEmptyEvent() };
+        HANDLE events[3] =
+        {
+            this->txThread.GetStopEvent(),
+            this->txThreadWorkQueue.GetNotEmptyEvent(),
+            this->txWindowEvent
+        };
+        StackContextScope stackContextScope(&this->stackContext);
 
         this->txThread.SetStartStatus(ERROR_SUCCESS);
 
@@ -1436,6 +2037,20 @@ namespace AdapterLib
                 break;
             }
 
+            case WAIT_OBJECT_0 + 2:
+            {
+                //
+                // Room in a device transaction window,
+                // send the deferred requests we can.
+                //
+                BACnetIoRequest^ request;
+                while ((request = this->getNextDeferredRequest()) != nullptr)
+                {
+                    this->txDispatch(request);
+                }
+                break;
+            }
+
             default:
                 DSB_ASSERT(FALSE);
                 break;
@@ -1456,6 +2071,50 @@ namespace AdapterLib
 
     void
     BACnetInterface::onTxWorkItem(BACnetIoRequest^ BACnetAdapterIoRequest)
+    {
+        BACnetAdapterIoRequest::IO_PARAMETERS ioParams;
+        BACnetAdapterIoRequest->GetIoParameters(&ioParams);
+
+        //
+        // Confirmed requests go through the target device transaction window,
+        // so we keep several requests in flight without overrunning the device.
+        // Their input buffer starts with the descriptor of the (first) target
+        // object property.
+        //
+        switch (BACnetAdapterIoRequest->GetType())
+        {
+        case IoType_ReadProperty:
+        case IoType_ReadPropertyMultiple:
+        case IoType_WriteProperty:
+        case IoType_SubscribeCOV:
+        case IoType_UnsubscribeCOV:
+        {
+            DSB_ASSERT(ioParams.InputBufferSize >= sizeof(BACNET_OBJECT_PROPERTY_DESCRIPTOR));
+
+            const BACNET_OBJECT_PROPERTY_DESCRIPTOR* objPropDescPtr =
+                reinterpret_cast<const BACNET_OBJECT_PROPERTY_DESCRIPTOR*>(ioParams.InputBufferPtr);
+
+            BACnetAdapterIoRequest->DeviceId = objPropDescPtr->DeviceId;
+
+            if (!this->admitRequest(BACnetAdapterIoRequest))
+            {
+                return;
+            }
+            break;
+        }
+
+        case IoType_StartDeviceDiscovery:
+        default:
+            // Unconfirmed
+            break;
+        }
+
+        this->txDispatch(BACnetAdapterIoRequest);
+    }
+
+
+    void
+    BACnetInterface::txDispatch(BACnetIoRequest^ BACnetAdapterIoRequest)
     {
         switch (BACnetAdapterIoRequest->GetType())
         {
@@ -1467,6 +2126,10 @@ namespace AdapterLib
             this->txReadProperty(BACnetAdapterIoRequest);
             break;
 
+        case IoType_ReadPropertyMultiple:
+            this->txReadPropertyMultiple(BACnetAdapterIoRequest);
+            break;
+
         case IoType_WriteProperty:
             this->txWriteProperty(BACnetAdapterIoRequest);
             break;
@@ -1512,7 +2175,7 @@ namespace AdapterLib
         // Make sure we 'know' this device
         BACNET_ADDRESS deviceAddress;
         unsigned maxApdu;
-        bool isDeviceBound = address_bind_request(
+        bool isDeviceBound = this->bindDeviceAddress(
                                 objPropDescPtr->DeviceId,
                                 &maxApdu,
                                 &deviceAddress
@@ -1523,8 +2186,11 @@ namespace AdapterLib
             // We need to lock the 'pending requests' list in order
             // to avoid a race condition where the handler is called before
             // the request is added to the 'pending requests' list.
+            // The stack looks the device address up in the address cache,
+            // which is always locked after pendingStackRequestsLock.
             //
             AutoLock sync(this->pendingStackRequestsLock);
+            AutoLock syncAddressCache(this->addressCacheLock);
 
             BACnetAdapterIoRequest->InvokeId = Send_Read_Property_Request(
                                         objPropDescPtr->DeviceId,
@@ -1559,6 +2225,122 @@ namespace AdapterLib
     }
 
 
+    void
+    BACnetInterface::txReadPropertyMultiple(BACnetIoRequest^ BACnetAdapterIoRequest)
+    {
+        DWORD status = ERROR_SUCCESS;
+        BACnetAdapterIoRequest::IO_PARAMETERS ioParams;
+        BACnetAdapterIoRequest->GetIoParameters(&ioParams);
+
+        // Get access to the read property parameters
+        const BACNET_OBJECT_PROPERTY_DESCRIPTOR* objPropDescPtr =
+            reinterpret_cast<const BACNET_OBJECT_PROPERTY_DESCRIPTOR*>(ioParams.InputBufferPtr);
+        size_t descCount = ioParams.InputBufferSize / sizeof(BACNET_OBJECT_PROPERTY_DESCRIPTOR);
+        BACNET_ADDRESS deviceAddress;
+        unsigned maxApdu;
+        bool isDeviceBound;
+
+        DSB_ASSERT(descCount != 0);
+
+        //
+        // Build the read access specification list, consecutive
+        // properties of the same object share a single object entry.
+        //
+        std::vector<BACNET_READ_ACCESS_DATA> readAccessData;
+        std::vector<BACNET_PROPERTY_REFERENCE> propertyRefs;
+        try
+        {
+            readAccessData.reserve(descCount);
+            propertyRefs.resize(descCount);
+        }
+        catch (std::bad_alloc)
+        {
+            status = ERROR_NOT_ENOUGH_MEMORY;
+            goto done;
+        }
+
+        for (size_t descInx = 0; descInx < descCount; ++descInx)
+        {
+            const BACNET_OBJECT_PROPERTY_DESCRIPTOR* descPtr = &objPropDescPtr[descInx];
+
+            DSB_ASSERT(descPtr->DeviceId == objPropDescPtr->DeviceId);
+
+            propertyRefs[descInx].propertyIdentifier = descPtr->PropertyId;
+            propertyRefs[descInx].propertyArrayIndex = descPtr->ValueIndex;
+
+            if ((descInx != 0) &&
+                (descPtr->ObjectType == objPropDescPtr[descInx - 1].ObjectType) &&
+                (descPtr->ObjectInstance == objPropDescPtr[descInx - 1].ObjectInstance))
+            {
+                propertyRefs[descInx - 1].next = &propertyRefs[descInx];
+                continue;
+            }
+
+            BACNET_READ_ACCESS_DATA objectData = { };
+            objectData.object_type = descPtr->ObjectType;
+            objectData.object_instance = descPtr->ObjectInstance;
+            objectData.listOfProperties = &propertyRefs[descInx];
+
+            // No reallocation, we reserved an entry per property
+            readAccessData.push_back(objectData);
+            if (readAccessData.size() > 1)
+            {
+                readAccessData[readAccessData.size() - 2].next = &readAccessData.back();
+            }
+        }
+
+        // Make sure we 'know' this device
+        isDeviceBound = this->bindDeviceAddress(
+                            objPropDescPtr->DeviceId,
+                            &maxApdu,
+                            &deviceAddress
+                            );
+        if (isDeviceBound)
+        {
+            uint8_t pduBuffer[MAX_PDU];
+
+            //
+            // We need to lock the 'pending requests' list in order
+            // to avoid a race condition where the handler is called before
+            // the request is added to the 'pending requests' list.
+            // The stack looks the device address up in the address cache,
+            // which is always locked after pendingStackRequestsLock.
+            //
+            AutoLock sync(this->pendingStackRequestsLock);
+            AutoLock syncAddressCache(this->addressCacheLock);
+
+            BACnetAdapterIoRequest->InvokeId = Send_Read_Property_Multiple_Request(
+                                        &pduBuffer[0],
+                                        sizeof(pduBuffer),
+                                        objPropDescPtr->DeviceId,
+                                        &readAccessData[0]
+                                        );
+            if (BACnetAdapterIoRequest->InvokeId == 0)
+            {
+                status = ERROR_DEVICE_NOT_AVAILABLE;
+                goto done;
+            }
+
+            status = this->putStackPendingRequest(BACnetAdapterIoRequest->InvokeId, BACnetAdapterIoRequest);
+            if (status == ERROR_SUCCESS)
+            {
+                status = ERROR_IO_PENDING;
+            }
+        }
+        else
+        {
+            status = ERROR_DEVICE_NOT_AVAILABLE;
+        }
+
+    done:
+
+        if (status != ERROR_IO_PENDING)
+        {
+            BACnetAdapterIoRequest->Complete(status, 0);
+        }
+    }
+
+
     void
     BACnetInterface::txWriteProperty(BACnetIoRequest^ BACnetAdapterIoRequest)
     {
@@ -1575,7 +2357,7 @@ namespace AdapterLib
         // Make sure we 'know' this device
         BACNET_ADDRESS deviceAddress;
         unsigned maxApdu;
-        bool isDeviceBound = address_bind_request(
+        bool isDeviceBound = this->bindDeviceAddress(
                                 objPropDescPtr->DeviceId,
                                 &maxApdu,
                                 &deviceAddress
@@ -1586,8 +2368,11 @@ namespace AdapterLib
             // We need to lock the 'pending requests' list in order
             // to avoid a race condition where the handler is called before
             // the request is added to the 'pending requests' list.
+            // The stack looks the device address up in the address cache,
+            // which is always locked after pendingStackRequestsLock.
             //
             AutoLock sync(this->pendingStackRequestsLock);
+            AutoLock syncAddressCache(this->addressCacheLock);
 
             BACnetAdapterIoRequest->InvokeId = Send_Write_Property_Request(
                                         objPropDescPtr->DeviceId,
@@ -1640,7 +2425,7 @@ namespace AdapterLib
         // Make sure we 'know' this device
         BACNET_ADDRESS deviceAddress;
         unsigned maxApdu;
-        bool isDeviceBound = address_bind_request(
+        bool isDeviceBound = this->bindDeviceAddress(
                                 objPropDescPtr->DeviceId,
                                 &maxApdu,
                                 &deviceAddress
@@ -1651,8 +2436,11 @@ namespace AdapterLib
             // We need to lock the 'pending requests' list in order
             // to avoid a race condition where the handler is called before
             // the request is added to the 'pending requests' list.
+            // The stack looks the device address up in the address cache,
+            // which is always locked after pendingStackRequestsLock.
             //
             AutoLock sync(this->pendingStackRequestsLock);
+            AutoLock syncAddressCache(this->addressCacheLock);
 
             BACNET_SUBSCRIBE_COV_DATA covData = { 0 };
             covData.monitoredObjectIdentifier.type = UINT16(objPropDescPtr->ObjectType);
@@ -1781,7 +2569,7 @@ namespace AdapterLib
         // since it may have already been completed.
         //
 
-        if (this->delStackPendingRequest(Request) == ERROR_SUCCESS)
+        if (this->delStackPendingRequest(Request, status) == ERROR_SUCCESS)
         {
             Request->Complete(status, 0);
         }
@@ -1789,6 +2577,10 @@ namespace AdapterLib
         {
             Request->Complete(status, 0);
         }
+        else if (this->delDeferredRequest(Request))
+        {
+            Request->Complete(status, 0);
+        }
         else
         {
             // IO request already completed!
@@ -17,6 +17,8 @@
 
 #include <vector>
 #include <map>
+#include <deque>
+#include <unordered_map>
 
 #include "BridgeUtils.h"
 #include "Thread.h"
@@ -125,6 +127,45 @@ namespace AdapterLib
     };
 
 
+    //
+    // BACNET_TX_STATISTICS:
+    //  BACnet confirmed requests scheduling statistics.
+    //
+    struct BACNET_TX_STATISTICS
+    {
+        // Requests sent, and waiting for the device response
+        UINT32  PendingRequests;
+        UINT32  PeakPendingRequests;
+
+        //
+        // Requests waiting for the device transaction window,
+        // or for a free stack transaction.
+        //
+        UINT32  DeferredRequests;
+        UINT32  PeakDeferredRequests;
+
+        // Total number of requests sent, and completed by the device
+        UINT64  SentRequests;
+        UINT64  CompletedRequests;
+
+        //
+        // Total number of sent requests we gave up on before the device
+        // responded: timed out (or failed waiting), and cancelled.
+        //
+        UINT64  TimedOutRequests;
+        UINT64  CancelledRequests;
+
+        // Response latency of the completed requests
+        UINT64  TotalLatencyMsec;
+        UINT32  MaxLatencyMsec;
+
+        BACNET_TX_STATISTICS()
+        {
+            RtlZeroMemory(this, sizeof(*this));
+        }
+    };
+
+
     //
     // BACNET_EVENT_PARAMS:
     //  BACnet event parameters.
@@ -194,6 +235,8 @@ namespace AdapterLib
         BACnetIoRequest(_In_ BACnetAdapterIoRequestPool* PoolPtr, _In_ Platform::Object^ Parent)
             : BACnetAdapterIoRequest(PoolPtr, Parent)
             , InvokeId(0)
+            , DeviceId(UINT32(-1))
+            , SentTime(0)
         {
         }
         ~BACnetIoRequest()
@@ -205,9 +248,17 @@ namespace AdapterLib
             BACnetAdapterIoRequest::reInitialize(Parent);
 
             this->InvokeId = 0;
+            this->DeviceId = UINT32(-1);
+            this->SentTime = 0;
         }
 
         UINT32 InvokeId;
+
+        // The target device, for confirmed requests
+        UINT32 DeviceId;
+
+        // The time the request was sent (mSec)
+        ULONGLONG SentTime;
     };
 
 
@@ -241,6 +292,14 @@ namespace AdapterLib
             _In_opt_ PVOID ContextPtr,
             _Out_opt_ BridgeRT::IAdapterIoRequest^* adapterIoRequestPtr
             );
+        DWORD ReadObjectPropertyMultiple(
+            _In_reads_(Count) const BACNET_OBJECT_PROPERTY_DESCRIPTOR* ObjectPropDescsPtr,
+            _Out_writes_(Count) DWORD* ReadStatusPtr,
+            _In_ UINT32 Count,
+            _In_opt_ BACnetAdapterIoRequest::COMPLETE_REQUEST_HANDLER CompletionRoutinePtr,
+            _In_opt_ PVOID ContextPtr,
+            _Out_opt_ BridgeRT::IAdapterIoRequest^* adapterIoRequestPtr
+            );
         DWORD WriteObjectProperty(
             _In_ const BACNET_OBJECT_PROPERTY_DESCRIPTOR* ObjectPropDescPtr,
             _In_opt_ BACnetAdapterIoRequest::COMPLETE_REQUEST_HANDLER CompletionRoutinePtr,
@@ -261,6 +320,13 @@ namespace AdapterLib
             _Out_opt_ BridgeRT::IAdapterIoRequest^* adapterIoRequestPtr
             );
 
+        DWORD GetDeviceMaxApdu(
+            _In_ UINT32 DeviceId,
+            _Out_ UINT32* MaxApduPtr
+            );
+
+        void GetTxStatistics(_Out_ BACNET_TX_STATISTICS* StatisticsPtr);
+
         bool IsValid() const;
 
     protected private:
@@ -275,6 +341,13 @@ namespace AdapterLib
         // If interface was initialized successfully
         bool isValid;
 
+        //
+        // The stack state of our datalink, the RX/TX threads and the
+        // methods that call into the stack bind it (see StackContextScope),
+        // so that each interface runs its own stack.
+        //
+        BACNET_STACK_CONTEXT stackContext;
+
         //
         // The BACNet network address to send broadcast
         // messages to.
@@ -298,6 +371,7 @@ namespace AdapterLib
 
         void txEnumDevices(BACnetIoRequest^ BACnetAdapterIoRequest);
         void txReadProperty(BACnetIoRequest^ BACnetAdapterIoRequest);
+        void txReadPropertyMultiple(BACnetIoRequest^ BACnetAdapterIoRequest);
         void txWriteProperty(BACnetIoRequest^ BACnetAdapterIoRequest);
         void txSubscribeProperty(BACnetIoRequest^ BACnetAdapterIoRequest, bool IsSubscribe);
 
@@ -320,17 +394,67 @@ namespace AdapterLib
         // The notification listener
         IBACnetNotificationListener^ notificationListener;
 
-        // Requests that are pending stack response
-        std::map<UINT32, BACnetIoRequest^> pendingStackRequests;
+        // Requests that are pending stack response, by invoke ID
+        std::unordered_map<UINT32, BACnetIoRequest^> pendingStackRequests;
+
+        //
+        // Invoke IDs of requests we gave up on -> when we did.
+        // They stay allocated in the stack TSM, so they are not reused while a
+        // late response may still arrive, and are released by the RX thread.
+        //
+        std::map<UINT32, ULONGLONG> retiredInvokeIds;
+
+        //
+        // DEVICE_TX_WINDOW:
+        //  The confirmed requests of a device, pending stack response,
+        //  or deferred until the device has room for more requests.
+        //
+        struct DEVICE_TX_WINDOW
+        {
+            UINT32 PendingCount;
+            std::deque<BACnetIoRequest^> Deferred;
+
+            DEVICE_TX_WINDOW() : PendingCount(0) {}
+        };
+
+        // Device ID -> device transaction window
+        std::map<UINT32, DEVICE_TX_WINDOW> deviceTxWindows;
 
-        // A lock object for pandingStackRequests
+        // Set when a pending request is removed, and there are deferred requests
+        HANDLE txWindowEvent;
+
+        // Request scheduling statistics
+        BACNET_TX_STATISTICS txStatistics;
+
+        //
+        // A lock object for pandingStackRequests, retiredInvokeIds,
+        // deviceTxWindows and txStatistics
+        //
         std::recursive_mutex pendingStackRequestsLock;
 
+        //
+        // A lock object for the stack device address cache (address.c),
+        // which the rx thread adds devices to while the other threads
+        // look them up. address.c is not thread safe, every call into it
+        // must hold this lock, including the Send_XXX() calls that look up
+        // the device address. When both locks are needed, it is taken
+        // after pendingStackRequestsLock.
+        //
+        std::recursive_mutex addressCacheLock;
+
     protected private:
 
         BACnetIoRequest^ getStackPendingRequest(UINT32 RequestId);
         uint32 putStackPendingRequest(UINT32 RequestId, BACnetIoRequest^ RequestPtr);
-        uint32 delStackPendingRequest(BACnetIoRequest^ RequestPtr);
+        uint32 delStackPendingRequest(BACnetIoRequest^ RequestPtr, DWORD Status);
+        void removeStackPendingRequest(std::unordered_map<UINT32, BACnetIoRequest^>::iterator Iter, DWORD Status);
+        void releaseRetiredInvokeIds();
+
+        bool bindDeviceAddress(UINT32 DeviceId, unsigned* MaxApduPtr, BACNET_ADDRESS* AddressPtr);
+
+        bool admitRequest(BACnetIoRequest^ RequestPtr);
+        BACnetIoRequest^ getNextDeferredRequest();
+        bool delDeferredRequest(BACnetIoRequest^ RequestPtr);
 
         bool addDevice(_In_ BACNET_DEVICE_ID* newDeviceIdPtr);
         void updatePropertyBySignal(
@@ -364,6 +488,7 @@ namespace AdapterLib
 
         DWORD   txThreadEntry();
         void    onTxWorkItem(BACnetIoRequest^ adapterIoRequestPtr);
+        void    txDispatch(BACnetIoRequest^ adapterIoRequestPtr);
 
         DWORD   notifyThreadEntry();
 
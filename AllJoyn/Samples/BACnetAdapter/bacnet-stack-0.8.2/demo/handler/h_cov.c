@@ -25,6 +25,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include "config.h"
@@ -51,6 +52,7 @@
 
 typedef struct BACnet_COV_Address {
     bool valid:1;
+    unsigned subscriptions;     /* number of subscriptions sent to it */
     BACNET_ADDRESS dest;
 } BACNET_COV_ADDRESS;
 
@@ -59,7 +61,8 @@ typedef struct BACnet_COV_Address {
 typedef struct BACnet_COV_Subscription_Flags {
     bool valid:1;
     bool issueConfirmedNotifications:1; /* optional */
-    bool send_requested:1;
+    bool send_requested:1;      /* on the send queue */
+    bool confirm_queued:1;      /* on the confirmed notification queue */
 } BACNET_COV_SUBSCRIPTION_FLAGS;
 
 typedef struct BACnet_COV_Subscription {
@@ -67,19 +70,79 @@ typedef struct BACnet_COV_Subscription {
     uint8_t dest_index;
     uint8_t invokeID;   /* for confirmed COV */
     uint32_t subscriberProcessIdentifier;
-    uint32_t lifetime;  /* optional */
+    uint32_t lifetime;  /* optional, COV_Clock time of expiry or 0 */
     BACNET_OBJECT_ID monitoredObjectIdentifier;
+    unsigned object;    /* entry of the monitored object */
+    /* the links below hold entry number + 1, or 0 at the end of a list */
+    unsigned next_subscriber;   /* next subscription to the same object */
+    unsigned next_send; /* next on the send queue */
+    unsigned next_confirm;      /* next on the confirmed notification queue */
 } BACNET_COV_SUBSCRIPTION;
 
+/* an object that has subscriptions, and the list of them */
+typedef struct BACnet_COV_Object {
+    BACNET_OBJECT_ID id;
+    unsigned subscribers;       /* first subscription, entry number + 1 or 0 */
+    unsigned next_changed;      /* next on the changed queue, number + 1 or 0 */
+    bool changed:1;     /* on the changed queue */
+} BACNET_COV_OBJECT;
+
+/* a simple FIFO of entries, linked through the entries */
+typedef struct BACnet_COV_Queue {
+    unsigned head;      /* entry number + 1 or 0 */
+    unsigned tail;      /* entry number + 1 or 0 */
+} BACNET_COV_QUEUE;
+
+/* The subscription and object tables grow on demand, from
+   COV_INITIAL_SUBCRIPTIONS entries up to MAX_COV_SUBCRIPTIONS. There are
+   never more monitored objects than subscriptions, so both have the same
+   number of entries. Monitored objects are found through a hash index
+   and each one has a list of its subscriptions, so that a change only
+   touches the subscriptions to the object that changed. */
 #ifndef MAX_COV_SUBCRIPTIONS
 #define MAX_COV_SUBCRIPTIONS 128
 #endif
-static BACNET_COV_SUBSCRIPTION COV_Subscriptions[MAX_COV_SUBCRIPTIONS];
+#ifndef COV_INITIAL_SUBCRIPTIONS
+#define COV_INITIAL_SUBCRIPTIONS 16
+#endif
+static BACNET_COV_SUBSCRIPTION *COV_Subscriptions;
+static BACNET_COV_OBJECT *COV_Objects;
+static unsigned COV_Size;       /* entries allocated in both tables */
+static unsigned COV_Subscription_Free;  /* no free subscriptions below */
+static unsigned COV_Object_Free;        /* no free objects below */
+static unsigned *COV_Object_Index;      /* object number + 1, or 0 */
+static unsigned COV_Object_Index_Bits;
 #ifndef MAX_COV_ADDRESSES
 #define MAX_COV_ADDRESSES 16
 #endif
 static BACNET_COV_ADDRESS COV_Addresses[MAX_COV_ADDRESSES];
 
+/* objects to check for changes, see handler_cov_object_changed() */
+static BACNET_COV_QUEUE COV_Changed_Queue;
+/* subscriptions with a notification to send */
+static BACNET_COV_QUEUE COV_Send_Queue;
+/* subscriptions waiting for a confirmed notification to complete */
+static BACNET_COV_QUEUE COV_Confirm_Queue;
+
+/* seconds since handler_cov_init(), subscriptions keep the time that
+   they expire so the timer only needs to look at them when one does */
+static uint32_t COV_Clock;
+static uint32_t COV_Next_Expiry;        /* 0 if none expires */
+
+/* Number of monitored objects that handler_cov_task() polls for a change
+   on each call, for objects that do not report their changes through
+   handler_cov_object_changed(). 0 if they all do. */
+#ifndef COV_TASK_POLL_OBJECTS
+#define COV_TASK_POLL_OBJECTS 8
+#endif
+static unsigned COV_Poll_Index;
+/* Number of notifications that handler_cov_task() sends on each call.
+   The default suits the worst case, MS/TP with the ability to send only
+   one notification per task cycle. */
+#ifndef COV_TASK_SEND_NOTIFICATIONS
+#define COV_TASK_SEND_NOTIFICATIONS 1
+#endif
+
 /**
 * Gets the address from the list of COV addresses
 *
@@ -103,35 +166,28 @@ static BACNET_ADDRESS *cov_address_get(
 }
 
 /**
- * Removes the address from the list of COV addresses, if it is not
- * used by other COV subscriptions
+ * Removes a subscription's use of an address from the list of COV
+ * addresses, and the address once no COV subscription uses it
+ *
+ * @param  index - offset into COV address list where address is stored
  */
-static void cov_address_remove_unused(
-    void)
+static void cov_address_release(
+    int index)
 {
-    unsigned index = 0;
-    unsigned cov_index = 0;
-    bool found = false;
-
-    for (cov_index = 0; cov_index < MAX_COV_ADDRESSES; cov_index++) {
-        if (COV_Addresses[cov_index].valid) {
-            found = false;
-            for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-                if ((COV_Subscriptions[index].flag.valid) &&
-                    (COV_Subscriptions[index].dest_index == cov_index)) {
-                    found = true;
-                    break;
-                }
+    if (index < MAX_COV_ADDRESSES) {
+        if (COV_Addresses[index].valid) {
+            if (COV_Addresses[index].subscriptions > 0) {
+                COV_Addresses[index].subscriptions--;
             }
-            if (!found) {
-                COV_Addresses[cov_index].valid = false;
+            if (COV_Addresses[index].subscriptions == 0) {
+                COV_Addresses[index].valid = false;
             }
         }
     }
 }
 
 /**
-* Adds the address to the list of COV addresses
+* Adds a subscription's use of the address to the list of COV addresses
 *
 * @param  dest - address to be added if there is room in the list
 *
@@ -154,6 +210,7 @@ static int cov_address_add(
                 found = bacnet_address_same(dest, cov_dest);
                 if (found) {
                     index = i;
+                    COV_Addresses[i].subscriptions++;
                     break;
                 }
             }
@@ -167,6 +224,7 @@ static int cov_address_add(
                     cov_dest = &COV_Addresses[i].dest;
                     bacnet_address_copy(cov_dest, dest);
                     COV_Addresses[i].valid = true;
+                    COV_Addresses[i].subscriptions = 1;
                     break;
                 }
             }
@@ -176,6 +234,432 @@ static int cov_address_add(
     return index;
 }
 
+/* the number of seconds until a subscription expires, 0 if it does not */
+static uint32_t cov_time_remaining(
+    BACNET_COV_SUBSCRIPTION * cov_subscription)
+{
+    if (cov_subscription->lifetime > COV_Clock) {
+        return cov_subscription->lifetime - COV_Clock;
+    }
+
+    return 0;
+}
+
+static unsigned cov_object_hash(
+    uint16_t object_type,
+    uint32_t object_instance)
+{
+    uint32_t key = ((uint32_t) object_type << 22) ^ object_instance;
+
+    /* multiplicative hash, the top bits are the well mixed ones */
+    return (unsigned) (((uint32_t) (key * 2654435761UL)) >> (32 -
+            COV_Object_Index_Bits));
+}
+
+/**
+ * Finds a monitored object
+ *
+ * @return the object entry, or NULL if the object has no subscriptions
+ */
+static BACNET_COV_OBJECT *cov_object_find(
+    uint16_t object_type,
+    uint32_t object_instance)
+{
+    unsigned mask;
+    unsigned slot;
+    unsigned number;
+    BACNET_COV_OBJECT *cov_object = NULL;
+
+    if (COV_Object_Index == NULL) {
+        return NULL;
+    }
+    mask = (1U << COV_Object_Index_Bits) - 1;
+    slot = cov_object_hash(object_type, object_instance);
+    while ((number = COV_Object_Index[slot]) != 0) {
+        cov_object = &COV_Objects[number - 1];
+        if ((cov_object->id.type == object_type) &&
+            (cov_object->id.instance == object_instance)) {
+            return cov_object;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return NULL;
+}
+
+static void cov_object_index_insert(
+    unsigned number)
+{
+    unsigned mask = (1U << COV_Object_Index_Bits) - 1;
+    unsigned slot;
+
+    slot =
+        cov_object_hash(COV_Objects[number - 1].id.type,
+        COV_Objects[number - 1].id.instance);
+    while (COV_Object_Index[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+    COV_Object_Index[slot] = number;
+}
+
+static void cov_object_index_remove(
+    unsigned number)
+{
+    unsigned mask = (1U << COV_Object_Index_Bits) - 1;
+    unsigned hole;
+    unsigned slot;
+    unsigned home;
+    BACNET_COV_OBJECT *cov_object = NULL;
+
+    cov_object = &COV_Objects[number - 1];
+    hole = cov_object_hash(cov_object->id.type, cov_object->id.instance);
+    while (COV_Object_Index[hole] != number) {
+        hole = (hole + 1) & mask;
+    }
+    /* move back any later entry of the run that may not probe past the
+       hole, so that lookups never need tombstones */
+    slot = hole;
+    for (;;) {
+        slot = (slot + 1) & mask;
+        if (COV_Object_Index[slot] == 0) {
+            break;
+        }
+        cov_object = &COV_Objects[COV_Object_Index[slot] - 1];
+        home = cov_object_hash(cov_object->id.type, cov_object->id.instance);
+        if ((hole <= slot) ? ((hole < home) && (home <= slot))
+            : ((hole < home) || (home <= slot))) {
+            continue;
+        }
+        COV_Object_Index[hole] = COV_Object_Index[slot];
+        hole = slot;
+    }
+    COV_Object_Index[hole] = 0;
+}
+
+/**
+ * Grows the subscription and object tables
+ *
+ * @return true if there are more free entries
+ */
+static bool cov_grow(
+    void)
+{
+    BACNET_COV_SUBSCRIPTION *subscriptions = NULL;
+    BACNET_COV_OBJECT *objects = NULL;
+    unsigned *object_index = NULL;
+    unsigned size = 0;
+    unsigned bits = 0;
+    unsigned i = 0;
+
+    size = COV_Size ? (COV_Size * 2) : COV_INITIAL_SUBCRIPTIONS;
+    if (size > MAX_COV_SUBCRIPTIONS) {
+        size = MAX_COV_SUBCRIPTIONS;
+    }
+    if (size <= COV_Size) {
+        return false;
+    }
+    /* keep the index at most half full */
+    bits = 1;
+    while ((1UL << bits) < (2UL * size)) {
+        bits++;
+    }
+    object_index = (unsigned *) calloc((size_t) 1 << bits, sizeof(unsigned));
+    if (object_index == NULL) {
+        return false;
+    }
+    subscriptions =
+        (BACNET_COV_SUBSCRIPTION *) realloc(COV_Subscriptions,
+        size * sizeof(BACNET_COV_SUBSCRIPTION));
+    if (subscriptions == NULL) {
+        free(object_index);
+        return false;
+    }
+    COV_Subscriptions = subscriptions;
+    objects =
+        (BACNET_COV_OBJECT *) realloc(COV_Objects,
+        size * sizeof(BACNET_COV_OBJECT));
+    if (objects == NULL) {
+        free(object_index);
+        return false;
+    }
+    COV_Objects = objects;
+    memset(&COV_Subscriptions[COV_Size], 0,
+        (size - COV_Size) * sizeof(BACNET_COV_SUBSCRIPTION));
+    memset(&COV_Objects[COV_Size], 0,
+        (size - COV_Size) * sizeof(BACNET_COV_OBJECT));
+    free(COV_Object_Index);
+    COV_Object_Index = object_index;
+    COV_Object_Index_Bits = bits;
+    for (i = 0; i < COV_Size; i++) {
+        if (COV_Objects[i].subscribers) {
+            cov_object_index_insert(i + 1);
+        }
+    }
+    COV_Size = size;
+
+    return true;
+}
+
+static void cov_queue_push(
+    BACNET_COV_QUEUE * queue,
+    unsigned number,
+    unsigned *next_of_tail)
+{
+    if (queue->tail) {
+        *next_of_tail = number;
+    } else {
+        queue->head = number;
+    }
+    queue->tail = number;
+}
+
+static unsigned cov_queue_pop(
+    BACNET_COV_QUEUE * queue,
+    unsigned next_of_head)
+{
+    unsigned number = queue->head;
+
+    if (number) {
+        queue->head = next_of_head;
+        if (queue->head == 0) {
+            queue->tail = 0;
+        }
+    }
+
+    return number;
+}
+
+/* queues a notification for the subscription, if one is not queued */
+static void cov_send_queue_push(
+    unsigned index)
+{
+    BACNET_COV_SUBSCRIPTION *cov_subscription = &COV_Subscriptions[index];
+    unsigned *next_of_tail = NULL;
+
+    if (!cov_subscription->flag.send_requested) {
+        cov_subscription->flag.send_requested = true;
+        cov_subscription->next_send = 0;
+        if (COV_Send_Queue.tail) {
+            next_of_tail = &COV_Subscriptions[COV_Send_Queue.tail - 1].next_send;
+        }
+        cov_queue_push(&COV_Send_Queue, index + 1, next_of_tail);
+    }
+}
+
+static BACNET_COV_SUBSCRIPTION *cov_send_queue_pop(
+    void)
+{
+    BACNET_COV_SUBSCRIPTION *cov_subscription = NULL;
+    unsigned number = 0;
+
+    if (COV_Send_Queue.head) {
+        number =
+            cov_queue_pop(&COV_Send_Queue,
+            COV_Subscriptions[COV_Send_Queue.head - 1].next_send);
+        cov_subscription = &COV_Subscriptions[number - 1];
+        cov_subscription->flag.send_requested = false;
+    }
+
+    return cov_subscription;
+}
+
+static void cov_confirm_queue_push(
+    unsigned index)
+{
+    BACNET_COV_SUBSCRIPTION *cov_subscription = &COV_Subscriptions[index];
+    unsigned *next_of_tail = NULL;
+
+    if (!cov_subscription->flag.confirm_queued) {
+        cov_subscription->flag.confirm_queued = true;
+        cov_subscription->next_confirm = 0;
+        if (COV_Confirm_Queue.tail) {
+            next_of_tail =
+                &COV_Subscriptions[COV_Confirm_Queue.tail - 1].next_confirm;
+        }
+        cov_queue_push(&COV_Confirm_Queue, index + 1, next_of_tail);
+    }
+}
+
+static BACNET_COV_SUBSCRIPTION *cov_confirm_queue_pop(
+    void)
+{
+    BACNET_COV_SUBSCRIPTION *cov_subscription = NULL;
+    unsigned number = 0;
+
+    if (COV_Confirm_Queue.head) {
+        number =
+            cov_queue_pop(&COV_Confirm_Queue,
+            COV_Subscriptions[COV_Confirm_Queue.head - 1].next_confirm);
+        cov_subscription = &COV_Subscriptions[number - 1];
+        cov_subscription->flag.confirm_queued = false;
+    }
+
+    return cov_subscription;
+}
+
+static void cov_changed_queue_push(
+    BACNET_COV_OBJECT * cov_object)
+{
+    unsigned *next_of_tail = NULL;
+
+    if (!cov_object->changed) {
+        cov_object->changed = true;
+        cov_object->next_changed = 0;
+        if (COV_Changed_Queue.tail) {
+            next_of_tail =
+                &COV_Objects[COV_Changed_Queue.tail - 1].next_changed;
+        }
+        cov_queue_push(&COV_Changed_Queue,
+            (unsigned) (cov_object - COV_Objects) + 1, next_of_tail);
+    }
+}
+
+static BACNET_COV_OBJECT *cov_changed_queue_pop(
+    void)
+{
+    BACNET_COV_OBJECT *cov_object = NULL;
+    unsigned number = 0;
+
+    if (COV_Changed_Queue.head) {
+        number =
+            cov_queue_pop(&COV_Changed_Queue,
+            COV_Objects[COV_Changed_Queue.head - 1].next_changed);
+        cov_object = &COV_Objects[number - 1];
+        cov_object->changed = false;
+    }
+
+    return cov_object;
+}
+
+/**
+ * Takes a free subscription entry, growing the tables if there is none.
+ * An entry may still be on the queues from an earlier subscription, the
+ * queues skip entries that no longer need their service.
+ *
+ * @return index of the entry, or -1 if out of resources
+ */
+static int cov_subscription_claim(
+    void)
+{
+    BACNET_COV_SUBSCRIPTION *cov_subscription = NULL;
+    unsigned index = 0;
+
+    for (;;) {
+        for (index = COV_Subscription_Free; index < COV_Size; index++) {
+            cov_subscription = &COV_Subscriptions[index];
+            if (!cov_subscription->flag.valid) {
+                COV_Subscription_Free = index + 1;
+                return (int) index;
+            }
+        }
+        COV_Subscription_Free = COV_Size;
+        if (!cov_grow()) {
+            break;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Adds a subscription to the list of subscriptions of its object,
+ * and the object to the monitored objects if it is not there already
+ *
+ * @return true if added, false if out of resources
+ */
+static bool cov_subscription_link(
+    unsigned index)
+{
+    BACNET_COV_SUBSCRIPTION *cov_subscription = &COV_Subscriptions[index];
+    BACNET_COV_OBJECT *cov_object = NULL;
+    unsigned number = 0;
+
+    cov_object =
+        cov_object_find(cov_subscription->monitoredObjectIdentifier.type,
+        cov_subscription->monitoredObjectIdentifier.instance);
+    if (!cov_object) {
+        for (number = COV_Object_Free; number < COV_Size; number++) {
+            if (COV_Objects[number].subscribers == 0) {
+                cov_object = &COV_Objects[number];
+                break;
+            }
+        }
+        if (!cov_object) {
+            return false;
+        }
+        COV_Object_Free = number + 1;
+        cov_object->id = cov_subscription->monitoredObjectIdentifier;
+        cov_object->subscribers = 0;
+        cov_object_index_insert(number + 1);
+    }
+    cov_subscription->object = (unsigned) (cov_object - COV_Objects);
+    cov_subscription->next_subscriber = cov_object->subscribers;
+    cov_object->subscribers = index + 1;
+
+    return true;
+}
+
+/**
+ * Removes a subscription from the list of subscriptions of its object,
+ * and the object from the monitored objects if it was the last one
+ */
+static void cov_subscription_unlink(
+    unsigned index)
+{
+    BACNET_COV_SUBSCRIPTION *cov_subscription = &COV_Subscriptions[index];
+    BACNET_COV_OBJECT *cov_object = &COV_Objects[cov_subscription->object];
+    unsigned *link = &cov_object->subscribers;
+
+    while (*link && (*link != (index + 1))) {
+        link = &COV_Subscriptions[*link - 1].next_subscriber;
+    }
+    if (*link) {
+        *link = cov_subscription->next_subscriber;
+    }
+    cov_subscription->next_subscriber = 0;
+    if (cov_object->subscribers == 0) {
+        cov_object_index_remove(cov_subscription->object + 1);
+        if (cov_subscription->object < COV_Object_Free) {
+            COV_Object_Free = cov_subscription->object;
+        }
+    }
+}
+
+/* ends a subscription, when cancelled or when its lifetime expires */
+static void cov_subscription_remove(
+    unsigned index)
+{
+    BACNET_COV_SUBSCRIPTION *cov_subscription = &COV_Subscriptions[index];
+
+    cov_subscription_unlink(index);
+    cov_subscription->flag.valid = false;
+    cov_address_release(cov_subscription->dest_index);
+    cov_subscription->dest_index = -1;
+    if (cov_subscription->invokeID) {
+        tsm_free_invoke_id(cov_subscription->invokeID);
+        cov_subscription->invokeID = 0;
+    }
+    if (index < COV_Subscription_Free) {
+        COV_Subscription_Free = index;
+    }
+}
+
+/* sets the lifetime of a subscription, in seconds from now or 0 */
+static void cov_lifetime_set(
+    BACNET_COV_SUBSCRIPTION * cov_subscription,
+    uint32_t lifetime)
+{
+    if (lifetime) {
+        cov_subscription->lifetime = COV_Clock + lifetime;
+        if ((COV_Next_Expiry == 0) ||
+            (cov_subscription->lifetime < COV_Next_Expiry)) {
+            COV_Next_Expiry = cov_subscription->lifetime;
+        }
+    } else {
+        cov_subscription->lifetime = 0;
+    }
+}
+
 /*
 BACnetCOVSubscription ::= SEQUENCE {
 Recipient [0] BACnetRecipientProcess,
@@ -283,7 +767,7 @@ static int cov_encode_subscription(
     /* TimeRemaining [3] Unsigned, */
     len =
         encode_context_unsigned(&apdu[apdu_len], 3,
-        cov_subscription->lifetime);
+        cov_time_remaining(cov_subscription));
     apdu_len += len;
 
     return apdu_len;
@@ -309,7 +793,7 @@ int handler_cov_encode_subscriptions(
     unsigned index = 0;
 
     if (apdu) {
-        for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
+        for (index = 0; index < COV_Size; index++) {
             if (COV_Subscriptions[index].flag.valid) {
                 len =
                     cov_encode_subscription(&apdu[apdu_len],
@@ -334,20 +818,27 @@ void handler_cov_init(
 {
     unsigned index = 0;
 
-    for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-        COV_Subscriptions[index].flag.valid = false;
+    if (COV_Size) {
+        memset(COV_Subscriptions, 0,
+            COV_Size * sizeof(BACNET_COV_SUBSCRIPTION));
+        memset(COV_Objects, 0, COV_Size * sizeof(BACNET_COV_OBJECT));
+        memset(COV_Object_Index, 0,
+            ((size_t) 1 << COV_Object_Index_Bits) * sizeof(unsigned));
+    }
+    for (index = 0; index < COV_Size; index++) {
         COV_Subscriptions[index].dest_index = -1;
-        COV_Subscriptions[index].subscriberProcessIdentifier = 0;
-        COV_Subscriptions[index].monitoredObjectIdentifier.type =
-            OBJECT_ANALOG_INPUT;
-        COV_Subscriptions[index].monitoredObjectIdentifier.instance = 0;
-        COV_Subscriptions[index].flag.issueConfirmedNotifications = false;
-        COV_Subscriptions[index].invokeID = 0;
-        COV_Subscriptions[index].lifetime = 0;
-        COV_Subscriptions[index].flag.send_requested = false;
     }
+    COV_Subscription_Free = 0;
+    COV_Object_Free = 0;
+    memset(&COV_Changed_Queue, 0, sizeof(COV_Changed_Queue));
+    memset(&COV_Send_Queue, 0, sizeof(COV_Send_Queue));
+    memset(&COV_Confirm_Queue, 0, sizeof(COV_Confirm_Queue));
+    COV_Clock = 0;
+    COV_Next_Expiry = 0;
+    COV_Poll_Index = 0;
     for (index = 0; index < MAX_COV_ADDRESSES; index++) {
         COV_Addresses[index].valid = false;
+        COV_Addresses[index].subscriptions = 0;
     }
 }
 
@@ -358,86 +849,92 @@ static bool cov_list_subscribe(
     BACNET_ERROR_CODE * error_code)
 {
     bool existing_entry = false;
-    int index;
-    int first_invalid_index = -1;
+    int index = -1;
+    unsigned number = 0;
     bool found = true;
     bool address_match = false;
     BACNET_ADDRESS *dest = NULL;
+    BACNET_COV_OBJECT *cov_object = NULL;
+    BACNET_COV_SUBSCRIPTION *cov_subscription = NULL;
 
     /* unable to subscribe - resources? */
     /* unable to cancel subscription - other? */
 
     /* existing? - match Object ID and Process ID and address */
-    for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-        if (COV_Subscriptions[index].flag.valid) {
-            dest = cov_address_get(COV_Subscriptions[index].dest_index);
-            if (dest) {
-                address_match = bacnet_address_same(src, dest);
-            } else {
-                /* skip address matching - we don't have an address */
-                address_match = true;
+    cov_object =
+        cov_object_find(cov_data->monitoredObjectIdentifier.type,
+        cov_data->monitoredObjectIdentifier.instance);
+    if (cov_object) {
+        number = cov_object->subscribers;
+    }
+    while (number) {
+        index = number - 1;
+        cov_subscription = &COV_Subscriptions[index];
+        number = cov_subscription->next_subscriber;
+        dest = cov_address_get(cov_subscription->dest_index);
+        if (dest) {
+            address_match = bacnet_address_same(src, dest);
+        } else {
+            /* skip address matching - we don't have an address */
+            address_match = true;
+        }
+        if ((cov_subscription->subscriberProcessIdentifier ==
+                cov_data->subscriberProcessIdentifier) && address_match) {
+            existing_entry = true;
+            if (cov_subscription->invokeID) {
+                tsm_free_invoke_id(cov_subscription->invokeID);
+                cov_subscription->invokeID = 0;
             }
-            if ((COV_Subscriptions[index].monitoredObjectIdentifier.type ==
-                    cov_data->monitoredObjectIdentifier.type) &&
-                (COV_Subscriptions[index].monitoredObjectIdentifier.instance ==
-                    cov_data->monitoredObjectIdentifier.instance) &&
-                (COV_Subscriptions[index].subscriberProcessIdentifier ==
-                    cov_data->subscriberProcessIdentifier) && address_match) {
-                existing_entry = true;
-                if (cov_data->cancellationRequest) {
-                    COV_Subscriptions[index].flag.valid = false;
-                    COV_Subscriptions[index].dest_index = -1;
-                    cov_address_remove_unused();
-                } else {
-                    COV_Subscriptions[index].dest_index = cov_address_add(src);
-                    COV_Subscriptions[index].flag.issueConfirmedNotifications =
-                        cov_data->issueConfirmedNotifications;
-                    COV_Subscriptions[index].lifetime = cov_data->lifetime;
-                    COV_Subscriptions[index].flag.send_requested = true;
-                }
-                if (COV_Subscriptions[index].invokeID) {
-                    tsm_free_invoke_id(COV_Subscriptions[index].invokeID);
-                    COV_Subscriptions[index].invokeID = 0;
+            if (cov_data->cancellationRequest) {
+                cov_subscription_remove(index);
+            } else {
+                if (!dest) {
+                    cov_subscription->dest_index = cov_address_add(src);
                 }
-                break;
-            }
-        } else {
-            if (first_invalid_index < 0) {
-                first_invalid_index = index;
+                cov_subscription->flag.issueConfirmedNotifications =
+                    cov_data->issueConfirmedNotifications;
+                cov_lifetime_set(cov_subscription, cov_data->lifetime);
+                cov_send_queue_push(index);
             }
+            break;
         }
     }
-    if (!existing_entry && (first_invalid_index >= 0) &&
-        (!cov_data->cancellationRequest)) {
-        index = first_invalid_index;
-        found = true;
-        COV_Subscriptions[index].flag.valid = true;
-        COV_Subscriptions[index].dest_index = cov_address_add(src);
-        COV_Subscriptions[index].monitoredObjectIdentifier.type =
-            cov_data->monitoredObjectIdentifier.type;
-        COV_Subscriptions[index].monitoredObjectIdentifier.instance =
-            cov_data->monitoredObjectIdentifier.instance;
-        COV_Subscriptions[index].subscriberProcessIdentifier =
-            cov_data->subscriberProcessIdentifier;
-        COV_Subscriptions[index].flag.issueConfirmedNotifications =
-            cov_data->issueConfirmedNotifications;
-        COV_Subscriptions[index].invokeID = 0;
-        COV_Subscriptions[index].lifetime = cov_data->lifetime;
-        COV_Subscriptions[index].flag.send_requested = true;
-    } else if (!existing_entry) {
-        if (first_invalid_index < 0) {
+    if (!existing_entry && (!cov_data->cancellationRequest)) {
+        index = cov_subscription_claim();
+        if (index >= 0) {
+            cov_subscription = &COV_Subscriptions[index];
+            cov_subscription->monitoredObjectIdentifier.type =
+                cov_data->monitoredObjectIdentifier.type;
+            cov_subscription->monitoredObjectIdentifier.instance =
+                cov_data->monitoredObjectIdentifier.instance;
+            if (!cov_subscription_link(index)) {
+                index = -1;
+            }
+        }
+        if (index >= 0) {
+            found = true;
+            cov_subscription->flag.valid = true;
+            cov_subscription->dest_index = cov_address_add(src);
+            cov_subscription->subscriberProcessIdentifier =
+                cov_data->subscriberProcessIdentifier;
+            cov_subscription->flag.issueConfirmedNotifications =
+                cov_data->issueConfirmedNotifications;
+            cov_subscription->invokeID = 0;
+            cov_lifetime_set(cov_subscription, cov_data->lifetime);
+            cov_send_queue_push(index);
+        } else {
             /* Out of resources */
             *error_class = ERROR_CLASS_RESOURCES;
             *error_code = ERROR_CODE_NO_SPACE_TO_ADD_LIST_ELEMENT;
             found = false;
-        } else {
-            /* cancellationRequest - valid object not subscribed */
-            /* From BACnet Standard 135-2010-13.14.2
-               ...Cancellations that are issued for which no matching COV
-               context can be found shall succeed as if a context had
-               existed, returning 'Result(+)'. */
-            found = true;
         }
+    } else if (!existing_entry) {
+        /* cancellationRequest - valid object not subscribed */
+        /* From BACnet Standard 135-2010-13.14.2
+           ...Cancellations that are issued for which no matching COV
+           context can be found shall succeed as if a context had
+           existed, returning 'Result(+)'. */
+        found = true;
     }
 
     return found;
@@ -486,7 +983,7 @@ static bool cov_send_request(
         cov_subscription->monitoredObjectIdentifier.type;
     cov_data.monitoredObjectIdentifier.instance =
         cov_subscription->monitoredObjectIdentifier.instance;
-    cov_data.timeRemaining = cov_subscription->lifetime;
+    cov_data.timeRemaining = cov_time_remaining(cov_subscription);
     cov_data.listOfValues = value_list;
     if (cov_subscription->flag.issueConfirmedNotifications) {
         invoke_id = tsm_next_free_invokeID();
@@ -523,66 +1020,11 @@ static bool cov_send_request(
     return status;
 }
 
-static void cov_lifetime_expiration_handler(
-    unsigned index,
-    uint32_t elapsed_seconds,
-    uint32_t lifetime_seconds)
-{
-    if (index < MAX_COV_SUBCRIPTIONS) {
-        /* handle lifetime expiration */
-        if (lifetime_seconds >= elapsed_seconds) {
-            COV_Subscriptions[index].lifetime -= elapsed_seconds;
-#if 0
-            fprintf(stderr, "COVtimer: subscription[%d].lifetime=%lu\n", index,
-                (unsigned long) COV_Subscriptions[index].lifetime);
-#endif
-        } else {
-            COV_Subscriptions[index].lifetime = 0;
-        }
-        if (COV_Subscriptions[index].lifetime == 0) {
-            /* expire the subscription */
-#if PRINT_ENABLED
-            fprintf(stderr, "COVtimer: PID=%u ",
-                COV_Subscriptions[index].subscriberProcessIdentifier);
-            fprintf(stderr, "%s %u ",
-                bactext_object_type_name(COV_Subscriptions[index].
-                    monitoredObjectIdentifier.type),
-                COV_Subscriptions[index].monitoredObjectIdentifier.instance);
-            fprintf(stderr, "time remaining=%u seconds ",
-                COV_Subscriptions[index].lifetime);
-            fprintf(stderr, "\n");
-#endif
-            COV_Subscriptions[index].flag.valid = false;
-            COV_Subscriptions[index].dest_index = -1;
-            cov_address_remove_unused();
-            if (COV_Subscriptions[index].flag.issueConfirmedNotifications) {
-                if (COV_Subscriptions[index].invokeID) {
-                    tsm_free_invoke_id(COV_Subscriptions[index].invokeID);
-                    COV_Subscriptions[index].invokeID = 0;
-                }
-            }
-        }
-    }
-}
-
-/** Handler to check the list of subscribed objects for any that have changed
- *  and so need to have notifications sent.
+/** Handler to expire the subscriptions whose lifetime has run out.
  * @ingroup DSCOV
  * This handler will be invoked by the main program every second or so.
- * This example only handles Binary Inputs, but can be easily extended to
- * support other types.
- * For each subscribed object,
- *  - See if the subscription has timed out
- *    - Remove it if it has timed out.
- *  - See if the subscribed object instance has changed
- *    (eg, check with Binary_Input_Change_Of_Value() )
- *  - If changed,
- *    - Clear the COV (eg, Binary_Input_Change_Of_Value_Clear() )
- *    - Send the notice with cov_send_request()
- *      - Will be confirmed or unconfirmed, as per the subscription.
- *
- * @note worst case tasking: MS/TP with the ability to send only
- *        one notification per task cycle.
+ * The subscriptions are only looked at when one of them expires, and
+ * those that have are removed.
  *
  * @param elapsed_seconds [in] How many seconds have elapsed since last called.
  */
@@ -590,153 +1032,198 @@ void handler_cov_timer_seconds(
     uint32_t elapsed_seconds)
 {
     unsigned index = 0;
-    uint32_t lifetime_seconds = 0;
+    uint32_t next_expiry = 0;
+    BACNET_COV_SUBSCRIPTION *cov_subscription = NULL;
 
     if (elapsed_seconds) {
-        /* handle the subscription timeouts */
-        for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-            if (COV_Subscriptions[index].flag.valid) {
-                lifetime_seconds = COV_Subscriptions[index].lifetime;
-                if (lifetime_seconds) {
-                    /* only expire COV with definite lifetimes */
-                    cov_lifetime_expiration_handler(index, elapsed_seconds,
-                        lifetime_seconds);
+        COV_Clock += elapsed_seconds;
+        if (COV_Next_Expiry && (COV_Clock >= COV_Next_Expiry)) {
+            for (index = 0; index < COV_Size; index++) {
+                cov_subscription = &COV_Subscriptions[index];
+                /* only expire COV with definite lifetimes */
+                if ((!cov_subscription->flag.valid) ||
+                    (cov_subscription->lifetime == 0)) {
+                    continue;
+                }
+                if (cov_subscription->lifetime <= COV_Clock) {
+                    /* expire the subscription */
+#if PRINT_ENABLED
+                    fprintf(stderr, "COVtimer: PID=%u ",
+                        cov_subscription->subscriberProcessIdentifier);
+                    fprintf(stderr, "%s %u ",
+                        bactext_object_type_name(cov_subscription->
+                            monitoredObjectIdentifier.type),
+                        cov_subscription->monitoredObjectIdentifier.instance);
+                    fprintf(stderr, "time remaining=%u seconds ", 0);
+                    fprintf(stderr, "\n");
+#endif
+                    cov_subscription_remove(index);
+                } else if ((next_expiry == 0) ||
+                    (cov_subscription->lifetime < next_expiry)) {
+                    next_expiry = cov_subscription->lifetime;
                 }
             }
+            COV_Next_Expiry = next_expiry;
         }
     }
 }
 
+/** Handler for an object to report that the values it sends in COV
+ *  notifications have changed, so that its subscriptions are notified
+ *  without waiting for handler_cov_task() to poll it.
+ * @ingroup DSCOV
+ *
+ * @param object_type [in] The type of the object that changed.
+ * @param object_instance [in] The instance of the object that changed.
+ */
+void handler_cov_object_changed(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    BACNET_COV_OBJECT *cov_object = NULL;
+
+    cov_object = cov_object_find(object_type, object_instance);
+    if (cov_object) {
+        cov_changed_queue_push(cov_object);
+    }
+}
+
+/** Handler to send the notifications for the subscribed objects
+ *  that have changed.
+ * @ingroup DSCOV
+ * This handler will be invoked by the main program every time through
+ * its loop, and only does work in proportion to the changes:
+ *  - Poll a few of the subscribed objects to see if they have changed
+ *    (eg, check with Binary_Input_Change_Of_Value() ), for objects
+ *    that do not call handler_cov_object_changed()
+ *  - For each changed object,
+ *    - Queue a notification for each of its subscriptions
+ *    - Clear the COV (eg, Binary_Input_Change_Of_Value_Clear() )
+ *  - Free the invoke IDs of completed confirmed notifications
+ *  - Send up to COV_TASK_SEND_NOTIFICATIONS queued notices with
+ *    cov_send_request()
+ *    - Will be confirmed or unconfirmed, as per the subscription.
+ *
+ * @note worst case tasking: MS/TP with the ability to send only
+ *        one notification per task cycle.
+ */
 void handler_cov_task(
     void)
 {
-    static int index = 0;
     BACNET_OBJECT_TYPE object_type = MAX_BACNET_OBJECT_TYPE;
     uint32_t object_instance = 0;
     bool status = false;
     bool send = false;
+    unsigned index = 0;
+    unsigned number = 0;
+    unsigned last = 0;
+    unsigned count = 0;
+    BACNET_COV_OBJECT *cov_object = NULL;
+    BACNET_COV_SUBSCRIPTION *cov_subscription = NULL;
     BACNET_PROPERTY_VALUE value_list[2];
-    /* states for transmitting */
-    static enum {
-        COV_STATE_IDLE = 0,
-        COV_STATE_MARK,
-        COV_STATE_CLEAR,
-        COV_STATE_FREE,
-        COV_STATE_SEND
-    } cov_task_state = COV_STATE_IDLE;
-
-    switch (cov_task_state) {
-        case COV_STATE_IDLE:
-            index = 0;
-            cov_task_state = COV_STATE_MARK;
-            break;
-        case COV_STATE_MARK:
-            /* mark any subscriptions where the value has changed */
-            if (COV_Subscriptions[index].flag.valid) {
-                object_type = (BACNET_OBJECT_TYPE)
-                    COV_Subscriptions[index].monitoredObjectIdentifier.type;
-                object_instance =
-                    COV_Subscriptions[index].
-                    monitoredObjectIdentifier.instance;
-                status = Device_COV(object_type, object_instance);
-                if (status) {
-                    COV_Subscriptions[index].flag.send_requested = true;
+
+#if COV_TASK_POLL_OBJECTS
+    /* look for changes in a few of the objects at a time */
+    for (count = 0; (count < COV_TASK_POLL_OBJECTS) && (count < COV_Size);
+        count++) {
+        if (COV_Poll_Index >= COV_Size) {
+            COV_Poll_Index = 0;
+        }
+        cov_object = &COV_Objects[COV_Poll_Index++];
+        if ((cov_object->subscribers) && (!cov_object->changed)) {
+            object_type = (BACNET_OBJECT_TYPE) cov_object->id.type;
+            object_instance = cov_object->id.instance;
+            if (Device_COV(object_type, object_instance)) {
+                cov_changed_queue_push(cov_object);
+            }
+        }
+    }
+#endif
+    /* mark the subscriptions to the objects that changed */
+    while ((cov_object = cov_changed_queue_pop()) != NULL) {
+        number = cov_object->subscribers;
+        if (number == 0) {
+            /* the subscriptions have ended since */
+            continue;
+        }
 #if PRINT_ENABLED
-                    fprintf(stderr, "COVtask: Marking...\n");
+        fprintf(stderr, "COVtask: Marking...\n");
 #endif
-                }
-            }
-            index++;
-            if (index >= MAX_COV_SUBCRIPTIONS) {
-                index = 0;
-                cov_task_state = COV_STATE_CLEAR;
-            }
-            break;
-        case COV_STATE_CLEAR:
-            /* clear the COV flag after checking all subscriptions */
-            if ((COV_Subscriptions[index].flag.valid) &&
-                (COV_Subscriptions[index].flag.send_requested)) {
-                object_type = (BACNET_OBJECT_TYPE)
-                    COV_Subscriptions[index].monitoredObjectIdentifier.type;
-                object_instance =
-                    COV_Subscriptions[index].
-                    monitoredObjectIdentifier.instance;
-                Device_COV_Clear(object_type, object_instance);
-            }
-            index++;
-            if (index >= MAX_COV_SUBCRIPTIONS) {
-                index = 0;
-                cov_task_state = COV_STATE_FREE;
+        while (number) {
+            cov_send_queue_push(number - 1);
+            number = COV_Subscriptions[number - 1].next_subscriber;
+        }
+        object_type = (BACNET_OBJECT_TYPE) cov_object->id.type;
+        object_instance = cov_object->id.instance;
+        Device_COV_Clear(object_type, object_instance);
+    }
+    /* confirmed notification house keeping */
+    last = COV_Confirm_Queue.tail;
+    while (last) {
+        number = COV_Confirm_Queue.head;
+        index = number - 1;
+        cov_subscription = cov_confirm_queue_pop();
+        if ((cov_subscription->flag.valid) && (cov_subscription->invokeID)) {
+            if (tsm_invoke_id_free(cov_subscription->invokeID)) {
+                cov_subscription->invokeID = 0;
+            } else if (tsm_invoke_id_failed(cov_subscription->invokeID)) {
+                tsm_free_invoke_id(cov_subscription->invokeID);
+                cov_subscription->invokeID = 0;
+            } else {
+                cov_confirm_queue_push(index);
             }
+        }
+        if (number == last) {
             break;
-        case COV_STATE_FREE:
-            /* confirmed notification house keeping */
-            if ((COV_Subscriptions[index].flag.valid) &&
-                (COV_Subscriptions[index].flag.issueConfirmedNotifications) &&
-                (COV_Subscriptions[index].invokeID)) {
-                if (tsm_invoke_id_free(COV_Subscriptions[index].invokeID)) {
-                    COV_Subscriptions[index].invokeID = 0;
-                } else
-                    if (tsm_invoke_id_failed(COV_Subscriptions
-                        [index].invokeID)) {
-                    tsm_free_invoke_id(COV_Subscriptions[index].invokeID);
-                    COV_Subscriptions[index].invokeID = 0;
+        }
+    }
+    /* send any COVs that are requested */
+    last = COV_Send_Queue.tail;
+    count = 0;
+    while (last && (count < COV_TASK_SEND_NOTIFICATIONS)) {
+        number = COV_Send_Queue.head;
+        index = number - 1;
+        cov_subscription = cov_send_queue_pop();
+        if (cov_subscription->flag.valid) {
+            send = true;
+            if (cov_subscription->flag.issueConfirmedNotifications) {
+                if (cov_subscription->invokeID != 0) {
+                    /* already sending */
+                    send = false;
                 }
-            }
-            index++;
-            if (index >= MAX_COV_SUBCRIPTIONS) {
-                index = 0;
-                cov_task_state = COV_STATE_SEND;
-            }
-            break;
-        case COV_STATE_SEND:
-            /* send any COVs that are requested */
-            if ((COV_Subscriptions[index].flag.valid) &&
-                (COV_Subscriptions[index].flag.send_requested)) {
-                send = true;
-                if (COV_Subscriptions[index].flag.issueConfirmedNotifications) {
-                    if (COV_Subscriptions[index].invokeID != 0) {
-                        /* already sending */
-                        send = false;
-                    }
-                    if (!tsm_transaction_available()) {
-                        /* no transactions available - can't send now */
-                        send = false;
-                    }
+                if (!tsm_transaction_available()) {
+                    /* no transactions available - can't send now */
+                    send = false;
                 }
-                if (send) {
-                    object_type = (BACNET_OBJECT_TYPE)
-                        COV_Subscriptions[index].
-                        monitoredObjectIdentifier.type;
-                    object_instance =
-                        COV_Subscriptions[index].
-                        monitoredObjectIdentifier.instance;
+            }
+            status = false;
+            if (send) {
+                object_type = (BACNET_OBJECT_TYPE)
+                    cov_subscription->monitoredObjectIdentifier.type;
+                object_instance =
+                    cov_subscription->monitoredObjectIdentifier.instance;
 #if PRINT_ENABLED
-                    fprintf(stderr, "COVtask: Sending...\n");
+                fprintf(stderr, "COVtask: Sending...\n");
 #endif
-                    /* configure the linked list for the two properties */
-                    value_list[0].next = &value_list[1];
-                    value_list[1].next = NULL;
-                    (void) Device_Encode_Value_List(object_type,
-                        object_instance, &value_list[0]);
-                    status =
-                        cov_send_request(&COV_Subscriptions[index],
-                        &value_list[0]);
-                    if (status) {
-                        COV_Subscriptions[index].flag.send_requested = false;
-                    }
+                /* configure the linked list for the two properties */
+                value_list[0].next = &value_list[1];
+                value_list[1].next = NULL;
+                (void) Device_Encode_Value_List(object_type, object_instance,
+                    &value_list[0]);
+                status = cov_send_request(cov_subscription, &value_list[0]);
+                if (cov_subscription->invokeID) {
+                    cov_confirm_queue_push(index);
                 }
+                count++;
             }
-            index++;
-            if (index >= MAX_COV_SUBCRIPTIONS) {
-                index = 0;
-                cov_task_state = COV_STATE_IDLE;
+            if (!status) {
+                /* try again later */
+                cov_send_queue_push(index);
             }
+        }
+        if (number == last) {
             break;
-        default:
-            index = 0;
-            cov_task_state = COV_STATE_IDLE;
-            break;
+        }
     }
 }
 
@@ -894,3 +1381,417 @@ void handler_cov_subscribe(
 
     return;
 }
+
+#ifdef TEST
+#include <assert.h>
+#include "ctest.h"
+
+/* the objects that report a change when polled */
+static bool Test_COV_Changed[256];
+/* notifications handed to the datalink */
+static unsigned Test_COV_Sent;
+
+bool Device_Valid_Object_Id(
+    int object_type,
+    uint32_t object_instance)
+{
+    object_type = object_type;
+    object_instance = object_instance;
+
+    return true;
+}
+
+bool Device_Value_List_Supported(
+    BACNET_OBJECT_TYPE object_type)
+{
+    object_type = object_type;
+
+    return true;
+}
+
+bool Device_COV(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    object_type = object_type;
+
+    return Test_COV_Changed[object_instance % 256];
+}
+
+void Device_COV_Clear(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    object_type = object_type;
+    Test_COV_Changed[object_instance % 256] = false;
+}
+
+bool Device_Encode_Value_List(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    BACNET_PROPERTY_VALUE * value_list)
+{
+    object_type = object_type;
+    object_instance = object_instance;
+    value_list->propertyIdentifier = PROP_PRESENT_VALUE;
+    value_list->propertyArrayIndex = BACNET_ARRAY_ALL;
+    value_list->value.tag = BACNET_APPLICATION_TAG_REAL;
+    value_list->value.type.Real = 1.0f;
+    value_list->value.next = NULL;
+    value_list->priority = 0;
+    value_list = value_list->next;
+    value_list->propertyIdentifier = PROP_STATUS_FLAGS;
+    value_list->propertyArrayIndex = BACNET_ARRAY_ALL;
+    value_list->value.tag = BACNET_APPLICATION_TAG_NULL;
+    value_list->value.next = NULL;
+    value_list->priority = 0;
+
+    return true;
+}
+
+uint32_t Device_Object_Instance_Number(
+    void)
+{
+    return 1234;
+}
+
+int datalink_send_pdu(
+    BACNET_ADDRESS * dest,
+    BACNET_NPDU_DATA * npdu_data,
+    uint8_t * pdu,
+    unsigned pdu_len)
+{
+    dest = dest;
+    npdu_data = npdu_data;
+    pdu = pdu;
+    Test_COV_Sent++;
+
+    return (int) pdu_len;
+}
+
+void datalink_get_my_address(
+    BACNET_ADDRESS * my_address)
+{
+    memset(my_address, 0, sizeof(BACNET_ADDRESS));
+}
+
+/* the tests only use unconfirmed notifications */
+uint8_t tsm_next_free_invokeID(
+    void)
+{
+    return 0;
+}
+
+void tsm_set_confirmed_unsegmented_transaction(
+    uint8_t invokeID,
+    BACNET_ADDRESS * dest,
+    BACNET_NPDU_DATA * ndpu_data,
+    uint8_t * apdu,
+    uint16_t apdu_len)
+{
+    invokeID = invokeID;
+    dest = dest;
+    ndpu_data = ndpu_data;
+    apdu = apdu;
+    apdu_len = apdu_len;
+}
+
+void tsm_free_invoke_id(
+    uint8_t invokeID)
+{
+    invokeID = invokeID;
+}
+
+bool tsm_invoke_id_free(
+    uint8_t invokeID)
+{
+    invokeID = invokeID;
+
+    return true;
+}
+
+bool tsm_invoke_id_failed(
+    uint8_t invokeID)
+{
+    invokeID = invokeID;
+
+    return false;
+}
+
+bool tsm_transaction_available(
+    void)
+{
+    return false;
+}
+
+static bool testCOVListSubscribe(
+    uint8_t mac,
+    uint32_t process_id,
+    uint32_t object_instance,
+    uint32_t lifetime,
+    bool cancel)
+{
+    BACNET_ADDRESS src;
+    BACNET_SUBSCRIBE_COV_DATA cov_data;
+    BACNET_ERROR_CLASS error_class = ERROR_CLASS_SERVICES;
+    BACNET_ERROR_CODE error_code = ERROR_CODE_OTHER;
+
+    memset(&src, 0, sizeof(src));
+    src.mac_len = 1;
+    src.mac[0] = mac;
+    memset(&cov_data, 0, sizeof(cov_data));
+    cov_data.subscriberProcessIdentifier = process_id;
+    cov_data.monitoredObjectIdentifier.type = OBJECT_ANALOG_INPUT;
+    cov_data.monitoredObjectIdentifier.instance = object_instance;
+    cov_data.lifetime = lifetime;
+    cov_data.cancellationRequest = cancel;
+
+    return cov_list_subscribe(&src, &cov_data, &error_class, &error_code);
+}
+
+static unsigned testCOVValidCount(
+    void)
+{
+    unsigned index = 0;
+    unsigned count = 0;
+
+    for (index = 0; index < COV_Size; index++) {
+        if (COV_Subscriptions[index].flag.valid) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/* runs the task until nothing is left to send */
+static void testCOVTaskSend(
+    void)
+{
+    unsigned i = 0;
+
+    handler_cov_task();
+    for (i = 0; (i < 10000) && COV_Send_Queue.head; i++) {
+        handler_cov_task();
+    }
+}
+
+static void testCOVReset(
+    void)
+{
+    handler_cov_init();
+    memset(Test_COV_Changed, 0, sizeof(Test_COV_Changed));
+    Test_COV_Sent = 0;
+}
+
+void testCOVHandlerSubscribe(
+    Test * pTest)
+{
+    testCOVReset();
+    ct_test(pTest, testCOVListSubscribe(1, 1, 5, 100, false));
+    ct_test(pTest, testCOVListSubscribe(2, 1, 5, 0, false));
+    ct_test(pTest, testCOVListSubscribe(1, 2, 5, 50, false));
+    ct_test(pTest, testCOVListSubscribe(1, 1, 6, 10, false));
+    ct_test(pTest, testCOVValidCount() == 4);
+    /* the same subscriber again only renews its subscription */
+    ct_test(pTest, testCOVListSubscribe(1, 1, 6, 10, false));
+    ct_test(pTest, testCOVValidCount() == 4);
+    /* each subscription gets its initial notification */
+    testCOVTaskSend();
+    ct_test(pTest, Test_COV_Sent == 4);
+    ct_test(pTest, COV_Send_Queue.head == 0);
+    /* a change found by polling notifies the subscribers of the object */
+    Test_COV_Sent = 0;
+    Test_COV_Changed[5] = true;
+    testCOVTaskSend();
+    ct_test(pTest, Test_COV_Sent == 3);
+    ct_test(pTest, Test_COV_Changed[5] == false);
+    /* a change reported by the object */
+    Test_COV_Sent = 0;
+    handler_cov_object_changed(OBJECT_ANALOG_INPUT, 6);
+    testCOVTaskSend();
+    ct_test(pTest, Test_COV_Sent == 1);
+    /* nothing changed */
+    Test_COV_Sent = 0;
+    handler_cov_object_changed(OBJECT_ANALOG_INPUT, 7);
+    testCOVTaskSend();
+    ct_test(pTest, Test_COV_Sent == 0);
+}
+
+void testCOVHandlerCancel(
+    Test * pTest)
+{
+    testCOVReset();
+    ct_test(pTest, testCOVListSubscribe(1, 1, 5, 0, false));
+    ct_test(pTest, testCOVListSubscribe(2, 1, 5, 0, false));
+    testCOVTaskSend();
+    ct_test(pTest, testCOVListSubscribe(1, 1, 5, 0, true));
+    ct_test(pTest, testCOVValidCount() == 1);
+    /* cancelling what is not subscribed succeeds */
+    ct_test(pTest, testCOVListSubscribe(1, 1, 5, 0, true));
+    ct_test(pTest, testCOVListSubscribe(3, 9, 77, 0, true));
+    ct_test(pTest, testCOVValidCount() == 1);
+    Test_COV_Sent = 0;
+    Test_COV_Changed[5] = true;
+    testCOVTaskSend();
+    ct_test(pTest, Test_COV_Sent == 1);
+    /* the object is no longer monitored with its last subscription gone */
+    ct_test(pTest, testCOVListSubscribe(2, 1, 5, 0, true));
+    ct_test(pTest, cov_object_find(OBJECT_ANALOG_INPUT, 5) == NULL);
+    Test_COV_Sent = 0;
+    Test_COV_Changed[5] = true;
+    handler_cov_object_changed(OBJECT_ANALOG_INPUT, 5);
+    testCOVTaskSend();
+    ct_test(pTest, Test_COV_Sent == 0);
+}
+
+void testCOVHandlerExpiry(
+    Test * pTest)
+{
+    testCOVReset();
+    ct_test(pTest, testCOVListSubscribe(1, 1, 5, 100, false));
+    ct_test(pTest, testCOVListSubscribe(2, 1, 5, 0, false));
+    ct_test(pTest, testCOVListSubscribe(1, 2, 5, 50, false));
+    ct_test(pTest, testCOVListSubscribe(1, 1, 6, 10, false));
+    handler_cov_timer_seconds(9);
+    ct_test(pTest, testCOVValidCount() == 4);
+    handler_cov_timer_seconds(1);
+    ct_test(pTest, testCOVValidCount() == 3);
+    /* renewing a subscription moves its expiry */
+    ct_test(pTest, testCOVListSubscribe(1, 2, 5, 100, false));
+    handler_cov_timer_seconds(40);
+    ct_test(pTest, testCOVValidCount() == 3);
+    handler_cov_timer_seconds(50);
+    ct_test(pTest, testCOVValidCount() == 2);
+    handler_cov_timer_seconds(10);
+    ct_test(pTest, testCOVValidCount() == 1);
+    /* without a lifetime it never expires */
+    handler_cov_timer_seconds(100000);
+    ct_test(pTest, testCOVValidCount() == 1);
+}
+
+void testCOVHandlerAddresses(
+    Test * pTest)
+{
+    testCOVReset();
+    ct_test(pTest, testCOVListSubscribe(1, 1, 5, 0, false));
+    ct_test(pTest, testCOVListSubscribe(1, 2, 6, 0, false));
+    ct_test(pTest, testCOVListSubscribe(2, 1, 5, 0, false));
+    ct_test(pTest, COV_Addresses[0].valid);
+    ct_test(pTest, COV_Addresses[0].subscriptions == 2);
+    ct_test(pTest, COV_Addresses[1].valid);
+    ct_test(pTest, COV_Addresses[1].subscriptions == 1);
+    ct_test(pTest, testCOVListSubscribe(1, 1, 5, 0, true));
+    ct_test(pTest, COV_Addresses[0].valid);
+    ct_test(pTest, COV_Addresses[0].subscriptions == 1);
+    /* the address is released with the last subscription sent to it */
+    ct_test(pTest, testCOVListSubscribe(1, 2, 6, 0, true));
+    ct_test(pTest, !COV_Addresses[0].valid);
+    ct_test(pTest, COV_Addresses[1].valid);
+    ct_test(pTest, COV_Addresses[1].subscriptions == 1);
+    /* and taken again by the next one */
+    ct_test(pTest, testCOVListSubscribe(3, 1, 5, 0, false));
+    ct_test(pTest, COV_Addresses[0].valid);
+    ct_test(pTest, COV_Addresses[0].subscriptions == 1);
+    ct_test(pTest, COV_Addresses[0].dest.mac[0] == 3);
+}
+
+void testCOVHandlerQueueReuse(
+    Test * pTest)
+{
+    unsigned index = 0;
+
+    testCOVReset();
+    ct_test(pTest, testCOVListSubscribe(1, 1, 5, 0, false));
+    ct_test(pTest, testCOVListSubscribe(1, 2, 5, 0, false));
+    testCOVTaskSend();
+    /* cancelled while its notification is still queued */
+    Test_COV_Sent = 0;
+    handler_cov_object_changed(OBJECT_ANALOG_INPUT, 5);
+    handler_cov_task();
+    ct_test(pTest, COV_Send_Queue.head != 0);
+    index = COV_Send_Queue.tail - 1;
+    ct_test(pTest, testCOVListSubscribe(1,
+            COV_Subscriptions[index].subscriberProcessIdentifier, 5, 0,
+            true));
+    ct_test(pTest, !COV_Subscriptions[index].flag.valid);
+    /* a new subscription takes the freed entry, still on the queue */
+    ct_test(pTest, testCOVListSubscribe(2, 3, 6, 0, false));
+    ct_test(pTest, COV_Subscriptions[index].flag.valid);
+    ct_test(pTest, COV_Subscriptions[index].subscriberProcessIdentifier == 3);
+    testCOVTaskSend();
+    ct_test(pTest, COV_Send_Queue.head == 0);
+    ct_test(pTest, COV_Send_Queue.tail == 0);
+    ct_test(pTest, !COV_Subscriptions[index].flag.send_requested);
+    ct_test(pTest, Test_COV_Sent == 2);
+    /* both entries are queued again on the next change */
+    Test_COV_Sent = 0;
+    handler_cov_object_changed(OBJECT_ANALOG_INPUT, 5);
+    handler_cov_object_changed(OBJECT_ANALOG_INPUT, 6);
+    testCOVTaskSend();
+    ct_test(pTest, Test_COV_Sent == 2);
+}
+
+void testCOVHandlerGrowth(
+    Test * pTest)
+{
+    unsigned i = 0;
+
+    testCOVReset();
+    ct_test(pTest, testCOVListSubscribe(0, 0, 0, 0, false));
+    ct_test(pTest, COV_Size == COV_INITIAL_SUBCRIPTIONS);
+    for (i = 1; i < MAX_COV_SUBCRIPTIONS; i++) {
+        ct_test(pTest, testCOVListSubscribe(i % 8, i, i, 0, false));
+    }
+    ct_test(pTest, COV_Size == MAX_COV_SUBCRIPTIONS);
+    ct_test(pTest, testCOVValidCount() == MAX_COV_SUBCRIPTIONS);
+    /* out of resources when full */
+    ct_test(pTest, !testCOVListSubscribe(0, 9999, 9999, 0, false));
+    /* the objects found before the tables grew are still found */
+    for (i = 0; i < MAX_COV_SUBCRIPTIONS; i++) {
+        ct_test(pTest, cov_object_find(OBJECT_ANALOG_INPUT, i) != NULL);
+    }
+    testCOVTaskSend();
+    Test_COV_Sent = 0;
+    handler_cov_object_changed(OBJECT_ANALOG_INPUT, 1);
+    testCOVTaskSend();
+    ct_test(pTest, Test_COV_Sent == 1);
+    /* a freed entry can be subscribed again */
+    ct_test(pTest, testCOVListSubscribe(1, 1, 1, 0, true));
+    ct_test(pTest, testCOVListSubscribe(0, 9999, 9999, 0, false));
+    ct_test(pTest, testCOVValidCount() == MAX_COV_SUBCRIPTIONS);
+    ct_test(pTest, cov_object_find(OBJECT_ANALOG_INPUT, 1) == NULL);
+    ct_test(pTest, cov_object_find(OBJECT_ANALOG_INPUT, 9999) != NULL);
+}
+
+#ifdef TEST_COV_HANDLER
+int main(
+    void)
+{
+    Test *pTest;
+    bool rc;
+
+    pTest = ct_create("BACnet COV Handler", NULL);
+    /* individual tests */
+    rc = ct_addTestFunction(pTest, testCOVHandlerSubscribe);
+    assert(rc);
+    rc = ct_addTestFunction(pTest, testCOVHandlerCancel);
+    assert(rc);
+    rc = ct_addTestFunction(pTest, testCOVHandlerExpiry);
+    assert(rc);
+    rc = ct_addTestFunction(pTest, testCOVHandlerAddresses);
+    assert(rc);
+    rc = ct_addTestFunction(pTest, testCOVHandlerQueueReuse);
+    assert(rc);
+    rc = ct_addTestFunction(pTest, testCOVHandlerGrowth);
+    assert(rc);
+
+    ct_setStream(pTest, stdout);
+    ct_run(pTest);
+    (void) ct_report(pTest);
+    ct_destroy(pTest);
+
+    return 0;
+}
+#endif /* TEST_COV_HANDLER */
+#endif /* TEST */
@@ -29,4 +29,6 @@
 
 /** @file txbuf.c  Declare the global Transmit Buffer for handler functions. */
 
+#if !BACNET_CONTEXT_ENABLED
 uint8_t Handler_Transmit_Buffer[MAX_PDU] = { 0 };
+#endif
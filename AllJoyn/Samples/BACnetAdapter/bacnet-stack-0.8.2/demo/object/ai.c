@@ -221,6 +221,8 @@ static void Analog_Input_COV_Detect(unsigned int index,
         if (cov_delta >= cov_increment) {
             AI_Descr[index].Changed = true;
             AI_Descr[index].Prior_Value = value;
+            handler_cov_object_changed(OBJECT_ANALOG_INPUT,
+                Analog_Input_Index_To_Instance(index));
         }
     }
 }
@@ -1396,6 +1398,14 @@ bool WPValidateArgType(
     return (bResult);
 }
 
+void handler_cov_object_changed(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    object_type = object_type;
+    object_instance = object_instance;
+}
+
 void testAnalogInput(
     Test * pTest)
 {
@@ -281,6 +281,7 @@ bool Binary_Input_Present_Value_Set(
         }
         if (Present_Value[index] != value) {
             Change_Of_Value[index] = true;
+            handler_cov_object_changed(OBJECT_BINARY_INPUT, object_instance);
         }
         Present_Value[index] = value;
         status = true;
@@ -299,6 +300,7 @@ void Binary_Input_Out_Of_Service_Set(
     if (index < MAX_BINARY_INPUTS) {
         if (Out_Of_Service[index] != value) {
             Change_Of_Value[index] = true;
+            handler_cov_object_changed(OBJECT_BINARY_INPUT, object_instance);
         }
         Out_Of_Service[index] = value;
     }
@@ -534,6 +536,14 @@ bool WPValidateArgType(
     return false;
 }
 
+void handler_cov_object_changed(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    object_type = object_type;
+    object_instance = object_instance;
+}
+
 void testBinaryInput(
     Test * pTest)
 {
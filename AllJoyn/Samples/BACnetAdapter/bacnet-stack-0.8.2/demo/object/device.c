@@ -28,6 +28,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>     /* for realloc */
 #include <string.h>     /* for memmove */
 #include <time.h>       /* for timezone, localtime */
 #include "bacdef.h"
@@ -93,6 +94,18 @@ extern bool Routed_Device_Write_Property_Local(
 
 /* may be overridden by outside table */
 static object_functions_t *Object_Table;
+/* position in the Object_Table + 1 of each object type, or 0 */
+static uint16_t Object_Type_Slot[MAX_BACNET_OBJECT_TYPE];
+
+/* The Object_List is served from a copy of the object identifiers, which is
+   made again when the object count or the Database_Revision changes. */
+static BACNET_OBJECT_ID *Object_List;
+static unsigned Object_List_Size;       /* identifiers allocated */
+static unsigned Object_List_Length;     /* identifiers in the copy */
+static unsigned Object_List_Total;      /* Device_Object_List_Count() */
+static uint32_t Object_List_Revision;   /* Database_Revision */
+static bool Object_List_Valid = false;
+static bool Object_List_Enabled = true;
 
 static object_functions_t My_Object_Table[] = {
     {OBJECT_DEVICE,
@@ -428,15 +441,13 @@ static object_functions_t My_Object_Table[] = {
 static struct object_functions *Device_Objects_Find_Functions(
     BACNET_OBJECT_TYPE Object_Type)
 {
-    struct object_functions *pObject = NULL;
+    unsigned slot = 0;
 
-    pObject = Object_Table;
-    while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
-        /* handle each object type */
-        if (pObject->Object_Type == Object_Type) {
-            return (pObject);
-        }
-        pObject++;
+    if ((unsigned) Object_Type < MAX_BACNET_OBJECT_TYPE) {
+        slot = Object_Type_Slot[Object_Type];
+    }
+    if (slot) {
+        return (&Object_Table[slot - 1]);
     }
 
     return (NULL);
@@ -996,17 +1007,16 @@ unsigned Device_Object_List_Count(
     return count;
 }
 
-/** Lookup the Object at the given array index in the Device's Object List.
- * Even though we don't keep a single linear array of objects in the Device,
- * this method acts as though we do and works through a virtual, concatenated
- * array of all of our object type arrays.
+/** Lookup the Object at the given array index by working through a virtual,
+ * concatenated array of all of our object type arrays.
+ * Used when the copy of the Object List can't be kept.
  *
  * @param array_index [in] The desired array index (1 to N)
  * @param object_type [out] The object's type, if found.
  * @param instance [out] The object's instance number, if found.
  * @return True if found, else false.
  */
-bool Device_Object_List_Identifier(
+static bool Device_Object_List_Walk(
     unsigned array_index,
     int *object_type,
     uint32_t * instance)
@@ -1057,6 +1067,107 @@ bool Device_Object_List_Identifier(
     return status;
 }
 
+/** Bring the copy of the Object List up to date.
+ * The copy is made in the same order as Device_Object_List_Walk() uses,
+ * stepping through each object type once.
+ * @return True if the copy is up to date, else false.
+ */
+static bool Device_Object_List_Update(
+    void)
+{
+    unsigned total = 0;
+    unsigned count = 0;
+    unsigned length = 0;
+    unsigned object_index = 0;
+    unsigned i = 0;
+    BACNET_OBJECT_ID *list = NULL;
+    struct object_functions *pObject = NULL;
+
+    if (!Object_List_Enabled) {
+        return false;
+    }
+    total = Device_Object_List_Count();
+    if (Object_List_Valid && (Object_List_Total == total) &&
+        (Object_List_Revision == Database_Revision)) {
+        return true;
+    }
+    Object_List_Valid = false;
+    if (total > Object_List_Size) {
+        list = realloc(Object_List, total * sizeof(BACNET_OBJECT_ID));
+        if (!list) {
+            return false;
+        }
+        Object_List = list;
+        Object_List_Size = total;
+    }
+    pObject = Object_Table;
+    while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
+        if (pObject->Object_Count && pObject->Object_Index_To_Instance) {
+            count = pObject->Object_Count();
+            if (count > (total - length)) {
+                /* the count changed while we were copying */
+                return false;
+            }
+            if (pObject->Object_Iterator) {
+                object_index = pObject->Object_Iterator(~(unsigned) 0);
+            } else {
+                object_index = 0;
+            }
+            for (i = 0; i < count; i++) {
+                Object_List[length].type = (uint16_t) pObject->Object_Type;
+                Object_List[length].instance =
+                    pObject->Object_Index_To_Instance(object_index);
+                length++;
+                if (pObject->Object_Iterator) {
+                    object_index = pObject->Object_Iterator(object_index);
+                } else {
+                    object_index++;
+                }
+            }
+        }
+        pObject++;
+    }
+    Object_List_Length = length;
+    Object_List_Total = total;
+    Object_List_Revision = Database_Revision;
+    Object_List_Valid = true;
+
+    return true;
+}
+
+/** Lookup the Object at the given array index in the Device's Object List.
+ * Even though we don't keep a single linear array of objects in the Device,
+ * this method acts as though we do.  The identifiers are copied into an
+ * array on first use, so an object that is created, deleted or renumbered
+ * without changing the object count must call Device_Inc_Database_Revision(),
+ * as the standard requires anyway.
+ *
+ * @param array_index [in] The desired array index (1 to N)
+ * @param object_type [out] The object's type, if found.
+ * @param instance [out] The object's instance number, if found.
+ * @return True if found, else false.
+ */
+bool Device_Object_List_Identifier(
+    unsigned array_index,
+    int *object_type,
+    uint32_t * instance)
+{
+    /* array index zero is length - so invalid */
+    if (array_index == 0) {
+        return false;
+    }
+    if (!Device_Object_List_Update()) {
+        return Device_Object_List_Walk(array_index, object_type, instance);
+    }
+    if (array_index > Object_List_Length) {
+        return false;
+    }
+    *object_type = Object_List[array_index - 1].type;
+    *instance = Object_List[array_index - 1].instance;
+
+    return true;
+}
+
 /** Determine if we have an object with the given object_name.
  * If the object_type and object_instance pointers are not null,
  * and the lookup succeeds, they will be given the resulting values.
@@ -1924,8 +2035,15 @@ void Device_Init(
     } else {
         Object_Table = &My_Object_Table[0];
     }
+    memset(Object_Type_Slot, 0, sizeof(Object_Type_Slot));
+    Object_List_Valid = false;
     pObject = Object_Table;
     while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
+        /* the first entry for a type is the one that is used */
+        if (!Object_Type_Slot[pObject->Object_Type]) {
+            Object_Type_Slot[pObject->Object_Type] =
+                (uint16_t) (pObject - Object_Table + 1);
+        }
         if (pObject->Object_Init) {
             pObject->Object_Init();
         }
@@ -2005,6 +2123,9 @@ void Routing_Device_Init(
     pDevObject->Object_Name = Routed_Device_Name;
     pDevObject->Object_Read_Property = Routed_Device_Read_Property_Local;
     pDevObject->Object_Write_Property = Routed_Device_Write_Property_Local;
+    /* the instance of the Device depends on which device is addressed,
+       so the Object List can't be copied */
+    Object_List_Enabled = false;
 }
 
 #endif /* BAC_ROUTING */
@@ -2055,6 +2176,14 @@ int handler_cov_encode_subscriptions(
     return 0;
 }
 
+void handler_cov_object_changed(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    object_type = object_type;
+    object_instance = object_instance;
+}
+
 void testDevice(
     Test * pTest)
 {
@@ -2088,6 +2217,170 @@ void testDevice(
     return;
 }
 
+/* test objects: Test_Count analog values numbered from Test_Base up, and
+   Test_Count / 2 binary values with the odd instances, found by iteration */
+static unsigned Test_Count = 5;
+static uint32_t Test_Base = 0;
+
+static unsigned Test_AV_Count(
+    void)
+{
+    return Test_Count;
+}
+
+static uint32_t Test_AV_Index_To_Instance(
+    unsigned index)
+{
+    return Test_Base + index;
+}
+
+static bool Test_AV_Valid_Instance(
+    uint32_t object_instance)
+{
+    return (object_instance >= Test_Base) &&
+        (object_instance < (Test_Base + Test_Count));
+}
+
+static unsigned Test_BV_Count(
+    void)
+{
+    return Test_Count / 2;
+}
+
+static unsigned Test_BV_Iterator(
+    unsigned index)
+{
+    if (index == ~(unsigned) 0) {
+        return 1;
+    }
+
+    return index + 2;
+}
+
+static uint32_t Test_BV_Index_To_Instance(
+    unsigned index)
+{
+    return index;
+}
+
+static object_functions_t Test_Object_Table[] = {
+    {OBJECT_DEVICE, NULL, Device_Count, Device_Index_To_Instance,
+            Device_Valid_Object_Instance_Number, Device_Object_Name,
+            Device_Read_Property_Local, NULL, NULL, NULL, NULL, NULL, NULL,
+        NULL, NULL},
+    {OBJECT_ANALOG_VALUE, NULL, Test_AV_Count, Test_AV_Index_To_Instance,
+            Test_AV_Valid_Instance, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+        NULL, NULL, NULL},
+    {OBJECT_BINARY_VALUE, NULL, Test_BV_Count, Test_BV_Index_To_Instance,
+            NULL, NULL, NULL, NULL, NULL, NULL, Test_BV_Iterator, NULL, NULL,
+        NULL, NULL},
+    {MAX_BACNET_OBJECT_TYPE, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+        NULL, NULL, NULL, NULL, NULL, NULL}
+};
+
+static void testObjectList(
+    Test * pTest,
+    uint32_t device_instance)
+{
+    unsigned count = 0;
+    unsigned i = 0;
+    int object_type = 0;
+    uint32_t instance = 0;
+    bool status = false;
+
+    count = Device_Object_List_Count();
+    ct_test(pTest, count == (1 + Test_Count + Test_Count / 2));
+    status = Device_Object_List_Identifier(0, &object_type, &instance);
+    ct_test(pTest, status == false);
+    status = Device_Object_List_Identifier(count + 1, &object_type, &instance);
+    ct_test(pTest, status == false);
+    status = Device_Object_List_Identifier(1, &object_type, &instance);
+    ct_test(pTest, status == true);
+    ct_test(pTest, object_type == OBJECT_DEVICE);
+    ct_test(pTest, instance == device_instance);
+    for (i = 0; i < Test_Count; i++) {
+        status =
+            Device_Object_List_Identifier(2 + i, &object_type, &instance);
+        ct_test(pTest, status == true);
+        ct_test(pTest, object_type == OBJECT_ANALOG_VALUE);
+        ct_test(pTest, instance == (Test_Base + i));
+    }
+    for (i = 0; i < (Test_Count / 2); i++) {
+        status =
+            Device_Object_List_Identifier(2 + Test_Count + i, &object_type,
+            &instance);
+        ct_test(pTest, status == true);
+        ct_test(pTest, object_type == OBJECT_BINARY_VALUE);
+        ct_test(pTest, instance == (1 + 2 * i));
+    }
+}
+
+void testDeviceObjectList(
+    Test * pTest)
+{
+    Device_Init(&Test_Object_Table[0]);
+    Device_Set_Object_Instance_Number(1234);
+    ct_test(pTest, Device_Objects_RR_Info(OBJECT_DEVICE) == NULL);
+    ct_test(pTest, Device_Valid_Object_Id(OBJECT_DEVICE, 1234));
+    ct_test(pTest, Device_Valid_Object_Id(OBJECT_ANALOG_VALUE, 4));
+    ct_test(pTest, !Device_Valid_Object_Id(OBJECT_ANALOG_VALUE, 5));
+    ct_test(pTest, !Device_Valid_Object_Id(OBJECT_ANALOG_INPUT, 0));
+    ct_test(pTest, !Device_Valid_Object_Id(MAX_BACNET_OBJECT_TYPE, 0));
+    testObjectList(pTest, 1234);
+    /* a change in the object count is seen */
+    Test_Count = 100;
+    testObjectList(pTest, 1234);
+    Test_Count = 7;
+    testObjectList(pTest, 1234);
+    /* so is a change in the Database_Revision */
+    Test_Base = 1000;
+    Device_Inc_Database_Revision();
+    testObjectList(pTest, 1234);
+    Device_Set_Object_Instance_Number(4321);
+    testObjectList(pTest, 4321);
+}
+
+#ifdef TEST_DEVICE_BENCHMARK
+#include <time.h>
+
+/* reads the Object_List of a device with many objects,
+   one element at a time, the way a client discovers the objects */
+int main(
+    int argc,
+    char *argv[])
+{
+    BACNET_READ_PROPERTY_DATA rpdata;
+    uint8_t apdu[MAX_APDU];
+    unsigned count = 0;
+    unsigned i = 0;
+    unsigned errors = 0;
+    clock_t start;
+
+    Test_Count = 50000;
+    if (argc > 1) {
+        Test_Count = (unsigned) strtoul(argv[1], NULL, 0);
+    }
+    Device_Init(&Test_Object_Table[0]);
+    count = Device_Object_List_Count();
+    start = clock();
+    for (i = 1; i <= count; i++) {
+        rpdata.object_type = OBJECT_DEVICE;
+        rpdata.object_instance = Device_Object_Instance_Number();
+        rpdata.object_property = PROP_OBJECT_LIST;
+        rpdata.array_index = i;
+        rpdata.application_data = &apdu[0];
+        rpdata.application_data_len = sizeof(apdu);
+        if (Device_Read_Property(&rpdata) <= 0) {
+            errors++;
+        }
+    }
+    printf("read %u object list elements in %.3fs, %u errors\n", count,
+        (double) (clock() - start) / CLOCKS_PER_SEC, errors);
+
+    return 0;
+}
+#endif /* TEST_DEVICE_BENCHMARK */
+
 #ifdef TEST_DEVICE
 int main(
     void)
@@ -2099,6 +2392,8 @@ int main(
     /* individual tests */
     rc = ct_addTestFunction(pTest, testDevice);
     assert(rc);
+    rc = ct_addTestFunction(pTest, testDeviceObjectList);
+    assert(rc);
 
     ct_setStream(pTest, stdout);
     ct_run(pTest);
@@ -5,12 +5,32 @@ TEST_DIR = ../../test
 PORTS_DIR = ../../ports/linux
 INCLUDES = -I../../include -I$(TEST_DIR) -I$(PORTS_DIR) -I.
 DEFINES = -DBIG_ENDIAN=0
-DEFINES += -DTEST -DBACDL_TEST
+DEFINES += -DBACDL_TEST
 DEFINES += -DBACAPP_ALL
+DEFINES += -DBACNET_PROPERTY_LISTS=1
 DEFINES += -DMAX_TSM_TRANSACTIONS=0
-DEFINES += -DTEST_DEVICE
 
-CFLAGS  = -Wall $(INCLUDES) $(DEFINES) -g
+# the objects are built without their own tests and stubs
+OBJECT_CFLAGS = -Wall $(INCLUDES) $(DEFINES) -g
+CFLAGS  = $(OBJECT_CFLAGS) -DTEST -DTEST_DEVICE
+
+OBJECT_SRCS = ai.c \
+	ao.c \
+	av.c \
+	bi.c \
+	bo.c \
+	bv.c \
+	channel.c \
+	command.c \
+	csv.c \
+	iv.c \
+	lc.c \
+	lo.c \
+	lsp.c \
+	ms-input.c \
+	mso.c \
+	msv.c \
+	trendlog.c
 
 SRCS = device.c \
 	$(SRC_DIR)/bacdcode.c \
@@ -19,6 +39,7 @@ SRCS = device.c \
 	$(SRC_DIR)/bacreal.c \
 	$(SRC_DIR)/datetime.c \
 	$(SRC_DIR)/bacapp.c \
+	$(SRC_DIR)/bacdevobjpropref.c \
 	$(SRC_DIR)/bactext.c \
 	$(SRC_DIR)/indtext.c \
 	$(SRC_DIR)/proplist.c \
@@ -35,9 +56,13 @@ TARGET = device
 all: ${TARGET}
 
 OBJS = ${SRCS:.c=.o}
+OBJECT_OBJS = ${OBJECT_SRCS:.c=.o}
+
+${TARGET}: ${OBJS} ${OBJECT_OBJS}
+	${CC} -o $@ ${OBJS} ${OBJECT_OBJS}
 
-${TARGET}: ${OBJS}
-	${CC} -o $@ ${OBJS}
+${OBJECT_OBJS}: %.o: %.c
+	${CC} -c ${OBJECT_CFLAGS} $< -o $@
 
 .c.o:
 	${CC} -c ${CFLAGS} $*.c -o $@
@@ -47,6 +72,6 @@ depend:
 	${CC} -MM ${CFLAGS} *.c >> .depend
 
 clean:
-	rm -rf core ${TARGET} $(OBJS)
+	rm -rf core ${TARGET} $(OBJS) $(OBJECT_OBJS)
 
 include: .depend
@@ -0,0 +1,43 @@
+#Makefile to build the trend log benchmark
+CC      = gcc
+SRC_DIR = ../../src
+TEST_DIR = ../../test
+INCLUDES = -I../../include -I$(TEST_DIR) -I.
+DEFINES = -DBIG_ENDIAN=0 -DTEST -DBACDL_TEST -DBACAPP_ALL -DTEST_TRENDLOG_BENCHMARK \
+	-DMAX_TREND_LOGS=1 -DTL_SEGMENT_STORAGE=1 -DTL_MAX_ENTRIES=1048576 -O2
+
+CFLAGS  = -Wall $(INCLUDES) $(DEFINES) -g
+
+SRCS = trendlog.c \
+	$(SRC_DIR)/bacdcode.c \
+	$(SRC_DIR)/bacint.c \
+	$(SRC_DIR)/bacstr.c \
+	$(SRC_DIR)/bacreal.c \
+	$(SRC_DIR)/datetime.c \
+	$(SRC_DIR)/bacapp.c \
+	$(SRC_DIR)/bacdevobjpropref.c \
+	$(SRC_DIR)/bactext.c \
+	$(SRC_DIR)/indtext.c \
+	$(SRC_DIR)/lighting.c \
+	$(TEST_DIR)/ctest.c
+
+TARGET = tlbench
+
+all: ${TARGET}
+ 
+OBJS = ${SRCS:.c=.o}
+
+${TARGET}: ${OBJS}
+	${CC} -o $@ ${OBJS} 
+
+.c.o:
+	${CC} -c ${CFLAGS} $*.c -o $@
+	
+depend:
+	rm -f .depend
+	${CC} -MM ${CFLAGS} *.c >> .depend
+	
+clean:
+	rm -rf core ${TARGET} $(OBJS) tl*.seg tl*.state
+
+include: .depend
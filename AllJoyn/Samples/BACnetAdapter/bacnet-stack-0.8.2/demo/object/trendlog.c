@@ -49,9 +49,455 @@
 #define MAX_TREND_LOGS 8
 #endif
 
-TL_DATA_REC Logs[MAX_TREND_LOGS][TL_MAX_ENTRIES];
 static TL_LOG_INFO LogInfo[MAX_TREND_LOGS];
 
+#if TL_SEGMENT_STORAGE
+#include <stdio.h>
+
+#if (TL_MAX_ENTRIES % TL_SEGMENT_ENTRIES) != 0
+#error TL_MAX_ENTRIES must be a multiple of TL_SEGMENT_ENTRIES
+#endif
+#if ((MAX_TREND_LOGS + TL_SEGMENT_CACHE) * TL_SEGMENT_ENTRIES) > TL_MAX_TOTAL_ENTRIES
+#error the open and cached segments exceed TL_MAX_TOTAL_ENTRIES
+#endif
+
+#define TL_SEGMENT_COUNT (TL_MAX_ENTRIES / TL_SEGMENT_ENTRIES)
+#define TL_SEGMENT_NONE 0xFFFFFFFFUL
+#define TL_SEGMENT_MAGIC 0x31534c54UL   /* "TLS1" */
+/* time stamp delta, type, status and the largest datum (the two varints of
+   an error) */
+#define TL_SEGMENT_MAX_REC (10 + 2 + 6)
+
+/* Segment files hold a header and the records in ring order. The time
+ * stamps are stored as the difference from the previous record and the
+ * datum as its type needs it, so a polled real log takes about half the
+ * space of the RAM records. The files are only read by the device that
+ * wrote them, so values are stored in its byte order.
+ */
+typedef struct tl_segment {
+    uint32_t uiSegment; /* Which segment of the log, TL_SEGMENT_NONE if none */
+    int iLog;
+    uint32_t uiCount;   /* Records in the segment */
+    uint32_t uiLastUse; /* For the cache replacement */
+    bool bDirty;        /* Records not written to the file yet */
+    TL_DATA_REC Rec[TL_SEGMENT_ENTRIES];
+} TL_SEGMENT;
+
+/* State written next to the segments of a log to restore it on start up */
+typedef struct tl_segment_state {
+    uint32_t ulMagic;
+    uint32_t ulMaxEntries;
+    uint32_t ulSegmentEntries;
+    uint32_t ulRecordCount;
+    uint32_t ulTotalRecordCount;
+    int32_t iIndex;
+    uint32_t ulUnorderedSeq;
+    time_t tLastDataTime;
+} TL_SEGMENT_STATE;
+
+/* The segment each log appends to */
+static TL_SEGMENT Head_Segment[MAX_TREND_LOGS];
+/* The segments read last by any log */
+static TL_SEGMENT Segment_Cache[TL_SEGMENT_CACHE];
+static uint32_t Segment_Use_Count;
+/* Time stamp of the first record of each segment */
+static time_t Segment_Start[MAX_TREND_LOGS][TL_SEGMENT_COUNT];
+/* Encoded segment on its way to or from a file */
+static uint8_t Segment_Buffer[8 + (TL_SEGMENT_ENTRIES * TL_SEGMENT_MAX_REC)];
+
+static void TL_segment_path(
+    char *pPath,
+    int iLog,
+    uint32_t uiSegment)
+{
+    if (uiSegment == TL_SEGMENT_NONE)
+        sprintf(pPath, "%s/tl%d.state", TL_SEGMENT_DIR, iLog);
+    else
+        sprintf(pPath, "%s/tl%d-%lu.seg", TL_SEGMENT_DIR, iLog,
+            (unsigned long) uiSegment);
+}
+
+static int TL_put_varint(
+    uint8_t * pBuf,
+    uint64_t ullValue)
+{
+    int iLen = 0;
+
+    while (ullValue >= 0x80) {
+        pBuf[iLen++] = (uint8_t) (ullValue | 0x80);
+        ullValue >>= 7;
+    }
+    pBuf[iLen++] = (uint8_t) ullValue;
+
+    return iLen;
+}
+
+/* returns the number of bytes used, 0 if the buffer ends first */
+static int TL_get_varint(
+    const uint8_t * pBuf,
+    const uint8_t * pEnd,
+    uint64_t * pullValue)
+{
+    int iLen = 0;
+    int iShift = 0;
+
+    *pullValue = 0;
+    while ((pBuf + iLen < pEnd) && (iShift < 64)) {
+        *pullValue |= (uint64_t) (pBuf[iLen] & 0x7F) << iShift;
+        if ((pBuf[iLen++] & 0x80) == 0)
+            return iLen;
+        iShift += 7;
+    }
+
+    return 0;
+}
+
+static uint32_t TL_segment_encode(
+    TL_SEGMENT * pSegment)
+{
+    uint8_t *pBuf = &Segment_Buffer[8];
+    uint32_t uiRec = 0;
+    time_t tPrevious = 0;
+    int64_t llDelta = 0;
+    TL_DATA_REC *pRec = NULL;
+
+    for (uiRec = 0; uiRec < pSegment->uiCount; uiRec++) {
+        pRec = &pSegment->Rec[uiRec];
+        llDelta = (int64_t) pRec->tTimeStamp - (int64_t) tPrevious;
+        tPrevious = pRec->tTimeStamp;
+        pBuf += TL_put_varint(pBuf,
+            ((uint64_t) llDelta << 1) ^ (uint64_t) (llDelta >> 63));
+        *pBuf++ = pRec->ucRecType;
+        *pBuf++ = pRec->ucStatus;
+        switch (pRec->ucRecType) {
+            case TL_TYPE_STATUS:
+            case TL_TYPE_BOOL:
+                *pBuf++ = pRec->Datum.ucBoolean;
+                break;
+            case TL_TYPE_REAL:
+            case TL_TYPE_DELTA:
+                memcpy(pBuf, &pRec->Datum.fReal, 4);
+                pBuf += 4;
+                break;
+            case TL_TYPE_ENUM:
+            case TL_TYPE_UNSIGN:
+                pBuf += TL_put_varint(pBuf, pRec->Datum.ulUValue);
+                break;
+            case TL_TYPE_SIGN:
+                pBuf += TL_put_varint(pBuf,
+                    ((uint32_t) pRec->Datum.lSValue << 1) ^
+                    (uint32_t) (pRec->Datum.lSValue >> 31));
+                break;
+            case TL_TYPE_BITS:
+                *pBuf++ = pRec->Datum.Bits.ucLen;
+                memcpy(pBuf, pRec->Datum.Bits.ucStore, 4);
+                pBuf += 4;
+                break;
+            case TL_TYPE_ERROR:
+                pBuf += TL_put_varint(pBuf, pRec->Datum.Error.usClass);
+                pBuf += TL_put_varint(pBuf, pRec->Datum.Error.usCode);
+                break;
+            default:
+                break;
+        }
+    }
+    encode_unsigned32(&Segment_Buffer[0], TL_SEGMENT_MAGIC);
+    encode_unsigned32(&Segment_Buffer[4], pSegment->uiCount);
+
+    return (uint32_t) (pBuf - &Segment_Buffer[0]);
+}
+
+/* decodes the records of a segment file, stops at the first one that
+   does not decode and returns how many did */
+static uint32_t TL_segment_decode(
+    TL_SEGMENT * pSegment,
+    uint32_t uiLen)
+{
+    const uint8_t *pBuf = &Segment_Buffer[8];
+    const uint8_t *pEnd = &Segment_Buffer[uiLen];
+    uint32_t uiCount = 0;
+    uint32_t uiRec = 0;
+    uint32_t ulValue = 0;
+    uint64_t ullValue = 0;
+    uint64_t ullValue2 = 0;
+    time_t tPrevious = 0;
+    int iLen = 0;
+    int iLen2 = 0;
+    TL_DATA_REC *pRec = NULL;
+
+    if (uiLen < 8)
+        return 0;
+    decode_unsigned32(&Segment_Buffer[0], &ulValue);
+    if (ulValue != TL_SEGMENT_MAGIC)
+        return 0;
+    decode_unsigned32(&Segment_Buffer[4], &uiCount);
+    if (uiCount > TL_SEGMENT_ENTRIES)
+        return 0;
+    for (uiRec = 0; uiRec < uiCount; uiRec++) {
+        pRec = &pSegment->Rec[uiRec];
+        iLen = TL_get_varint(pBuf, pEnd, &ullValue);
+        if ((iLen == 0) || (pEnd - (pBuf + iLen) < 2))
+            break;
+        pBuf += iLen;
+        tPrevious += (time_t) (int64_t) ((ullValue >> 1) ^ (0 - (ullValue & 1)));
+        pRec->tTimeStamp = tPrevious;
+        pRec->ucRecType = *pBuf++;
+        pRec->ucStatus = *pBuf++;
+        iLen = 0;
+        switch (pRec->ucRecType) {
+            case TL_TYPE_STATUS:
+            case TL_TYPE_BOOL:
+                if (pBuf < pEnd) {
+                    pRec->Datum.ucBoolean = *pBuf;
+                    iLen = 1;
+                } else
+                    iLen = -1;
+                break;
+            case TL_TYPE_REAL:
+            case TL_TYPE_DELTA:
+                if (pEnd - pBuf >= 4) {
+                    memcpy(&pRec->Datum.fReal, pBuf, 4);
+                    iLen = 4;
+                } else
+                    iLen = -1;
+                break;
+            case TL_TYPE_ENUM:
+            case TL_TYPE_UNSIGN:
+                iLen = TL_get_varint(pBuf, pEnd, &ullValue);
+                pRec->Datum.ulUValue = (uint32_t) ullValue;
+                if (iLen == 0)
+                    iLen = -1;
+                break;
+            case TL_TYPE_SIGN:
+                iLen = TL_get_varint(pBuf, pEnd, &ullValue);
+                pRec->Datum.lSValue =
+                    (int32_t) (uint32_t) ((ullValue >> 1) ^ (0 - (ullValue &
+                            1)));
+                if (iLen == 0)
+                    iLen = -1;
+                break;
+            case TL_TYPE_BITS:
+                if (pEnd - pBuf >= 5) {
+                    pRec->Datum.Bits.ucLen = pBuf[0];
+                    memcpy(pRec->Datum.Bits.ucStore, &pBuf[1], 4);
+                    iLen = 5;
+                } else
+                    iLen = -1;
+                break;
+            case TL_TYPE_ERROR:
+                iLen = TL_get_varint(pBuf, pEnd, &ullValue);
+                if (iLen != 0)
+                    iLen2 = TL_get_varint(pBuf + iLen, pEnd, &ullValue2);
+                pRec->Datum.Error.usClass = (uint16_t) ullValue;
+                pRec->Datum.Error.usCode = (uint16_t) ullValue2;
+                if ((iLen == 0) || (iLen2 == 0))
+                    iLen = -1;
+                else
+                    iLen += iLen2;
+                break;
+            default:
+                break;
+        }
+        if (iLen < 0)
+            break;
+        pBuf += iLen;
+    }
+
+    return uiRec;
+}
+
+static void TL_segment_write(
+    TL_SEGMENT * pSegment)
+{
+    char szPath[sizeof(TL_SEGMENT_DIR) + 32];
+    FILE *pFile = NULL;
+    uint32_t uiLen = 0;
+
+    uiLen = TL_segment_encode(pSegment);
+    TL_segment_path(szPath, pSegment->iLog, pSegment->uiSegment);
+    pFile = fopen(szPath, "wb");
+    if (pFile) {
+        if (fwrite(Segment_Buffer, 1, uiLen, pFile) == uiLen)
+            pSegment->bDirty = false;
+        fclose(pFile);
+    }
+}
+
+/* a segment that was never written, or does not decode, has no records */
+static void TL_segment_read(
+    TL_SEGMENT * pSegment,
+    int iLog,
+    uint32_t uiSegment)
+{
+    char szPath[sizeof(TL_SEGMENT_DIR) + 32];
+    FILE *pFile = NULL;
+    uint32_t uiLen = 0;
+
+    memset(pSegment->Rec, 0, sizeof(pSegment->Rec));
+    pSegment->iLog = iLog;
+    pSegment->uiSegment = uiSegment;
+    pSegment->uiCount = 0;
+    pSegment->bDirty = false;
+    TL_segment_path(szPath, iLog, uiSegment);
+    pFile = fopen(szPath, "rb");
+    if (pFile) {
+        uiLen =
+            (uint32_t) fread(Segment_Buffer, 1, sizeof(Segment_Buffer), pFile);
+        fclose(pFile);
+        pSegment->uiCount = TL_segment_decode(pSegment, uiLen);
+    }
+}
+
+static TL_SEGMENT *TL_segment_get(
+    int iLog,
+    uint32_t uiSegment)
+{
+    TL_SEGMENT *pSegment = NULL;
+    int iCache = 0;
+
+    if (Head_Segment[iLog].uiSegment == uiSegment)
+        return (&Head_Segment[iLog]);
+
+    pSegment = &Segment_Cache[0];
+    for (iCache = 0; iCache < TL_SEGMENT_CACHE; iCache++) {
+        if ((Segment_Cache[iCache].iLog == iLog) &&
+            (Segment_Cache[iCache].uiSegment == uiSegment)) {
+            pSegment = &Segment_Cache[iCache];
+            pSegment->uiLastUse = ++Segment_Use_Count;
+            return (pSegment);
+        }
+        if (Segment_Cache[iCache].uiLastUse < pSegment->uiLastUse)
+            pSegment = &Segment_Cache[iCache];
+    }
+    TL_segment_read(pSegment, iLog, uiSegment);
+    pSegment->uiLastUse = ++Segment_Use_Count;
+
+    return (pSegment);
+}
+
+/****************************************************************************
+ * Access to the record in a slot of the ring of a log. Pointers returned   *
+ * stay valid until TL_SEGMENT_CACHE other segments have been read.         *
+ ****************************************************************************/
+
+static TL_DATA_REC *TL_record_at(
+    int iLog,
+    uint32_t uiSlot)
+{
+    return (&TL_segment_get(iLog,
+            uiSlot / TL_SEGMENT_ENTRIES)->Rec[uiSlot % TL_SEGMENT_ENTRIES]);
+}
+
+static void TL_store_record(
+    int iLog,
+    uint32_t uiSlot,
+    TL_DATA_REC * pRecord)
+{
+    TL_SEGMENT *pHead = &Head_Segment[iLog];
+    uint32_t uiSegment = uiSlot / TL_SEGMENT_ENTRIES;
+    uint32_t uiOffset = uiSlot % TL_SEGMENT_ENTRIES;
+    int iCache = 0;
+
+    if (pHead->uiSegment != uiSegment) {
+        if (pHead->bDirty)
+            TL_segment_write(pHead);
+        /* the ring wrapped round, the records ahead of the slot are the
+           oldest ones of the log */
+        TL_segment_read(pHead, iLog, uiSegment);
+        for (iCache = 0; iCache < TL_SEGMENT_CACHE; iCache++) {
+            if ((Segment_Cache[iCache].iLog == iLog) &&
+                (Segment_Cache[iCache].uiSegment == uiSegment))
+                Segment_Cache[iCache].uiSegment = TL_SEGMENT_NONE;
+        }
+    }
+    pHead->Rec[uiOffset] = *pRecord;
+    if (uiOffset >= pHead->uiCount)
+        pHead->uiCount = uiOffset + 1;
+    pHead->bDirty = true;
+    if (uiOffset == 0)
+        Segment_Start[iLog][uiSegment] = pRecord->tTimeStamp;
+}
+
+static void TL_segment_write_state(
+    int iLog)
+{
+    char szPath[sizeof(TL_SEGMENT_DIR) + 32];
+    TL_SEGMENT_STATE State;
+    FILE *pFile = NULL;
+
+    memset(&State, 0, sizeof(State));
+    State.ulMagic = TL_SEGMENT_MAGIC;
+    State.ulMaxEntries = TL_MAX_ENTRIES;
+    State.ulSegmentEntries = TL_SEGMENT_ENTRIES;
+    State.ulRecordCount = LogInfo[iLog].ulRecordCount;
+    State.ulTotalRecordCount = LogInfo[iLog].ulTotalRecordCount;
+    State.iIndex = LogInfo[iLog].iIndex;
+    State.ulUnorderedSeq = LogInfo[iLog].ulUnorderedSeq;
+    State.tLastDataTime = LogInfo[iLog].tLastDataTime;
+    TL_segment_path(szPath, iLog, TL_SEGMENT_NONE);
+    pFile = fopen(szPath, "wb");
+    if (pFile) {
+        fwrite(&State, sizeof(State), 1, pFile);
+        fwrite(Segment_Start[iLog], sizeof(Segment_Start[iLog]), 1, pFile);
+        fclose(pFile);
+    }
+}
+
+/* restores a log written with the same ring and segment sizes */
+static bool TL_segment_read_state(
+    int iLog)
+{
+    char szPath[sizeof(TL_SEGMENT_DIR) + 32];
+    TL_SEGMENT_STATE State;
+    FILE *pFile = NULL;
+    bool bRead = false;
+
+    TL_segment_path(szPath, iLog, TL_SEGMENT_NONE);
+    pFile = fopen(szPath, "rb");
+    if (!pFile)
+        return false;
+    if ((fread(&State, sizeof(State), 1, pFile) == 1) &&
+        (State.ulMagic == TL_SEGMENT_MAGIC) &&
+        (State.ulMaxEntries == TL_MAX_ENTRIES) &&
+        (State.ulSegmentEntries == TL_SEGMENT_ENTRIES) &&
+        (State.ulRecordCount <= TL_MAX_ENTRIES) &&
+        (State.iIndex >= 0) && (State.iIndex < TL_MAX_ENTRIES) &&
+        (fread(Segment_Start[iLog], sizeof(Segment_Start[iLog]), 1,
+                pFile) == 1)) {
+        LogInfo[iLog].ulRecordCount = State.ulRecordCount;
+        LogInfo[iLog].ulTotalRecordCount = State.ulTotalRecordCount;
+        LogInfo[iLog].iIndex = State.iIndex;
+        LogInfo[iLog].ulUnorderedSeq = State.ulUnorderedSeq;
+        LogInfo[iLog].tLastDataTime = State.tLastDataTime;
+        bRead = true;
+    }
+    fclose(pFile);
+
+    return bRead;
+}
+#else
+#if (MAX_TREND_LOGS * TL_MAX_ENTRIES) > TL_MAX_TOTAL_ENTRIES
+#error MAX_TREND_LOGS * TL_MAX_ENTRIES exceeds TL_MAX_TOTAL_ENTRIES
+#endif
+
+TL_DATA_REC Logs[MAX_TREND_LOGS][TL_MAX_ENTRIES];
+
+static TL_DATA_REC *TL_record_at(
+    int iLog,
+    uint32_t uiSlot)
+{
+    return (&Logs[iLog][uiSlot]);
+}
+
+static void TL_store_record(
+    int iLog,
+    uint32_t uiSlot,
+    TL_DATA_REC * pRecord)
+{
+    Logs[iLog][uiSlot] = *pRecord;
+}
+#endif
+
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int Trend_Log_Properties_Required[] = {
     PROP_OBJECT_IDENTIFIER,
@@ -172,10 +618,20 @@ void Trend_Log_Init(
     int iEntry;
     struct tm TempTime;
     time_t tClock;
+    TL_DATA_REC TempRec;
+    bool bRestored = false;
 
     if (!initialized) {
         initialized = true;
 
+#if TL_SEGMENT_STORAGE
+        for (iLog = 0; iLog < MAX_TREND_LOGS; iLog++) {
+            Head_Segment[iLog].uiSegment = TL_SEGMENT_NONE;
+        }
+        for (iEntry = 0; iEntry < TL_SEGMENT_CACHE; iEntry++) {
+            Segment_Cache[iEntry].uiSegment = TL_SEGMENT_NONE;
+        }
+#endif
         /* initialize all the values */
 
         for (iLog = 0; iLog < MAX_TREND_LOGS; iLog++) {
@@ -190,32 +646,44 @@ void Trend_Log_Init(
              * entries into any active logs if the power down or reset
              * may have caused us to miss readings.
              */
-
-            /* We will just fill the logs with some entries for testing
-             * purposes.
-             */
-            TempTime.tm_year = 109;
-            TempTime.tm_mon = iLog + 1; /* Different month for each log */
-            TempTime.tm_mday = 1;
-            TempTime.tm_hour = 0;
-            TempTime.tm_min = 0;
-            TempTime.tm_sec = 0;
-            tClock = mktime(&TempTime);
-
-            for (iEntry = 0; iEntry < TL_MAX_ENTRIES; iEntry++) {
-                Logs[iLog][iEntry].tTimeStamp = tClock;
-                Logs[iLog][iEntry].ucRecType = TL_TYPE_REAL;
-                Logs[iLog][iEntry].Datum.fReal =
-                    (float) (iEntry + (iLog * TL_MAX_ENTRIES));
+#if TL_SEGMENT_STORAGE
+            /* the log survives in its segment files */
+            bRestored = TL_segment_read_state(iLog);
+#endif
+            if (!bRestored) {
+                /* We will just fill the logs with some entries for testing
+                 * purposes.
+                 */
+                TempTime.tm_year = 109;
+                TempTime.tm_mon = iLog + 1;     /* Different month for each log */
+                TempTime.tm_mday = 1;
+                TempTime.tm_hour = 0;
+                TempTime.tm_min = 0;
+                TempTime.tm_sec = 0;
+                tClock = mktime(&TempTime);
+
+                memset(&TempRec, 0, sizeof(TempRec));
+                TempRec.ucRecType = TL_TYPE_REAL;
                 /* Put status flags with every second log */
                 if ((iLog & 1) == 0)
-                    Logs[iLog][iEntry].ucStatus = 128;
+                    TempRec.ucStatus = 128;
                 else
-                    Logs[iLog][iEntry].ucStatus = 0;
-                tClock += 900;  /* advance 15 minutes */
-            }
+                    TempRec.ucStatus = 0;
+                for (iEntry = 0; iEntry < TL_MAX_ENTRIES; iEntry++) {
+                    TempRec.tTimeStamp = tClock;
+                    TempRec.Datum.fReal =
+                        (float) (iEntry + (iLog * TL_MAX_ENTRIES));
+                    TL_store_record(iLog, (uint32_t) iEntry, &TempRec);
+                    tClock += 900;      /* advance 15 minutes */
+                }
 
-            LogInfo[iLog].tLastDataTime = tClock - 900;
+                LogInfo[iLog].tLastDataTime = tClock - 900;
+                LogInfo[iLog].iIndex = 0;
+                LogInfo[iLog].ulRecordCount = TL_MAX_ENTRIES;
+                LogInfo[iLog].ulTotalRecordCount =
+                    (TL_MAX_ENTRIES < 10000) ? 10000 : TL_MAX_ENTRIES;
+                LogInfo[iLog].ulUnorderedSeq = 0;
+            }
             LogInfo[iLog].bAlignIntervals = true;
             LogInfo[iLog].bEnable = true;
             LogInfo[iLog].bStopWhenFull = false;
@@ -224,10 +692,7 @@ void Trend_Log_Init(
             LogInfo[iLog].Source.arrayIndex = 0;
             LogInfo[iLog].ucTimeFlags = 0;
             LogInfo[iLog].ulIntervalOffset = 0;
-            LogInfo[iLog].iIndex = 0;
             LogInfo[iLog].ulLogInterval = 900;
-            LogInfo[iLog].ulRecordCount = TL_MAX_ENTRIES;
-            LogInfo[iLog].ulTotalRecordCount = 10000;
 
             LogInfo[iLog].Source.deviceIndentifier.instance =
                 Device_Object_Instance_Number();
@@ -246,11 +711,33 @@ void Trend_Log_Init(
             LogInfo[iLog].tStopTime =
                 TL_BAC_Time_To_Local(&LogInfo[iLog].StopTime);
         }
+#if TL_SEGMENT_STORAGE
+        Trend_Log_Flush();
+#endif
     }
 
     return;
 }
 
+/*
+ * Writes the records appended since the last call and the state of the
+ * logs to the segment files, trend_log_timer() calls it every
+ * TL_FLUSH_INTERVAL seconds. Nothing to do when the logs are kept in RAM.
+ */
+void Trend_Log_Flush(
+    void)
+{
+#if TL_SEGMENT_STORAGE
+    int iLog;
+
+    for (iLog = 0; iLog < MAX_TREND_LOGS; iLog++) {
+        if (Head_Segment[iLog].bDirty)
+            TL_segment_write(&Head_Segment[iLog]);
+        TL_segment_write_state(iLog);
+    }
+#endif
+}
+
 
 /*
  * Note: we use the instance number here and build the name based
@@ -832,6 +1319,52 @@ bool TrendLogGetRRInfo(
     return (false);
 }
 
+/****************************************************************************
+ * Return a log entry by its BACnet 1 based position, converting to a 0     *
+ * based array index and handling the wrap around of the circular buffer.   *
+ ****************************************************************************/
+
+static TL_DATA_REC *TL_get_record(
+    int iLog,
+    uint32_t uiEntry)
+{
+    if (LogInfo[iLog].ulRecordCount < TL_MAX_ENTRIES)
+        return (TL_record_at(iLog, (uiEntry - 1) % TL_MAX_ENTRIES));
+
+    return (TL_record_at(iLog,
+            (LogInfo[iLog].iIndex + uiEntry - 1) % TL_MAX_ENTRIES));
+}
+
+/****************************************************************************
+ * Append an entry to a trend log, pushing out the oldest one if it is full. *
+ * ReadRange by time relies on the entries being in time order, so note     *
+ * the entry if the clock was set back since the one ahead of it.           *
+ ****************************************************************************/
+
+static void TL_append_record(
+    int iLog,
+    TL_DATA_REC * pRecord)
+{
+    TL_LOG_INFO *CurrentLog;
+
+    CurrentLog = &LogInfo[iLog];
+
+    if (CurrentLog->ulRecordCount == 0)
+        CurrentLog->ulUnorderedSeq = 0;
+    else if (pRecord->tTimeStamp <
+        TL_get_record(iLog, CurrentLog->ulRecordCount)->tTimeStamp)
+        CurrentLog->ulUnorderedSeq = CurrentLog->ulTotalRecordCount + 1;
+
+    TL_store_record(iLog, (uint32_t) CurrentLog->iIndex++, pRecord);
+    if (CurrentLog->iIndex >= TL_MAX_ENTRIES)
+        CurrentLog->iIndex = 0;
+
+    CurrentLog->ulTotalRecordCount++;
+
+    if (CurrentLog->ulRecordCount < TL_MAX_ENTRIES)
+        CurrentLog->ulRecordCount++;
+}
+
 /*****************************************************************************
  * Insert a status record into a trend log - does not check for enable/log   *
  * full, time slots and so on as these type of entries have to go in         *
@@ -844,11 +1377,8 @@ void TL_Insert_Status_Rec(
     BACNET_LOG_STATUS eStatus,
     bool bState)
 {
-    TL_LOG_INFO *CurrentLog;
     TL_DATA_REC TempRec;
 
-    CurrentLog = &LogInfo[iLog];
-
     TempRec.tTimeStamp = time(NULL);
     TempRec.ucRecType = TL_TYPE_STATUS;
     TempRec.ucStatus = 0;
@@ -871,14 +1401,7 @@ void TL_Insert_Status_Rec(
             break;
     }
 
-    Logs[iLog][CurrentLog->iIndex++] = TempRec;
-    if (CurrentLog->iIndex >= TL_MAX_ENTRIES)
-        CurrentLog->iIndex = 0;
-
-    CurrentLog->ulTotalRecordCount++;
-
-    if (CurrentLog->ulRecordCount < TL_MAX_ENTRIES)
-        CurrentLog->ulRecordCount++;
+    TL_append_record(iLog, &TempRec);
 }
 
 /*****************************************************************************
@@ -969,6 +1492,7 @@ time_t TL_BAC_Time_To_Local(
     LocalTime.tm_hour = SourceTime->time.hour;
     LocalTime.tm_min = SourceTime->time.min;
     LocalTime.tm_sec = SourceTime->time.sec;
+    LocalTime.tm_isdst = -1;    /* Let mktime() work out if DST applies */
 
     return (mktime(&LocalTime));
 }
@@ -1286,6 +1810,118 @@ int TL_encode_by_sequence(
     return (iLen);
 }
 
+#if TL_SEGMENT_STORAGE
+/****************************************************************************
+ * Narrow the count TL_count_before() searches for down to the entries of a *
+ * single segment, with a binary search of the time stamps of the first     *
+ * entries of the segments, so that the search reads a single segment.      *
+ * Position uiFirst + k * TL_SEGMENT_ENTRIES (0 based) is the first entry   *
+ * of a segment, the entries between two of them are in the same segment.   *
+ ****************************************************************************/
+
+static void TL_count_before_segment(
+    int iLog,
+    time_t tRefTime,
+    bool bInclusive,
+    uint32_t * puiLow,
+    uint32_t * puiHigh)
+{
+    TL_LOG_INFO *CurrentLog = &LogInfo[iLog];
+    uint32_t uiStart = 0;       /* Slot of the oldest entry */
+    uint32_t uiFirst = 0;       /* Position of the first segment start */
+    uint32_t uiStarts = 0;      /* Segment starts in the log */
+    uint32_t uiLow = 0;
+    uint32_t uiHigh = 0;
+    uint32_t uiMid = 0;
+    uint32_t uiSlot = 0;
+    time_t tStamp = 0;
+
+    if (CurrentLog->ulRecordCount == TL_MAX_ENTRIES)
+        uiStart = (uint32_t) CurrentLog->iIndex;
+    uiFirst =
+        (TL_SEGMENT_ENTRIES -
+        (uiStart % TL_SEGMENT_ENTRIES)) % TL_SEGMENT_ENTRIES;
+    if (uiFirst >= CurrentLog->ulRecordCount)
+        return;
+    uiStarts =
+        (CurrentLog->ulRecordCount - uiFirst + TL_SEGMENT_ENTRIES -
+        1) / TL_SEGMENT_ENTRIES;
+
+    uiHigh = uiStarts;
+    while (uiLow < uiHigh) {
+        uiMid = uiLow + ((uiHigh - uiLow) / 2);
+        uiSlot =
+            (uiStart + uiFirst + (uiMid * TL_SEGMENT_ENTRIES)) % TL_MAX_ENTRIES;
+        tStamp = Segment_Start[iLog][uiSlot / TL_SEGMENT_ENTRIES];
+        if ((tStamp < tRefTime) || (bInclusive && (tStamp == tRefTime)))
+            uiLow = uiMid + 1;
+        else
+            uiHigh = uiMid;
+    }
+
+    /* uiLow segment starts count, the count is at least the position
+       after the last of them and at most the position of the next one */
+    if (uiLow > 0)
+        *puiLow = uiFirst + ((uiLow - 1) * TL_SEGMENT_ENTRIES) + 1;
+    if (uiLow < uiStarts)
+        *puiHigh = uiFirst + (uiLow * TL_SEGMENT_ENTRIES);
+}
+#endif
+
+/****************************************************************************
+ * Count the entries which are older than the reference time, or not newer  *
+ * than it if bInclusive is true. Entries are inserted in time order so the *
+ * buffer is sorted by timestamp from its oldest entry and we can use a     *
+ * binary search rather than walking a log of TL_MAX_ENTRIES entries.       *
+ * While an entry stamped before the one ahead of it (the clock was set     *
+ * back) is in the buffer, it is walked instead: from the oldest entry to   *
+ * the first one newer than the reference time if bInclusive is true, else  *
+ * from the newest entry to the last one older than the reference time.     *
+ ****************************************************************************/
+
+static uint32_t TL_count_before(
+    int iLog,
+    time_t tRefTime,
+    bool bInclusive)
+{
+    TL_LOG_INFO *CurrentLog = &LogInfo[iLog];
+    uint32_t uiLow = 0;
+    uint32_t uiHigh = CurrentLog->ulRecordCount;
+    uint32_t uiMid = 0;
+    uint32_t uiFirstSeq = 0;
+    time_t tStamp = 0;
+
+    uiFirstSeq =
+        CurrentLog->ulTotalRecordCount - (CurrentLog->ulRecordCount - 1);
+    if ((CurrentLog->ulUnorderedSeq != 0) &&
+        (CurrentLog->ulUnorderedSeq > uiFirstSeq)) {
+        if (bInclusive) {
+            while ((uiLow < uiHigh) &&
+                (TL_get_record(iLog, uiLow + 1)->tTimeStamp <= tRefTime))
+                uiLow++;
+            return (uiLow);
+        }
+        while ((uiHigh > 0) &&
+            (TL_get_record(iLog, uiHigh)->tTimeStamp >= tRefTime))
+            uiHigh--;
+        return (uiHigh);
+    }
+
+#if TL_SEGMENT_STORAGE
+    TL_count_before_segment(iLog, tRefTime, bInclusive, &uiLow, &uiHigh);
+#endif
+    while (uiLow < uiHigh) {
+        uiMid = uiLow + ((uiHigh - uiLow) / 2);
+        tStamp = TL_get_record(iLog, uiMid + 1)->tTimeStamp;
+        if ((tStamp < tRefTime) || (bInclusive && (tStamp == tRefTime)))
+            uiLow = uiMid + 1;
+        else
+            uiHigh = uiMid;
+    }
+
+    return (uiLow);
+}
+
 /****************************************************************************
  * Handle encoding for the By Time option.                                  *
  * The fact that the buffer always has at least a single entry is used      *
@@ -1316,29 +1952,18 @@ int TL_encode_by_time(
     CurrentLog = &LogInfo[log_index];
 
     tRefTime = TL_BAC_Time_To_Local(&pRequest->Range.RefTime);
-    /* Find correct position for oldest entry in log */
-    if (CurrentLog->ulRecordCount < TL_MAX_ENTRIES)
-        uiIndex = 0;
-    else
-        uiIndex = CurrentLog->iIndex;
+    /* Figure out the sequence number for the first record, last is ulTotalRecordCount */
+    uiFirstSeq =
+        CurrentLog->ulTotalRecordCount - (CurrentLog->ulRecordCount - 1);
 
     if (pRequest->Count < 0) {
-        /* Start at end of log and look for record which has
-         * timestamp greater than or equal to the reference.
+        /* Look for the last record which has a timestamp
+         * less than the reference.
          */
-        iCount = CurrentLog->ulRecordCount - 1;
-        /* Start out with the sequence number for the last record */
-        uiFirstSeq = CurrentLog->ulTotalRecordCount;
-        for (;;) {
-            if (Logs[pRequest->object_instance][(uiIndex +
-                        iCount) % TL_MAX_ENTRIES].tTimeStamp < tRefTime)
-                break;
-
-            uiFirstSeq--;
-            iCount--;
-            if (iCount < 0)
-                return (0);
-        }
+        iCount = (int) TL_count_before(log_index, tRefTime, false) - 1;
+        if (iCount < 0)
+            return (0);
+        uiFirstSeq += iCount;
 
         /* We have an and point for our request,
          * now work backwards to find where we should start from
@@ -1360,23 +1985,13 @@ int TL_encode_by_time(
             iCount -= iTemp;
         }
     } else {
-        /* Start at beginning of log and look for 1st record which has
-         * timestamp greater than the reference time.
+        /* Look for the 1st record which has a timestamp
+         * greater than the reference time.
          */
-        iCount = 0;
-        /* Figure out the sequence number for the first record, last is ulTotalRecordCount */
-        uiFirstSeq =
-            CurrentLog->ulTotalRecordCount - (CurrentLog->ulRecordCount - 1);
-        for (;;) {
-            if (Logs[pRequest->object_instance][(uiIndex +
-                        iCount) % TL_MAX_ENTRIES].tTimeStamp > tRefTime)
-                break;
-
-            uiFirstSeq++;
-            iCount++;
-            if ((uint32_t) iCount == CurrentLog->ulRecordCount)
-                return (0);
-        }
+        iCount = (int) TL_count_before(log_index, tRefTime, true);
+        if ((uint32_t) iCount == CurrentLog->ulRecordCount)
+            return (0);
+        uiFirstSeq += iCount;
     }
 
     /* We now have a starting point for the operation and a +ve count */
@@ -1433,14 +2048,7 @@ int TL_encode_entry(
     uint8_t ucCount = 0;
     BACNET_DATE_TIME TempTime;
 
-    /* Convert from BACnet 1 based to 0 based array index and then
-     * handle wrap around of the circular buffer */
-
-    if (LogInfo[iLog].ulRecordCount < TL_MAX_ENTRIES)
-        pSource = &Logs[iLog][(iEntry - 1) % TL_MAX_ENTRIES];
-    else
-        pSource =
-            &Logs[iLog][(LogInfo[iLog].iIndex + iEntry - 1) % TL_MAX_ENTRIES];
+    pSource = TL_get_record(iLog, (uint32_t) iEntry);
 
     iLen = 0;
     /* First stick the time stamp in with tag [0] */
@@ -1703,14 +2311,7 @@ static void TL_fetch_property(
         TempRec.ucStatus = 128 | bitstring_octet(&TempBits, 0);
     }
 
-    Logs[iLog][CurrentLog->iIndex++] = TempRec;
-    if (CurrentLog->iIndex >= TL_MAX_ENTRIES)
-        CurrentLog->iIndex = 0;
-
-    CurrentLog->ulTotalRecordCount++;
-
-    if (CurrentLog->ulRecordCount < TL_MAX_ENTRIES)
-        CurrentLog->ulRecordCount++;
+    TL_append_record(iLog, &TempRec);
 }
 
 /****************************************************************************
@@ -1723,9 +2324,18 @@ void trend_log_timer(
     TL_LOG_INFO *CurrentLog = NULL;
     int iCount = 0;
     time_t tNow = 0;
+#if TL_SEGMENT_STORAGE
+    static uint32_t ulFlushSeconds = 0;
 
+    ulFlushSeconds += uSeconds;
+    if (ulFlushSeconds >= TL_FLUSH_INTERVAL) {
+        ulFlushSeconds = 0;
+        Trend_Log_Flush();
+    }
+#else
     /* unused parameter */
     uSeconds = uSeconds;
+#endif
     /* use OS to get the current time */
     tNow = time(NULL);
     for (iCount = 0; iCount < MAX_TREND_LOGS; iCount++) {
@@ -1782,3 +2392,391 @@ void trend_log_timer(
         }
     }
 }
+
+#ifdef TEST
+#include <assert.h>
+#include <string.h>
+#include "ctest.h"
+
+uint32_t Device_Object_Instance_Number(
+    void)
+{
+    return 1234;
+}
+
+int Device_Read_Property(
+    BACNET_READ_PROPERTY_DATA * rpdata)
+{
+    rpdata = rpdata;
+
+    return -1;
+}
+
+bool WPValidateArgType(
+    BACNET_APPLICATION_DATA_VALUE * pValue,
+    uint8_t ucExpectedTag,
+    BACNET_ERROR_CLASS * pErrorClass,
+    BACNET_ERROR_CODE * pErrorCode)
+{
+    pValue = pValue;
+    ucExpectedTag = ucExpectedTag;
+    pErrorClass = pErrorClass;
+    pErrorCode = pErrorCode;
+
+    return false;
+}
+
+static uint8_t Test_APDU[MAX_APDU];
+
+static int TL_test_read_by_time(
+    BACNET_READ_RANGE_DATA * pRequest,
+    int iLog,
+    time_t tRefTime,
+    int32_t iCount)
+{
+    memset(pRequest, 0, sizeof(BACNET_READ_RANGE_DATA));
+    pRequest->object_type = OBJECT_TRENDLOG;
+    pRequest->object_instance = iLog;
+    pRequest->object_property = PROP_LOG_BUFFER;
+    pRequest->array_index = BACNET_ARRAY_ALL;
+    pRequest->RequestType = RR_BY_TIME;
+    pRequest->Overhead = 16;
+    pRequest->Count = iCount;
+    TL_Local_Time_To_BAC(&pRequest->Range.RefTime, tRefTime);
+
+    return rr_trend_log_encode(Test_APDU, pRequest);
+}
+
+void testTrendLogByTime(
+    Test * pTest)
+{
+    BACNET_READ_RANGE_DATA request;
+    TL_LOG_INFO *CurrentLog = &LogInfo[0];
+    uint32_t uiFirstSeq = 0;
+    uint32_t uiEntry = 0;
+    time_t tFirst = 0;
+    int iLen = 0;
+
+    Trend_Log_Init();
+    uiFirstSeq =
+        CurrentLog->ulTotalRecordCount - (CurrentLog->ulRecordCount - 1);
+    tFirst = TL_get_record(0, 1)->tTimeStamp;
+
+    /* the records after the reference time */
+    iLen = TL_test_read_by_time(&request, 0, tFirst + (10 * 900), 5);
+    ct_test(pTest, iLen > 0);
+    ct_test(pTest, request.ItemCount == 5);
+    ct_test(pTest, request.FirstSequence == uiFirstSeq + 11);
+    /* the records before it */
+    iLen = TL_test_read_by_time(&request, 0, tFirst + (10 * 900), -5);
+    ct_test(pTest, iLen > 0);
+    ct_test(pTest, request.ItemCount == 5);
+    ct_test(pTest, request.FirstSequence == uiFirstSeq + 5);
+    /* a count reaching back past the oldest record is pinned to it */
+    iLen = TL_test_read_by_time(&request, 0, tFirst + (3 * 900), -10);
+    ct_test(pTest, request.ItemCount == 3);
+    ct_test(pTest, request.FirstSequence == uiFirstSeq);
+    ct_test(pTest, bitstring_bit(&request.ResultFlags,
+            RESULT_FLAG_FIRST_ITEM));
+    /* a reference between two records */
+    iLen = TL_test_read_by_time(&request, 0, tFirst + (10 * 900) + 1, 1);
+    ct_test(pTest, request.FirstSequence == uiFirstSeq + 11);
+    iLen = TL_test_read_by_time(&request, 0, tFirst + (10 * 900) + 1, -1);
+    ct_test(pTest, request.FirstSequence == uiFirstSeq + 10);
+    /* nothing before the oldest record or after the newest one */
+    iLen = TL_test_read_by_time(&request, 0, tFirst, -1);
+    ct_test(pTest, iLen == 0);
+    ct_test(pTest, request.ItemCount == 0);
+    iLen =
+        TL_test_read_by_time(&request, 0,
+        TL_get_record(0, CurrentLog->ulRecordCount)->tTimeStamp, 1);
+    ct_test(pTest, iLen == 0);
+    ct_test(pTest, request.ItemCount == 0);
+
+    /* once the buffer has wrapped the oldest record is at the
+       insertion point */
+    for (uiEntry = 0; uiEntry < 10; uiEntry++) {
+        TL_Insert_Status_Rec(0, LOG_STATUS_LOG_DISABLED, false);
+    }
+    ct_test(pTest, CurrentLog->iIndex == 10);
+    uiFirstSeq += 10;
+    iLen = TL_test_read_by_time(&request, 0, tFirst + (20 * 900), 1);
+    ct_test(pTest, request.ItemCount == 1);
+    ct_test(pTest, request.FirstSequence == uiFirstSeq + 11);
+    iLen = TL_test_read_by_time(&request, 0, tFirst + (10 * 900), 1);
+    ct_test(pTest, request.FirstSequence == uiFirstSeq + 1);
+    iLen = TL_test_read_by_time(&request, 0, tFirst + (10 * 900), -1);
+    ct_test(pTest, iLen == 0);
+    /* the status records inserted now are the newest */
+    iLen = TL_test_read_by_time(&request, 0, time(NULL) + 1, -10);
+    ct_test(pTest, request.ItemCount == 10);
+    ct_test(pTest, request.FirstSequence ==
+        CurrentLog->ulTotalRecordCount - 9);
+    ct_test(pTest, bitstring_bit(&request.ResultFlags,
+            RESULT_FLAG_LAST_ITEM));
+}
+
+void testTrendLogClockSetBack(
+    Test * pTest)
+{
+    /* a log the other tests leave alone */
+    const int iLog = MAX_TREND_LOGS - 1;
+    BACNET_READ_RANGE_DATA request;
+    TL_LOG_INFO *CurrentLog = &LogInfo[iLog];
+    TL_DATA_REC Record;
+    uint32_t uiFirstSeq = 0;
+    uint32_t uiEntry = 0;
+    time_t tLast = 0;
+    int iLen = 0;
+
+    Trend_Log_Init();
+    tLast = TL_get_record(iLog, CurrentLog->ulRecordCount)->tTimeStamp;
+    memset(&Record, 0, sizeof(Record));
+    Record.ucRecType = TL_TYPE_REAL;
+
+    /* the clock is set back an hour after the newest entry */
+    Record.tTimeStamp = tLast - 3600;
+    TL_append_record(iLog, &Record);
+    Record.tTimeStamp = tLast - 3600 + 900;
+    TL_append_record(iLog, &Record);
+    ct_test(pTest, CurrentLog->ulUnorderedSeq ==
+        CurrentLog->ulTotalRecordCount - 1);
+    uiFirstSeq =
+        CurrentLog->ulTotalRecordCount - (CurrentLog->ulRecordCount - 1);
+
+    /* the first entry newer than the reference, walking from the oldest */
+    iLen = TL_test_read_by_time(&request, iLog, tLast - 1, 1);
+    ct_test(pTest, iLen > 0);
+    ct_test(pTest, request.ItemCount == 1);
+    ct_test(pTest, request.FirstSequence ==
+        CurrentLog->ulTotalRecordCount - 2);
+    /* the last entry older than the reference, walking from the newest */
+    iLen = TL_test_read_by_time(&request, iLog, tLast - 1800, -1);
+    ct_test(pTest, request.ItemCount == 1);
+    ct_test(pTest, request.FirstSequence ==
+        CurrentLog->ulTotalRecordCount);
+    /* entries stamped the same as the reference do not count */
+    iLen = TL_test_read_by_time(&request, iLog, tLast - 3600, -2);
+    ct_test(pTest, request.ItemCount == 2);
+    ct_test(pTest, request.FirstSequence ==
+        CurrentLog->ulTotalRecordCount - 8);
+
+    /* once the entry ahead of the step has been pushed out the log is
+       in order again and the binary search is back in use */
+    for (uiEntry = 0; uiEntry < TL_MAX_ENTRIES - 2; uiEntry++) {
+        Record.tTimeStamp += 900;
+        TL_append_record(iLog, &Record);
+    }
+    uiFirstSeq =
+        CurrentLog->ulTotalRecordCount - (CurrentLog->ulRecordCount - 1);
+    ct_test(pTest, CurrentLog->ulUnorderedSeq == uiFirstSeq);
+    iLen = TL_test_read_by_time(&request, iLog, tLast - 3600, 1);
+    ct_test(pTest, request.FirstSequence == uiFirstSeq + 1);
+
+    /* clearing the log forgets the step */
+    CurrentLog->ulRecordCount = 0;
+    CurrentLog->iIndex = 0;
+    TL_Insert_Status_Rec(iLog, LOG_STATUS_BUFFER_PURGED, true);
+    ct_test(pTest, CurrentLog->ulUnorderedSeq == 0);
+}
+
+#if TL_SEGMENT_STORAGE
+/* a record of a different type and value for each entry number */
+static void TL_test_record(
+    TL_DATA_REC * pRecord,
+    uint32_t uiEntry,
+    time_t tFirst)
+{
+    memset(pRecord, 0, sizeof(TL_DATA_REC));
+    pRecord->tTimeStamp = tFirst + (time_t) (uiEntry * 60);
+    pRecord->ucRecType = (uint8_t) (uiEntry % (TL_TYPE_DELTA + 1));
+    if (uiEntry & 1)
+        pRecord->ucStatus = (uint8_t) (128 | (uiEntry & 7));
+    switch (pRecord->ucRecType) {
+        case TL_TYPE_STATUS:
+            pRecord->Datum.ucLogStatus = 1 << LOG_STATUS_LOG_INTERRUPTED;
+            break;
+        case TL_TYPE_BOOL:
+            pRecord->Datum.ucBoolean = (uint8_t) ((uiEntry >> 1) & 1);
+            break;
+        case TL_TYPE_REAL:
+            pRecord->Datum.fReal = (float) uiEntry * 0.5f;
+            break;
+        case TL_TYPE_ENUM:
+            pRecord->Datum.ulEnum = uiEntry;
+            break;
+        case TL_TYPE_UNSIGN:
+            pRecord->Datum.ulUValue = uiEntry * 100000UL;
+            break;
+        case TL_TYPE_SIGN:
+            pRecord->Datum.lSValue = -(int32_t) uiEntry * 1000;
+            break;
+        case TL_TYPE_BITS:
+            pRecord->Datum.Bits.ucLen = 0x31;
+            pRecord->Datum.Bits.ucStore[0] = (uint8_t) uiEntry;
+            pRecord->Datum.Bits.ucStore[1] = (uint8_t) ~uiEntry;
+            pRecord->Datum.Bits.ucStore[2] = 0x55;
+            break;
+        case TL_TYPE_ERROR:
+            pRecord->Datum.Error.usClass = ERROR_CLASS_DEVICE;
+            pRecord->Datum.Error.usCode = (uint16_t) uiEntry;
+            break;
+        case TL_TYPE_DELTA:
+            pRecord->Datum.fTime = 60.0f;
+            break;
+        default:
+            break;
+    }
+}
+
+void testTrendLogSegments(
+    Test * pTest)
+{
+    /* a log the other tests leave alone */
+    const int iLog = 1;
+    const uint32_t uiAppended = TL_SEGMENT_ENTRIES + (TL_SEGMENT_ENTRIES / 2);
+    BACNET_READ_RANGE_DATA request;
+    TL_LOG_INFO *CurrentLog = &LogInfo[iLog];
+    TL_LOG_INFO SavedLog;
+    TL_DATA_REC Record;
+    TL_DATA_REC *pRecord = NULL;
+    uint32_t uiEntry = 0;
+    uint32_t uiFirstSeq = 0;
+    uint32_t uiItems = 0;
+    time_t tFirst = 0;
+    int iCache = 0;
+    int iLen = 0;
+
+    Trend_Log_Init();
+    /* records of every type, from part way into a segment to past the
+       end of the next one */
+    tFirst = TL_get_record(iLog, CurrentLog->ulRecordCount)->tTimeStamp + 60;
+    for (uiEntry = 0; uiEntry < uiAppended; uiEntry++) {
+        TL_test_record(&Record, uiEntry, tFirst);
+        TL_append_record(iLog, &Record);
+    }
+    Trend_Log_Flush();
+    iLen = TL_test_read_by_time(&request, iLog, tFirst + (100 * 60), 10);
+    ct_test(pTest, request.ItemCount == 10);
+    uiFirstSeq = request.FirstSequence;
+    uiItems = request.ItemCount;
+
+    /* forget what is held in RAM, as on a restart */
+    SavedLog = *CurrentLog;
+    for (iCache = 0; iCache < MAX_TREND_LOGS; iCache++) {
+        Head_Segment[iCache].uiSegment = TL_SEGMENT_NONE;
+        Head_Segment[iCache].bDirty = false;
+    }
+    for (iCache = 0; iCache < TL_SEGMENT_CACHE; iCache++) {
+        Segment_Cache[iCache].uiSegment = TL_SEGMENT_NONE;
+    }
+    memset(Segment_Start[iLog], 0, sizeof(Segment_Start[iLog]));
+    CurrentLog->ulRecordCount = 0;
+    CurrentLog->ulTotalRecordCount = 0;
+    CurrentLog->iIndex = 0;
+
+    /* the log is restored from its files */
+    ct_test(pTest, TL_segment_read_state(iLog));
+    ct_test(pTest, CurrentLog->ulRecordCount == SavedLog.ulRecordCount);
+    ct_test(pTest,
+        CurrentLog->ulTotalRecordCount == SavedLog.ulTotalRecordCount);
+    ct_test(pTest, CurrentLog->iIndex == SavedLog.iIndex);
+    for (uiEntry = 0; uiEntry < uiAppended; uiEntry++) {
+        TL_test_record(&Record, uiEntry, tFirst);
+        pRecord =
+            TL_get_record(iLog,
+            CurrentLog->ulRecordCount - uiAppended + 1 + uiEntry);
+        ct_test(pTest, pRecord->tTimeStamp == Record.tTimeStamp);
+        ct_test(pTest, pRecord->ucRecType == Record.ucRecType);
+        ct_test(pTest, pRecord->ucStatus == Record.ucStatus);
+        ct_test(pTest, memcmp(&pRecord->Datum, &Record.Datum,
+                sizeof(Record.Datum)) == 0);
+    }
+    iLen = TL_test_read_by_time(&request, iLog, tFirst + (100 * 60), 10);
+    ct_test(pTest, iLen > 0);
+    ct_test(pTest, request.ItemCount == uiItems);
+    ct_test(pTest, request.FirstSequence == uiFirstSeq);
+    ct_test(pTest, request.FirstSequence ==
+        CurrentLog->ulTotalRecordCount - uiAppended + 102);
+}
+#endif
+
+#ifdef TEST_TRENDLOG
+int main(
+    void)
+{
+    Test *pTest;
+    bool rc;
+#if TL_SEGMENT_STORAGE
+    char szPath[sizeof(TL_SEGMENT_DIR) + 32];
+    int iLog;
+
+    /* start from the demo logs rather than the ones of the last run */
+    for (iLog = 0; iLog < MAX_TREND_LOGS; iLog++) {
+        TL_segment_path(szPath, iLog, TL_SEGMENT_NONE);
+        remove(szPath);
+    }
+#endif
+
+    pTest = ct_create("BACnet Trend Log", NULL);
+    /* individual tests */
+    rc = ct_addTestFunction(pTest, testTrendLogByTime);
+    assert(rc);
+    rc = ct_addTestFunction(pTest, testTrendLogClockSetBack);
+    assert(rc);
+#if TL_SEGMENT_STORAGE
+    rc = ct_addTestFunction(pTest, testTrendLogSegments);
+    assert(rc);
+#endif
+
+    ct_setStream(pTest, stdout);
+    ct_run(pTest);
+    (void) ct_report(pTest);
+    ct_destroy(pTest);
+
+    return 0;
+}
+#endif /* TEST_TRENDLOG */
+
+#ifdef TEST_TRENDLOG_BENCHMARK
+/* times ReadRange by time on logs of TL_MAX_ENTRIES records,
+   see tlbench.mak */
+int main(
+    void)
+{
+    BACNET_READ_RANGE_DATA request;
+    time_t tFirst = 0;
+    uint32_t uiRead = 0;
+    uint32_t uiItems = 0;
+    clock_t start;
+
+    start = clock();
+    Trend_Log_Init();
+    printf("writing a %lu record log took %.3fs\n",
+        (unsigned long) LogInfo[0].ulRecordCount,
+        (double) (clock() - start) / CLOCKS_PER_SEC);
+    tFirst = TL_get_record(0, 1)->tTimeStamp;
+    start = clock();
+    for (uiRead = 0; uiRead < 100000; uiRead++) {
+        (void) TL_test_read_by_time(&request, 0,
+            tFirst + (time_t) (((uiRead * 7919UL) % TL_MAX_ENTRIES) * 900),
+            (uiRead & 1) ? 20 : -20);
+        uiItems += request.ItemCount;
+    }
+    printf("%lu reads by time of a %lu record log returned %lu records "
+        "in %.3fs\n", (unsigned long) uiRead,
+        (unsigned long) LogInfo[0].ulRecordCount, (unsigned long) uiItems,
+        (double) (clock() - start) / CLOCKS_PER_SEC);
+    start = clock();
+    for (uiRead = 1; uiRead <= LogInfo[0].ulRecordCount; uiRead++) {
+        if (TL_get_record(0, uiRead)->tTimeStamp < tFirst)
+            break;
+    }
+    printf("reading all %lu records in order took %.3fs\n",
+        (unsigned long) (uiRead - 1),
+        (double) (clock() - start) / CLOCKS_PER_SEC);
+
+    return 0;
+}
+#endif /* TEST_TRENDLOG_BENCHMARK */
+#endif /* TEST */
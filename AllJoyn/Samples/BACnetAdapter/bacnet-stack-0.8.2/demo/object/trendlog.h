@@ -80,7 +80,43 @@ extern "C" {
 #define TL_T_START_WILD 1       /* Start time is wild carded */
 #define TL_T_STOP_WILD  2       /* Stop Time is wild carded */
 
+/* Each log is a ring of TL_MAX_ENTRIES records. By default the rings are
+ * kept in static RAM, and MAX_TREND_LOGS * TL_MAX_ENTRIES may not exceed
+ * TL_MAX_TOTAL_ENTRIES so the RAM the logs take stays bounded.
+ *
+ * Define TL_SEGMENT_STORAGE as 1 to keep the rings in files instead, for
+ * logs that hold weeks of samples. A ring is cut into segments of
+ * TL_SEGMENT_ENTRIES records, each stored compressed in its own file under
+ * TL_SEGMENT_DIR. RAM holds the segment each log appends to, a cache of
+ * the TL_SEGMENT_CACHE segments read last and the time stamp of the first
+ * record of every segment, which ReadRange by time searches before it reads
+ * a single segment. The logs are restored from the files on start up, and
+ * the records of the last TL_FLUSH_INTERVAL seconds may be lost on a
+ * power loss.
+ */
+#ifndef TL_MAX_ENTRIES
 #define TL_MAX_ENTRIES 1000     /* Entries per datalog */
+#endif
+#ifndef TL_MAX_TOTAL_ENTRIES
+#define TL_MAX_TOTAL_ENTRIES 65536      /* Entries held in RAM for all datalogs */
+#endif
+#ifndef TL_SEGMENT_STORAGE
+#define TL_SEGMENT_STORAGE 0
+#endif
+#if TL_SEGMENT_STORAGE
+#ifndef TL_SEGMENT_ENTRIES
+#define TL_SEGMENT_ENTRIES 4096 /* Entries per segment file */
+#endif
+#ifndef TL_SEGMENT_CACHE
+#define TL_SEGMENT_CACHE 4      /* Segments read last kept in RAM */
+#endif
+#ifndef TL_SEGMENT_DIR
+#define TL_SEGMENT_DIR "."      /* Where the segment files go */
+#endif
+#ifndef TL_FLUSH_INTERVAL
+#define TL_FLUSH_INTERVAL 60    /* Seconds between writes of the open segments */
+#endif
+#endif
 
 /* Structure containing config and status info for a Trend Log */
 
@@ -102,6 +138,7 @@ extern "C" {
         bool bTrigger;  /* Set to 1 to cause a reading to be taken */
         int iIndex;     /* Current insertion point */
         time_t tLastDataTime;
+        uint32_t ulUnorderedSeq;        /* Sequence number of the newest entry stamped before the one ahead of it, 0 if none */
     } TL_LOG_INFO;
 
 /*
@@ -150,6 +187,8 @@ extern "C" {
         BACNET_WRITE_PROPERTY_DATA * wp_data);
     void Trend_Log_Init(
         void);
+    void Trend_Log_Flush(
+        void);
 
     void TL_Insert_Status_Rec(
         int iLog,
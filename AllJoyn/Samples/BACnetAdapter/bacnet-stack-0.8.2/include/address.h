@@ -30,6 +30,37 @@
 #include "bacdef.h"
 #include "readrange.h"
 
+/* an entry in the address cache, see address.c for the Flags */
+struct Address_Cache_Entry {
+    uint8_t Flags;
+    uint32_t device_id;
+    unsigned max_apdu;
+    BACNET_ADDRESS address;
+    uint32_t TimeToLive;
+    /* neighbours in least recently used order, entry number + 1 or 0 */
+    unsigned lru_newer;
+    unsigned lru_older;
+};
+
+/* The cache grows on demand up to MAX_ADDRESS_CACHE entries and is
+   indexed by device instance.  A zero filled cache is an empty one.
+
+   The address cache functions are not thread safe.  Lookups modify the
+   cache as well: they move the entry in the LRU order, and adding an
+   entry may reallocate the entries and the index, which invalidates
+   pointers into them.  A program that uses the cache from more than one
+   thread must serialize every call below, lookups included, with one
+   lock. */
+typedef struct Address_Cache {
+    struct Address_Cache_Entry *Entries;
+    unsigned Size;      /* number of entries allocated */
+    unsigned Free_Hint; /* there are no free entries below this one */
+    unsigned *Index;    /* device instance hash of entry number + 1 */
+    unsigned Index_Bits;        /* the index has 2^Index_Bits slots */
+    unsigned LRU_Newest;        /* entry number + 1 or 0 */
+    unsigned LRU_Oldest;        /* entry number + 1 or 0 */
+} ADDRESS_CACHE;
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -40,6 +71,9 @@ extern "C" {
     void address_init_partial(
         void);
 
+    void address_cleanup(
+        void);
+
     void address_add(
         uint32_t device_id,
         unsigned max_apdu,
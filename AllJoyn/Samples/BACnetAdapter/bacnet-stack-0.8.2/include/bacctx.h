@@ -0,0 +1,154 @@
+/**************************************************************************
+*
+* Copyright (C) 2016 Microsoft Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+*********************************************************************/
+#ifndef BACCTX_H
+#define BACCTX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "config.h"
+
+#if BACNET_CONTEXT_ENABLED
+#include "bacdef.h"
+#include "apdu.h"
+#include "tsm.h"
+#include "address.h"
+#if (defined(BACDL_BIP) || defined(BACDL_ALL))
+#include "bip.h"
+#include "bvlc.h"
+#endif
+
+/** @file bacctx.h  Stack state that can be bound per datalink */
+
+/* The state of the TSM, the address cache, the APDU handlers, DCC, the
+   B/IP, BVLC and MS/TP datalinks and the handler transmit buffer is kept
+   in a BACNET_STACK_CONTEXT.  A process that runs several datalinks gives
+   each of them a context.  Every thread that works on a datalink, such
+   as its receive and its transmit thread, binds the context of that
+   datalink before calling the stack:
+
+       static BACNET_STACK_CONTEXT context;
+       bacctx_init(&context);
+       bacctx_set(&context);
+       ...the usual datalink_init(), apdu_set_*_handler() and receive loop
+
+   and the threads that the MS/TP port starts bind the context that was
+   bound when dlmstp_init() was called.  The existing functions use the
+   context bound to the calling thread, or the default context when none
+   has been bound, so a process that only runs one datalink does not need
+   to do anything.
+
+   The threads that share a context must not call the stack at the same
+   time, as with the global stack.  A context must outlive the datalink
+   threads that use it, and the MS/TP port keeps its state in memory it
+   allocates on first use and never releases, as its threads never stop.
+   The Ethernet and ARCNET datalinks and the demo object tables are not
+   in the context and stay shared by all datalinks. */
+typedef struct BACnet_Stack_Context {
+    /* see txbuf.h */
+    uint8_t Transmit_Buffer[MAX_PDU];
+    /* see apdu.c */
+    struct {
+        uint16_t Timeout_Milliseconds;
+        uint8_t Number_Of_Retries;
+        confirmed_function Confirmed_Function[MAX_BACNET_CONFIRMED_SERVICE];
+        confirmed_function Unrecognized_Service_Handler;
+        unconfirmed_function
+            Unconfirmed_Function[MAX_BACNET_UNCONFIRMED_SERVICE];
+        confirmed_ack_function
+            Confirmed_ACK_Function[MAX_BACNET_CONFIRMED_SERVICE];
+        error_function Error_Function[MAX_BACNET_CONFIRMED_SERVICE];
+        abort_function Abort_Function;
+        reject_function Reject_Function;
+    } apdu;
+#if (MAX_TSM_TRANSACTIONS)
+    /* see tsm.c */
+    struct {
+        BACNET_TSM_DATA List[MAX_TSM_TRANSACTIONS];
+        uint8_t Current_Invoke_ID;
+        tsm_timeout_function Timeout_Function;
+    } tsm;
+#endif
+    /* see address.c */
+    ADDRESS_CACHE address;
+    /* see dcc.c */
+    struct {
+        uint32_t Time_Duration_Seconds;
+        BACNET_COMMUNICATION_ENABLE_DISABLE Enable_Disable;
+    } dcc;
+#if (defined(BACDL_BIP) || defined(BACDL_ALL))
+    /* see bip.c */
+    struct {
+        int Socket;
+        uint16_t Port;
+        struct in_addr Address;
+        struct in_addr Broadcast_Address;
+    } bip;
+    /* see bvlc.c */
+    struct {
+        struct sockaddr_in Remote_BBMD;
+        struct in_addr Global_Address;
+        bool NAT_Handling;
+        BACNET_BVLC_RESULT Result_Code;
+        BACNET_BVLC_FUNCTION Function_Code;
+#if defined(BBMD_ENABLED) && BBMD_ENABLED
+        BBMD_TABLE_ENTRY BBMD_Table[MAX_BBMD_ENTRIES];
+        FD_TABLE_ENTRY FD_Table[MAX_FD_ENTRIES];
+#endif
+    } bvlc;
+#endif
+#if (defined(BACDL_MSTP) || defined(BACDL_ALL))
+    /* see the dlmstp.c and rs485.c of the port */
+    struct dlmstp_data *dlmstp;
+    struct rs485_data *rs485;
+#endif
+} BACNET_STACK_CONTEXT;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* sets a context to the same state as a freshly started stack */
+    void bacctx_init(
+        BACNET_STACK_CONTEXT * context);
+
+/* the context used by threads that have not bound one, it is set up
+   statically so that threads can start using it at any time */
+    BACNET_STACK_CONTEXT *bacctx_default(
+        void);
+
+/* binds the context of a datalink to the calling thread, or unbinds it
+   when NULL, and returns the context that was bound before */
+    BACNET_STACK_CONTEXT *bacctx_set(
+        BACNET_STACK_CONTEXT * context);
+
+/* the context of the calling thread */
+    BACNET_STACK_CONTEXT *bacctx_get(
+        void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* BACNET_CONTEXT_ENABLED */
+#endif
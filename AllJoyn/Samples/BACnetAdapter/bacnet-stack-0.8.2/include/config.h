@@ -54,6 +54,14 @@
 #endif
 #endif
 
+/* Define as 1 to keep the TSM, address cache, APDU handlers, DCC, B/IP,
+   BVLC and MS/TP port state and the handler transmit buffer in a
+   BACNET_STACK_CONTEXT that the threads of a datalink bind, so that several
+   datalinks can run in one process.  See bacctx.h */
+#if !defined(BACNET_CONTEXT_ENABLED)
+#define BACNET_CONTEXT_ENABLED 0
+#endif
+
 
 /* Define your processor architecture as
    Big Endian (PowerPC,68K,Sparc) or Little Endian (Intel,AVR)
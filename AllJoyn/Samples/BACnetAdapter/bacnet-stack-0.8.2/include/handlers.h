@@ -237,6 +237,9 @@ extern "C" {
         void);
     void handler_cov_timer_seconds(
         uint32_t elapsed_seconds);
+    void handler_cov_object_changed(
+        BACNET_OBJECT_TYPE object_type,
+        uint32_t object_instance);
     void handler_cov_init(
         void);
     int handler_cov_encode_subscriptions(
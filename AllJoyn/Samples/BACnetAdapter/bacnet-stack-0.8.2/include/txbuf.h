@@ -30,6 +30,12 @@
 #include "config.h"
 #include "datalink.h"
 
+#if BACNET_CONTEXT_ENABLED
+#include "bacctx.h"
+/* each stack context has its own transmit buffer */
+#define Handler_Transmit_Buffer (bacctx_get()->Transmit_Buffer)
+#else
 extern uint8_t Handler_Transmit_Buffer[MAX_PDU];
+#endif
 
 #endif
@@ -39,11 +39,83 @@
 #include "bits.h"
 #include "ringbuf.h"
 #include "debug.h"
+#include "bacctx.h"
 /* OS Specific include */
 #include "net.h"
 
 /** @file linux/dlmstp.c  Provides Linux-specific DataLink functions for MS/TP. */
 
+/* data structure for MS/TP PDU Queue */
+struct mstp_pdu_packet {
+    bool data_expecting_reply;
+    uint8_t destination_mac;
+    uint16_t length;
+    uint8_t buffer[MAX_MPDU];
+};
+/* count must be a power of 2 for ringbuf library */
+#ifndef MSTP_PDU_PACKET_COUNT
+#define MSTP_PDU_PACKET_COUNT 8
+#endif
+
+#if BACNET_CONTEXT_ENABLED
+/* the port belongs to the stack context bound to the calling thread,
+   so each datalink context runs its own MS/TP port */
+struct dlmstp_data {
+    uint16_t MSTP_Packets;
+    DLMSTP_PACKET Receive_Packet;
+    pthread_cond_t Receive_Packet_Flag;
+    pthread_mutex_t Receive_Packet_Mutex;
+    pthread_cond_t Received_Frame_Flag;
+    pthread_mutex_t Received_Frame_Mutex;
+    pthread_cond_t Master_Done_Flag;
+    pthread_mutex_t Master_Done_Mutex;
+    volatile struct mstp_port_struct_t MSTP_Port;
+    uint8_t TxBuffer[MAX_MPDU];
+    uint8_t RxBuffer[MAX_MPDU];
+    struct mstp_pdu_packet PDU_Buffer[MSTP_PDU_PACKET_COUNT];
+    RING_BUFFER PDU_Queue;
+    uint16_t Treply_timeout;
+    uint8_t Tusage_timeout;
+    struct timeval Silence_Start;
+};
+
+/* the port is set up the first time the context uses it, which may be
+   before dlmstp_init(), and it is kept for as long as the process runs */
+static struct dlmstp_data *dlmstp_data(
+    void)
+{
+    BACNET_STACK_CONTEXT *context = bacctx_get();
+
+    if (!context->dlmstp) {
+        context->dlmstp = calloc(1, sizeof(struct dlmstp_data));
+        if (!context->dlmstp) {
+            fprintf(stderr, "MS/TP: cannot allocate the port data.\n");
+            exit(1);
+        }
+        context->dlmstp->Treply_timeout = 300;
+        context->dlmstp->Tusage_timeout = 100;
+    }
+
+    return context->dlmstp;
+}
+
+#define MSTP_Packets (dlmstp_data()->MSTP_Packets)
+#define Receive_Packet (dlmstp_data()->Receive_Packet)
+#define Receive_Packet_Flag (dlmstp_data()->Receive_Packet_Flag)
+#define Receive_Packet_Mutex (dlmstp_data()->Receive_Packet_Mutex)
+#define Received_Frame_Flag (dlmstp_data()->Received_Frame_Flag)
+#define Received_Frame_Mutex (dlmstp_data()->Received_Frame_Mutex)
+#define Master_Done_Flag (dlmstp_data()->Master_Done_Flag)
+#define Master_Done_Mutex (dlmstp_data()->Master_Done_Mutex)
+#define MSTP_Port (dlmstp_data()->MSTP_Port)
+#define TxBuffer (dlmstp_data()->TxBuffer)
+#define RxBuffer (dlmstp_data()->RxBuffer)
+#define PDU_Buffer (dlmstp_data()->PDU_Buffer)
+#define PDU_Queue (dlmstp_data()->PDU_Queue)
+#define Treply_timeout (dlmstp_data()->Treply_timeout)
+#define Tusage_timeout (dlmstp_data()->Tusage_timeout)
+#define Silence_Start (dlmstp_data()->Silence_Start)
+#else
 /* Number of MS/TP Packets Rx/Tx */
 uint16_t MSTP_Packets = 0;
 
@@ -73,17 +145,6 @@ static volatile struct mstp_port_struct_t MSTP_Port;
 /* buffers needed by mstp port struct */
 static uint8_t TxBuffer[MAX_MPDU];
 static uint8_t RxBuffer[MAX_MPDU];
-/* data structure for MS/TP PDU Queue */
-struct mstp_pdu_packet {
-    bool data_expecting_reply;
-    uint8_t destination_mac;
-    uint16_t length;
-    uint8_t buffer[MAX_MPDU];
-};
-/* count must be a power of 2 for ringbuf library */
-#ifndef MSTP_PDU_PACKET_COUNT
-#define MSTP_PDU_PACKET_COUNT 8
-#endif
 static struct mstp_pdu_packet PDU_Buffer[MSTP_PDU_PACKET_COUNT];
 static RING_BUFFER PDU_Queue;
 /* The minimum time without a DataAvailable or ReceiveError event */
@@ -98,7 +159,8 @@ static uint16_t Treply_timeout = 300;
 static uint8_t Tusage_timeout = 100;
 /* Timer that indicates line silence - and functions */
 
-static struct timeval start;
+static struct timeval Silence_Start;
+#endif
 
 static uint32_t Timer_Silence(
     void *pArg)
@@ -107,7 +169,7 @@ static uint32_t Timer_Silence(
     int32_t res;
 
     gettimeofday(&now, NULL);
-    timersub(&start, &now, &tmp_diff);
+    timersub(&Silence_Start, &now, &tmp_diff);
     res = ((tmp_diff.tv_sec) * 1000 + (tmp_diff.tv_usec) / 1000);
 
     return (res >= 0 ? res : -res);
@@ -116,7 +178,7 @@ static uint32_t Timer_Silence(
 static void Timer_Silence_Reset(
     void *pArg)
 {
-    gettimeofday(&start, NULL);
+    gettimeofday(&Silence_Start, NULL);
 }
 
 static void get_abstime(
@@ -142,6 +204,11 @@ void dlmstp_cleanup(
     pthread_mutex_destroy(&Received_Frame_Mutex);
     pthread_mutex_destroy(&Receive_Packet_Mutex);
     pthread_mutex_destroy(&Master_Done_Mutex);
+#if BACNET_CONTEXT_ENABLED
+    /* the exit handler of RS485_Initialize() would restore some other
+       context's serial port */
+    RS485_Cleanup();
+#endif
 }
 
 /* returns number of bytes sent on success, zero on failure */
@@ -218,7 +285,12 @@ static void *dlmstp_master_fsm_task(
     uint32_t silence = 0;
     bool run_master = false;
 
+#if BACNET_CONTEXT_ENABLED
+    /* run the port of the datalink context that started this thread */
+    bacctx_set((BACNET_STACK_CONTEXT *) pArg);
+#else
     (void) pArg;
+#endif
     for (;;) {
         if (MSTP_Port.ReceivedValidFrame == false &&
             MSTP_Port.ReceivedInvalidFrame == false) {
@@ -668,8 +740,12 @@ bool dlmstp_init(
     char *ifname)
 {
     unsigned long hThread = 0;
+    void *fsm_context = NULL;
     int rv = 0;
 
+#if BACNET_CONTEXT_ENABLED
+    fsm_context = bacctx_get();
+#endif
     /* initialize PDU queue */
     Ringbuf_Init(&PDU_Queue, (uint8_t *) & PDU_Buffer,
         sizeof(struct mstp_pdu_packet), MSTP_PDU_PACKET_COUNT);
@@ -701,7 +777,7 @@ bool dlmstp_init(
     MSTP_Port.InputBufferSize = sizeof(RxBuffer);
     MSTP_Port.OutputBuffer = &TxBuffer[0];
     MSTP_Port.OutputBufferSize = sizeof(TxBuffer);
-    gettimeofday(&start, NULL);
+    gettimeofday(&Silence_Start, NULL);
     MSTP_Port.SilenceTimer = Timer_Silence;
     MSTP_Port.SilenceTimerReset = Timer_Silence_Reset;
     MSTP_Init(&MSTP_Port);
@@ -715,7 +791,7 @@ bool dlmstp_init(
     /*    if (rv != 0) {
        fprintf(stderr, "Failed to start recive FSM task\n");
        } */
-    rv = pthread_create(&hThread, NULL, dlmstp_master_fsm_task, NULL);
+    rv = pthread_create(&hThread, NULL, dlmstp_master_fsm_task, fsm_context);
     if (rv != 0) {
         fprintf(stderr, "Failed to start Master Node FSM task\n");
     }
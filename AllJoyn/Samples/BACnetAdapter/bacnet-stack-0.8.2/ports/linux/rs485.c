@@ -67,6 +67,7 @@
 #include <sys/time.h>
 
 #include "dlmstp_linux.h"
+#include "bacctx.h"
 
 /* Posix serial programming reference:
 http://www.easysw.com/~mike/serial/serial.html */
@@ -75,18 +76,63 @@ http://www.easysw.com/~mike/serial/serial.html */
    $ sudo ionice -c 1 -n 0 ./bin/bacserv 12345
 */
 
+/* some terminal I/O have RS-485 specific functionality */
+#ifndef RS485MOD
+#define RS485MOD 0
+#endif
+
+#if BACNET_CONTEXT_ENABLED
+/* the serial port belongs to the stack context bound to the calling
+   thread, so each datalink context runs its own MS/TP port */
+struct rs485_data {
+    int RS485_Port_Handle;
+    unsigned int RS485_Port_Baud;
+    char *RS485_Port_Name;
+    struct termios RS485_oldtio;
+    struct serial_struct RS485_oldserial;
+    bool RS485_SpecBaud;
+    FIFO_BUFFER RS485_Rx_FIFO;
+    uint8_t Rx_Buffer[4096];
+};
+
+/* the port is set up the first time the context uses it, which may be
+   before RS485_Initialize(), and it is kept for as long as the process runs */
+static struct rs485_data *rs485_data(
+    void)
+{
+    BACNET_STACK_CONTEXT *context = bacctx_get();
+
+    if (!context->rs485) {
+        context->rs485 = calloc(1, sizeof(struct rs485_data));
+        if (!context->rs485) {
+            fprintf(stderr, "RS485: cannot allocate the port data.\n");
+            exit(1);
+        }
+        context->rs485->RS485_Port_Handle = -1;
+        context->rs485->RS485_Port_Baud = B38400;
+        context->rs485->RS485_Port_Name = "/dev/ttyUSB0";
+    }
+
+    return context->rs485;
+}
+
+#define RS485_Port_Handle (rs485_data()->RS485_Port_Handle)
+#define RS485_Port_Baud (rs485_data()->RS485_Port_Baud)
+#define RS485_Port_Name (rs485_data()->RS485_Port_Name)
+#define RS485_oldtio (rs485_data()->RS485_oldtio)
+#define RS485_oldserial (rs485_data()->RS485_oldserial)
+#define RS485_SpecBaud (rs485_data()->RS485_SpecBaud)
+#define RS485_Rx_FIFO (rs485_data()->RS485_Rx_FIFO)
+#define Rx_Buffer (rs485_data()->Rx_Buffer)
+#else
 /* handle returned from open() */
-static int RS485_Handle = -1;
+static int RS485_Port_Handle = -1;
 /* baudrate settings are defined in <asm/termbits.h>, which is
    included by <termios.h> */
-static unsigned int RS485_Baud = B38400;
+static unsigned int RS485_Port_Baud = B38400;
 /* serial port name, /dev/ttyS0,
   /dev/ttyUSB0 for USB->RS485 from B&B Electronics USOPTL4 */
 static char *RS485_Port_Name = "/dev/ttyUSB0";
-/* some terminal I/O have RS-485 specific functionality */
-#ifndef RS485MOD
-#define RS485MOD 0
-#endif
 /* serial I/O settings */
 static struct termios RS485_oldtio;
 /* for setting custom divisor */
@@ -95,9 +141,10 @@ static struct serial_struct RS485_oldserial;
 static bool RS485_SpecBaud = false;
 
 /* Ring buffer for incoming bytes, in order to speed up the receiving. */
-static FIFO_BUFFER Rx_FIFO;
+static FIFO_BUFFER RS485_Rx_FIFO;
 /* buffer size needs to be a power of 2 */
 static uint8_t Rx_Buffer[4096];
+#endif
 
 #define _POSIX_SOURCE 1 /* POSIX compliant source */
 
@@ -139,7 +186,7 @@ uint32_t RS485_Get_Baud_Rate(
 {
     uint32_t baud = 0;
 
-    switch (RS485_Baud) {
+    switch (RS485_Port_Baud) {
         case B0:
             baud = 0;
             break;
@@ -304,65 +351,65 @@ bool RS485_Set_Baud_Rate(
     RS485_SpecBaud = false;
     switch (baud) {
         case 0:
-            RS485_Baud = B0;
+            RS485_Port_Baud = B0;
             break;
         case 50:
-            RS485_Baud = B50;
+            RS485_Port_Baud = B50;
             break;
         case 75:
-            RS485_Baud = B75;
+            RS485_Port_Baud = B75;
             break;
         case 110:
-            RS485_Baud = B110;
+            RS485_Port_Baud = B110;
             break;
         case 134:
-            RS485_Baud = B134;
+            RS485_Port_Baud = B134;
             break;
         case 150:
-            RS485_Baud = B150;
+            RS485_Port_Baud = B150;
             break;
         case 200:
-            RS485_Baud = B200;
+            RS485_Port_Baud = B200;
             break;
         case 300:
-            RS485_Baud = B300;
+            RS485_Port_Baud = B300;
             break;
         case 600:
-            RS485_Baud = B600;
+            RS485_Port_Baud = B600;
             break;
         case 1200:
-            RS485_Baud = B1200;
+            RS485_Port_Baud = B1200;
             break;
         case 1800:
-            RS485_Baud = B1800;
+            RS485_Port_Baud = B1800;
             break;
         case 2400:
-            RS485_Baud = B2400;
+            RS485_Port_Baud = B2400;
             break;
         case 4800:
-            RS485_Baud = B4800;
+            RS485_Port_Baud = B4800;
             break;
         case 9600:
-            RS485_Baud = B9600;
+            RS485_Port_Baud = B9600;
             break;
         case 19200:
-            RS485_Baud = B19200;
+            RS485_Port_Baud = B19200;
             break;
         case 38400:
-            RS485_Baud = B38400;
+            RS485_Port_Baud = B38400;
             break;
         case 57600:
-            RS485_Baud = B57600;
+            RS485_Port_Baud = B57600;
             break;
         case 76800:
-            RS485_Baud = B38400;
+            RS485_Port_Baud = B38400;
             RS485_SpecBaud = true;
             break;
         case 115200:
-            RS485_Baud = B115200;
+            RS485_Port_Baud = B115200;
             break;
         case 230400:
-            RS485_Baud = B230400;
+            RS485_Port_Baud = B230400;
             break;
         default:
             valid = false;
@@ -408,15 +455,15 @@ void RS485_Send_Frame(
            regular file, 0 will be returned without causing any other effect.  For
            a special file, the results are not portable.
          */
-        written = write(RS485_Handle, buffer, nbytes);
+        written = write(RS485_Port_Handle, buffer, nbytes);
         greska = errno;
         if (written <= 0) {
             printf("write error: %s\n", strerror(greska));
         } else {
             /* wait until all output has been transmitted. */
-            tcdrain(RS485_Handle);
+            tcdrain(RS485_Port_Handle);
         }
-        /*  tcdrain(RS485_Handle); */
+        /*  tcdrain(RS485_Port_Handle); */
         /* per MSTP spec, sort of */
         if (mstp_port) {
             mstp_port->SilenceTimerReset((void *) mstp_port);
@@ -441,7 +488,7 @@ void RS485_Send_Frame(
             /* wait until all output has been transmitted. */
             tcdrain(poSharedData->RS485_Handle);
         }
-        /*  tcdrain(RS485_Handle); */
+        /*  tcdrain(RS485_Port_Handle); */
         /* per MSTP spec, sort of */
         if (mstp_port) {
             mstp_port->SilenceTimerReset((void *) mstp_port);
@@ -474,9 +521,9 @@ void RS485_Check_UART_Data(
             waiter.tv_usec = 5000;
         } else if (mstp_port->DataAvailable == false) {
             /* wait for state machine to read from the DataRegister */
-            if (FIFO_Count(&Rx_FIFO) > 0) {
+            if (FIFO_Count(&RS485_Rx_FIFO) > 0) {
                 /* data is available */
-                mstp_port->DataRegister = FIFO_Get(&Rx_FIFO);
+                mstp_port->DataRegister = FIFO_Get(&RS485_Rx_FIFO);
                 mstp_port->DataAvailable = true;
                 /* FIFO is giving data - don't wait very long */
                 waiter.tv_sec = 0;
@@ -489,14 +536,14 @@ void RS485_Check_UART_Data(
         }
         /* grab bytes and stuff them into the FIFO every time */
         FD_ZERO(&input);
-        FD_SET(RS485_Handle, &input);
-        n = select(RS485_Handle + 1, &input, NULL, NULL, &waiter);
+        FD_SET(RS485_Port_Handle, &input);
+        n = select(RS485_Port_Handle + 1, &input, NULL, NULL, &waiter);
         if (n < 0) {
             return;
         }
-        if (FD_ISSET(RS485_Handle, &input)) {
-            n = read(RS485_Handle, buf, sizeof(buf));
-            FIFO_Add(&Rx_FIFO, &buf[0], n);
+        if (FD_ISSET(RS485_Port_Handle, &input)) {
+            n = read(RS485_Port_Handle, buf, sizeof(buf));
+            FIFO_Add(&RS485_Rx_FIFO, &buf[0], n);
         }
     } else {
         if (mstp_port->ReceiveError == true) {
@@ -538,9 +585,9 @@ void RS485_Cleanup(
     void)
 {
     /* restore the old port settings */
-    tcsetattr(RS485_Handle, TCSANOW, &RS485_oldtio);
-    ioctl(RS485_Handle, TIOCSSERIAL, &RS485_oldserial);
-    close(RS485_Handle);
+    tcsetattr(RS485_Port_Handle, TCSANOW, &RS485_oldtio);
+    ioctl(RS485_Port_Handle, TIOCSSERIAL, &RS485_oldserial);
+    close(RS485_Port_Handle);
 }
 
 
@@ -556,22 +603,22 @@ void RS485_Initialize(
        Open device for reading and writing.
        Blocking mode - more CPU effecient
      */
-    RS485_Handle = open(RS485_Port_Name, O_RDWR | O_NOCTTY /*| O_NDELAY */ );
-    if (RS485_Handle < 0) {
+    RS485_Port_Handle = open(RS485_Port_Name, O_RDWR | O_NOCTTY /*| O_NDELAY */ );
+    if (RS485_Port_Handle < 0) {
         perror(RS485_Port_Name);
         exit(-1);
     }
 #if 0
     /* non blocking for the read */
-    fcntl(RS485_Handle, F_SETFL, FNDELAY);
+    fcntl(RS485_Port_Handle, F_SETFL, FNDELAY);
 #else
     /* efficient blocking for the read */
-    fcntl(RS485_Handle, F_SETFL, 0);
+    fcntl(RS485_Port_Handle, F_SETFL, 0);
 #endif
     /* save current serial port settings */
-    tcgetattr(RS485_Handle, &RS485_oldtio);
+    tcgetattr(RS485_Port_Handle, &RS485_oldtio);
     /* we read the old serial setup */
-    ioctl(RS485_Handle, TIOCGSERIAL, &RS485_oldserial);
+    ioctl(RS485_Port_Handle, TIOCGSERIAL, &RS485_oldserial);
     /* we need a copy of existing settings */
     memcpy(&newserial, &RS485_oldserial, sizeof(struct serial_struct));
     /* clear struct for new port settings */
@@ -584,7 +631,7 @@ void RS485_Initialize(
        CLOCAL  : local connection, no modem contol
        CREAD   : enable receiving characters
      */
-    newtio.c_cflag = RS485_Baud | CS8 | CLOCAL | CREAD | RS485MOD;
+    newtio.c_cflag = RS485_Port_Baud | CS8 | CLOCAL | CREAD | RS485MOD;
     /* Raw input */
     newtio.c_iflag = 0;
     /* Raw output */
@@ -592,7 +639,7 @@ void RS485_Initialize(
     /* no processing */
     newtio.c_lflag = 0;
     /* activate the settings for the port after flushing I/O */
-    tcsetattr(RS485_Handle, TCSAFLUSH, &newtio);
+    tcsetattr(RS485_Port_Handle, TCSAFLUSH, &newtio);
     if (RS485_SpecBaud) {
         /* 76800, custom divisor must be set */
         newserial.flags |= ASYNC_SPD_CUST;
@@ -611,16 +658,19 @@ void RS485_Initialize(
             exit(EXIT_FAILURE);
         }
         /* if all goes well, set new divisor */
-        ioctl(RS485_Handle, TIOCSSERIAL, &newserial);
+        ioctl(RS485_Port_Handle, TIOCSSERIAL, &newserial);
     }
     printf(" at Baud Rate %u", RS485_Get_Baud_Rate());
-    /* destructor */
+#if !BACNET_CONTEXT_ENABLED
+    /* destructor - with contexts, dlmstp_cleanup() restores the port of
+       its context, as exit handlers do not run in the datalink context */
     atexit(RS485_Cleanup);
+#endif
     /* flush any data waiting */
     usleep(200000);
-    tcflush(RS485_Handle, TCIOFLUSH);
+    tcflush(RS485_Port_Handle, TCIOFLUSH);
     /* ringbuffer */
-    FIFO_Init(&Rx_FIFO, Rx_Buffer, sizeof(Rx_Buffer));
+    FIFO_Init(&RS485_Rx_FIFO, Rx_Buffer, sizeof(Rx_Buffer));
     printf("=success!\n");
 }
 
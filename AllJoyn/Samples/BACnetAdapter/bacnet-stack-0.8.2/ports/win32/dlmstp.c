@@ -41,11 +41,75 @@
 #include "bits.h"
 #include "ringbuf.h"
 #include "timer.h"
+#include "bacctx.h"
 
 #define WIN32_LEAN_AND_MEAN
 #define STRICT 1
 #include <windows.h>
 
+#if BACNET_CONTEXT_ENABLED
+/* the port belongs to the stack context bound to the calling thread,
+   so each datalink context runs its own MS/TP port */
+struct dlmstp_data {
+    uint16_t MSTP_Packets;
+    DLMSTP_PACKET Receive_Packet;
+    HANDLE Receive_Packet_Flag;
+    HANDLE Received_Frame_Flag;
+    DLMSTP_PACKET Transmit_Packet;
+    volatile struct mstp_port_struct_t MSTP_Port;
+    uint8_t TxBuffer[MAX_MPDU];
+    uint8_t RxBuffer[MAX_MPDU];
+    uint16_t Treply_timeout;
+    uint8_t Tusage_timeout;
+    DWORD Silence_Start;
+};
+
+/* the port is set up the first time the context uses it, which may be
+   before dlmstp_init(), and it is kept for as long as the process runs */
+static struct dlmstp_data *dlmstp_data(
+    void)
+{
+    BACNET_STACK_CONTEXT *context = bacctx_get();
+
+    if (!context->dlmstp) {
+        context->dlmstp = calloc(1, sizeof(struct dlmstp_data));
+        if (!context->dlmstp) {
+            fprintf(stderr, "MS/TP: cannot allocate the port data.\n");
+            exit(1);
+        }
+        context->dlmstp->Treply_timeout = 260;
+        context->dlmstp->Tusage_timeout = 50;
+    }
+
+    return context->dlmstp;
+}
+
+#define MSTP_Packets (dlmstp_data()->MSTP_Packets)
+#define Receive_Packet (dlmstp_data()->Receive_Packet)
+#define Receive_Packet_Flag (dlmstp_data()->Receive_Packet_Flag)
+#define Received_Frame_Flag (dlmstp_data()->Received_Frame_Flag)
+#define Transmit_Packet (dlmstp_data()->Transmit_Packet)
+#define MSTP_Port (dlmstp_data()->MSTP_Port)
+#define TxBuffer (dlmstp_data()->TxBuffer)
+#define RxBuffer (dlmstp_data()->RxBuffer)
+#define Treply_timeout (dlmstp_data()->Treply_timeout)
+#define Tusage_timeout (dlmstp_data()->Tusage_timeout)
+#define Silence_Start (dlmstp_data()->Silence_Start)
+
+/* the silence timer of timer.c is shared by the process, each port
+   keeps its own */
+static uint32_t Timer_Silence(
+    void *pArg)
+{
+    return timeGetTime() - Silence_Start;
+}
+
+static void Timer_Silence_Reset(
+    void *pArg)
+{
+    Silence_Start = timeGetTime();
+}
+#else
 /* Number of MS/TP Packets Rx/Tx */
 uint16_t MSTP_Packets = 0;
 
@@ -83,6 +147,7 @@ static void Timer_Silence_Reset(
 {
     timer_reset(TIMER_SILENCE);
 }
+#endif
 
 void dlmstp_cleanup(
     void)
@@ -94,6 +159,11 @@ void dlmstp_cleanup(
     if (Receive_Packet_Flag) {
         CloseHandle(Receive_Packet_Flag);
     }
+#if BACNET_CONTEXT_ENABLED
+    /* the exit handler of RS485_Initialize() would restore some other
+       context's serial port */
+    RS485_Cleanup();
+#endif
 }
 
 /* returns number of bytes sent on success, zero on failure */
@@ -165,7 +235,12 @@ static void dlmstp_receive_fsm_task(
 {
     bool received_frame;
 
+#if BACNET_CONTEXT_ENABLED
+    /* run the port of the datalink context that started this thread */
+    bacctx_set((BACNET_STACK_CONTEXT *) pArg);
+#else
     (void) pArg;
+#endif
     (void) SetThreadPriority(GetCurrentThread(),
         THREAD_PRIORITY_TIME_CRITICAL);
     for (;;) {
@@ -191,7 +266,11 @@ static void dlmstp_master_fsm_task(
 {
     DWORD dwMilliseconds = 0;
 
+#if BACNET_CONTEXT_ENABLED
+    bacctx_set((BACNET_STACK_CONTEXT *) pArg);
+#else
     (void) pArg;
+#endif
     (void) SetThreadPriority(GetCurrentThread(),
         THREAD_PRIORITY_TIME_CRITICAL);
     for (;;) {
@@ -583,14 +662,23 @@ bool dlmstp_init(
 {
     unsigned long hThread = 0;
     uint32_t arg_value = 0;
-
+    void *fsm_arg = &arg_value;
+
+#if BACNET_CONTEXT_ENABLED
+    fsm_arg = bacctx_get();
+    /* named semaphores would be shared by the ports of all the contexts */
+    Receive_Packet_Flag = CreateSemaphore(NULL, 0, 1, NULL);
+    Received_Frame_Flag = CreateSemaphore(NULL, 0, 1, NULL);
+    Silence_Start = timeGetTime();
+#else
+    Receive_Packet_Flag = CreateSemaphore(NULL, 0, 1, "dlmstpReceivePacket");
+    Received_Frame_Flag = CreateSemaphore(NULL, 0, 1, "dlsmtpReceiveFrame");
+#endif
     /* initialize packet queue */
     Receive_Packet.ready = false;
     Receive_Packet.pdu_len = 0;
-    Receive_Packet_Flag = CreateSemaphore(NULL, 0, 1, "dlmstpReceivePacket");
     if (Receive_Packet_Flag == NULL)
         exit(1);
-    Received_Frame_Flag = CreateSemaphore(NULL, 0, 1, "dlsmtpReceiveFrame");
     if (Received_Frame_Flag == NULL) {
         CloseHandle(Receive_Packet_Flag);
         exit(1);
@@ -643,11 +731,11 @@ bool dlmstp_init(
     fprintf(stderr, "MS/TP Max_Info_Frames: %u\n",
         (unsigned) MSTP_Port.Nmax_info_frames);
 #endif
-    hThread = _beginthread(dlmstp_receive_fsm_task, 4096, &arg_value);
+    hThread = _beginthread(dlmstp_receive_fsm_task, 4096, fsm_arg);
     if (hThread == 0) {
         fprintf(stderr, "Failed to start recive FSM task\n");
     }
-    hThread = _beginthread(dlmstp_master_fsm_task, 4096, &arg_value);
+    hThread = _beginthread(dlmstp_master_fsm_task, 4096, fsm_arg);
     if (hThread == 0) {
         fprintf(stderr, "Failed to start Master Node FSM task\n");
     }
@@ -55,9 +55,60 @@
 #include <windows.h>
 #include "rs485.h"
 #include "fifo.h"
+#include "bacctx.h"
 
 /* details from Serial Communications in Win32 at MSDN */
 
+#if BACNET_CONTEXT_ENABLED
+/* the serial port belongs to the stack context bound to the calling
+   thread, next to the MS/TP port that uses it */
+struct rs485_data {
+    HANDLE RS485_Handle;
+    COMMTIMEOUTS RS485_Timeouts;
+    char RS485_Port_Name[256];
+    DWORD RS485_Baud;
+    DWORD RS485_ByteSize;
+    DWORD RS485_Parity;
+    DWORD RS485_StopBits;
+    DWORD RS485_DTRControl;
+    DWORD RS485_RTSControl;
+};
+
+/* set up on first use with the defaults of the single port build */
+static struct rs485_data *rs485_data(
+    void)
+{
+    BACNET_STACK_CONTEXT *context = bacctx_get();
+
+    if (!context->rs485) {
+        context->rs485 = calloc(1, sizeof(struct rs485_data));
+        if (!context->rs485) {
+            fprintf(stderr, "RS485: cannot allocate the port data.\n");
+            exit(1);
+        }
+        context->rs485->RS485_Handle = INVALID_HANDLE_VALUE;
+        strcpy(context->rs485->RS485_Port_Name, "COM4");
+        context->rs485->RS485_Baud = CBR_38400;
+        context->rs485->RS485_ByteSize = 8;
+        context->rs485->RS485_Parity = NOPARITY;
+        context->rs485->RS485_StopBits = ONESTOPBIT;
+        context->rs485->RS485_DTRControl = DTR_CONTROL_DISABLE;
+        context->rs485->RS485_RTSControl = RTS_CONTROL_DISABLE;
+    }
+
+    return context->rs485;
+}
+
+#define RS485_Handle (rs485_data()->RS485_Handle)
+#define RS485_Timeouts (rs485_data()->RS485_Timeouts)
+#define RS485_Port_Name (rs485_data()->RS485_Port_Name)
+#define RS485_Baud (rs485_data()->RS485_Baud)
+#define RS485_ByteSize (rs485_data()->RS485_ByteSize)
+#define RS485_Parity (rs485_data()->RS485_Parity)
+#define RS485_StopBits (rs485_data()->RS485_StopBits)
+#define RS485_DTRControl (rs485_data()->RS485_DTRControl)
+#define RS485_RTSControl (rs485_data()->RS485_RTSControl)
+#else
 /* Win32 handle for the port */
 HANDLE RS485_Handle;
 /* Original COM Timeouts */
@@ -84,6 +135,7 @@ static DWORD RS485_DTRControl = DTR_CONTROL_DISABLE;
     RTS_CONTROL_ENABLE, RTS_CONTROL_DISABLE,
     RTS_CONTROL_HANDSHAKE, RTS_CONTROL_TOGGLE */
 static DWORD RS485_RTSControl = RTS_CONTROL_DISABLE;
+#endif
 
 /****************************************************************************
 * DESCRIPTION: Change the characters in a string to uppercase
@@ -247,7 +299,7 @@ static void RS485_Configure_Status(
 * ALGORITHM:   none
 * NOTES:       none
 *****************************************************************************/
-static void RS485_Cleanup(
+void RS485_Cleanup(
     void)
 {
     if (!EscapeCommFunction(RS485_Handle, CLRDTR)) {
@@ -289,7 +341,11 @@ void RS485_Initialize(
     fprintf(stderr, "RS485 Interface: %s\n", RS485_Port_Name);
 #endif
 
+#if !BACNET_CONTEXT_ENABLED
+    /* with contexts, dlmstp_cleanup() closes the port of its context,
+       as exit handlers do not run in the datalink context */
     atexit(RS485_Cleanup);
+#endif
 
     return;
 }
@@ -51,6 +51,8 @@ extern "C" {
 
     void RS485_Initialize(
         void);
+    void RS485_Cleanup(
+        void);
 
     void RS485_Send_Frame(
         volatile struct mstp_port_struct_t *mstp_port,  /* port specific data */
@@ -36,12 +36,14 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "config.h"
 #include "bacaddr.h"
 #include "address.h"
 #include "bacdef.h"
 #include "bacdcode.h"
 #include "readrange.h"
+#include "bacctx.h"
 
 /** @file address.c  Handle address binding */
 
@@ -49,13 +51,18 @@
 /* occurs in BACnet.  A device id is bound to a MAC address. */
 /* The normal method is using Who-Is, and using the data from I-Am */
 
-static struct Address_Cache_Entry {
-    uint8_t Flags;
-    uint32_t device_id;
-    unsigned max_apdu;
-    BACNET_ADDRESS address;
-    uint32_t TimeToLive;
-} Address_Cache[MAX_ADDRESS_CACHE];
+#if BACNET_CONTEXT_ENABLED
+/* the cache belongs to the stack context bound to the calling thread */
+#define Address_Cache (bacctx_get()->address)
+#else
+static ADDRESS_CACHE Address_Cache;
+#endif
+
+/* number of entries allocated when the cache is first used,
+   it doubles from there on up to MAX_ADDRESS_CACHE */
+#ifndef ADDRESS_CACHE_INITIAL_SIZE
+#define ADDRESS_CACHE_INITIAL_SIZE 32
+#endif
 
 /* State flags for cache entries */
 
@@ -108,87 +115,294 @@ bool address_match(
     return true;
 }
 
-void address_remove_device(
+/****************************************************************************
+ * The entries are kept in an array that only grows, so that an entry keeps *
+ * its position (and its place in the device address binding list) for as  *
+ * long as it is in use.  New entries take the lowest free position, as     *
+ * they always have.  The entries in use are found by device instance      *
+ * through an open addressed hash index, and every entry holding a position *
+ * is on a list in least recently used order for eviction and expiry.       *
+ ****************************************************************************/
+
+static unsigned address_hash(
+    ADDRESS_CACHE * cache,
     uint32_t device_id)
 {
-    struct Address_Cache_Entry *pMatch;
+    /* multiplicative hash, the top bits are the well mixed ones */
+    return (unsigned) (((uint32_t) (device_id * 2654435761UL)) >> (32 -
+            cache->Index_Bits));
+}
+
+static struct Address_Cache_Entry *address_find(
+    ADDRESS_CACHE * cache,
+    uint32_t device_id)
+{
+    unsigned mask;
+    unsigned slot;
+    unsigned number;
+
+    if (cache->Index == NULL)
+        return NULL;
+    mask = (1U << cache->Index_Bits) - 1;
+    slot = address_hash(cache, device_id);
+    while ((number = cache->Index[slot]) != 0) {
+        if (cache->Entries[number - 1].device_id == device_id)
+            return &cache->Entries[number - 1];
+        slot = (slot + 1) & mask;
+    }
 
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            pMatch->Flags = 0;
+    return NULL;
+}
+
+static void address_index_insert(
+    ADDRESS_CACHE * cache,
+    unsigned number)
+{
+    unsigned mask = (1U << cache->Index_Bits) - 1;
+    unsigned slot;
+
+    slot = address_hash(cache, cache->Entries[number - 1].device_id);
+    while (cache->Index[slot] != 0)
+        slot = (slot + 1) & mask;
+    cache->Index[slot] = number;
+}
+
+static void address_index_remove(
+    ADDRESS_CACHE * cache,
+    unsigned number)
+{
+    unsigned mask = (1U << cache->Index_Bits) - 1;
+    unsigned hole;
+    unsigned slot;
+    unsigned home;
+
+    hole = address_hash(cache, cache->Entries[number - 1].device_id);
+    while (cache->Index[hole] != number)
+        hole = (hole + 1) & mask;
+    /* move back any later entry of the run that may not probe past the
+       hole, so that lookups never need tombstones */
+    slot = hole;
+    for (;;) {
+        slot = (slot + 1) & mask;
+        if (cache->Index[slot] == 0)
             break;
-        }
-        pMatch++;
+        home =
+            address_hash(cache,
+            cache->Entries[cache->Index[slot] - 1].device_id);
+        if ((hole <= slot) ? ((hole < home) && (home <= slot))
+            : ((hole < home) || (home <= slot)))
+            continue;
+        cache->Index[hole] = cache->Index[slot];
+        hole = slot;
     }
+    cache->Index[hole] = 0;
+}
+
+static void address_lru_unlink(
+    ADDRESS_CACHE * cache,
+    unsigned number)
+{
+    struct Address_Cache_Entry *pEntry = &cache->Entries[number - 1];
+
+    if (pEntry->lru_newer)
+        cache->Entries[pEntry->lru_newer - 1].lru_older = pEntry->lru_older;
+    else
+        cache->LRU_Newest = pEntry->lru_older;
+    if (pEntry->lru_older)
+        cache->Entries[pEntry->lru_older - 1].lru_newer = pEntry->lru_newer;
+    else
+        cache->LRU_Oldest = pEntry->lru_newer;
+    pEntry->lru_newer = 0;
+    pEntry->lru_older = 0;
+}
+
+static void address_lru_push(
+    ADDRESS_CACHE * cache,
+    unsigned number)
+{
+    struct Address_Cache_Entry *pEntry = &cache->Entries[number - 1];
+
+    pEntry->lru_newer = 0;
+    pEntry->lru_older = cache->LRU_Newest;
+    if (cache->LRU_Newest)
+        cache->Entries[cache->LRU_Newest - 1].lru_newer = number;
+    else
+        cache->LRU_Oldest = number;
+    cache->LRU_Newest = number;
+}
+
+/* mark an entry as the most recently used one */
+static void address_touch(
+    ADDRESS_CACHE * cache,
+    struct Address_Cache_Entry *pEntry)
+{
+    unsigned number = (unsigned) (pEntry - cache->Entries) + 1;
+
+    if (cache->LRU_Newest != number) {
+        address_lru_unlink(cache, number);
+        address_lru_push(cache, number);
+    }
+}
+
+/* give up the position held by an entry */
+static void address_release(
+    ADDRESS_CACHE * cache,
+    struct Address_Cache_Entry *pEntry)
+{
+    unsigned number = (unsigned) (pEntry - cache->Entries) + 1;
+
+    if (pEntry->Flags == 0)
+        return;
+    if ((pEntry->Flags & BAC_ADDR_IN_USE) != 0)
+        address_index_remove(cache, number);
+    address_lru_unlink(cache, number);
+    pEntry->Flags = 0;
+    if (number - 1 < cache->Free_Hint)
+        cache->Free_Hint = number - 1;
+}
+
+static bool address_grow(
+    ADDRESS_CACHE * cache)
+{
+    struct Address_Cache_Entry *pEntries;
+    unsigned *pIndex;
+    unsigned size;
+    unsigned bits;
+    unsigned i;
+
+    size = cache->Size ? (cache->Size * 2) : ADDRESS_CACHE_INITIAL_SIZE;
+    if (size > MAX_ADDRESS_CACHE)
+        size = MAX_ADDRESS_CACHE;
+    if (size <= cache->Size)
+        return false;
+    /* keep the index at most half full */
+    bits = 1;
+    while ((1UL << bits) < (2UL * size))
+        bits++;
+    pIndex = (unsigned *) calloc((size_t) 1 << bits, sizeof(unsigned));
+    if (pIndex == NULL)
+        return false;
+    pEntries =
+        (struct Address_Cache_Entry *) realloc(cache->Entries,
+        size * sizeof(struct Address_Cache_Entry));
+    if (pEntries == NULL) {
+        free(pIndex);
+        return false;
+    }
+    memset(&pEntries[cache->Size], 0,
+        (size - cache->Size) * sizeof(struct Address_Cache_Entry));
+    free(cache->Index);
+    cache->Entries = pEntries;
+    cache->Index = pIndex;
+    cache->Index_Bits = bits;
+    for (i = 0; i < cache->Size; i++) {
+        if ((pEntries[i].Flags & BAC_ADDR_IN_USE) != 0)
+            address_index_insert(cache, i + 1);
+    }
+    cache->Size = size;
+
+    return true;
+}
+
+void address_remove_device(
+    uint32_t device_id)
+{
+    ADDRESS_CACHE *cache = &Address_Cache;
+    struct Address_Cache_Entry *pMatch;
+
+    pMatch = address_find(cache, device_id);
+    if (pMatch != NULL)
+        address_release(cache, pMatch);
 
     return;
 }
 
 /*****************************************************************************
- * Search the cache for the entry nearest expiry and delete it. Mark the     *
- * entry as reserved with a 1 hour TTL and return a pointer to the reserved  *
- * entry. Will not delete a static entry and returns NULL pointer if no      *
- * entry available to free up. Does not check for free entries as it is      *
- * assumed we are calling this due to the lack of those.                     *
+ * Free up the least recently used entry, preferring bound entries over      *
+ * those with a bind request outstanding, and return it. Will not delete a   *
+ * static entry and returns NULL pointer if no entry available to free up.   *
+ * Does not check for free entries as it is assumed we are calling this due  *
+ * to the lack of those.                                                     *
  *****************************************************************************/
 
-
 static struct Address_Cache_Entry *address_remove_oldest(
-    void)
+    ADDRESS_CACHE * cache)
 {
     struct Address_Cache_Entry *pMatch;
-    struct Address_Cache_Entry *pCandidate;
-    uint32_t ulTime;
-
-    pCandidate = NULL;
-    ulTime = BAC_ADDR_FOREVER - 1;      /* Longest possible non static time to live */
+    struct Address_Cache_Entry *pCandidate = NULL;
+    unsigned number;
 
     /* First pass - try only in use and bound entries */
-
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
+    number = cache->LRU_Oldest;
+    while (number) {
+        pMatch = &cache->Entries[number - 1];
         if ((pMatch->
                 Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ |
                     BAC_ADDR_STATIC)) == BAC_ADDR_IN_USE) {
-            if (pMatch->TimeToLive <= ulTime) { /* Shorter lived entry found */
-                ulTime = pMatch->TimeToLive;
-                pCandidate = pMatch;
-            }
+            pCandidate = pMatch;
+            break;
         }
-        pMatch++;
-    }
-
-    if (pCandidate != NULL) {   /* Found something to free up */
-        pCandidate->Flags = BAC_ADDR_RESERVED;
-        pCandidate->TimeToLive = BAC_ADDR_SHORT_TIME;   /* only reserve it for a short while */
-        return (pCandidate);
+        number = pMatch->lru_newer;
     }
 
     /* Second pass - try in use and un bound as last resort */
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
+    number = cache->LRU_Oldest;
+    while ((pCandidate == NULL) && number) {
+        pMatch = &cache->Entries[number - 1];
         if ((pMatch->
                 Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ |
                     BAC_ADDR_STATIC)) ==
             ((uint8_t) (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ))) {
-            if (pMatch->TimeToLive <= ulTime) { /* Shorter lived entry found */
-                ulTime = pMatch->TimeToLive;
-                pCandidate = pMatch;
-            }
+            pCandidate = pMatch;
         }
-        pMatch++;
+        number = pMatch->lru_newer;
     }
 
-    if (pCandidate != NULL) {   /* Found something to free up */
-        pCandidate->Flags = BAC_ADDR_RESERVED;
-        pCandidate->TimeToLive = BAC_ADDR_SHORT_TIME;   /* only reserve it for a short while */
-    }
+    if (pCandidate != NULL)
+        address_release(cache, pCandidate);
 
     return (pCandidate);
 }
 
+/* take the lowest free position, growing the cache or evicting an entry
+   when there is none, and enter it for the device */
+static struct Address_Cache_Entry *address_claim(
+    ADDRESS_CACHE * cache,
+    uint32_t device_id,
+    uint8_t flags)
+{
+    struct Address_Cache_Entry *pMatch = NULL;
+    unsigned i;
+
+    for (i = cache->Free_Hint; i < cache->Size; i++) {
+        if (cache->Entries[i].Flags == 0) {
+            pMatch = &cache->Entries[i];
+            break;
+        }
+    }
+    if ((pMatch == NULL) && address_grow(cache)) {
+        i = cache->Free_Hint;
+        while (cache->Entries[i].Flags != 0)
+            i++;
+        pMatch = &cache->Entries[i];
+    }
+    if (pMatch != NULL) {
+        cache->Free_Hint = (unsigned) (pMatch - cache->Entries) + 1;
+    } else {
+        pMatch = address_remove_oldest(cache);
+        /* the entry given up was the only free one */
+        cache->Free_Hint = cache->Size;
+    }
+    if (pMatch != NULL) {
+        i = (unsigned) (pMatch - cache->Entries);
+        pMatch->Flags = flags;
+        pMatch->device_id = device_id;
+        address_index_insert(cache, i + 1);
+        address_lru_push(cache, i + 1);
+    }
+
+    return pMatch;
+}
 /** Initialize a BACNET_MAC_ADDRESS
  *
  * @param mac [out] BACNET_MAC_ADDRESS structure
@@ -339,13 +553,17 @@ static void address_file_init(
 void address_init(
     void)
 {
-    struct Address_Cache_Entry *pMatch;
+    ADDRESS_CACHE *cache = &Address_Cache;
 
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        pMatch->Flags = 0;
-        pMatch++;
+    if (cache->Size) {
+        memset(cache->Entries, 0,
+            cache->Size * sizeof(struct Address_Cache_Entry));
+        memset(cache->Index, 0,
+            ((size_t) 1 << cache->Index_Bits) * sizeof(unsigned));
     }
+    cache->Free_Hint = 0;
+    cache->LRU_Newest = 0;
+    cache->LRU_Oldest = 0;
     address_file_init(Address_Cache_Filename);
 
     return;
@@ -362,27 +580,42 @@ void address_init(
 void address_init_partial(
     void)
 {
+    ADDRESS_CACHE *cache = &Address_Cache;
     struct Address_Cache_Entry *pMatch;
+    unsigned i;
 
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
+    for (i = 0; i < cache->Size; i++) {
+        pMatch = &cache->Entries[i];
         if ((pMatch->Flags & BAC_ADDR_IN_USE) != 0) {   /* It's in use so let's check further */
             if (((pMatch->Flags & BAC_ADDR_BIND_REQ) != 0) ||
                 (pMatch->TimeToLive == 0))
-                pMatch->Flags = 0;
+                address_release(cache, pMatch);
         }
 
         if ((pMatch->Flags & BAC_ADDR_RESERVED) != 0) { /* Reserved entries should be cleared */
-            pMatch->Flags = 0;
+            address_release(cache, pMatch);
         }
-
-        pMatch++;
     }
     address_file_init(Address_Cache_Filename);
 
     return;
 }
 
+/****************************************************************************
+ * Release the memory held by the cache. It is allocated again as entries   *
+ * are added.                                                               *
+ ****************************************************************************/
+
+void address_cleanup(
+    void)
+{
+    ADDRESS_CACHE *cache = &Address_Cache;
+
+    free(cache->Entries);
+    free(cache->Index);
+    memset(cache, 0, sizeof(ADDRESS_CACHE));
+}
+
 
 /****************************************************************************
  * Set the TTL info for the given device entry. If it is a bound entry we   *
@@ -398,24 +631,19 @@ void address_set_device_TTL(
 {
     struct Address_Cache_Entry *pMatch;
 
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {     /* If bound then we have either static or normaal */
-                if (StaticFlag) {
-                    pMatch->Flags |= BAC_ADDR_STATIC;
-                    pMatch->TimeToLive = BAC_ADDR_FOREVER;
-                } else {
-                    pMatch->Flags &= ~BAC_ADDR_STATIC;
-                    pMatch->TimeToLive = TimeOut;
-                }
+    pMatch = address_find(&Address_Cache, device_id);
+    if (pMatch != NULL) {
+        if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) { /* If bound then we have either static or normaal */
+            if (StaticFlag) {
+                pMatch->Flags |= BAC_ADDR_STATIC;
+                pMatch->TimeToLive = BAC_ADDR_FOREVER;
             } else {
-                pMatch->TimeToLive = TimeOut;   /* For unbound we can only set the time to live */
+                pMatch->Flags &= ~BAC_ADDR_STATIC;
+                pMatch->TimeToLive = TimeOut;
             }
-            break;      /* Exit now if found at all - bound or unbound */
+        } else {
+            pMatch->TimeToLive = TimeOut;       /* For unbound we can only set the time to live */
         }
-        pMatch++;
     }
 }
 
@@ -425,21 +653,18 @@ bool address_get_by_device(
     unsigned *max_apdu,
     BACNET_ADDRESS * src)
 {
+    ADDRESS_CACHE *cache = &Address_Cache;
     struct Address_Cache_Entry *pMatch;
     bool found = false; /* return value */
 
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {     /* If bound then fetch data */
-                *src = pMatch->address;
-                *max_apdu = pMatch->max_apdu;
-                found = true;   /* Prove we found it */
-            }
-            break;      /* Exit now if found at all - bound or unbound */
+    pMatch = address_find(cache, device_id);
+    if (pMatch != NULL) {
+        if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) { /* If bound then fetch data */
+            *src = pMatch->address;
+            *max_apdu = pMatch->max_apdu;
+            found = true;       /* Prove we found it */
         }
-        pMatch++;
+        address_touch(cache, pMatch);
     }
 
     return found;
@@ -451,11 +676,13 @@ bool address_get_device_id(
     BACNET_ADDRESS * src,
     uint32_t * device_id)
 {
+    ADDRESS_CACHE *cache = &Address_Cache;
     struct Address_Cache_Entry *pMatch;
     bool found = false; /* return value */
+    unsigned i;
 
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
+    for (i = 0; i < cache->Size; i++) {
+        pMatch = &cache->Entries[i];
         if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) == BAC_ADDR_IN_USE) {       /* If bound */
             if (bacnet_address_same(&pMatch->address, src)) {
                 if (device_id) {
@@ -465,7 +692,6 @@ bool address_get_device_id(
                 break;
             }
         }
-        pMatch++;
     }
 
     return found;
@@ -476,7 +702,7 @@ void address_add(
     unsigned max_apdu,
     BACNET_ADDRESS * src)
 {
-    bool found = false; /* return value */
+    ADDRESS_CACHE *cache = &Address_Cache;
     struct Address_Cache_Entry *pMatch;
 
     /* Note: Previously this function would ignore bind request
@@ -486,58 +712,33 @@ void address_add(
        bind request if it exists */
 
     /* existing device or bind request outstanding - update address */
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            pMatch->address = *src;
-            pMatch->max_apdu = max_apdu;
-
-            /* Pick the right time to live */
-
-            if ((pMatch->Flags & BAC_ADDR_BIND_REQ) != 0)       /* Bind requested so long time */
-                pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
-            else if ((pMatch->Flags & BAC_ADDR_STATIC) != 0)    /* Static already so make sure it never expires */
-                pMatch->TimeToLive = BAC_ADDR_FOREVER;
-            else if ((pMatch->Flags & BAC_ADDR_SHORT_TTL) != 0) /* Opportunistic entry so leave on short fuse */
-                pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
-            else
-                pMatch->TimeToLive = BAC_ADDR_LONG_TIME;        /* Renewing existing entry */
+    pMatch = address_find(cache, device_id);
+    if (pMatch != NULL) {
+        pMatch->address = *src;
+        pMatch->max_apdu = max_apdu;
 
-            pMatch->Flags &= ~BAC_ADDR_BIND_REQ;        /* Clear bind request flag just in case */
-            found = true;
-            break;
-        }
-        pMatch++;
-    }
+        /* Pick the right time to live */
 
-    /* new device - add to cache if there is room */
-    if (!found) {
-        pMatch = Address_Cache;
-        while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-            if ((pMatch->Flags & BAC_ADDR_IN_USE) == 0) {
-                pMatch->Flags = BAC_ADDR_IN_USE;
-                pMatch->device_id = device_id;
-                pMatch->max_apdu = max_apdu;
-                pMatch->address = *src;
-                pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;       /* Opportunistic entry so leave on short fuse */
-                found = true;
-                break;
-            }
-            pMatch++;
-        }
+        if ((pMatch->Flags & BAC_ADDR_BIND_REQ) != 0)   /* Bind requested so long time */
+            pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
+        else if ((pMatch->Flags & BAC_ADDR_STATIC) != 0)        /* Static already so make sure it never expires */
+            pMatch->TimeToLive = BAC_ADDR_FOREVER;
+        else if ((pMatch->Flags & BAC_ADDR_SHORT_TTL) != 0)     /* Opportunistic entry so leave on short fuse */
+            pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
+        else
+            pMatch->TimeToLive = BAC_ADDR_LONG_TIME;    /* Renewing existing entry */
+
+        pMatch->Flags &= ~BAC_ADDR_BIND_REQ;    /* Clear bind request flag just in case */
+        address_touch(cache, pMatch);
+        return;
     }
 
-    /* See if we can squeeze it in */
-    if (!found) {
-        pMatch = address_remove_oldest();
-        if (pMatch != NULL) {
-            pMatch->Flags = BAC_ADDR_IN_USE;
-            pMatch->device_id = device_id;
-            pMatch->max_apdu = max_apdu;
-            pMatch->address = *src;
-            pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;   /* Opportunistic entry so leave on short fuse */
-        }
+    /* new device - add to cache, squeezing it in if there is no room */
+    pMatch = address_claim(cache, device_id, BAC_ADDR_IN_USE);
+    if (pMatch != NULL) {
+        pMatch->max_apdu = max_apdu;
+        pMatch->address = *src;
+        pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;       /* Opportunistic entry so leave on short fuse */
     }
     return;
 }
@@ -549,79 +750,60 @@ bool address_bind_request(
     unsigned *max_apdu,
     BACNET_ADDRESS * src)
 {
+    ADDRESS_CACHE *cache = &Address_Cache;
     bool found = false; /* return value */
     struct Address_Cache_Entry *pMatch;
 
     /* existing device - update address info if currently bound */
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {     /* Already bound */
-                found = true;
-                *src = pMatch->address;
-                *max_apdu = pMatch->max_apdu;
-                if ((pMatch->Flags & BAC_ADDR_SHORT_TTL) != 0) {        /* Was picked up opportunistacilly */
-                    pMatch->Flags &= ~BAC_ADDR_SHORT_TTL;       /* Convert to normal entry  */
-                    pMatch->TimeToLive = BAC_ADDR_LONG_TIME;    /* And give it a decent time to live */
-                }
+    pMatch = address_find(cache, device_id);
+    if (pMatch != NULL) {
+        if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) { /* Already bound */
+            found = true;
+            *src = pMatch->address;
+            *max_apdu = pMatch->max_apdu;
+            if ((pMatch->Flags & BAC_ADDR_SHORT_TTL) != 0) {    /* Was picked up opportunistacilly */
+                pMatch->Flags &= ~BAC_ADDR_SHORT_TTL;   /* Convert to normal entry  */
+                pMatch->TimeToLive = BAC_ADDR_LONG_TIME;        /* And give it a decent time to live */
             }
-            return (found);     /* True if bound, false if bind request outstanding */
-        }
-        pMatch++;
-    }
-
-    /* Not there already so look for a free entry to put it in */
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_RESERVED)) == 0) {
-            /* In use and awaiting binding */
-            pMatch->Flags = (uint8_t) (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ);
-            pMatch->device_id = device_id;
-            /* No point in leaving bind requests in for long haul */
-            pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
-            /* now would be a good time to do a Who-Is request */
-            return (false);
         }
-        pMatch++;
+        address_touch(cache, pMatch);
+        return (found); /* True if bound, false if bind request outstanding */
     }
 
-    /* No free entries, See if we can squeeze it in by dropping an existing one */
-    pMatch = address_remove_oldest();
+    /* Not there already so put it in a free entry or, if there are none,
+       squeeze it in by dropping an existing one */
+    pMatch =
+        address_claim(cache, device_id,
+        (uint8_t) (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ));
     if (pMatch != NULL) {
-        pMatch->Flags = (uint8_t) (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ);
-        pMatch->device_id = device_id;
         /* No point in leaving bind requests in for long haul */
         pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
+        /* now would be a good time to do a Who-Is request */
     }
     return (false);
 }
 
-
 void address_add_binding(
     uint32_t device_id,
     unsigned max_apdu,
     BACNET_ADDRESS * src)
 {
+    ADDRESS_CACHE *cache = &Address_Cache;
     struct Address_Cache_Entry *pMatch;
 
     /* existing device or bind request - update address */
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            pMatch->address = *src;
-            pMatch->max_apdu = max_apdu;
-            /* Clear bind request flag in case it was set */
-            pMatch->Flags &= ~BAC_ADDR_BIND_REQ;
-            /* Only update TTL if not static */
-            if ((pMatch->Flags & BAC_ADDR_STATIC) == 0) {
-                /* and set it on a long fuse */
-                pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
-            }
-            break;
+    pMatch = address_find(cache, device_id);
+    if (pMatch != NULL) {
+        pMatch->address = *src;
+        pMatch->max_apdu = max_apdu;
+        /* Clear bind request flag in case it was set */
+        pMatch->Flags &= ~BAC_ADDR_BIND_REQ;
+        /* Only update TTL if not static */
+        if ((pMatch->Flags & BAC_ADDR_STATIC) == 0) {
+            /* and set it on a long fuse */
+            pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
         }
-        pMatch++;
+        address_touch(cache, pMatch);
     }
     return;
 }
@@ -632,11 +814,12 @@ bool address_get_by_index(
     unsigned *max_apdu,
     BACNET_ADDRESS * src)
 {
+    ADDRESS_CACHE *cache = &Address_Cache;
     struct Address_Cache_Entry *pMatch;
     bool found = false; /* return value */
 
-    if (index < MAX_ADDRESS_CACHE) {
-        pMatch = &Address_Cache[index];
+    if (index < cache->Size) {
+        pMatch = &cache->Entries[index];
         if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) ==
             BAC_ADDR_IN_USE) {
             *src = pMatch->address;
@@ -652,17 +835,15 @@ bool address_get_by_index(
 unsigned address_count(
     void)
 {
-    struct Address_Cache_Entry *pMatch;
+    ADDRESS_CACHE *cache = &Address_Cache;
     unsigned count = 0; /* return value */
+    unsigned i;
 
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
+    for (i = 0; i < cache->Size; i++) {
         /* Only count bound entries */
-        if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) ==
-            BAC_ADDR_IN_USE)
+        if ((cache->Entries[i].Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ))
+            == BAC_ADDR_IN_USE)
             count++;
-
-        pMatch++;
     }
 
     return count;
@@ -677,17 +858,19 @@ int address_list_encode(
     uint8_t * apdu,
     unsigned apdu_len)
 {
+    ADDRESS_CACHE *cache = &Address_Cache;
     int iLen = 0;
     struct Address_Cache_Entry *pMatch;
     BACNET_OCTET_STRING MAC_Address;
+    unsigned i;
 
     /* FIXME: I really shouild check the length remaining here but it is
        fairly pointless until we have the true length remaining in
        the packet to work with as at the moment it is just MAX_APDU */
     apdu_len = apdu_len;
     /* look for matching address */
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
+    for (i = 0; i < cache->Size; i++) {
+        pMatch = &cache->Entries[i];
         if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) ==
             BAC_ADDR_IN_USE) {
             iLen +=
@@ -710,7 +893,6 @@ int address_list_encode(
                     encode_application_octet_string(&apdu[iLen], &MAC_Address);
             }
         }
-        pMatch++;
     }
 
     return (iLen);
@@ -745,9 +927,11 @@ int rr_address_list_encode(
     uint8_t * apdu,
     BACNET_READ_RANGE_DATA * pRequest)
 {
+    ADDRESS_CACHE *cache = &Address_Cache;
     int iLen = 0;
     int32_t iTemp = 0;
     struct Address_Cache_Entry *pMatch = NULL;
+    unsigned uiEntry = 0;       /* Position in the cache */
     BACNET_OCTET_STRING MAC_Address;
     uint32_t uiTotal = 0;       /* Number of bound entries in the cache */
     uint32_t uiIndex = 0;       /* Current entry number */
@@ -813,19 +997,19 @@ int rr_address_list_encode(
     if (uiTarget > uiTotal)     /* Capped at end of list if necessary */
         uiTarget = uiTotal;
 
-    pMatch = Address_Cache;
-    uiIndex = 1;
-    while ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) != BAC_ADDR_IN_USE)  /* Find first bound entry */
-        pMatch++;
-
-    /* Seek to start position */
-    while (uiIndex != pRequest->Range.RefIndex) {
-        if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) == BAC_ADDR_IN_USE) {       /* Only count bound entries */
-            pMatch++;
+    /* Seek to start position, only counting bound entries */
+    uiIndex = 0;
+    for (uiEntry = 0; uiEntry < cache->Size; uiEntry++) {
+        pMatch = &cache->Entries[uiEntry];
+        if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) ==
+            BAC_ADDR_IN_USE) {
             uiIndex++;
-        } else
-            pMatch++;
+            if (uiIndex == pRequest->Range.RefIndex)
+                break;
+        }
     }
+    if (uiEntry == cache->Size) /* Positions start at 1 */
+        return (0);
 
     uiFirst = uiIndex;  /* Record where we started from */
     while (uiIndex <= uiTarget) {
@@ -867,11 +1051,14 @@ int rr_address_list_encode(
 
         uiLast = uiIndex;       /* Record the last entry encoded */
         uiIndex++;      /* and get ready for next one */
-        pMatch++;
         pRequest->ItemCount++;  /* Chalk up another one for the response count */
 
-        while ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) != BAC_ADDR_IN_USE)      /* Find next bound entry */
-            pMatch++;
+        if (uiIndex > uiTarget)
+            break;
+        do {    /* Find next bound entry */
+            pMatch = &cache->Entries[++uiEntry];
+        } while ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) !=
+            BAC_ADDR_IN_USE);
     }
 
     /* Set remaining result flags if necessary */
@@ -895,19 +1082,21 @@ int rr_address_list_encode(
 void address_cache_timer(
     uint16_t uSeconds)
 {       /* Approximate number of seconds since last call to this function */
+    ADDRESS_CACHE *cache = &Address_Cache;
     struct Address_Cache_Entry *pMatch;
-
-    pMatch = Address_Cache;
-    while (pMatch <= &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
-        if (((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_RESERVED)) != 0)
-            && ((pMatch->Flags & BAC_ADDR_STATIC) == 0)) {      /* Check all entries holding a slot except statics */
+    unsigned number;
+
+    /* every entry holding a slot is on the least recently used list */
+    number = cache->LRU_Oldest;
+    while (number) {
+        pMatch = &cache->Entries[number - 1];
+        number = pMatch->lru_newer;     /* before the entry is released */
+        if ((pMatch->Flags & BAC_ADDR_STATIC) == 0) {   /* Check all entries holding a slot except statics */
             if (pMatch->TimeToLive >= uSeconds)
                 pMatch->TimeToLive -= uSeconds;
             else
-                pMatch->Flags = 0;
+                address_release(cache, pMatch);
         }
-
-        pMatch++;
     }
 }
 
@@ -915,7 +1104,6 @@ void address_cache_timer(
 
 #ifdef TEST
 #include <assert.h>
-#include <string.h>
 #include "ctest.h"
 
 static void set_address(
@@ -1066,6 +1254,49 @@ void testAddress(
     }
 }
 
+void testAddressLRU(
+    Test * pTest)
+{
+    unsigned i;
+    BACNET_ADDRESS src;
+    unsigned max_apdu = 480;
+    BACNET_ADDRESS test_address;
+    unsigned test_max_apdu = 0;
+
+    /* start from an empty cache, without the entries of the file */
+    address_cleanup();
+    for (i = 0; i < MAX_ADDRESS_CACHE; i++) {
+        set_address(i, &src);
+        address_add(i * 255, max_apdu, &src);
+    }
+    /* using the first entry makes the second one the least recently used */
+    ct_test(pTest, address_get_by_device(0, &test_max_apdu, &test_address));
+    set_address(MAX_ADDRESS_CACHE, &src);
+    address_add(MAX_ADDRESS_CACHE * 255, max_apdu, &src);
+    ct_test(pTest, address_count() == MAX_ADDRESS_CACHE);
+    ct_test(pTest, address_get_by_device(0, &test_max_apdu, &test_address));
+    ct_test(pTest, !address_get_by_device(255, &test_max_apdu,
+            &test_address));
+    ct_test(pTest, address_get_by_device(MAX_ADDRESS_CACHE * 255,
+            &test_max_apdu, &test_address));
+    ct_test(pTest, bacnet_address_same(&test_address, &src));
+    /* the new entry took the position given up */
+    ct_test(pTest, address_get_by_index(1, &i, &test_max_apdu,
+            &test_address));
+    ct_test(pTest, i == MAX_ADDRESS_CACHE * 255);
+
+    /* opportunistic entries expire after an hour, static ones never */
+    address_set_device_TTL(0, 0, true);
+    address_cache_timer(3599);
+    ct_test(pTest, address_count() == MAX_ADDRESS_CACHE);
+    address_cache_timer(2);
+    ct_test(pTest, address_count() == 1);
+    ct_test(pTest, address_get_by_device(0, &test_max_apdu, &test_address));
+    address_remove_device(0);
+    ct_test(pTest, address_count() == 0);
+    address_cleanup();
+}
+
 #ifdef TEST_ADDRESS
 int main(
     void)
@@ -1079,6 +1310,8 @@ int main(
     assert(rc);
     rc = ct_addTestFunction(pTest, testAddressFile);
     assert(rc);
+    rc = ct_addTestFunction(pTest, testAddressLRU);
+    assert(rc);
 
 
     ct_setStream(pTest, stdout);
@@ -1089,4 +1322,56 @@ int main(
     return 0;
 }
 #endif /* TEST_ADDRESS */
+
+#ifdef TEST_ADDRESS_BENCHMARK
+#include <time.h>
+
+/* times the cache at its MAX_ADDRESS_CACHE size, see addrbench.mak */
+static double benchmark_seconds(
+    clock_t start)
+{
+    return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(
+    void)
+{
+    unsigned i;
+    unsigned found = 0;
+    BACNET_ADDRESS src;
+    BACNET_ADDRESS test_address;
+    unsigned test_max_apdu = 0;
+    clock_t start;
+
+    start = clock();
+    for (i = 0; i < MAX_ADDRESS_CACHE; i++) {
+        set_address(i, &src);
+        address_add(i * 7919, 480, &src);
+    }
+    printf("%u devices added in %.3fs\n", address_count(),
+        benchmark_seconds(start));
+    start = clock();
+    for (i = 0; i < MAX_ADDRESS_CACHE; i++) {
+        if (address_get_by_device(i * 7919, &test_max_apdu, &test_address))
+            found++;
+    }
+    printf("%u devices found in %.3fs\n", found, benchmark_seconds(start));
+    start = clock();
+    for (i = 0; i < MAX_ADDRESS_CACHE; i++) {
+        set_address(i, &src);
+        address_add((MAX_ADDRESS_CACHE + i) * 7919, 480, &src);
+    }
+    printf("%u devices replaced in %.3fs\n", (unsigned) MAX_ADDRESS_CACHE,
+        benchmark_seconds(start));
+    start = clock();
+    for (i = 0; i < MAX_ADDRESS_CACHE; i++) {
+        address_remove_device((MAX_ADDRESS_CACHE + i) * 7919);
+    }
+    printf("%u devices removed in %.3fs\n", (unsigned) MAX_ADDRESS_CACHE,
+        benchmark_seconds(start));
+    address_cleanup();
+
+    return (address_count() == 0) ? 0 : 1;
+}
+#endif /* TEST_ADDRESS_BENCHMARK */
 #endif /* TEST */
@@ -42,6 +42,7 @@
 #include "tsm.h"
 #include "dcc.h"
 #include "iam.h"
+#include "bacctx.h"
 
 /** @file apdu.c  Handles APDU services */
 
@@ -52,10 +53,25 @@ extern int Routed_Device_Service_Approval(
     uint8_t invoke_id);
 
 
+#if BACNET_CONTEXT_ENABLED
+/* the timeouts and the handler tables belong to the stack context
+   bound to the calling thread */
+#define Timeout_Milliseconds (bacctx_get()->apdu.Timeout_Milliseconds)
+#define Number_Of_Retries (bacctx_get()->apdu.Number_Of_Retries)
+#define Confirmed_Function (bacctx_get()->apdu.Confirmed_Function)
+#define Unrecognized_Service_Handler \
+    (bacctx_get()->apdu.Unrecognized_Service_Handler)
+#define Unconfirmed_Function (bacctx_get()->apdu.Unconfirmed_Function)
+#define Confirmed_ACK_Function (bacctx_get()->apdu.Confirmed_ACK_Function)
+#define Error_Function (bacctx_get()->apdu.Error_Function)
+#define Abort_Function (bacctx_get()->apdu.Abort_Function)
+#define Reject_Function (bacctx_get()->apdu.Reject_Function)
+#else
 /* APDU Timeout in Milliseconds */
 static uint16_t Timeout_Milliseconds = 3000;
 /* Number of APDU Retries */
 static uint8_t Number_Of_Retries = 3;
+#endif
 
 /* a simple table for crossing the services supported */
 static BACNET_SERVICES_SUPPORTED
@@ -109,7 +125,9 @@ static BACNET_SERVICES_SUPPORTED
 
 /* Confirmed Function Handlers */
 /* If they are not set, they are handled by a reject message */
+#if !BACNET_CONTEXT_ENABLED
 static confirmed_function Confirmed_Function[MAX_BACNET_CONFIRMED_SERVICE];
+#endif
 
 void apdu_set_confirmed_handler(
     BACNET_CONFIRMED_SERVICE service_choice,
@@ -120,7 +138,9 @@ void apdu_set_confirmed_handler(
 }
 
 /* Allow the APDU handler to automatically reject */
+#if !BACNET_CONTEXT_ENABLED
 static confirmed_function Unrecognized_Service_Handler;
+#endif
 
 void apdu_set_unrecognized_service_handler_handler(
     confirmed_function pFunction)
@@ -130,8 +150,10 @@ void apdu_set_unrecognized_service_handler_handler(
 
 /* Unconfirmed Function Handlers */
 /* If they are not set, they are not handled */
+#if !BACNET_CONTEXT_ENABLED
 static unconfirmed_function
     Unconfirmed_Function[MAX_BACNET_UNCONFIRMED_SERVICE];
+#endif
 
 void apdu_set_unconfirmed_handler(
     BACNET_UNCONFIRMED_SERVICE service_choice,
@@ -228,8 +250,10 @@ bool apdu_service_supported_to_index(
 }
 
 /* Confirmed ACK Function Handlers */
+#if !BACNET_CONTEXT_ENABLED
 static confirmed_ack_function
     Confirmed_ACK_Function[MAX_BACNET_CONFIRMED_SERVICE];
+#endif
 
 void apdu_set_confirmed_simple_ack_handler(
     BACNET_CONFIRMED_SERVICE service_choice,
@@ -295,7 +319,9 @@ void apdu_set_confirmed_ack_handler(
     }
 }
 
+#if !BACNET_CONTEXT_ENABLED
 static error_function Error_Function[MAX_BACNET_CONFIRMED_SERVICE];
+#endif
 
 void apdu_set_error_handler(
     BACNET_CONFIRMED_SERVICE service_choice,
@@ -305,7 +331,9 @@ void apdu_set_error_handler(
         Error_Function[service_choice] = pFunction;
 }
 
+#if !BACNET_CONTEXT_ENABLED
 static abort_function Abort_Function;
+#endif
 
 void apdu_set_abort_handler(
     abort_function pFunction)
@@ -313,7 +341,9 @@ void apdu_set_abort_handler(
     Abort_Function = pFunction;
 }
 
+#if !BACNET_CONTEXT_ENABLED
 static reject_function Reject_Function;
+#endif
 
 void apdu_set_reject_handler(
     reject_function pFunction)
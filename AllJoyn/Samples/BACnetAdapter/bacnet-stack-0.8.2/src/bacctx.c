@@ -0,0 +1,219 @@
+/**************************************************************************
+*
+* Copyright (C) 2016 Microsoft Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+*********************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "config.h"
+#include "bacctx.h"
+
+/** @file bacctx.c  Stack state that can be bound per datalink */
+
+#if BACNET_CONTEXT_ENABLED
+
+/* define BACNET_THREAD_LOCAL in your project for other compilers */
+#if !defined(BACNET_THREAD_LOCAL)
+#if defined(_MSC_VER)
+#define BACNET_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define BACNET_THREAD_LOCAL __thread
+#else
+#define BACNET_THREAD_LOCAL
+#endif
+#endif
+
+/* the state of a freshly started stack, as set by bacctx_init() */
+static BACNET_STACK_CONTEXT Default_Context = {
+    .apdu = {
+        .Timeout_Milliseconds = 3000,
+        .Number_Of_Retries = 3},
+#if (MAX_TSM_TRANSACTIONS)
+    .tsm = {
+        .Current_Invoke_ID = 1},
+#endif
+    .dcc = {
+        .Enable_Disable = COMMUNICATION_ENABLE},
+#if (defined(BACDL_BIP) || defined(BACDL_ALL))
+    .bip = {
+        .Socket = -1},
+    .bvlc = {
+        .NAT_Handling = false,
+        .Result_Code = BVLC_RESULT_SUCCESSFUL_COMPLETION,
+        .Function_Code = BVLC_RESULT},
+#endif
+};
+
+static BACNET_THREAD_LOCAL BACNET_STACK_CONTEXT *Thread_Context;
+
+void bacctx_init(
+    BACNET_STACK_CONTEXT * context)
+{
+    if (!context)
+        return;
+    memset(context, 0, sizeof(BACNET_STACK_CONTEXT));
+    context->apdu.Timeout_Milliseconds = 3000;
+    context->apdu.Number_Of_Retries = 3;
+#if (MAX_TSM_TRANSACTIONS)
+    context->tsm.Current_Invoke_ID = 1;
+#endif
+    context->dcc.Enable_Disable = COMMUNICATION_ENABLE;
+#if (defined(BACDL_BIP) || defined(BACDL_ALL))
+    context->bip.Socket = -1;
+    context->bvlc.NAT_Handling = false;
+    context->bvlc.Result_Code = BVLC_RESULT_SUCCESSFUL_COMPLETION;
+    context->bvlc.Function_Code = BVLC_RESULT;
+#endif
+}
+
+BACNET_STACK_CONTEXT *bacctx_default(
+    void)
+{
+    return &Default_Context;
+}
+
+BACNET_STACK_CONTEXT *bacctx_set(
+    BACNET_STACK_CONTEXT * context)
+{
+    BACNET_STACK_CONTEXT *previous = Thread_Context;
+
+    Thread_Context = context;
+
+    return previous;
+}
+
+BACNET_STACK_CONTEXT *bacctx_get(
+    void)
+{
+    if (Thread_Context)
+        return Thread_Context;
+
+    return bacctx_default();
+}
+
+#ifdef TEST
+#include <assert.h>
+#include "apdu.h"
+#include "tsm.h"
+#include "dcc.h"
+#include "ctest.h"
+
+/* the contexts are too large for the stack of the test */
+static BACNET_STACK_CONTEXT Test_Context_A;
+static BACNET_STACK_CONTEXT Test_Context_B;
+
+void testContextDefault(
+    Test * pTest)
+{
+    ct_test(pTest, bacctx_get() == bacctx_default());
+    ct_test(pTest, apdu_timeout() == 3000);
+    ct_test(pTest, apdu_retries() == 3);
+    ct_test(pTest, bacctx_set(&Test_Context_A) == NULL);
+    ct_test(pTest, bacctx_get() == &Test_Context_A);
+    ct_test(pTest, bacctx_set(NULL) == &Test_Context_A);
+    ct_test(pTest, bacctx_get() == bacctx_default());
+}
+
+void testContextIsolation(
+    Test * pTest)
+{
+    uint8_t invoke_id = 0;
+
+    bacctx_init(&Test_Context_A);
+    bacctx_init(&Test_Context_B);
+
+    bacctx_set(&Test_Context_A);
+    apdu_timeout_set(100);
+    invoke_id = tsm_next_free_invokeID();
+    ct_test(pTest, invoke_id == 1);
+    ct_test(pTest, !tsm_invoke_id_free(invoke_id));
+
+    /* nothing done in A is seen from B */
+    bacctx_set(&Test_Context_B);
+    ct_test(pTest, apdu_timeout() == 3000);
+    ct_test(pTest, tsm_invoke_id_free(invoke_id));
+    ct_test(pTest, tsm_next_free_invokeID() == 1);
+    tsm_free_invoke_id(1);
+
+    /* or from the default context */
+    bacctx_set(NULL);
+    ct_test(pTest, apdu_timeout() == 3000);
+    ct_test(pTest, tsm_invoke_id_free(invoke_id));
+
+    bacctx_set(&Test_Context_A);
+    ct_test(pTest, apdu_timeout() == 100);
+    ct_test(pTest, tsm_next_free_invokeID() == 2);
+    bacctx_set(NULL);
+}
+
+void testContextDCC(
+    Test * pTest)
+{
+    bacctx_init(&Test_Context_A);
+    bacctx_init(&Test_Context_B);
+
+    bacctx_set(&Test_Context_A);
+    ct_test(pTest, dcc_communication_enabled());
+    ct_test(pTest, dcc_set_status_duration(COMMUNICATION_DISABLE, 5));
+    ct_test(pTest, dcc_communication_disabled());
+
+    /* disabling communication on one datalink leaves the others alone */
+    bacctx_set(&Test_Context_B);
+    ct_test(pTest, dcc_communication_enabled());
+    ct_test(pTest, dcc_duration_seconds() == 0);
+    bacctx_set(NULL);
+    ct_test(pTest, dcc_communication_enabled());
+
+    bacctx_set(&Test_Context_A);
+    ct_test(pTest, dcc_duration_seconds() == 300);
+    dcc_timer_seconds(300);
+    ct_test(pTest, dcc_communication_enabled());
+    bacctx_set(NULL);
+}
+
+#ifdef TEST_BACCTX
+int main(
+    void)
+{
+    Test *pTest;
+    bool rc;
+
+    pTest = ct_create("BACnet Stack Context", NULL);
+    /* individual tests */
+    rc = ct_addTestFunction(pTest, testContextDefault);
+    assert(rc);
+    rc = ct_addTestFunction(pTest, testContextIsolation);
+    assert(rc);
+    rc = ct_addTestFunction(pTest, testContextDCC);
+    assert(rc);
+
+    ct_setStream(pTest, stdout);
+    ct_run(pTest);
+    (void) ct_report(pTest);
+    ct_destroy(pTest);
+
+    return 0;
+}
+#endif /* TEST_BACCTX */
+#endif /* TEST */
+#endif /* BACNET_CONTEXT_ENABLED */
@@ -39,12 +39,21 @@
 #include "bip.h"
 #include "bvlc.h"
 #include "net.h"        /* custom per port */
+#include "bacctx.h"
 #if PRINT_ENABLED
 #include <stdio.h>      /* for standard i/o, like printing */
 #endif
 
 /** @file bip.c  Configuration and Operations for BACnet/IP */
 
+#if BACNET_CONTEXT_ENABLED
+/* the socket and addresses belong to the stack context bound to the
+   calling thread, so each datalink context has its own B/IP port */
+#define BIP_Socket (bacctx_get()->bip.Socket)
+#define BIP_Port (bacctx_get()->bip.Port)
+#define BIP_Address (bacctx_get()->bip.Address)
+#define BIP_Broadcast_Address (bacctx_get()->bip.Broadcast_Address)
+#else
 static int BIP_Socket = -1;
 /* port to use - stored in network byte order */
 static uint16_t BIP_Port = 0;   /* this will force initialization in demos */
@@ -52,6 +61,7 @@ static uint16_t BIP_Port = 0;   /* this will force initialization in demos */
 static struct in_addr BIP_Address;
 /* Broadcast Address - stored in network byte order */
 static struct in_addr BIP_Broadcast_Address;
+#endif
 
 /** Setter for the BACnet/IP socket handle.
  *
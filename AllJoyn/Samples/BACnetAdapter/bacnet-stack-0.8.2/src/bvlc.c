@@ -39,6 +39,7 @@
 #include "bacdcode.h"
 #include "bacint.h"
 #include "bvlc.h"
+#include "bacctx.h"
 #ifndef DEBUG_ENABLED
 #define DEBUG_ENABLED 0
 #endif
@@ -50,6 +51,16 @@
  * Foreign Device Registration.
  */
 
+#if BACNET_CONTEXT_ENABLED
+/* the BVLC state belongs to the stack context bound to the calling thread */
+#define Remote_BBMD (bacctx_get()->bvlc.Remote_BBMD)
+#define BVLC_Global_Address (bacctx_get()->bvlc.Global_Address)
+#define BVLC_NAT_Handling (bacctx_get()->bvlc.NAT_Handling)
+#define BVLC_Result_Code (bacctx_get()->bvlc.Result_Code)
+#define BVLC_Function_Code (bacctx_get()->bvlc.Function_Code)
+#define BBMD_Table (bacctx_get()->bvlc.BBMD_Table)
+#define FD_Table (bacctx_get()->bvlc.FD_Table)
+#else
 /** if we are a foreign device, store the
    remote BBMD address/port here in network byte order */
 static struct sockaddr_in Remote_BBMD;
@@ -65,6 +76,7 @@ BACNET_BVLC_RESULT BVLC_Result_Code = BVLC_RESULT_SUCCESSFUL_COMPLETION;
 
 /** The current BVLC Function Code being handled. */
 BACNET_BVLC_FUNCTION BVLC_Function_Code = BVLC_RESULT;  /* A safe default */
+#endif
 
 /* Define BBMD_ENABLED to get the functions that a
  * BBMD needs to handle its services.
@@ -74,36 +86,11 @@ BACNET_BVLC_FUNCTION BVLC_Function_Code = BVLC_RESULT;  /* A safe default */
 #if defined(BBMD_ENABLED) && BBMD_ENABLED
 
 
-#ifndef MAX_BBMD_ENTRIES
-#define MAX_BBMD_ENTRIES 128
-#endif
+#if !BACNET_CONTEXT_ENABLED
 static BBMD_TABLE_ENTRY BBMD_Table[MAX_BBMD_ENTRIES];
 
-/*Each device that registers as a foreign device shall be placed
-in an entry in the BBMD's Foreign Device Table (FDT). Each
-entry shall consist of the 6-octet B/IP address of the registrant;
-the 2-octet Time-to-Live value supplied at the time of
-registration; and a 2-octet value representing the number of
-seconds remaining before the BBMD will purge the registrant's FDT
-entry if no re-registration occurs. This value will be initialized
-to the 2-octet Time-to-Live value supplied at the time of
-registration.*/
-typedef struct {
-    bool valid;
-    /* BACnet/IP address */
-    struct in_addr dest_address;
-    /* BACnet/IP port number - not always 47808=BAC0h */
-    uint16_t dest_port;
-    /* seconds for valid entry lifetime */
-    uint16_t time_to_live;
-    /* our counter */
-    time_t seconds_remaining;   /* includes 30 second grace period */
-} FD_TABLE_ENTRY;
-
-#ifndef MAX_FD_ENTRIES
-#define MAX_FD_ENTRIES 128
-#endif
 static FD_TABLE_ENTRY FD_Table[MAX_FD_ENTRIES];
+#endif
 
 
 /** A timer function that is called about once a second.
@@ -36,6 +36,7 @@
 #include "bacdcode.h"
 #include "bacdef.h"
 #include "dcc.h"
+#include "bacctx.h"
 
 /** @file dcc.c  Enable/Disable Device Communication Control (DCC) */
 
@@ -44,9 +45,15 @@
 /* note: time duration is given in Minutes, but in order to be accurate,
    we need to count down in seconds. */
 /* infinite time duration is defined as 0 */
+#if BACNET_CONTEXT_ENABLED
+/* the DCC state belongs to the stack context bound to the calling thread */
+#define DCC_Time_Duration_Seconds (bacctx_get()->dcc.Time_Duration_Seconds)
+#define DCC_Enable_Disable (bacctx_get()->dcc.Enable_Disable)
+#else
 static uint32_t DCC_Time_Duration_Seconds = 0;
 static BACNET_COMMUNICATION_ENABLE_DISABLE DCC_Enable_Disable =
     COMMUNICATION_ENABLE;
+#endif
 /* password is optionally supported */
 
 BACNET_COMMUNICATION_ENABLE_DISABLE dcc_enable_status(
@@ -46,6 +46,7 @@
 #include "handlers.h"
 #include "address.h"
 #include "bacaddr.h"
+#include "bacctx.h"
 
 /** @file tsm.c  BACnet Transaction State Machine operations  */
 
@@ -57,6 +58,12 @@
 
 /* FIXME: not coded for segmentation */
 
+#if BACNET_CONTEXT_ENABLED
+/* the transactions belong to the stack context bound to the calling thread */
+#define TSM_List (bacctx_get()->tsm.List)
+#define Current_Invoke_ID (bacctx_get()->tsm.Current_Invoke_ID)
+#define Timeout_Function (bacctx_get()->tsm.Timeout_Function)
+#else
 /* declare space for the TSM transactions, and set it up in the init. */
 /* table rules: an Invoke ID = 0 is an unused spot in the table */
 static BACNET_TSM_DATA TSM_List[MAX_TSM_TRANSACTIONS];
@@ -65,6 +72,7 @@ static BACNET_TSM_DATA TSM_List[MAX_TSM_TRANSACTIONS];
 static uint8_t Current_Invoke_ID = 1;
 
 static tsm_timeout_function Timeout_Function;
+#endif
 
 void tsm_set_timeout_handler(
     tsm_timeout_function pFunction)
@@ -9,8 +9,8 @@
 
 LOGFILE = test.log
 
-all: abort address arf awf bacapp bacdcode bacerror bacint bacstr \
-	cov crc datetime dcc event filename fifo getevent iam ihave \
+all: abort address arf awf bacapp bacctx bacdcode bacerror bacint bacstr \
+	cov crc datetime dcc event filename fifo getevent h_cov iam ihave \
 	indtext keylist key memcopy npdu proplist ptransfer \
 	rd reject ringbuf rp rpm sbuf timesync \
 	whohas whois wp objects lighting
@@ -46,6 +46,11 @@ bacapp: logfile test/bacapp.mak
 	( ./test/bacapp >> ${LOGFILE} )
 	$(MAKE) -s -C test -f bacapp.mak clean
 
+bacctx: logfile test/bacctx.mak
+	$(MAKE) -s -C test -f bacctx.mak clean all
+	( ./test/bacctx >> ${LOGFILE} )
+	$(MAKE) -s -C test -f bacctx.mak clean
+
 bacdcode: logfile test/bacdcode.mak
 	$(MAKE) -s -C test -f bacdcode.mak clean all
 	( ./test/bacdcode >> ${LOGFILE} )
@@ -106,6 +111,11 @@ getevent: logfile test/getevent.mak
 	( ./test/getevent >> ${LOGFILE} )
 	$(MAKE) -s -C test -f getevent.mak clean
 
+h_cov: logfile test/h_cov.mak
+	$(MAKE) -s -C test -f h_cov.mak clean all
+	( ./test/h_cov >> ${LOGFILE} )
+	$(MAKE) -s -C test -f h_cov.mak clean
+
 iam: logfile test/iam.mak
 	$(MAKE) -s -C test -f iam.mak clean all
 	( ./test/iam >> ${LOGFILE} )
@@ -206,7 +216,8 @@ wp: logfile test/wp.mak
 	( ./test/wp >> ${LOGFILE} )
 	$(MAKE) -s -C test -f wp.mak clean
 
-objects: ai ao av bi bo bv csv lc lo lso lsp mso msv ms-input command
+objects: ai ao av bi bo bv csv lc lo lso lsp mso msv ms-input command \
+	trendlog trendlog-segments
 
 ai: logfile demo/object/ai.mak
 	$(MAKE) -s -C demo/object -f ai.mak clean all
@@ -286,3 +297,17 @@ msv: logfile demo/object/msv.mak
 	$(MAKE) -s -C demo/object -f msv.mak clean all
 	( ./demo/object/multistate_value >> ${LOGFILE} )
 	$(MAKE) -s -C demo/object -f msv.mak clean
+
+trendlog: logfile demo/object/trendlog.mak
+	$(MAKE) -s -C demo/object -f trendlog.mak clean all
+	( ./demo/object/trendlog >> ${LOGFILE} )
+	$(MAKE) -s -C demo/object -f trendlog.mak clean
+
+TL_SEGMENT_DEFINES = -DTL_SEGMENT_STORAGE=1 -DTL_MAX_ENTRIES=1024 \
+	-DTL_SEGMENT_ENTRIES=128
+
+trendlog-segments: logfile demo/object/trendlog.mak
+	$(MAKE) -s -C demo/object -f trendlog.mak \
+		TL_DEFINES="$(TL_SEGMENT_DEFINES)" clean all
+	( cd demo/object && ./trendlog >> ../../${LOGFILE} )
+	$(MAKE) -s -C demo/object -f trendlog.mak clean
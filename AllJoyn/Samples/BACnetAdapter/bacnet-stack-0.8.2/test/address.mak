@@ -12,11 +12,6 @@ SRCS = $(SRC_DIR)/address.c \
 	$(SRC_DIR)/bacint.c \
 	$(SRC_DIR)/bacstr.c \
 	$(SRC_DIR)/bacreal.c \
-	$(SRC_DIR)/bacapp.c \
-	$(SRC_DIR)/datetime.c \
-	$(SRC_DIR)/lighting.c \
-	$(SRC_DIR)/bactext.c \
-	$(SRC_DIR)/indtext.c \
 	ctest.c
 
 OBJS = ${SRCS:.c=.o}
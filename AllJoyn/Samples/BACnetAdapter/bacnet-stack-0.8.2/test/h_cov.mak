@@ -0,0 +1,50 @@
+#Makefile to build test case
+CC      = gcc
+SRC_DIR = ../src
+HANDLER_DIR = ../demo/handler
+INCLUDES = -I../include -I. -I../demo/object
+DEFINES = -DBIG_ENDIAN=0 -DTEST -DTEST_COV_HANDLER -DBACAPP_ALL -DBACDL_TEST
+
+CFLAGS  = -Wall $(INCLUDES) $(DEFINES) -g
+
+SRCS = $(HANDLER_DIR)/h_cov.c \
+	$(HANDLER_DIR)/txbuf.c \
+	$(SRC_DIR)/abort.c \
+	$(SRC_DIR)/bacaddr.c \
+	$(SRC_DIR)/bacapp.c \
+	$(SRC_DIR)/bacdevobjpropref.c \
+	$(SRC_DIR)/bacdcode.c \
+	$(SRC_DIR)/bacerror.c \
+	$(SRC_DIR)/bacint.c \
+	$(SRC_DIR)/bacreal.c \
+	$(SRC_DIR)/bacstr.c \
+	$(SRC_DIR)/bactext.c \
+	$(SRC_DIR)/cov.c \
+	$(SRC_DIR)/datetime.c \
+	$(SRC_DIR)/dcc.c \
+	$(SRC_DIR)/indtext.c \
+	$(SRC_DIR)/lighting.c \
+	$(SRC_DIR)/npdu.c \
+	$(SRC_DIR)/reject.c \
+	ctest.c
+
+OBJS = ${SRCS:.c=.o}
+
+TARGET = h_cov
+
+all: ${TARGET}
+ 
+${TARGET}: ${OBJS}
+	${CC} -o $@ ${OBJS} 
+
+.c.o:
+	${CC} -c ${CFLAGS} $*.c -o $@
+	
+depend:
+	rm -f .depend
+	${CC} -MM ${CFLAGS} *.c >> .depend
+	
+clean:
+	rm -rf core ${TARGET} $(OBJS) *.bak *.1 *.ini
+
+include: .depend
@@ -330,6 +330,9 @@ namespace AdapterLib
 
         try
         {
+            // Get and Set requests can come in concurrently
+            AutoLock sync(this->lock);
+
             *ValuePtr = ref new MockAdapterValue(dynamic_cast<MockAdapterValue^>(attribute->Value));
         }
         catch (OutOfMemoryException^)
@@ -366,6 +369,8 @@ namespace AdapterLib
             return ERROR_NOT_FOUND;
         }
 
+        AutoLock sync(this->lock);
+
         return dynamic_cast<MockAdapterValue^>(attribute->Value)->Set(Value);
     }
 
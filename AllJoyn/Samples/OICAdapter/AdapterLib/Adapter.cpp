@@ -66,18 +66,27 @@ namespace AdapterLib
     static const string PRESENCE_QUERY = string("coap://") + OC_MULTICAST_PREFIX + OC_RSRVD_PRESENCE_URI;
     static const string RT_PRESENCE = OC_RSRVD_RESOURCE_TYPE_PRESENCE;
 
-    static const int64 OCProcessTimeout = 100;            //in msec
+    static const uint32_t OCProcessTimeout = 100;         //max wait for stack events, in msec
     static const int64 DeviceDiscoveryTimeout = 60000;            //in msec
     static const int64 DeviceMonitorTimeout = 60000;            //in msec
     static const DWORD ResourceDiscoveryTimeout = 15000;     //in msecs
 
     static const int64 DevicePingTimeout = 300;            //in seconds
 
+    static const uint32 MaxConcurrentDiscoveries = 16;      //endpoints between device and resource discovery
+    static const int64 EndpointDiscoveryTimeout = 30;       //in seconds, frees the slot of an endpoint that stopped answering
+    static const int64 ResourceRefreshInterval = 600;       //in seconds, known devices get their resources discovered again
+
     static const GUID APPLICATION_GUID = { 0xc0d9e107,0x6ec8,0x4255,{0xb1,0xc1,0x05,0xae,0x3a,0x58,0xf8,0xad} };
 
 
     Adapter^ Adapter::adapterInstance = nullptr;
 
+    static string EndpointKey(const OCDevAddr& addr)
+    {
+        return string(addr.addr) + ":" + to_string(addr.port);
+    }
+
     Adapter::Adapter()
     {
         adapterInstance = this;
@@ -107,6 +116,8 @@ namespace AdapterLib
             m_version = L"0.0.0.0";
         }
 
+        m_discoveryMetrics = DISCOVERY_METRICS{ -1, -1, 0, 0 };
+
         CreateSignals();
     }
 
@@ -159,7 +170,14 @@ namespace AdapterLib
                     AutoLock sync(adapterInstance->m_ocStackLock);
                 OCProcess();
                 }
-                Sleep(OCProcessTimeout);
+
+                //Sleep until the connectivity layer has received data for OCProcess.
+                //The wait is bounded so presence timers and cancellation are still serviced,
+                //and must be done without m_ocStackLock as the stack callbacks take it.
+                if (OCWaitForEvent(OCProcessTimeout) == OC_STACK_NOTIMPL)
+                {
+                    Sleep(OCProcessTimeout);
+                }
             }
         })
         );
@@ -207,6 +225,30 @@ namespace AdapterLib
 
     OCStackResult Adapter::InitPlatformDiscovery()
     {
+        {
+            AutoLock sync(m_lock);
+
+            //free the slots of endpoints that stopped answering half way through the previous round
+            steady_clock::time_point tpNow = steady_clock::now();
+            auto iter = m_discoveryEndpoints.begin();
+            while (iter != m_discoveryEndpoints.end())
+            {
+                if (iter->second.bStarted && duration_cast<seconds>(tpNow - iter->second.startTime).count() >= EndpointDiscoveryTimeout)
+                {
+                    iter = m_discoveryEndpoints.erase(iter);
+                    --m_discoveriesInFlight;
+                }
+                else
+                {
+                    ++iter;
+                }
+            }
+
+            m_discoveryRoundStart = tpNow;
+            m_discoveryMetrics = DISCOVERY_METRICS{ -1, -1, 0, m_discoveriesInFlight };
+        }
+        StartQueuedDiscoveries();
+
         AutoLock sync(m_ocStackLock);
         OCCallbackData cbData{};
 
@@ -250,6 +292,100 @@ namespace AdapterLib
         return OCDoResource(NULL, OC_REST_DISCOVER, RESOURCE_DISCOVERY_QUERY.c_str(), pDevice->DevAddr, 0, CT_ADAPTER_IP, OC_LOW_QOS, &cbData, NULL, 0);
     }
 
+    //must be called with m_lock held
+    void Adapter::QueueDeviceDiscovery(PlatformInfo* pInfo)
+    {
+        string key = EndpointKey(pInfo->addr);
+        if (m_discoveryEndpoints.find(key) != m_discoveryEndpoints.end())
+        {
+            //already queued or in flight
+            return;
+        }
+
+        m_discoveryEndpoints[key] = DISCOVERY_ENTRY{ false, steady_clock::time_point() };
+        m_discoveryQueue.push_back(pInfo);
+    }
+
+    //must be called without m_lock held, as it issues stack requests
+    void Adapter::StartQueuedDiscoveries()
+    {
+        for (;;)
+        {
+            PlatformInfo* pInfo = nullptr;
+            {
+                AutoLock sync(m_lock);
+                if (m_discoveryQueue.empty() || m_discoveriesInFlight >= MaxConcurrentDiscoveries)
+                {
+                    break;
+                }
+
+                pInfo = m_discoveryQueue.front();
+                m_discoveryQueue.pop_front();
+
+                DISCOVERY_ENTRY& entry = m_discoveryEndpoints[EndpointKey(pInfo->addr)];
+                entry.bStarted = true;
+                entry.startTime = steady_clock::now();
+
+                if (++m_discoveriesInFlight > m_discoveryMetrics.PeakInFlight)
+                {
+                    m_discoveryMetrics.PeakInFlight = m_discoveriesInFlight;
+                }
+            }
+
+            if (InitDeviceDiscovery(pInfo) != OC_STACK_OK)
+            {
+                EndDeviceDiscovery(pInfo->addr, false);
+            }
+        }
+    }
+
+    void Adapter::EndDeviceDiscovery(const OCDevAddr& addr, bool bStartNext)
+    {
+        bool bRoundComplete = false;
+        {
+            AutoLock sync(m_lock);
+
+            auto iter = m_discoveryEndpoints.find(EndpointKey(addr));
+            if (iter != m_discoveryEndpoints.end() && iter->second.bStarted)
+            {
+                m_discoveryEndpoints.erase(iter);
+                --m_discoveriesInFlight;
+
+                if (m_discoveriesInFlight == 0 && m_discoveryQueue.empty())
+                {
+                    m_discoveryMetrics.TimeToAllDevices = duration_cast<milliseconds>(steady_clock::now() - m_discoveryRoundStart).count();
+                    bRoundComplete = true;
+                }
+            }
+        }
+
+        if (bRoundComplete)
+        {
+            LogDiscoveryMetrics();
+        }
+
+        if (bStartNext)
+        {
+            StartQueuedDiscoveries();
+        }
+    }
+
+    DISCOVERY_METRICS Adapter::GetDiscoveryMetrics()
+    {
+        AutoLock sync(m_lock);
+        return m_discoveryMetrics;
+    }
+
+    void Adapter::LogDiscoveryMetrics()
+    {
+        DISCOVERY_METRICS metrics = GetDiscoveryMetrics();
+        wchar_t message[160];
+
+        swprintf_s(message, L"OIC discovery: %u devices, first after %lld ms, all after %lld ms, %u in flight at most\n",
+            metrics.DevicesArrived, metrics.TimeToFirstDevice, metrics.TimeToAllDevices, metrics.PeakInFlight);
+        OutputDebugStringW(message);
+    }
+
     OCStackResult Adapter::InitGetRequest(ResourceContext* context, const std::string& query)
     {
         AutoLock sync(m_ocStackLock);
@@ -365,23 +501,25 @@ namespace AdapterLib
 
             if (payload && payload->base.type == PAYLOAD_TYPE_PLATFORM)
             {
-                AutoLock sync(adapterInstance->m_lock);
+                {
+                    AutoLock sync(adapterInstance->m_lock);
 
-                shared_ptr<PlatformInfo> pInfo{ new PlatformInfo{ payload->info, response->devAddr } };
+                    shared_ptr<PlatformInfo> pInfo{ new PlatformInfo{ payload->info, response->devAddr } };
 
-                auto iter = find_if(adapterInstance->m_platforms.begin(), adapterInstance->m_platforms.end(), [&pInfo](shared_ptr<PlatformInfo>& info)
-                {
-                    return(*info == *pInfo);
-                });
+                    auto iter = find_if(adapterInstance->m_platforms.begin(), adapterInstance->m_platforms.end(), [&pInfo](shared_ptr<PlatformInfo>& info)
+                    {
+                        return(*info == *pInfo);
+                    });
 
-                if (iter == adapterInstance->m_platforms.end())
-                {
-                    adapterInstance->m_platforms.push_back(pInfo);
-                    iter = prev(adapterInstance->m_platforms.end());
-                }
+                    if (iter == adapterInstance->m_platforms.end())
+                    {
+                        adapterInstance->m_platforms.push_back(pInfo);
+                        iter = prev(adapterInstance->m_platforms.end());
+                    }
 
-                //auto pInfo = new PlatformInfo{ payload->info, response->devAddr };
-                adapterInstance->InitDeviceDiscovery((*iter).get());
+                    adapterInstance->QueueDeviceDiscovery((*iter).get());
+                }
+                adapterInstance->StartQueuedDiscoveries();
             }
         }
         return OC_STACK_KEEP_TRANSACTION;
@@ -389,39 +527,69 @@ namespace AdapterLib
 
     OCStackApplicationResult Adapter::OnNotifyDevice(void* ctx, OCDoHandle /*handle*/, OCClientResponse * response)
     {
+        PlatformInfo *pInfo = reinterpret_cast<PlatformInfo*>(ctx);
+        AdapterDevice^ device = nullptr;
+
         if (response && response->result == OC_STACK_OK)
         {
             OCDevicePayload *payload = (OCDevicePayload*)response->payload;
-            if (payload && payload->base.type == PAYLOAD_TYPE_DEVICE && payload->sid)
+            if (payload && payload->base.type == PAYLOAD_TYPE_DEVICE && payload->sid && pInfo)
             {
                 AutoLock sync(adapterInstance->m_lock);
 
-                PlatformInfo *pInfo = reinterpret_cast<PlatformInfo*>(ctx);
-                if (pInfo)
+                try
                 {
-                    try
+                    device = ref new AdapterDevice(*pInfo, *payload, adapterInstance);
+
+                    //a known device only has its resources discovered again if its device information
+                    //changed or they were last discovered ResourceRefreshInterval ago
+                    auto iter = find_if(adapterInstance->m_devices.begin(), adapterInstance->m_devices.end(), [device](IAdapterDevice^ pDev)
                     {
-                        AdapterDevice^ device = ref new AdapterDevice(*pInfo, *payload, adapterInstance);
-                            adapterInstance->InitResourceDiscovery(device);
-                        }
-                    catch (NullReferenceException^)
+                        return (wstring(device->SerialNumber->Data()) == pDev->SerialNumber->Data());
+                    });
+                    if (iter != adapterInstance->m_devices.end())
                     {
-                        //dont add the device to the list. ignore
+                        AdapterDevice^ knownDevice = dynamic_cast<AdapterDevice^>(*iter);
+                        steady_clock::time_point tpNow = steady_clock::now();
+
+                        knownDevice->LastDiscoveredTime = tpNow;
+                        if (adapterInstance->IsSameDeviceInfo(knownDevice, device) &&
+                            duration_cast<seconds>(tpNow - knownDevice->LastResourceDiscoveryTime).count() < ResourceRefreshInterval)
+                        {
+                            device = nullptr;
+                        }
                     }
                 }
+                catch (NullReferenceException^)
+                {
+                    //dont add the device to the list. ignore
+                    device = nullptr;
+                }
             }
         }
-        return OC_STACK_KEEP_TRANSACTION;
+
+        if (device == nullptr || adapterInstance->InitResourceDiscovery(device) != OC_STACK_OK)
+        {
+            if (pInfo)
+            {
+                adapterInstance->EndDeviceDiscovery(pInfo->addr);
+            }
+        }
+
+        //the request is unicast so no other response is expected
+        return OC_STACK_DELETE_TRANSACTION;
     }
 
     OCStackApplicationResult Adapter::OnNotifyResource(void* ctx, OCDoHandle /*handle*/, OCClientResponse * response)
     {
+        AdapterDevice^ pDevice = reinterpret_cast<AdapterDevice^>(ctx);
+        bool bPending = false;  //the endpoint discovery finishes once the resources have been read
+
         if (response && (response->result == OC_STACK_NO_RESOURCE || response->result == OC_STACK_OK))
         {
             OCDiscoveryPayload *payload = (OCDiscoveryPayload*)response->payload;
-                AdapterDevice^ pDevice = reinterpret_cast<AdapterDevice^>(ctx);
-                if (pDevice)
-                {
+            if (pDevice)
+            {
                 AutoLock sync(adapterInstance->m_lock);
                 //check if the device already exist
                 auto iter = find_if(adapterInstance->m_devices.begin(), adapterInstance->m_devices.end(), [pDevice](IAdapterDevice^ pDev)
@@ -430,17 +598,19 @@ namespace AdapterLib
                 });
                 if (iter != adapterInstance->m_devices.end())
                 {
-                    //Device exist, see if resources are same. if there is a mismatch in the resources, we must remove the previous device representation
-                    //Also if there are no resources remove the device
+                    //Device exist, see if its information and resources are the same. if there is a mismatch,
+                    //we must remove the previous device representation. Also if there are no resources remove the device
+                    AdapterDevice^ knownDevice = dynamic_cast<AdapterDevice^>(*iter);
                     bool bRemove = false;
-                    /*if (response->result == OC_STACK_NO_RESOURCE)
-                    { 
+                    if (response->result == OC_STACK_NO_RESOURCE)
+                    {
                         bRemove = true;
                     }
                     else if (payload)
                     {
-                        bRemove = !adapterInstance->DoDeviceResourcesMatch(dynamic_cast<AdapterDevice^>(*iter), payload->resources);
-                    }*/
+                        bRemove = !adapterInstance->IsSameDeviceInfo(knownDevice, pDevice) ||
+                                  !adapterInstance->DoDeviceResourcesMatch(knownDevice, payload->resources);
+                    }
                     if (bRemove)
                     {
                         //remove the device
@@ -449,72 +619,78 @@ namespace AdapterLib
                     }
                     else
                     {
-                        // the device representation match. update the last discovered time and leave
-                        dynamic_cast<AdapterDevice^>(*iter)->LastDiscoveredTime = steady_clock::now();
+                        // the device representation match. update the discovery times and leave
+                        knownDevice->LastDiscoveredTime = steady_clock::now();
+                        knownDevice->LastResourceDiscoveryTime = knownDevice->LastDiscoveredTime;
                         goto leave;
                     }
                 }
             }
-            if (response->result == OC_STACK_OK)
+            if (response->result == OC_STACK_OK && pDevice && payload)
             {
-                    vector<shared_ptr<ResourceContext>> contextList;
-                    OCResourcePayload* resource = payload->resources;
+                vector<shared_ptr<ResourceContext>> contextList;
+                OCResourcePayload* resource = payload->resources;
 
-                    while (resource)
+                while (resource)
+                {
+                    OCStringLL* strll = resource->types;
+                    while (strll)
                     {
-                        OCStringLL* strll = resource->types;
-                        while (strll)
+                        if (resource->uri && strll->value)
                         {
-                            if (resource->uri && strll->value)
+                            AdapterProperty^ pProperty = ref new AdapterProperty(resource->uri, strll->value, pDevice);
+                            if (resource->bitmap & OC_OBSERVABLE)
                             {
-                                AdapterProperty^ pProperty = ref new AdapterProperty(resource->uri, strll->value, pDevice);
-                                if (resource->bitmap & OC_OBSERVABLE)
-                                {
-                                    pProperty->Observable = true;
-                                }
-                                string query = resource->uri + RESOURCE_TYPE_SUBQUERY + strll->value;
-                                auto pContext = new ResourceContext{};
-                                pContext->hdl = CreateEvent(nullptr, TRUE, FALSE, nullptr);
-                                pContext->pProperty = pProperty;
-                                
-                                adapterInstance->InitGetRequest(pContext, query);
-
-                                contextList.push_back(shared_ptr<ResourceContext>(pContext, [](ResourceContext* pCtx)
+                                pProperty->Observable = true;
+                            }
+                            string query = resource->uri + RESOURCE_TYPE_SUBQUERY + strll->value;
+                            auto pContext = new ResourceContext{};
+                            pContext->hdl = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+                            pContext->pProperty = pProperty;
+
+                            adapterInstance->InitGetRequest(pContext, query);
+
+                            contextList.push_back(shared_ptr<ResourceContext>(pContext, [](ResourceContext* pCtx)
+                            {
+                                if (pCtx)
                                 {
-                                    if (pCtx)
+                                    if (pCtx->hdl)
                                     {
-                                        if (pCtx->hdl)
-                                        {
-                                            CloseHandle(pCtx->hdl);
-                                            pCtx->hdl = nullptr;
-                                        }
-                                        delete pCtx;
+                                        CloseHandle(pCtx->hdl);
+                                        pCtx->hdl = nullptr;
                                     }
-                                }));
-                                
-                            }
-                            strll = strll->next;
+                                    delete pCtx;
+                                }
+                            }));
                         }
-                        resource = resource->next;
+                        strll = strll->next;
                     }
-                    ThreadPool::RunAsync(ref new WorkItemHandler([pDevice, contextList](IAsyncAction^)
+                    resource = resource->next;
+                }
+                ThreadPool::RunAsync(ref new WorkItemHandler([pDevice, contextList](IAsyncAction^)
+                {
+                    //the requests were all sent together, so they share one deadline
+                    steady_clock::time_point deadline = steady_clock::now() + milliseconds(ResourceDiscoveryTimeout);
+
+                    for (auto& pContext : contextList)
                     {
-                        for (auto& pContext : contextList)
+                        int64 remaining = duration_cast<milliseconds>(deadline - steady_clock::now()).count();
+                        DWORD timeout = (remaining > 0) ? static_cast<DWORD>(remaining) : 0;
+
+                        if ((WaitForSingleObject(pContext->hdl, timeout) == WAIT_OBJECT_0) && (pContext->result == OC_STACK_OK))
                         {
-                            if ((WaitForSingleObject(pContext->hdl, ResourceDiscoveryTimeout) == WAIT_OBJECT_0) && (pContext->result == OC_STACK_OK))
+                            AutoLock sync(adapterInstance->m_lock);
+                            pDevice->AddProperty(pContext->pProperty);
+                            if (pContext->pProperty->Observable)
                             {
-                                AutoLock sync(adapterInstance->m_lock);
-                                pDevice->AddProperty(pContext->pProperty);
-                                if (pContext->pProperty->Observable)
-                                {
-                                    //Register for property change notifications
-                                    adapterInstance->InitObserveRequest(pContext->pProperty);
-                                }
+                                //Register for property change notifications
+                                adapterInstance->InitObserveRequest(pContext->pProperty);
                             }
                         }
+                    }
 
-                        {
-                            AutoLock sync(adapterInstance->m_lock);
+                    {
+                        AutoLock sync(adapterInstance->m_lock);
                         //check if the device already exist
                         auto iter = find_if(adapterInstance->m_devices.begin(), adapterInstance->m_devices.end(), [pDevice](IAdapterDevice^ pDev)
                         {
@@ -522,16 +698,30 @@ namespace AdapterLib
                         });
                         if (iter == adapterInstance->m_devices.end())
                         {
-                        pDevice->LastDiscoveredTime = steady_clock::now();
+                            pDevice->LastDiscoveredTime = steady_clock::now();
+                            pDevice->LastResourceDiscoveryTime = pDevice->LastDiscoveredTime;
                             adapterInstance->m_devices.push_back(pDevice);
                         }
+
+                        DISCOVERY_METRICS& metrics = adapterInstance->m_discoveryMetrics;
+                        if (metrics.TimeToFirstDevice < 0)
+                        {
+                            metrics.TimeToFirstDevice = duration_cast<milliseconds>(steady_clock::now() - adapterInstance->m_discoveryRoundStart).count();
                         }
+                        ++metrics.DevicesArrived;
+                    }
 
-                        adapterInstance->NotifyDeviceArrival(pDevice);
-                    }));
-                }
+                    adapterInstance->NotifyDeviceArrival(pDevice);
+                    adapterInstance->EndDeviceDiscovery(*pDevice->DevAddr);
+                }));
+                bPending = true;
             }
+        }
     leave:
+        if (pDevice && !bPending)
+        {
+            adapterInstance->EndDeviceDiscovery(*pDevice->DevAddr);
+        }
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -1055,29 +1245,44 @@ namespace AdapterLib
     {
         AutoLock sync(adapterInstance->m_lock);
 
-        bool bMatch = true;
-        vector<string> resourceUris;
+        //a property is created for each resource type of a resource
+        vector<pair<string, string>> resourceTypes;
         while (resource)
         {
-            resourceUris.push_back(resource->uri);
+            for (OCStringLL* strll = resource->types; strll; strll = strll->next)
+            {
+                if (resource->uri && strll->value)
+                {
+                    resourceTypes.push_back(make_pair(string(resource->uri), string(strll->value)));
+                }
+            }
             resource = resource->next;
         }
-        if (pDevice->Properties->Size != resourceUris.size())
+        if (pDevice->Properties->Size != resourceTypes.size())
         {
-            bMatch = false;
+            return false;
         }
-        else
+
+        for (IAdapterProperty^ pProperty : pDevice->Properties)
         {
-            for (IAdapterProperty^ pProperty : pDevice->Properties)
+            AdapterProperty^ pAdapterProperty = dynamic_cast<AdapterProperty^>(pProperty);
+            if (find(resourceTypes.begin(), resourceTypes.end(), make_pair(pAdapterProperty->Uri, pAdapterProperty->ResourceType)) == resourceTypes.end())
             {
-                if (find(resourceUris.begin(), resourceUris.end(), dynamic_cast<AdapterProperty^>(pProperty)->Uri) == resourceUris.end())
-                {
-                    bMatch = false;
-                    break;
-                }
+                return false;
             }
         }
-        return bMatch;
+        return true;
+    }
+
+    bool Adapter::IsSameDeviceInfo(AdapterDevice^ pDevice, AdapterDevice^ pOther)
+    {
+        return (pDevice->Name == pOther->Name) &&
+               (pDevice->Version == pOther->Version) &&
+               (pDevice->Description == pOther->Description) &&
+               (pDevice->Vendor == pOther->Vendor) &&
+               (pDevice->Model == pOther->Model) &&
+               (pDevice->FirmwareVersion == pOther->FirmwareVersion) &&
+               (EndpointKey(*pDevice->DevAddr) == EndpointKey(*pOther->DevAddr));
     }
 
     _Use_decl_annotations_
@@ -35,6 +35,11 @@
 
 #include "ocstack.h"
 
+#include <chrono>
+#include <deque>
+#include <map>
+#include <string>
+
 namespace AdapterLib
 {
     //const definitions
@@ -51,6 +56,25 @@ namespace AdapterLib
         AdapterProperty^ pProperty;
     }ResourceContext;
 
+    //
+    // Timing of the last discovery round, started by InitPlatformDiscovery.
+    // Times are in msec from the start of the round, -1 until reached.
+    //
+    struct DISCOVERY_METRICS
+    {
+        // first device arrival
+        int64 TimeToFirstDevice;
+
+        // last endpoint discovery finished, with none queued or in flight
+        int64 TimeToAllDevices;
+
+        // devices that arrived during the round
+        uint32 DevicesArrived;
+
+        // largest number of endpoint discoveries in flight
+        uint32 PeakInFlight;
+    };
+
 
     //
     // Adapter class.
@@ -204,12 +228,19 @@ namespace AdapterLib
             static OCStackApplicationResult OnNotifyObserve(void* ctx, OCDoHandle handle, OCClientResponse * response);
             static OCStackApplicationResult OnNotifyPresence(void* ctx, OCDoHandle handle, OCClientResponse * response);
 
+            DISCOVERY_METRICS GetDiscoveryMetrics();
+
     private:
         void CreateSignals();
 
         OCStackResult InitPlatformDiscovery();
         OCStackResult InitDeviceDiscovery(PlatformInfo* pInfo);
         OCStackResult InitResourceDiscovery(AdapterDevice^ pDevice);
+
+        void QueueDeviceDiscovery(PlatformInfo* pInfo);
+        void StartQueuedDiscoveries();
+        void EndDeviceDiscovery(const OCDevAddr& addr, bool bStartNext = true);
+        void LogDiscoveryMetrics();
         OCStackResult InitGetRequest(ResourceContext* context, const std::string& query);
         OCStackResult InitPostRequest(ResourceContext* context, const std::string& uri, OCPayload* payload);
         OCStackResult InitPutRequest(ResourceContext* context, const std::string& uri, OCPayload* payload);
@@ -220,6 +251,7 @@ namespace AdapterLib
         OCStackResult AddResources(OCRepPayload* payload, AdapterProperty^ pProperty, const std::wstring& namePrefix = L"");
 
         bool DoDeviceResourcesMatch(AdapterDevice^ pDevice, OCResourcePayload* resource);
+        bool IsSameDeviceInfo(AdapterDevice^ pDevice, AdapterDevice^ pOther);
         void MonitorDevices();
 
     private:
@@ -282,6 +314,25 @@ namespace AdapterLib
         //platform list
         std::vector<std::shared_ptr<PlatformInfo>> m_platforms;
 
+        //
+        // Device discovery pipeline. Each endpoint that answers the platform discovery
+        // goes through device and resource discovery; at most MaxConcurrentDiscoveries
+        // endpoints are between those stages at a time and the others wait in the queue.
+        //
+        struct DISCOVERY_ENTRY
+        {
+            bool bStarted;
+            std::chrono::steady_clock::time_point startTime;
+        };
+
+        // endpoints queued or in flight, by address
+        std::map<std::string, DISCOVERY_ENTRY> m_discoveryEndpoints;
+        std::deque<PlatformInfo*> m_discoveryQueue;
+        uint32 m_discoveriesInFlight{ 0 };
+
+        std::chrono::steady_clock::time_point m_discoveryRoundStart;
+        DISCOVERY_METRICS m_discoveryMetrics;
+
         //OIC stack processing Thread
         Windows::Foundation::IAsyncAction^ m_OICProcessThreadAction{ nullptr };
 
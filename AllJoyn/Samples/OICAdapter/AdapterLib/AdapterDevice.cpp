@@ -99,6 +99,7 @@ namespace AdapterLib
         memcpy(&m_addr, &pInfo.addr, sizeof(m_addr));
 
         m_LastDiscoveredTime = chrono::steady_clock::now();
+        m_LastResourceDiscoveryTime = m_LastDiscoveredTime;
 
         //Add aplaceholder COV signal to the device
         AddChangeOfValueSignal(ref new AdapterProperty("temp", "temp", this), ref new AdapterValue("temp"));
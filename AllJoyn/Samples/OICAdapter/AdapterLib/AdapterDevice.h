@@ -126,6 +126,12 @@ namespace AdapterLib
             void set(std::chrono::steady_clock::time_point tp) { m_LastDiscoveredTime = tp; }
         }
 
+        property std::chrono::steady_clock::time_point LastResourceDiscoveryTime
+        {
+            std::chrono::steady_clock::time_point get() { return m_LastResourceDiscoveryTime; }
+            void set(std::chrono::steady_clock::time_point tp) { m_LastResourceDiscoveryTime = tp; }
+        }
+
     internal:
         AdapterDevice(const PlatformInfo& pInfo, const OCDevicePayload& deviceInfo, Adapter^ parent);
 
@@ -180,5 +186,6 @@ namespace AdapterLib
         OCDevAddr m_addr;
 
         std::chrono::steady_clock::time_point m_LastDiscoveredTime;
+        std::chrono::steady_clock::time_point m_LastResourceDiscoveryTime;
     };
 } // namespace AdapterLib
\ No newline at end of file
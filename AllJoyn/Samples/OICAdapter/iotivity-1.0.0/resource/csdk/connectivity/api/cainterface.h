@@ -201,6 +201,23 @@ CAResult_t CAGetNetworkInformation(CAEndpoint_t **info, uint32_t *size);
  */
 CAResult_t CAHandleRequestResponse();
 
+/**
+ * Wait until received data is available for ::CAHandleRequestResponse.
+ * Lets the thread that drives the stack sleep instead of polling.
+ * @param[in]   timeoutMs     maximum time to wait in milliseconds.
+ * @return   ::CA_STATUS_OK if data is pending, ::CA_STATUS_FAILED on timeout,
+ *           ::CA_NOT_SUPPORTED or ::CA_STATUS_NOT_INITIALIZED
+ */
+CAResult_t CAWaitForRequestResponse(uint32_t timeoutMs);
+
+/**
+ * Set the maximum number of confirmable messages awaiting an ACK. While the
+ * limit is reached, new requests fail with ::CA_SEND_FAILED.
+ * @param[in]   maxPendingCount     new limit, 0 for no limit.
+ * @return   ::CA_STATUS_OK or ::CA_STATUS_NOT_INITIALIZED
+ */
+CAResult_t CASetRetransmissionMaxPending(uint32_t maxPendingCount);
+
 #ifdef RA_ADAPTER
 /**
  * Set Remote Access information for XMPP Client.
@@ -126,6 +126,22 @@ void CATerminateMessageHandler();
  */
 void CAHandleRequestResponseCallbacks();
 
+/**
+ * Block the calling thread until received data is queued for
+ * ::CAHandleRequestResponseCallbacks or the timeout expires.
+ * @param[in] timeoutMs     maximum time to wait in milliseconds. 0 does not wait.
+ * @return  ::CA_STATUS_OK if data is pending, ::CA_STATUS_FAILED on timeout or
+ *          ::CA_NOT_SUPPORTED in the single thread model.
+ */
+CAResult_t CAWaitForRequestResponseCallbacks(uint32_t timeoutMs);
+
+/**
+ * Set the maximum number of CON messages awaiting ACK.
+ * @param[in] maxPendingCount   new limit. 0 means no limit.
+ * @return  ::CA_STATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CASetMessageHandlerMaxPendingCount(uint32_t maxPendingCount);
+
 /**
  * To log the PDU data.
  * @param[in] pdu    pdu data.
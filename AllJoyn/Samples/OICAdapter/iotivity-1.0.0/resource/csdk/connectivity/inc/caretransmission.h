@@ -47,6 +47,9 @@
 /** check period is 1 sec. **/
 #define RETRANSMISSION_CHECK_PERIOD_SEC     1
 
+/** by default there is no limit on the number of CON messages awaiting ACK. **/
+#define DEFAULT_RETRANSMISSION_MAX_PENDING  0
+
 /** retransmission data send method type. **/
 typedef CAResult_t (*CADataSendMethod_t)(const CAEndpoint_t *endpoint,
                                          const void *pdu,
@@ -65,8 +68,14 @@ typedef struct
     /** retransmission trying count. **/
     uint8_t tryingCount;
 
+    /** maximum number of CON messages awaiting ACK. 0 means no limit. **/
+    uint32_t maxPendingCount;
+
 } CARetransmissionConfig_t;
 
+/** retransmission data for one CON message. **/
+struct CARetransmissionData;
+
 typedef struct
 {
     /** Thread pool of the thread started. **/
@@ -90,8 +99,17 @@ typedef struct
     /** Variable to inform the thread to stop. **/
     bool isStop;
 
-    /** array list on which the thread is operating. **/
-    u_arraylist_t *dataList;
+    /** pending data ordered by next retransmission time (binary min-heap). **/
+    struct CARetransmissionData **dataHeap;
+
+    /** number of entries in dataHeap. **/
+    uint32_t dataCount;
+
+    /** allocated size of dataHeap. **/
+    uint32_t dataCapacity;
+
+    /** pending data hashed by message id and transport adapter. **/
+    struct CARetransmissionData *dataIndex;
 
 } CARetransmission_t;
 
@@ -116,6 +134,26 @@ CAResult_t CARetransmissionInitialize(CARetransmission_t *context,
                                       CATimeoutCallback_t timeoutCallback,
                                       CARetransmissionConfig_t* config);
 
+/**
+ * Replace the configuration of a retransmission context at runtime.
+ * Lowering maxPendingCount below the number of CON messages already awaiting
+ * ACK does not drop them; new ones are refused until enough are acknowledged.
+ * @param[in]   context      context for retransmission.
+ * @param[in]   config       new configuration.
+ * @return  ::CA_STATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CARetransmissionSetConfig(CARetransmission_t *context,
+                                     const CARetransmissionConfig_t *config);
+
+/**
+ * Get the configuration of a retransmission context.
+ * @param[in]   context      context for retransmission.
+ * @param[out]  config       current configuration.
+ * @return  ::CA_STATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CARetransmissionGetConfig(CARetransmission_t *context,
+                                     CARetransmissionConfig_t *config);
+
 /**
  * Starting the retransmission context.
  * @param[in]   context      context for retransmission.
@@ -150,6 +188,14 @@ CAResult_t CARetransmissionReceivedData(CARetransmission_t *context,
                                         const CAEndpoint_t *endpoint, const void *pdu,
                                         uint32_t size, void **retransmissionPdu);
 
+/**
+ * Check whether the number of CON messages awaiting ACK has reached
+ * the maxPendingCount of the configuration.
+ * @param[in]   context         context for retransmission.
+ * @return  true if no more CON messages can be tracked, false otherwise.
+ */
+bool CARetransmissionIsFull(CARetransmission_t *context);
+
 /**
  * Stopping the retransmission context.
  * @param[in]   context         context for retransmission.
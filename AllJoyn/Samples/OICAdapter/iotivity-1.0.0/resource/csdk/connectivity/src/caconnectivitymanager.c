@@ -377,6 +377,28 @@ CAResult_t CAHandleRequestResponse()
     return CA_STATUS_OK;
 }
 
+CAResult_t CAWaitForRequestResponse(uint32_t timeoutMs)
+{
+    if (!g_isInitialized)
+    {
+        OIC_LOG(ERROR, TAG, "not initialized");
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    return CAWaitForRequestResponseCallbacks(timeoutMs);
+}
+
+CAResult_t CASetRetransmissionMaxPending(uint32_t maxPendingCount)
+{
+    if (!g_isInitialized)
+    {
+        OIC_LOG(ERROR, TAG, "not initialized");
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    return CASetMessageHandlerMaxPendingCount(maxPendingCount);
+}
+
 #ifdef __WITH_DTLS__
 
 CAResult_t CASelectCipherSuite(const uint16_t cipher)
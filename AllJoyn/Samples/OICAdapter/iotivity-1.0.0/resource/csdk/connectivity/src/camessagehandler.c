@@ -58,6 +58,12 @@ static CAQueueingThread_t g_receiveThread;
 #define CA_MAX_RT_ARRAY_SIZE    3
 #endif  /* SINGLE_THREAD */
 
+#ifndef CA_MAX_RT_ARRAY_SIZE
+// initial max number of CON messages awaiting ACK. 0 means no limit.
+// CASetRetransmissionMaxPending changes it at runtime.
+#define CA_MAX_RT_ARRAY_SIZE    DEFAULT_RETRANSMISSION_MAX_PENDING
+#endif
+
 #define TAG "CA_MSG_HNDLR"
 
 static CARetransmission_t g_retransmissionContext;
@@ -879,6 +885,50 @@ void CAHandleRequestResponseCallbacks()
 #endif
 }
 
+CAResult_t CAWaitForRequestResponseCallbacks(uint32_t timeoutMs)
+{
+#if defined(SINGLE_THREAD) || !defined(SINGLE_HANDLE)
+    (void)timeoutMs;
+    return CA_NOT_SUPPORTED;
+#else
+    CAResult_t res = CA_STATUS_OK;
+
+    // The receive queueing thread is never started in SINGLE_HANDLE mode, so its
+    // condition is only signalled by CAQueueingThreadAddData and can be shared with
+    // the thread that drives CAHandleRequestResponseCallbacks.
+    ca_mutex_lock(g_receiveThread.threadMutex);
+
+    if (u_queue_get_size(g_receiveThread.dataQueue) <= 0)
+    {
+        if (0 == timeoutMs ||
+            CA_WAIT_SUCCESS != ca_cond_wait_for(g_receiveThread.threadCond,
+                                                g_receiveThread.threadMutex,
+                                                (uint64_t)timeoutMs * 1000))
+        {
+            res = (u_queue_get_size(g_receiveThread.dataQueue) > 0) ?
+                  CA_STATUS_OK : CA_STATUS_FAILED;
+        }
+    }
+
+    ca_mutex_unlock(g_receiveThread.threadMutex);
+
+    return res;
+#endif
+}
+
+CAResult_t CASetMessageHandlerMaxPendingCount(uint32_t maxPendingCount)
+{
+    CARetransmissionConfig_t config;
+    CAResult_t res = CARetransmissionGetConfig(&g_retransmissionContext, &config);
+    if (CA_STATUS_OK != res)
+    {
+        return res;
+    }
+
+    config.maxPendingCount = maxPendingCount;
+    return CARetransmissionSetConfig(&g_retransmissionContext, &config);
+}
+
 static CAData_t* CAPrepareSendData(const CAEndpoint_t *endpoint, const void *sendData,
                                    CADataType_t dataType)
 {
@@ -951,14 +1001,12 @@ CAResult_t CADetachRequestMessage(const CAEndpoint_t *object, const CARequestInf
         return CA_STATUS_FAILED;
     }
 
-#ifdef ARDUINO
     // If max retransmission queue is reached, then don't handle new request
-    if (CA_MAX_RT_ARRAY_SIZE == u_arraylist_length(g_retransmissionContext.dataList))
+    if (CARetransmissionIsFull(&g_retransmissionContext))
     {
         OIC_LOG(ERROR, TAG, "max RT queue size reached!");
         return CA_SEND_FAILED;
     }
-#endif /* ARDUINO */
 
     CAData_t *data = CAPrepareSendData(object, request, CA_REQUEST_DATA);
     if(!data)
@@ -1143,8 +1191,11 @@ CAResult_t CAInitializeMessageHandler()
 #endif /* SINGLE_HANDLE */
 
     // retransmission initialize
+    CARetransmissionConfig_t retransmissionConfig = { .supportType = DEFAULT_RETRANSMISSION_TYPE,
+                                                      .tryingCount = DEFAULT_RETRANSMISSION_COUNT,
+                                                      .maxPendingCount = CA_MAX_RT_ARRAY_SIZE };
     CARetransmissionInitialize(&g_retransmissionContext, g_threadPoolHandle, CASendUnicastData,
-                               CATimeoutCallback, NULL);
+                               CATimeoutCallback, &retransmissionConfig);
 
 #ifdef WITH_BWT
     // block-wise transfer initialize
@@ -1164,8 +1215,11 @@ CAResult_t CAInitializeMessageHandler()
     CAInitializeAdapters(g_threadPoolHandle);
 #else
     // retransmission initialize
+    CARetransmissionConfig_t retransmissionConfig = { .supportType = DEFAULT_RETRANSMISSION_TYPE,
+                                                      .tryingCount = DEFAULT_RETRANSMISSION_COUNT,
+                                                      .maxPendingCount = CA_MAX_RT_ARRAY_SIZE };
     CARetransmissionInitialize(&g_retransmissionContext, NULL, CASendUnicastData,
-                               CATimeoutCallback, NULL);
+                               CATimeoutCallback, &retransmissionConfig);
     CAInitializeAdapters();
 #endif
 
@@ -64,20 +64,34 @@
 #include "caprotocolmessage.h"
 #include "oic_malloc.h"
 #include "logger.h"
+#include "uthash.h"
 
 #define TAG "CA_RETRANS"
 
+/** initial size of the retransmission heap. **/
+#define RETRANSMISSION_HEAP_INITIAL_SIZE    8
+
 typedef struct
+{
+    uint16_t messageId;                 /**< coap PDU message id */
+    CATransportAdapter_t adapter;       /**< transport adapter of the remote endpoint */
+} CARetransmissionKey_t;
+
+typedef struct CARetransmissionData
 {
     uint64_t timeStamp;                 /**< last sent time. microseconds */
 #ifndef SINGLE_THREAD
     uint64_t timeout;                   /**< timeout value. microseconds */
 #endif
+    uint64_t deadline;                  /**< next retransmission time. microseconds */
+    uint32_t heapIndex;                 /**< position in the retransmission heap */
     uint8_t triedCount;                 /**< retransmission count */
     uint16_t messageId;                 /**< coap PDU message id */
     CAEndpoint_t *endpoint;             /**< remote endpoint */
     void *pdu;                          /**< coap PDU */
     uint32_t size;                      /**< coap PDU size */
+    CARetransmissionKey_t key;          /**< key of the message id index */
+    UT_hash_handle hh;                  /**< message id index handle */
 } CARetransmissionData_t;
 
 static const uint64_t USECS_PER_SEC = 1000000;
@@ -135,36 +149,143 @@ CAResult_t CARetransmissionStart(CARetransmission_t *context)
 #endif
 
 /**
- * @brief   check timeout routine
- * @param   currentTime     [IN]microseconds
+ * @brief   calculate the time of the next retransmission.
+ *          the timeout is doubled after every retransmission (CoAP).
  * @param   retData         [IN]retransmission data
- * @return  true if the timeout period has elapsed, false otherwise
+ * @return  microseconds
  */
-static bool CACheckTimeout(uint64_t currentTime, CARetransmissionData_t *retData)
+static uint64_t CAGetNextDeadline(const CARetransmissionData_t *retData)
 {
 #ifndef SINGLE_THREAD
-    // #1. calculate timeout
     uint32_t milliTimeoutValue = retData->timeout * 0.001;
     uint64_t timeout = (milliTimeoutValue << retData->triedCount) * (uint64_t) 1000;
+#else
+    uint64_t timeout = (2 << retData->triedCount) * USECS_PER_SEC;
+#endif
+    return retData->timeStamp + timeout;
+}
+
+static void CAHeapSwap(CARetransmission_t *context, uint32_t a, uint32_t b)
+{
+    CARetransmissionData_t *tmp = context->dataHeap[a];
+    context->dataHeap[a] = context->dataHeap[b];
+    context->dataHeap[b] = tmp;
+    context->dataHeap[a]->heapIndex = a;
+    context->dataHeap[b]->heapIndex = b;
+}
 
-    if (currentTime >= retData->timeStamp + timeout)
+static void CAHeapSiftUp(CARetransmission_t *context, uint32_t i)
+{
+    while (i > 0)
     {
-        OIC_LOG_V(DEBUG, TAG, "%d microseconds time out!!, tried count(%ld)",
-                  timeout, retData->triedCount);
-        return true;
+        uint32_t parent = (i - 1) / 2;
+        if (context->dataHeap[parent]->deadline <= context->dataHeap[i]->deadline)
+        {
+            break;
+        }
+        CAHeapSwap(context, i, parent);
+        i = parent;
     }
-#else
-    // #1. calculate timeout
-    uint64_t timeOut = (2 << retData->triedCount) * 1000000;
+}
 
-    if (currentTime >= retData->timeStamp + timeOut)
+static void CAHeapSiftDown(CARetransmission_t *context, uint32_t i)
+{
+    while (true)
     {
-        OIC_LOG_V(DEBUG, TAG, "timeout=%d, tried cnt=%d",
-                  (2 << retData->triedCount), retData->triedCount);
-        return true;
+        uint32_t smallest = i;
+        uint32_t left = 2 * i + 1;
+        uint32_t right = left + 1;
+
+        if (left < context->dataCount
+            && context->dataHeap[left]->deadline < context->dataHeap[smallest]->deadline)
+        {
+            smallest = left;
+        }
+        if (right < context->dataCount
+            && context->dataHeap[right]->deadline < context->dataHeap[smallest]->deadline)
+        {
+            smallest = right;
+        }
+        if (smallest == i)
+        {
+            break;
+        }
+        CAHeapSwap(context, i, smallest);
+        i = smallest;
     }
-#endif
-    return false;
+}
+
+/**
+ * @brief   add the retransmission data to the heap and the message id index.
+ *          the caller must hold threadMutex.
+ */
+static CAResult_t CAAddRetransmissionData(CARetransmission_t *context,
+                                          CARetransmissionData_t *retData)
+{
+    if (context->dataCount == context->dataCapacity)
+    {
+        uint32_t capacity = context->dataCapacity ?
+                            context->dataCapacity * 2 : RETRANSMISSION_HEAP_INITIAL_SIZE;
+        CARetransmissionData_t **heap = (CARetransmissionData_t **) OICRealloc(
+                context->dataHeap, capacity * sizeof(CARetransmissionData_t *));
+        if (NULL == heap)
+        {
+            OIC_LOG(ERROR, TAG, "memory error");
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+        context->dataHeap = heap;
+        context->dataCapacity = capacity;
+    }
+
+    retData->heapIndex = context->dataCount;
+    context->dataHeap[context->dataCount++] = retData;
+    CAHeapSiftUp(context, retData->heapIndex);
+
+    HASH_ADD(hh, context->dataIndex, key, sizeof(CARetransmissionKey_t), retData);
+
+    return CA_STATUS_OK;
+}
+
+/**
+ * @brief   remove the retransmission data from the heap and the message id index.
+ *          the caller must hold threadMutex.
+ */
+static void CARemoveRetransmissionData(CARetransmission_t *context,
+                                       CARetransmissionData_t *retData)
+{
+    uint32_t i = retData->heapIndex;
+    uint32_t last = --context->dataCount;
+
+    if (i != last)
+    {
+        CAHeapSwap(context, i, last);
+        CAHeapSiftDown(context, i);
+        CAHeapSiftUp(context, i);
+    }
+    context->dataHeap[last] = NULL;
+
+    HASH_DELETE(hh, context->dataIndex, retData);
+}
+
+static CARetransmissionData_t *CAFindRetransmissionData(CARetransmission_t *context,
+                                                        uint16_t messageId,
+                                                        CATransportAdapter_t adapter)
+{
+    CARetransmissionKey_t key;
+    memset(&key, 0, sizeof(key));
+    key.messageId = messageId;
+    key.adapter = adapter;
+
+    CARetransmissionData_t *retData = NULL;
+    HASH_FIND(hh, context->dataIndex, &key, sizeof(CARetransmissionKey_t), retData);
+    return retData;
+}
+
+static void CAFreeRetransmissionData(CARetransmissionData_t *retData)
+{
+    CAFreeEndpoint(retData->endpoint);
+    OICFree(retData->pdu);
+    OICFree(retData);
 }
 
 static void CACheckRetransmissionList(CARetransmission_t *context)
@@ -178,64 +299,48 @@ static void CACheckRetransmissionList(CARetransmission_t *context)
     // mutex lock
     ca_mutex_lock(context->threadMutex);
 
-    uint32_t i = 0;
-    uint32_t len = u_arraylist_length(context->dataList);
+    uint64_t currentTime = getCurrentTimeInMicroSeconds();
 
-    for (i = 0; i < len; i++)
+    // only the entries at the top of the heap can be due.
+    while (0 < context->dataCount && context->dataHeap[0]->deadline <= currentTime)
     {
-        CARetransmissionData_t *retData = u_arraylist_get(context->dataList, i);
-
-        if (NULL == retData)
-        {
-            continue;
-        }
+        CARetransmissionData_t *retData = context->dataHeap[0];
 
-        uint64_t currentTime = getCurrentTimeInMicroSeconds();
+        OIC_LOG_V(DEBUG, TAG, "timeout!!, tried count(%d)", retData->triedCount);
 
-        if (CACheckTimeout(currentTime, retData))
+        // #1. if time's up, send the data.
+        if (NULL != context->dataSendMethod)
         {
-            // #2. if time's up, send the data.
-            if (NULL != context->dataSendMethod)
-            {
-                OIC_LOG_V(DEBUG, TAG, "retransmission CON data!!, msgid=%d",
-                          retData->messageId);
-                context->dataSendMethod(retData->endpoint, retData->pdu, retData->size);
-            }
-
-            // #3. increase the retransmission count and update timestamp.
-            retData->timeStamp = currentTime;
-            retData->triedCount++;
+            OIC_LOG_V(DEBUG, TAG, "retransmission CON data!!, msgid=%d",
+                      retData->messageId);
+            context->dataSendMethod(retData->endpoint, retData->pdu, retData->size);
         }
 
-        // #4. if tried count is max, remove the retransmission data from list.
+        // #2. increase the retransmission count and update timestamp.
+        retData->timeStamp = currentTime;
+        retData->triedCount++;
+
+        // #3. if tried count is max, remove the retransmission data.
         if (retData->triedCount >= context->config.tryingCount)
         {
-            CARetransmissionData_t *removedData = u_arraylist_remove(context->dataList, i);
-            if (NULL == removedData)
-            {
-                OIC_LOG(ERROR, TAG, "Removed data is NULL");
-                // mutex unlock
-                ca_mutex_unlock(context->threadMutex);
-                return;
-            }
+            CARemoveRetransmissionData(context, retData);
+
             OIC_LOG_V(DEBUG, TAG, "max trying count, remove RTCON data,"
-                      "msgid=%d", removedData->messageId);
+                      "msgid=%d", retData->messageId);
 
             // callback for retransmit timeout
             if (NULL != context->timeoutCallback)
             {
-                context->timeoutCallback(removedData->endpoint, removedData->pdu,
-                                         removedData->size);
+                context->timeoutCallback(retData->endpoint, retData->pdu,
+                                         retData->size);
             }
 
-            CAFreeEndpoint(removedData->endpoint);
-            OICFree(removedData->pdu);
-
-            OICFree(removedData);
-
-            // modify loop value.
-            len = u_arraylist_length(context->dataList);
-            --i;
+            CAFreeRetransmissionData(retData);
+        }
+        else
+        {
+            retData->deadline = CAGetNextDeadline(retData);
+            CAHeapSiftDown(context, 0);
         }
     }
 
@@ -270,7 +375,7 @@ void CARetransmissionBaseRoutine(void *threadValue)
         // mutex lock
         ca_mutex_lock(context->threadMutex);
 
-        if (!context->isStop && u_arraylist_length(context->dataList) <= 0)
+        if (!context->isStop && 0 == context->dataCount)
         {
             // if list is empty, thread will wait
             OIC_LOG(DEBUG, TAG, "wait..there is no retransmission data.");
@@ -282,13 +387,19 @@ void CARetransmissionBaseRoutine(void *threadValue)
         }
         else if (!context->isStop)
         {
-            // check each RETRANSMISSION_CHECK_PERIOD_SEC time.
-            OIC_LOG_V(DEBUG, TAG, "wait..(%ld)microseconds",
-                      RETRANSMISSION_CHECK_PERIOD_SEC * (uint64_t) USECS_PER_SEC);
+            // sleep until the earliest retransmission is due.
+            // new data or a stop request will wake the thread earlier.
+            uint64_t currentTime = getCurrentTimeInMicroSeconds();
+            uint64_t deadline = context->dataHeap[0]->deadline;
 
-            // wait
-            uint64_t absTime = RETRANSMISSION_CHECK_PERIOD_SEC * (uint64_t) USECS_PER_SEC;
-            ca_cond_wait_for(context->threadCond, context->threadMutex, absTime );
+            if (deadline > currentTime)
+            {
+                OIC_LOG_V(DEBUG, TAG, "wait..(%lld)microseconds",
+                          (long long) (deadline - currentTime));
+
+                ca_cond_wait_for(context->threadCond, context->threadMutex,
+                                 deadline - currentTime);
+            }
         }
         else
         {
@@ -339,7 +450,8 @@ CAResult_t CARetransmissionInitialize(CARetransmission_t *context,
     memset(context, 0, sizeof(CARetransmission_t));
 
     CARetransmissionConfig_t cfg = { .supportType = DEFAULT_RETRANSMISSION_TYPE,
-                                     .tryingCount = DEFAULT_RETRANSMISSION_COUNT };
+                                     .tryingCount = DEFAULT_RETRANSMISSION_COUNT,
+                                     .maxPendingCount = DEFAULT_RETRANSMISSION_MAX_PENDING };
 
     if (config)
     {
@@ -354,11 +466,62 @@ CAResult_t CARetransmissionInitialize(CARetransmission_t *context,
     context->timeoutCallback = timeoutCallback;
     context->config = cfg;
     context->isStop = false;
-    context->dataList = u_arraylist_create();
+    context->dataHeap = NULL;
+    context->dataCount = 0;
+    context->dataCapacity = 0;
+    context->dataIndex = NULL;
+
+    return CA_STATUS_OK;
+}
+
+CAResult_t CARetransmissionSetConfig(CARetransmission_t *context,
+                                     const CARetransmissionConfig_t *config)
+{
+    if (NULL == context || NULL == config || NULL == context->threadMutex)
+    {
+        OIC_LOG(ERROR, TAG, "invalid parameter");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    ca_mutex_lock(context->threadMutex);
+    context->config = *config;
+    ca_mutex_unlock(context->threadMutex);
 
     return CA_STATUS_OK;
 }
 
+CAResult_t CARetransmissionGetConfig(CARetransmission_t *context,
+                                     CARetransmissionConfig_t *config)
+{
+    if (NULL == context || NULL == config || NULL == context->threadMutex)
+    {
+        OIC_LOG(ERROR, TAG, "invalid parameter");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    ca_mutex_lock(context->threadMutex);
+    *config = context->config;
+    ca_mutex_unlock(context->threadMutex);
+
+    return CA_STATUS_OK;
+}
+
+bool CARetransmissionIsFull(CARetransmission_t *context)
+{
+    if (NULL == context)
+    {
+        return false;
+    }
+
+    // the configuration may be changed at runtime
+    ca_mutex_lock(context->threadMutex);
+    bool isFull = 0 != context->config.maxPendingCount
+                  && context->dataCount >= context->config.maxPendingCount;
+    ca_mutex_unlock(context->threadMutex);
+
+    return isFull;
+}
+
 CAResult_t CARetransmissionSentData(CARetransmission_t *context,
                                     const CAEndpoint_t *endpoint,
                                     const void *pdu, uint32_t size)
@@ -370,7 +533,10 @@ CAResult_t CARetransmissionSentData(CARetransmission_t *context,
     }
 
     // #0. check support transport type
-    if (!(context->config.supportType & endpoint->adapter))
+    ca_mutex_lock(context->threadMutex);
+    bool isSupported = (context->config.supportType & endpoint->adapter);
+    ca_mutex_unlock(context->threadMutex);
+    if (!isSupported)
     {
         OIC_LOG_V(DEBUG, TAG, "not supported transport type=%d", endpoint->adapter);
         return CA_NOT_SUPPORTED;
@@ -424,53 +590,54 @@ CAResult_t CARetransmissionSentData(CARetransmission_t *context,
     retData->timeout = CAGetTimeoutValue();
 #endif
     retData->triedCount = 0;
+    retData->deadline = CAGetNextDeadline(retData);
     retData->messageId = messageId;
     retData->endpoint = remoteEndpoint;
     retData->pdu = pduData;
     retData->size = size;
-#ifndef SINGLE_THREAD
+    retData->key.messageId = messageId;
+    retData->key.adapter = endpoint->adapter;
+
     // mutex lock
     ca_mutex_lock(context->threadMutex);
 
-    uint32_t i = 0;
-    uint32_t len = u_arraylist_length(context->dataList);
+    CAResult_t res = CA_STATUS_OK;
 
-    // #3. add data into list
-    for (i = 0; i < len; i++)
+    // #3. add data into the heap unless the limit is reached or the id is in use
+    if (0 != context->config.maxPendingCount
+        && context->dataCount >= context->config.maxPendingCount)
     {
-        CARetransmissionData_t *currData = u_arraylist_get(context->dataList, i);
-
-        if (NULL == currData)
-        {
-            continue;
-        }
-
-        // found index
-        if (NULL != currData->endpoint && currData->messageId == messageId
-            && (currData->endpoint->adapter == endpoint->adapter))
-        {
-            OIC_LOG(ERROR, TAG, "Duplicate message ID");
+        OIC_LOG(ERROR, TAG, "max RT queue size reached!");
+        res = CA_SEND_FAILED;
+    }
+    else if (NULL != CAFindRetransmissionData(context, messageId, endpoint->adapter))
+    {
+        OIC_LOG(ERROR, TAG, "Duplicate message ID");
+        res = CA_STATUS_FAILED;
+    }
+    else
+    {
+        res = CAAddRetransmissionData(context, retData);
+    }
 
-            // mutex unlock
-            ca_mutex_unlock(context->threadMutex);
+    if (CA_STATUS_OK != res)
+    {
+        // mutex unlock
+        ca_mutex_unlock(context->threadMutex);
 
-            OICFree(retData);
-            OICFree(pduData);
-            OICFree(remoteEndpoint);
-            return CA_STATUS_FAILED;
-        }
+        CAFreeRetransmissionData(retData);
+        return res;
     }
 
-    u_arraylist_add(context->dataList, (void *) retData);
-
+#ifndef SINGLE_THREAD
     // notify the thread
     ca_cond_signal(context->threadCond);
 
     // mutex unlock
     ca_mutex_unlock(context->threadMutex);
-
 #else
-    u_arraylist_add(context->dataList, (void *) retData);
+    // mutex unlock
+    ca_mutex_unlock(context->threadMutex);
 
     CACheckRetransmissionList(context);
 #endif
@@ -489,7 +656,10 @@ CAResult_t CARetransmissionReceivedData(CARetransmission_t *context,
     }
 
     // #0. check support transport type
-    if (!(context->config.supportType & endpoint->adapter))
+    ca_mutex_lock(context->threadMutex);
+    bool isSupported = (context->config.supportType & endpoint->adapter);
+    ca_mutex_unlock(context->threadMutex);
+    if (!isSupported)
     {
         OIC_LOG_V(DEBUG, TAG, "not supported transport type=%d", endpoint->adapter);
         return CA_STATUS_OK;
@@ -509,75 +679,47 @@ CAResult_t CARetransmissionReceivedData(CARetransmission_t *context,
 
     // mutex lock
     ca_mutex_lock(context->threadMutex);
-    uint32_t len = u_arraylist_length(context->dataList);
 
-    // find index
-    uint32_t i;
-    for (i = 0; i < len; i++)
+    CARetransmissionData_t *retData = CAFindRetransmissionData(context, messageId,
+                                                               endpoint->adapter);
+    if (NULL != retData)
     {
-        CARetransmissionData_t *retData = (CARetransmissionData_t *) u_arraylist_get(
-                context->dataList, i);
-
-        if (NULL == retData)
+        // get pdu data for getting token when CA_EMPTY(RST/ACK) is received from remote device
+        // if retransmission was finish..token will be unavailable.
+        if (CA_EMPTY == CAGetCodeFromPduBinaryData(pdu, size))
         {
-            continue;
-        }
+            OIC_LOG(DEBUG, TAG, "code is CA_EMPTY");
 
-        // found index
-        if (NULL != retData->endpoint && retData->messageId == messageId
-            && (retData->endpoint->adapter == endpoint->adapter))
-        {
-            // get pdu data for getting token when CA_EMPTY(RST/ACK) is received from remote device
-            // if retransmission was finish..token will be unavailable.
-            if (CA_EMPTY == CAGetCodeFromPduBinaryData(pdu, size))
+            if (NULL == retData->pdu)
             {
-                OIC_LOG(DEBUG, TAG, "code is CA_EMPTY");
-
-                if (NULL == retData->pdu)
-                {
-                    OIC_LOG(ERROR, TAG, "retData->pdu is null");
-                    OICFree(retData);
-                    // mutex unlock
-                    ca_mutex_unlock(context->threadMutex);
-
-                    return CA_STATUS_FAILED;
-                }
-
-                // copy PDU data
-                (*retransmissionPdu) = (void *) OICCalloc(1, retData->size);
-                if ((*retransmissionPdu) == NULL)
-                {
-                    OICFree(retData);
-                    OIC_LOG(ERROR, TAG, "memory error");
-
-                    // mutex unlock
-                    ca_mutex_unlock(context->threadMutex);
-
-                    return CA_MEMORY_ALLOC_FAILED;
-                }
-                memcpy((*retransmissionPdu), retData->pdu, retData->size);
+                OIC_LOG(ERROR, TAG, "retData->pdu is null");
+
+                // mutex unlock
+                ca_mutex_unlock(context->threadMutex);
+
+                return CA_STATUS_FAILED;
             }
 
-            // #2. remove data from list
-            CARetransmissionData_t *removedData = u_arraylist_remove(context->dataList, i);
-            if (NULL == removedData)
+            // copy PDU data
+            (*retransmissionPdu) = (void *) OICCalloc(1, retData->size);
+            if ((*retransmissionPdu) == NULL)
             {
-                OIC_LOG(ERROR, TAG, "Removed data is NULL");
+                OIC_LOG(ERROR, TAG, "memory error");
 
                 // mutex unlock
                 ca_mutex_unlock(context->threadMutex);
 
-                return CA_STATUS_FAILED;
+                return CA_MEMORY_ALLOC_FAILED;
             }
+            memcpy((*retransmissionPdu), retData->pdu, retData->size);
+        }
 
-            OIC_LOG_V(DEBUG, TAG, "remove RTCON data!!, msgid=%d", messageId);
+        // #2. remove data
+        CARemoveRetransmissionData(context, retData);
 
-            CAFreeEndpoint(removedData->endpoint);
-            OICFree(removedData->pdu);
-            OICFree(removedData);
+        OIC_LOG_V(DEBUG, TAG, "remove RTCON data!!, msgid=%d", messageId);
 
-            break;
-        }
+        CAFreeRetransmissionData(retData);
     }
 
     // mutex unlock
@@ -627,7 +769,19 @@ CAResult_t CARetransmissionDestroy(CARetransmission_t *context)
     ca_mutex_free(context->threadMutex);
     context->threadMutex = NULL;
     ca_cond_free(context->threadCond);
-    u_arraylist_free(&context->dataList);
+
+    // release the data that never got ACK.
+    CARetransmissionData_t *retData = NULL;
+    CARetransmissionData_t *tmp = NULL;
+    HASH_ITER(hh, context->dataIndex, retData, tmp)
+    {
+        HASH_DELETE(hh, context->dataIndex, retData);
+        CAFreeRetransmissionData(retData);
+    }
+    OICFree(context->dataHeap);
+    context->dataHeap = NULL;
+    context->dataCount = 0;
+    context->dataCapacity = 0;
 
     return CA_STATUS_OK;
 }
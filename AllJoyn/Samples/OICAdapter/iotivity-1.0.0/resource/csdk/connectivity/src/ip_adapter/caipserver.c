@@ -49,6 +49,10 @@ static int inet_aton(const char* pszAddrString, void* pAddrBuf) { return inet_pt
 #include <linux/netlink.h>
 #include <linux/rtnetlink.h>
 #endif
+#if defined(__linux__) && !defined(__ANDROID__)
+#define CA_IP_USE_EPOLL // epoll, recvmmsg and sendmmsg are available
+#include <sys/epoll.h>
+#endif
 
 #include "pdu.h"
 #include "caipinterface.h"
@@ -69,6 +73,12 @@ static int inet_aton(const char* pszAddrString, void* pAddrBuf) { return inet_pt
 
 #define SELECT_TIMEOUT 1     // select() seconds (and termination latency)
 
+#ifdef CA_IP_USE_EPOLL
+#define EPOLL_MAX_EVENTS 16  // ready fds handled per epoll_wait()
+#define RECV_BATCH_SIZE  16  // datagrams read per recvmmsg()
+#define SEND_BATCH_SIZE  16  // interfaces sent to per sendmmsg()
+#endif
+
 #define IPv4_MULTICAST     "224.0.1.187"
 static struct in_addr IPv4MulticastAddress = { 0 };
 
@@ -111,11 +121,23 @@ static CAIPExceptionCallback g_exceptionCallback;
 
 static CAIPPacketReceivedCallback g_packetReceivedCallback;
 
+// lets CAIPStopServer wait for CAReceiveHandler to return
+static ca_mutex g_receiveMutex = NULL;
+static ca_cond g_receiveCond = NULL;
+static bool g_receiveRunning = false;
+
 static void CAHandleNetlink();
 static void CAFindReadyMessage();
+static void CASelectReadyMessage();
 static void CASelectReturned(fd_set *readFds, int ret);
 static void CAProcessNewInterface(CAInterface_t *ifchanged);
 static CAResult_t CAReceiveMessage(int fd, CATransportFlags_t flags);
+static void CADeliverMessage(CATransportFlags_t flags, unsigned char *pktinfo,
+                             struct sockaddr_storage *srcAddr,
+                             char *recvBuffer, uint32_t recvLen);
+#ifdef CA_IP_USE_EPOLL
+static void CAEpollReadyMessage();
+#endif
 
 #define SET(TYPE, FDS) \
     if (caglobals.ip.TYPE.fd != -1) \
@@ -140,10 +162,27 @@ static void CAReceiveHandler(void *data)
         CAFindReadyMessage();
     }
 
+    ca_mutex_lock(g_receiveMutex);
+    g_receiveRunning = false;
+    ca_cond_signal(g_receiveCond);
+    ca_mutex_unlock(g_receiveMutex);
+
     OIC_LOG(DEBUG, TAG, "OUT");
 }
 
 static void CAFindReadyMessage()
+{
+#ifdef CA_IP_USE_EPOLL
+    if (caglobals.ip.epollFd != -1)
+    {
+        CAEpollReadyMessage();
+        return;
+    }
+#endif
+    CASelectReadyMessage();
+}
+
+static void CASelectReadyMessage()
 {
     fd_set readFds;
     struct timeval timeout;
@@ -326,12 +365,21 @@ static CAResult_t CAReceiveMessage(int fd, CATransportFlags_t flags)
         }
     }
 
+    CADeliverMessage(flags, pktinfo, &srcAddr, recvBuffer, recvLen);
+
+    return CA_STATUS_OK;
+}
+
+static void CADeliverMessage(CATransportFlags_t flags, unsigned char *pktinfo,
+                             struct sockaddr_storage *srcAddr,
+                             char *recvBuffer, uint32_t recvLen)
+{
     CASecureEndpoint_t sep = {.endpoint = {.adapter = CA_ADAPTER_IP, .flags = flags}};
 
     if (flags & CA_IPV6)
     {
-        sep.endpoint.iface = ((struct sockaddr_in6 *)&srcAddr)->sin6_scope_id;
-        ((struct sockaddr_in6 *)&srcAddr)->sin6_scope_id = 0;
+        sep.endpoint.iface = ((struct sockaddr_in6 *)srcAddr)->sin6_scope_id;
+        ((struct sockaddr_in6 *)srcAddr)->sin6_scope_id = 0;
 
         if ((flags & CA_MULTICAST) && pktinfo)
         {
@@ -357,7 +405,7 @@ static CAResult_t CAReceiveMessage(int fd, CATransportFlags_t flags)
         }
     }
 
-    CAConvertAddrToName(&srcAddr, sep.endpoint.addr, &sep.endpoint.port);
+    CAConvertAddrToName(srcAddr, sep.endpoint.addr, &sep.endpoint.port);
 
     if (flags & CA_SECURE)
     {
@@ -375,9 +423,177 @@ static CAResult_t CAReceiveMessage(int fd, CATransportFlags_t flags)
             g_packetReceivedCallback(&sep, recvBuffer, recvLen);
         }
     }
+}
 
-    return CA_STATUS_OK;
+#ifdef CA_IP_USE_EPOLL
+typedef union
+{
+    struct cmsghdr cmsg;
+    unsigned char data[CMSG_SPACE(sizeof (struct in6_pktinfo))];
+} CAControlBuffer_t;
+
+// only the receive thread uses these
+static char g_recvBuffers[RECV_BATCH_SIZE][COAP_MAX_PDU_SIZE];
+static struct sockaddr_storage g_recvAddrs[RECV_BATCH_SIZE];
+static CAControlBuffer_t g_recvControls[RECV_BATCH_SIZE];
+
+static void CAEpollAdd(int fd, CATransportFlags_t flags)
+{
+    if (fd == -1)
+    {
+        return;
+    }
+
+    // the fd goes in the low word, the transport flags of its socket in the high word
+    struct epoll_event event = { .events = EPOLLIN };
+    event.data.u64 = ((uint64_t)flags << 32) | (uint32_t)fd;
+
+    if (-1 == epoll_ctl(caglobals.ip.epollFd, EPOLL_CTL_ADD, fd, &event))
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_ctl failed: %s", strerror(errno));
+    }
+}
+
+static void CAInitializeEpoll()
+{
+    caglobals.ip.epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (caglobals.ip.epollFd == -1)
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_create1 failed: %s (using select)", strerror(errno));
+        return;
+    }
+
+    CAEpollAdd(caglobals.ip.u6.fd,  CA_IPV6);
+    CAEpollAdd(caglobals.ip.u6s.fd, CA_IPV6 | CA_SECURE);
+    CAEpollAdd(caglobals.ip.u4.fd,  CA_IPV4);
+    CAEpollAdd(caglobals.ip.u4s.fd, CA_IPV4 | CA_SECURE);
+    CAEpollAdd(caglobals.ip.m6.fd,  CA_MULTICAST | CA_IPV6);
+    CAEpollAdd(caglobals.ip.m6s.fd, CA_MULTICAST | CA_IPV6 | CA_SECURE);
+    CAEpollAdd(caglobals.ip.m4.fd,  CA_MULTICAST | CA_IPV4);
+    CAEpollAdd(caglobals.ip.m4s.fd, CA_MULTICAST | CA_IPV4 | CA_SECURE);
+    CAEpollAdd(caglobals.ip.shutdownFds[0], CA_DEFAULT_FLAGS);
+    CAEpollAdd(caglobals.ip.netlinkFd, CA_DEFAULT_FLAGS);
+}
+
+static unsigned char *CAGetPacketInfo(struct msghdr *msg, CATransportFlags_t flags)
+{
+    int level = (flags & CA_IPV6) ? IPPROTO_IPV6 : IPPROTO_IP;
+    int type = (flags & CA_IPV6) ? IPV6_PKTINFO : IP_PKTINFO;
+    unsigned char *pktinfo = NULL;
+
+    for (struct cmsghdr *cmp = CMSG_FIRSTHDR(msg); cmp != NULL; cmp = CMSG_NXTHDR(msg, cmp))
+    {
+        if (cmp->cmsg_level == level && cmp->cmsg_type == type)
+        {
+            pktinfo = CMSG_DATA(cmp);
+        }
+    }
+    return pktinfo;
+}
+
+/*
+ * Read everything queued on the socket, RECV_BATCH_SIZE datagrams per system call.
+ */
+static void CAReceiveMessages(int fd, CATransportFlags_t flags)
+{
+    struct mmsghdr msgs[RECV_BATCH_SIZE];
+    struct iovec iovs[RECV_BATCH_SIZE];
+    int received = 0;
+
+    do
+    {
+        memset(msgs, 0, sizeof (msgs));
+        for (int i = 0; i < RECV_BATCH_SIZE; i++)
+        {
+            iovs[i].iov_base = g_recvBuffers[i];
+            iovs[i].iov_len = sizeof (g_recvBuffers[i]);
+            msgs[i].msg_hdr.msg_name = &g_recvAddrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof (g_recvAddrs[i]);
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_control = &g_recvControls[i];
+            msgs[i].msg_hdr.msg_controllen = sizeof (g_recvControls[i]);
+        }
+
+        received = recvmmsg(fd, msgs, RECV_BATCH_SIZE, MSG_DONTWAIT, NULL);
+        if (-1 == received)
+        {
+            if (ENOSYS == errno)
+            {
+                (void)CAReceiveMessage(fd, flags);
+            }
+            else if (EAGAIN != errno && EWOULDBLOCK != errno && EINTR != errno)
+            {
+                OIC_LOG_V(ERROR, TAG, "recvmmsg failed %s", strerror(errno));
+            }
+            return;
+        }
+
+        for (int i = 0; i < received && !caglobals.ip.terminate; i++)
+        {
+            unsigned char *pktinfo = NULL;
+            if (flags & CA_MULTICAST)
+            {
+                pktinfo = CAGetPacketInfo(&msgs[i].msg_hdr, flags);
+            }
+            CADeliverMessage(flags, pktinfo, &g_recvAddrs[i], g_recvBuffers[i], msgs[i].msg_len);
+        }
+    } while (RECV_BATCH_SIZE == received && !caglobals.ip.terminate);
+}
+
+static void CAEpollReadyMessage()
+{
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    int timeout = caglobals.ip.selectTimeout == -1 ? -1 : caglobals.ip.selectTimeout * 1000;
+
+    int ret = epoll_wait(caglobals.ip.epollFd, events, EPOLL_MAX_EVENTS, timeout);
+
+    if (caglobals.ip.terminate)
+    {
+        OIC_LOG_V(DEBUG, TAG, "Packet receiver Stop request received.");
+        return;
+    }
+    if (ret <= 0)
+    {
+        if (ret < 0 && EINTR != errno)
+        {
+            OIC_LOG_V(FATAL, TAG, "epoll_wait error %s", strerror(errno));
+        }
+        return;
+    }
+
+    for (int i = 0; i < ret && !caglobals.ip.terminate; i++)
+    {
+        int fd = (int)(events[i].data.u64 & 0xFFFFFFFF);
+        CATransportFlags_t flags = (CATransportFlags_t)(events[i].data.u64 >> 32);
+
+        if (fd == caglobals.ip.netlinkFd)
+        {
+            CAHandleNetlink();
+        }
+        else if (fd == caglobals.ip.shutdownFds[0])
+        {
+            // consume the wake up so the pipe does not stay readable
+            char buf[16];
+            if (read(fd, buf, sizeof (buf)) <= 0)
+            {
+                continue;
+            }
+
+            CAInterface_t *ifchanged = CAFindInterfaceChange();
+            if (ifchanged)
+            {
+                CAProcessNewInterface(ifchanged);
+                OICFree(ifchanged);
+            }
+        }
+        else
+        {
+            CAReceiveMessages(fd, flags);
+        }
+    }
 }
+#endif
 
 void CAIPPullData()
 {
@@ -627,6 +843,11 @@ CAResult_t CAIPStartServer(const ca_thread_pool_t threadPool)
     // create source of network interface change notifications
     CAInitializeNetlink();
 
+    caglobals.ip.epollFd = -1;
+#ifdef CA_IP_USE_EPOLL
+    CAInitializeEpoll();
+#endif
+
     caglobals.ip.selectTimeout = CAGetPollingInterval(caglobals.ip.selectTimeout);
 
     res = CAIPStartListenServer();
@@ -636,11 +857,24 @@ CAResult_t CAIPStartServer(const ca_thread_pool_t threadPool)
         return res;
     }
 
+    if (!g_receiveMutex)
+    {
+        g_receiveMutex = ca_mutex_new();
+        g_receiveCond = ca_cond_new();
+        if (!g_receiveMutex || !g_receiveCond)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to create receive thread mutex");
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+    }
+
     caglobals.ip.terminate = false;
+    g_receiveRunning = true;
     res = ca_thread_pool_add_task(threadPool, CAReceiveHandler, NULL);
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "thread_pool_add_task failed");
+        g_receiveRunning = false;
         return res;
     }
     OIC_LOG(DEBUG, TAG, "CAReceiveHandler thread started successfully.");
@@ -666,6 +900,26 @@ void CAIPStopServer()
         // receive thread will stop in SELECT_TIMEOUT seconds.
     }
 
+    // wait for the receive thread before closing what it polls, so a
+    // restart cannot hand it the new epoll instance
+    if (g_receiveMutex)
+    {
+        ca_mutex_lock(g_receiveMutex);
+        while (g_receiveRunning)
+        {
+            ca_cond_wait(g_receiveCond, g_receiveMutex);
+        }
+        ca_mutex_unlock(g_receiveMutex);
+    }
+
+#ifdef CA_IP_USE_EPOLL
+    if (caglobals.ip.epollFd != -1)
+    {
+        close(caglobals.ip.epollFd);
+        caglobals.ip.epollFd = -1;
+    }
+#endif
+
     OIC_LOG(DEBUG, TAG, "OUT");
 }
 
@@ -956,6 +1210,114 @@ static void sendData(int fd, const CAEndpoint_t *endpoint,
     }
 }
 
+#ifdef CA_IP_USE_EPOLL
+/*
+ * Send one copy of the datagram out of every running interface of the given family
+ * with as few sendmmsg() calls as possible. The outgoing interface of each copy is
+ * selected with IP(V6)_PKTINFO ancillary data rather than IP(V6)_MULTICAST_IF.
+ * Returns CA_NOT_SUPPORTED if nothing was sent and the caller should fall back.
+ */
+static CAResult_t sendMulticastBatch(int fd, const u_arraylist_t *iflist, int family,
+                                     const CAEndpoint_t *endpoint,
+                                     const void *data, uint32_t dlen, const char *fam)
+{
+    struct sockaddr_storage sock;
+    CAConvertNameToAddr(endpoint->addr, endpoint->port, &sock);
+    socklen_t socklen = (AF_INET6 == family) ? sizeof (struct sockaddr_in6)
+                                             : sizeof (struct sockaddr_in);
+
+    struct sockaddr_storage socks[SEND_BATCH_SIZE];
+    CAControlBuffer_t controls[SEND_BATCH_SIZE];
+    struct mmsghdr msgs[SEND_BATCH_SIZE];
+    struct iovec iov = { (void *)data, dlen };
+    bool sentAny = false;
+
+    uint32_t len = u_arraylist_length(iflist);
+    uint32_t i = 0;
+    while (i < len)
+    {
+        int count = 0;
+        memset(msgs, 0, sizeof (msgs));
+        memset(controls, 0, sizeof (controls));
+
+        for (; i < len && count < SEND_BATCH_SIZE; i++)
+        {
+            CAInterface_t *ifitem = (CAInterface_t *)u_arraylist_get(iflist, i);
+            if (!ifitem)
+            {
+                continue;
+            }
+            if ((ifitem->flags & (IFF_UP|IFF_RUNNING)) != (IFF_UP|IFF_RUNNING))
+            {
+                continue;
+            }
+            if (ifitem->family != family)
+            {
+                continue;
+            }
+
+            struct msghdr *msg = &msgs[count].msg_hdr;
+            socks[count] = sock;
+            msg->msg_name = &socks[count];
+            msg->msg_namelen = socklen;
+            msg->msg_iov = &iov;
+            msg->msg_iovlen = 1;
+            msg->msg_control = &controls[count];
+
+            if (AF_INET6 == family)
+            {
+                ((struct sockaddr_in6 *)&socks[count])->sin6_scope_id = ifitem->index;
+
+                msg->msg_controllen = CMSG_SPACE(sizeof (struct in6_pktinfo));
+                struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg);
+                cmsg->cmsg_level = IPPROTO_IPV6;
+                cmsg->cmsg_type = IPV6_PKTINFO;
+                cmsg->cmsg_len = CMSG_LEN(sizeof (struct in6_pktinfo));
+                ((struct in6_pktinfo *)CMSG_DATA(cmsg))->ipi6_ifindex = ifitem->index;
+            }
+            else
+            {
+                msg->msg_controllen = CMSG_SPACE(sizeof (struct in_pktinfo));
+                struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg);
+                cmsg->cmsg_level = IPPROTO_IP;
+                cmsg->cmsg_type = IP_PKTINFO;
+                cmsg->cmsg_len = CMSG_LEN(sizeof (struct in_pktinfo));
+                struct in_pktinfo *info = (struct in_pktinfo *)CMSG_DATA(cmsg);
+                info->ipi_ifindex = ifitem->index;
+                info->ipi_spec_dst.s_addr = ifitem->ipv4addr;
+            }
+            count++;
+        }
+
+        int offset = 0;
+        while (offset < count)
+        {
+            int ret = sendmmsg(fd, msgs + offset, count - offset, 0);
+            if (-1 == ret)
+            {
+                if (ENOSYS == errno && !sentAny)
+                {
+                    return CA_NOT_SUPPORTED;
+                }
+                // skip the copy that failed and carry on with the other interfaces
+                (void)fam;
+                OIC_LOG_V(ERROR, TAG, "multicast %s sendmmsg failed: %s", fam, strerror(errno));
+                ret = 1;
+            }
+            else
+            {
+                OIC_LOG_V(INFO, TAG, "multicast %s sendmmsg is successful: %d interfaces",
+                          fam, ret);
+            }
+            sentAny = true;
+            offset += ret;
+        }
+    }
+
+    return CA_STATUS_OK;
+}
+#endif
+
 static void sendMulticastData6(const u_arraylist_t *iflist,
                                CAEndpoint_t *endpoint,
                                const void *data, uint32_t datalen)
@@ -970,6 +1332,14 @@ static void sendMulticastData6(const u_arraylist_t *iflist,
     OICStrcpy(endpoint->addr, sizeof(endpoint->addr), ipv6mcname);
     int fd = caglobals.ip.u6.fd;
 
+#ifdef CA_IP_USE_EPOLL
+    if (CA_NOT_SUPPORTED != sendMulticastBatch(fd, iflist, AF_INET6, endpoint,
+                                               data, datalen, "ipv6"))
+    {
+        return;
+    }
+#endif
+
     uint32_t len = u_arraylist_length(iflist);
     for (uint32_t i = 0; i < len; i++)
     {
@@ -1005,6 +1375,14 @@ static void sendMulticastData4(const u_arraylist_t *iflist,
     OICStrcpy(endpoint->addr, sizeof(endpoint->addr), IPv4_MULTICAST);
     int fd = caglobals.ip.u4.fd;
 
+#ifdef CA_IP_USE_EPOLL
+    if (CA_NOT_SUPPORTED != sendMulticastBatch(fd, iflist, AF_INET, endpoint,
+                                               data, datalen, "ipv4"))
+    {
+        return;
+    }
+#endif
+
     uint32_t len = u_arraylist_length(iflist);
     for (uint32_t i = 0; i < len; i++)
     {
@@ -0,0 +1,117 @@
+/* ****************************************************************
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/*
+ * Loopback receive benchmark for the IP adapter: starts the IP server,
+ * sends small datagrams at its IPv4 unicast port from one socket and
+ * reports how many reached the packet-received callback.
+ *
+ *   caipbench [seconds] [datagram size]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "caipinterface.h"
+#include "cathreadpool.h"
+
+#define DEFAULT_SECONDS  3
+#define DEFAULT_SIZE     64
+#define MAX_SIZE         1024
+#define SEND_BURST       64
+
+static volatile unsigned long g_received = 0;
+
+static void PacketReceived(const CASecureEndpoint_t *sep, const void *data, uint32_t dataLength)
+{
+    (void)sep;
+    (void)data;
+    (void)dataLength;
+    __sync_fetch_and_add(&g_received, 1);
+}
+
+static double Now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    double seconds = argc > 1 ? atof(argv[1]) : DEFAULT_SECONDS;
+    size_t size = argc > 2 ? (size_t)atoi(argv[2]) : DEFAULT_SIZE;
+    if (seconds <= 0 || size < 4 || size > MAX_SIZE)
+    {
+        fprintf(stderr, "usage: %s [seconds] [datagram size 4..%d]\n", argv[0], MAX_SIZE);
+        return 1;
+    }
+
+    ca_thread_pool_t threadPool = NULL;
+    if (CA_STATUS_OK != ca_thread_pool_init(2, &threadPool))
+    {
+        fprintf(stderr, "thread pool init failed\n");
+        return 1;
+    }
+
+    caglobals.ip.ipv4enabled = true;
+    CAIPSetPacketReceiveCallback(PacketReceived);
+    if (CA_STATUS_OK != CAIPStartServer(threadPool))
+    {
+        fprintf(stderr, "CAIPStartServer failed\n");
+        return 1;
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr = { .sin_family = AF_INET,
+                                .sin_port = htons(caglobals.ip.u4.port) };
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    // a non-confirmable CoAP header, so the datagram looks like traffic
+    char buf[MAX_SIZE] = { 0x50, 0x01, 0x00, 0x00 };
+    unsigned long sent = 0;
+    double start = Now();
+    while (Now() - start < seconds)
+    {
+        for (int i = 0; i < SEND_BURST; i++)
+        {
+            if (sendto(fd, buf, size, 0, (struct sockaddr *)&addr, sizeof(addr)) > 0)
+            {
+                sent++;
+            }
+        }
+    }
+    double elapsed = Now() - start;
+
+    // let the receive thread drain the socket buffer
+    usleep(200000);
+    unsigned long received = g_received;
+
+    printf("%zu-byte datagrams for %.1f s: sent %.0f pps, received %.0f pps (%.1f%%)\n",
+           size, elapsed, sent / elapsed, received / elapsed,
+           sent ? 100.0 * received / sent : 0.0);
+
+    close(fd);
+    CAIPStopServer();
+    ca_thread_pool_free(threadPool);
+    return 0;
+}
@@ -0,0 +1,155 @@
+//******************************************************************
+//
+// Copyright 2016 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include "caretransmission.h"
+#include "oic_malloc.h"
+
+namespace {
+
+// 4 byte CoAP header: version 1, no token, then code and message id.
+const uint8_t COAP_CON = 0x40;
+const uint8_t COAP_ACK = 0x60;
+const uint8_t COAP_GET = 0x01;
+const uint8_t COAP_EMPTY = 0x00;
+
+void MakePdu(uint8_t *pdu, uint8_t type, uint8_t code, uint16_t messageId)
+{
+    pdu[0] = type;
+    pdu[1] = code;
+    pdu[2] = (uint8_t) (messageId >> 8);
+    pdu[3] = (uint8_t) (messageId & 0xFF);
+}
+
+CAResult_t NullSend(const CAEndpoint_t *, const void *, uint32_t)
+{
+    return CA_STATUS_OK;
+}
+
+class RetransmissionTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        memset(&endpoint, 0, sizeof(endpoint));
+        endpoint.adapter = CA_ADAPTER_IP;
+
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &pool));
+    }
+
+    virtual void TearDown()
+    {
+        CARetransmissionDestroy(&context);
+        ca_thread_pool_free(pool);
+    }
+
+    void Init(uint32_t maxPendingCount)
+    {
+        CARetransmissionConfig_t config = { (CATransportAdapter_t) DEFAULT_RETRANSMISSION_TYPE,
+                                            DEFAULT_RETRANSMISSION_COUNT,
+                                            maxPendingCount };
+        ASSERT_EQ(CA_STATUS_OK, CARetransmissionInitialize(&context, pool, NullSend,
+                                                           NULL, &config));
+    }
+
+    CAResult_t SendCon(uint16_t messageId)
+    {
+        uint8_t pdu[4];
+        MakePdu(pdu, COAP_CON, COAP_GET, messageId);
+        return CARetransmissionSentData(&context, &endpoint, pdu, sizeof(pdu));
+    }
+
+    ca_thread_pool_t pool;
+    CARetransmission_t context;
+    CAEndpoint_t endpoint;
+};
+
+TEST_F(RetransmissionTest, DuplicateMessageIdIsRejected)
+{
+    Init(0);
+    EXPECT_EQ(CA_STATUS_OK, SendCon(1));
+    EXPECT_EQ(CA_STATUS_FAILED, SendCon(1));
+    EXPECT_EQ(CA_STATUS_OK, SendCon(2));
+}
+
+TEST_F(RetransmissionTest, MaxPendingCountIsEnforced)
+{
+    Init(2);
+    EXPECT_EQ(CA_STATUS_OK, SendCon(1));
+    EXPECT_FALSE(CARetransmissionIsFull(&context));
+    EXPECT_EQ(CA_STATUS_OK, SendCon(2));
+    EXPECT_TRUE(CARetransmissionIsFull(&context));
+    EXPECT_EQ(CA_SEND_FAILED, SendCon(3));
+}
+
+TEST_F(RetransmissionTest, MaxPendingCountCanBeChanged)
+{
+    Init(1);
+    EXPECT_EQ(CA_STATUS_OK, SendCon(1));
+    EXPECT_TRUE(CARetransmissionIsFull(&context));
+
+    CARetransmissionConfig_t config;
+    ASSERT_EQ(CA_STATUS_OK, CARetransmissionGetConfig(&context, &config));
+    EXPECT_EQ(1u, config.maxPendingCount);
+    config.maxPendingCount = 3;
+    ASSERT_EQ(CA_STATUS_OK, CARetransmissionSetConfig(&context, &config));
+    EXPECT_FALSE(CARetransmissionIsFull(&context));
+    EXPECT_EQ(CA_STATUS_OK, SendCon(2));
+    EXPECT_EQ(CA_STATUS_OK, SendCon(3));
+    EXPECT_EQ(CA_SEND_FAILED, SendCon(4));
+
+    // lowering the limit keeps the pending messages
+    config.maxPendingCount = 2;
+    ASSERT_EQ(CA_STATUS_OK, CARetransmissionSetConfig(&context, &config));
+    EXPECT_TRUE(CARetransmissionIsFull(&context));
+    EXPECT_EQ(CA_SEND_FAILED, SendCon(4));
+
+    config.maxPendingCount = 0;
+    ASSERT_EQ(CA_STATUS_OK, CARetransmissionSetConfig(&context, &config));
+    EXPECT_FALSE(CARetransmissionIsFull(&context));
+    EXPECT_EQ(CA_STATUS_OK, SendCon(4));
+}
+
+TEST_F(RetransmissionTest, AckRemovesPendingMessage)
+{
+    Init(1000);
+    for (uint16_t id = 1; id <= 1000; id++)
+    {
+        ASSERT_EQ(CA_STATUS_OK, SendCon(id));
+    }
+    EXPECT_TRUE(CARetransmissionIsFull(&context));
+
+    uint8_t ack[4];
+    MakePdu(ack, COAP_ACK, COAP_EMPTY, 500);
+    void *conPdu = NULL;
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionReceivedData(&context, &endpoint, ack,
+                                                         sizeof(ack), &conPdu));
+    ASSERT_TRUE(NULL != conPdu);
+    EXPECT_EQ(COAP_CON, ((uint8_t *) conPdu)[0]);
+    EXPECT_EQ(0x01, ((uint8_t *) conPdu)[2]);
+    EXPECT_EQ(0xF4, ((uint8_t *) conPdu)[3]);
+    OICFree(conPdu);
+
+    EXPECT_FALSE(CARetransmissionIsFull(&context));
+    EXPECT_EQ(CA_STATUS_OK, SendCon(500));
+}
+
+} // namespace
@@ -52,6 +52,33 @@ void DeInitACLResource();
  */
 const OicSecAcl_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAcl_t **savePtr);
 
+/**
+ * This method is used by PolicyEngine to find the ACE deciding a request. It
+ * looks the subject and resource up in an index of the ACL instead of walking it.
+ *
+ * @param subjectId     ID of the requesting subject.
+ * @param resource      URI of the requested resource.
+ * @param subjectFound  set to true if the ACL has any ACE for subjectId.
+ *
+ * @retval  the first ACE for subjectId, in ACL order, listing 'resource' or the
+ *          wildcard resource; NULL if there is none.
+ */
+const OicSecAcl_t* GetACEForResource(const OicUuid_t* subjectId, const char* resource,
+                                     bool* subjectFound);
+
+/**
+ * Returns a counter that changes whenever the installed ACL changes, so
+ * callers can tell whether results derived from it are still current.
+ */
+uint32_t GetACLGeneration();
+
+/**
+ * Drops the index behind GetACEForResource and moves GetACLGeneration on.
+ * The ACL resource does this itself when it changes gAcl; anyone else who
+ * replaces, frees or edits gAcl must call it before the next access check.
+ */
+void InvalidateACLIndex();
+
 /**
  * This function converts ACL data into JSON format.
  * Caller needs to invoke 'free' when done using
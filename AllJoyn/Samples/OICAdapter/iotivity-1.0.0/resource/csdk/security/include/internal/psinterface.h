@@ -21,6 +21,10 @@
 #ifndef IOTVT_SRM_PSI_H
 #define IOTVT_SRM_PSI_H
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**
  * Reads the Secure Virtual Database from PS into dynamically allocated
  * memory buffer.
@@ -43,4 +47,8 @@ char * GetSVRDatabase();
  */
 OCStackResult UpdateSVRDatabase(const char* rsrcName, cJSON* jsonObj);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif //IOTVT_SRM_PSI_H
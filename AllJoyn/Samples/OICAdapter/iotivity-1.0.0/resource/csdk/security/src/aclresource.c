@@ -30,6 +30,7 @@
 #include "aclresource.h"
 #include "psinterface.h"
 #include "utlist.h"
+#include "uthash.h"
 #include "srmresourcestrings.h"
 #include "doxmresource.h"
 #include "srmutility.h"
@@ -46,6 +47,33 @@
 OicSecAcl_t               *gAcl = NULL;
 static OCResourceHandle    gAclHandle = NULL;
 
+/**
+ * First ACE, in ACL order, of a subject that lists a given resource href.
+ */
+typedef struct AclResourceIndex
+{
+    const char          *href;          // key, points into the ACE
+    const OicSecAcl_t   *ace;
+    size_t              order;          // position of 'ace' in gAcl
+    UT_hash_handle      hh;
+} AclResourceIndex_t;
+
+/**
+ * Per-subject view of gAcl used by the policy engine.
+ */
+typedef struct AclSubjectIndex
+{
+    OicUuid_t           subject;        // key
+    AclResourceIndex_t  *resources;
+    const OicSecAcl_t   *wildcardAce;   // first ACE listing WILDCARD_RESOURCE_URI
+    size_t              wildcardOrder;
+    UT_hash_handle      hh;
+} AclSubjectIndex_t;
+
+static AclSubjectIndex_t  *gAclIndex = NULL;
+static bool                gAclIndexValid = false;
+static uint32_t            gAclGeneration = 0;
+
 /**
  * This function frees OicSecAcl_t object's fields and object itself.
  */
@@ -106,6 +134,93 @@ void DeleteACLList(OicSecAcl_t* acl)
     }
 }
 
+static void FreeACLIndex()
+{
+    AclSubjectIndex_t *subjectEntry = NULL;
+    AclSubjectIndex_t *subjectTmp = NULL;
+    HASH_ITER(hh, gAclIndex, subjectEntry, subjectTmp)
+    {
+        AclResourceIndex_t *resourceEntry = NULL;
+        AclResourceIndex_t *resourceTmp = NULL;
+        HASH_ITER(hh, subjectEntry->resources, resourceEntry, resourceTmp)
+        {
+            HASH_DEL(subjectEntry->resources, resourceEntry);
+            OICFree(resourceEntry);
+        }
+        HASH_DEL(gAclIndex, subjectEntry);
+        OICFree(subjectEntry);
+    }
+    gAclIndex = NULL;
+    gAclIndexValid = false;
+}
+
+void InvalidateACLIndex()
+{
+    gAclIndexValid = false;
+    gAclGeneration++;
+}
+
+static bool BuildACLIndex()
+{
+    OicSecAcl_t *acl = NULL;
+    size_t order = 0;
+
+    FreeACLIndex();
+
+    LL_FOREACH(gAcl, acl)
+    {
+        AclSubjectIndex_t *subjectEntry = NULL;
+        HASH_FIND(hh, gAclIndex, &acl->subject, sizeof(OicUuid_t), subjectEntry);
+        if (NULL == subjectEntry)
+        {
+            subjectEntry = (AclSubjectIndex_t *)OICCalloc(1, sizeof(AclSubjectIndex_t));
+            VERIFY_NON_NULL(TAG, subjectEntry, ERROR);
+            memcpy(&subjectEntry->subject, &acl->subject, sizeof(OicUuid_t));
+            HASH_ADD(hh, gAclIndex, subject, sizeof(OicUuid_t), subjectEntry);
+        }
+
+        for (size_t i = 0; i < acl->resourcesLen; i++)
+        {
+            const char *href = acl->resources[i];
+            if (NULL == href)
+            {
+                continue;
+            }
+
+            if (0 == strcmp(href, WILDCARD_RESOURCE_URI))
+            {
+                if (NULL == subjectEntry->wildcardAce)
+                {
+                    subjectEntry->wildcardAce = acl;
+                    subjectEntry->wildcardOrder = order;
+                }
+                continue;
+            }
+
+            AclResourceIndex_t *resourceEntry = NULL;
+            HASH_FIND_STR(subjectEntry->resources, href, resourceEntry);
+            if (NULL == resourceEntry)
+            {
+                resourceEntry = (AclResourceIndex_t *)OICCalloc(1, sizeof(AclResourceIndex_t));
+                VERIFY_NON_NULL(TAG, resourceEntry, ERROR);
+                resourceEntry->href = href;
+                resourceEntry->ace = acl;
+                resourceEntry->order = order;
+                HASH_ADD_KEYPTR(hh, subjectEntry->resources, resourceEntry->href,
+                                strlen(resourceEntry->href), resourceEntry);
+            }
+        }
+        order++;
+    }
+
+    gAclIndexValid = true;
+    return true;
+
+exit:
+    FreeACLIndex();
+    return false;
+}
+
 /*
  * This internal method converts ACL data into JSON format.
  *
@@ -511,6 +626,7 @@ static OCStackResult RemoveACE(const OicUuid_t * subject,
 
     if(deleteFlag)
     {
+        InvalidateACLIndex();
         if(UpdatePersistentStorage(gAcl))
         {
             ret = OC_STACK_RESOURCE_DELETED;
@@ -674,6 +790,7 @@ static OCEntityHandlerResult HandleACLPostRequest (const OCEntityHandlerRequest
     {
         // Append the new ACL to existing ACL
         LL_APPEND(gAcl, newAcl);
+        InvalidateACLIndex();
 
         if(UpdatePersistentStorage(gAcl))
         {
@@ -898,6 +1015,7 @@ OCStackResult InitACLResource()
         GetDefaultACL(&gAcl);
         // TODO Needs to update persistent storage
     }
+    InvalidateACLIndex();
     VERIFY_NON_NULL(TAG, gAcl, FATAL);
 
     // Instantiate 'oic.sec.acl'
@@ -923,6 +1041,9 @@ void DeInitACLResource()
 
     DeleteACLList(gAcl);
     gAcl = NULL;
+
+    FreeACLIndex();
+    InvalidateACLIndex();
 }
 
 /**
@@ -985,6 +1106,74 @@ const OicSecAcl_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAcl_t **
     return NULL;
 }
 
+/**
+ * This method is used by PolicyEngine to find the ACE deciding a request.
+ *
+ * @param subjectId     ID of the requesting subject.
+ * @param resource      URI of the requested resource.
+ * @param subjectFound  set to true if the ACL has any ACE for subjectId.
+ *
+ * @retval  the first ACE for subjectId, in ACL order, listing 'resource' or the
+ *          wildcard resource; NULL if there is none.
+ */
+const OicSecAcl_t* GetACEForResource(const OicUuid_t* subjectId, const char* resource,
+                                     bool* subjectFound)
+{
+    if (NULL == subjectId || NULL == resource || NULL == subjectFound)
+    {
+        return NULL;
+    }
+    *subjectFound = false;
+
+    if (!gAclIndexValid && !BuildACLIndex())
+    {
+        // Out of memory: fall back to walking the list.
+        OicSecAcl_t *acl = NULL;
+        LL_FOREACH(gAcl, acl)
+        {
+            if (memcmp(&(acl->subject), subjectId, sizeof(OicUuid_t)) == 0)
+            {
+                *subjectFound = true;
+                for (size_t i = 0; i < acl->resourcesLen; i++)
+                {
+                    if (acl->resources[i] && (0 == strcmp(resource, acl->resources[i]) ||
+                        0 == strcmp(WILDCARD_RESOURCE_URI, acl->resources[i])))
+                    {
+                        return acl;
+                    }
+                }
+            }
+        }
+        return NULL;
+    }
+
+    AclSubjectIndex_t *subjectEntry = NULL;
+    HASH_FIND(hh, gAclIndex, subjectId, sizeof(OicUuid_t), subjectEntry);
+    if (NULL == subjectEntry)
+    {
+        return NULL;
+    }
+    *subjectFound = true;
+
+    AclResourceIndex_t *resourceEntry = NULL;
+    HASH_FIND_STR(subjectEntry->resources, resource, resourceEntry);
+
+    if (resourceEntry && (NULL == subjectEntry->wildcardAce ||
+                          resourceEntry->order < subjectEntry->wildcardOrder))
+    {
+        return resourceEntry->ace;
+    }
+    return subjectEntry->wildcardAce;
+}
+
+/**
+ * Returns a counter that changes whenever the installed ACL changes, so
+ * callers can tell whether results derived from it are still current.
+ */
+uint32_t GetACLGeneration()
+{
+    return gAclGeneration;
+}
 
 OCStackResult InstallNewACL(const char* newJsonStr)
 {
@@ -997,6 +1186,7 @@ OCStackResult InstallNewACL(const char* newJsonStr)
     {
         // Append the new ACL to existing ACL
         LL_APPEND(gAcl, newAcl);
+        InvalidateACLIndex();
 
         // Convert ACL data into JSON for update to persistent storage
         char *jsonStr = BinToAclJSON(gAcl);
@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "oic_malloc.h"
+#include "oic_string.h"
 #include "policyengine.h"
 #include "amsmgr.h"
 #include "resourcemanager.h"
@@ -33,6 +34,56 @@
 
 #define TAG "SRM-PE"
 
+/**
+ * Number of recent ProcessAccessRequest() results remembered. Set it to 0 to
+ * disable the cache.
+ */
+#ifndef PE_DECISION_CACHE_SIZE
+#ifdef WITH_ARDUINO
+#define PE_DECISION_CACHE_SIZE 0
+#else
+#define PE_DECISION_CACHE_SIZE 64
+#endif
+#endif
+
+#if PE_DECISION_CACHE_SIZE > 0
+/**
+ * A cached ProcessAccessRequest() result. It is only valid for the ACL
+ * generation it was computed from.
+ */
+typedef struct PEDecision
+{
+    bool                valid;
+    uint32_t            aclGeneration;
+    OicUuid_t           subject;
+    uint16_t            permission;
+    char                resource[MAX_URI_LENGTH];
+    SRMAccessResponse_t retVal;
+    bool                matchingAclFound;
+} PEDecision_t;
+
+// Direct mapped: a new decision simply replaces whatever shared its slot.
+static PEDecision_t gDecisionCache[PE_DECISION_CACHE_SIZE];
+
+static PEDecision_t* GetDecisionSlot(const OicUuid_t *subject, const char *resource,
+                                     uint16_t permission)
+{
+    // FNV-1a over subject, resource and permission
+    uint32_t hash = 2166136261u;
+    for(size_t i = 0; i < sizeof(subject->id); i++)
+    {
+        hash = (hash ^ subject->id[i]) * 16777619u;
+    }
+    for(const char *c = resource; *c; c++)
+    {
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    }
+    hash = (hash ^ permission) * 16777619u;
+
+    return &gDecisionCache[hash % PE_DECISION_CACHE_SIZE];
+}
+#endif
+
 /**
  * Return the uint16_t CRUDN permission corresponding to passed CAMethod_t.
  */
@@ -277,14 +328,16 @@ static bool IsAccessWithinValidTime(const OicSecAcl_t *acl)
 
 
 /**
- * Find ACLs containing context->subject.
- * Search each ACL for requested resource.
- * If resource found, check for context->permission and period validity.
+ * Find the first ACL containing context->subject and the requested resource.
+ * If found, check for context->permission and period validity.
  * If the ACL is not found locally and AMACL for the resource is found
  * then sends the request to AMS service for the ACL
  * Set context->retVal to result from first ACL found which contains
  * correct subject AND resource.
  *
+ * Results that don't depend on the time of the request are cached until
+ * the ACL changes.
+ *
  * @retval void
  */
 void ProcessAccessRequest(PEContext_t *context)
@@ -293,49 +346,72 @@ void ProcessAccessRequest(PEContext_t *context)
     if(NULL != context)
     {
         const OicSecAcl_t *currentAcl = NULL;
-        OicSecAcl_t *savePtr = NULL;
+        bool subjectFound = false;
+
+#if PE_DECISION_CACHE_SIZE > 0
+        uint32_t aclGeneration = GetACLGeneration();
+        PEDecision_t *decision = GetDecisionSlot(&context->subject, context->resource,
+                                                 context->permission);
+        if(decision->valid && decision->aclGeneration == aclGeneration &&
+           decision->permission == context->permission &&
+           UuidCmp(&decision->subject, &context->subject) &&
+           0 == strcmp(decision->resource, context->resource))
+        {
+            OC_LOG_V(DEBUG, TAG, "%s:using cached decision" ,__func__);
+            context->retVal = decision->retVal;
+            context->matchingAclFound = decision->matchingAclFound;
+            return;
+        }
+#endif
 
         // Start out assuming subject not found.
         context->retVal = ACCESS_DENIED_SUBJECT_NOT_FOUND;
 
-        // Loop through all ACLs with a matching Subject searching for the right
-        // ACL for this request.
-        do
+        currentAcl = GetACEForResource(&context->subject, context->resource, &subjectFound);
+        if(subjectFound)
         {
-            OC_LOG_V(DEBUG, TAG, "%s: getting ACL..." ,__func__);
-            currentAcl = GetACLResourceData(&context->subject, &savePtr);
+            // Subject was found, so err changes to Rsrc not found for now.
+            context->retVal = ACCESS_DENIED_RESOURCE_NOT_FOUND;
+        }
 
-            if(NULL != currentAcl)
-            {
-                // Found the subject, so how about resource?
-                OC_LOG_V(DEBUG, TAG, "%s:found ACL matching subject" ,__func__);
+        if(NULL != currentAcl)
+        {
+            OC_LOG_V(INFO, TAG, "%s:found matching resource in ACL" ,__func__);
+            context->matchingAclFound = true;
 
-                // Subject was found, so err changes to Rsrc not found for now.
-                context->retVal = ACCESS_DENIED_RESOURCE_NOT_FOUND;
-                OC_LOG_V(DEBUG, TAG, "%s:Searching for resource..." ,__func__);
-                if(IsResourceInAcl(context->resource, currentAcl))
+            // Found the resource, so it's down to valid period & permission.
+            context->retVal = ACCESS_DENIED_INVALID_PERIOD;
+            if(IsAccessWithinValidTime(currentAcl))
+            {
+                context->retVal = ACCESS_DENIED_INSUFFICIENT_PERMISSION;
+                if(IsPermissionAllowingRequest(currentAcl->permission, context->permission))
                 {
-                    OC_LOG_V(INFO, TAG, "%s:found matching resource in ACL" ,__func__);
-                    context->matchingAclFound = true;
-
-                    // Found the resource, so it's down to valid period & permission.
-                    context->retVal = ACCESS_DENIED_INVALID_PERIOD;
-                    if(IsAccessWithinValidTime(currentAcl))
-                    {
-                        context->retVal = ACCESS_DENIED_INSUFFICIENT_PERMISSION;
-                        if(IsPermissionAllowingRequest(currentAcl->permission, context->permission))
-                        {
-                            context->retVal = ACCESS_GRANTED;
-                        }
-                    }
+                    context->retVal = ACCESS_GRANTED;
                 }
             }
-            else
-            {
-                OC_LOG_V(INFO, TAG, "%s:no ACL found matching subject for resource %s",__func__, context->resource);
-            }
         }
-        while((NULL != currentAcl) && (false == context->matchingAclFound));
+        else
+        {
+            OC_LOG_V(INFO, TAG, "%s:no ACL found matching subject for resource %s",__func__, context->resource);
+        }
+
+#if PE_DECISION_CACHE_SIZE > 0
+        // A decision made by a time-restricted ACE may change at any moment.
+        if(NULL == currentAcl || 0 == currentAcl->prdRecrLen)
+        {
+            decision->valid = true;
+            decision->aclGeneration = aclGeneration;
+            decision->permission = context->permission;
+            memcpy(&decision->subject, &context->subject, sizeof(OicUuid_t));
+            OICStrcpy(decision->resource, sizeof(decision->resource), context->resource);
+            decision->retVal = context->retVal;
+            decision->matchingAclFound = context->matchingAclFound;
+        }
+        else
+        {
+            decision->valid = false;
+        }
+#endif
 
         if(IsAccessGranted(context->retVal))
         {
@@ -473,6 +549,9 @@ OCStackResult InitPolicyEngine(PEContext_t *context)
 
     context->amsMgrContext = (AmsMgrContext_t *)OICMalloc(sizeof(AmsMgrContext_t));
     SetPolicyEngineState(context, AWAITING_REQUEST);
+#if PE_DECISION_CACHE_SIZE > 0
+    memset(gDecisionCache, 0, sizeof(gDecisionCache));
+#endif
 
     return OC_STACK_OK;
 }
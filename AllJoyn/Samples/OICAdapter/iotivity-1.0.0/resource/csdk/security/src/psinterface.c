@@ -27,22 +27,57 @@
 #include "resourcemanager.h"
 #include "srmresourcestrings.h"
 #include "srmutility.h"
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifdef WIN32
+#include <windows.h>
+#endif
 
 #define TAG  "SRM-PSI"
 
 //SVR database buffer block size
 #define DB_FILE_SIZE_BLOCK 1023
 
+/*
+ * The SVR database file holds a JSON document, optionally followed by update
+ * records appended by UpdateSVRDatabase(). Each record sits on its own line and
+ * is a JSON object with a single member that replaces the SVR of the same name
+ * (or removes it when the value is null). A line that doesn't parse, such as a
+ * record torn by a crash, is skipped. Records are folded back into the document
+ * once they outgrow it or a damaged one is found. The folded document is first
+ * written to a temporary file, which is then renamed over the database. When
+ * the open handler maps paths to files the C library can't see, the database is
+ * rewritten in place instead and the temporary file is only removed once that
+ * has finished; a database left unreadable is restored from it when loaded.
+ * Handlers that ignore the path have no second file, so their database is
+ * simply rewritten in place.
+ */
+
+// Records smaller than this never trigger a compaction on their own
+#define SVR_DB_MIN_COMPACTION_SIZE 4096
+
+// Suffix of the file a compacted database is written to before being renamed
+#define SVR_DB_TEMP_SUFFIX ".tmp"
+
 /**
- * Gets the Secure Virtual Database size.
- *
- * @param ps  pointer of OCPersistentStorage for the SVR name ("acl", "cred", "pstat" etc).
- *
- * @retval  total size of the SVR database.
+ * What is known about the database file written through 'ps'. Appending is
+ * only allowed while 'ps' matches the current persistent storage handler.
  */
-size_t GetSVRDatabaseSize(OCPersistentStorage* ps)
+typedef struct SVRDatabaseState
+{
+    OCPersistentStorage *ps;
+    size_t              documentSize;   // bytes taken by the JSON document
+    size_t              recordsSize;    // bytes taken by the update records
+    bool                damaged;        // a record had to be skipped
+} SVRDatabaseState_t;
+
+static SVRDatabaseState_t gSVRDbState = { NULL, 0, 0, false };
+
+/**
+ * Gets the size of the file 'ps' opens for 'path'.
+ */
+static size_t GetSVRDatabaseFileSize(OCPersistentStorage* ps, const char *path)
 {
     size_t size = 0;
     if (!ps)
@@ -51,7 +86,7 @@ size_t GetSVRDatabaseSize(OCPersistentStorage* ps)
     }
     size_t bytesRead  = 0;
     char buffer[DB_FILE_SIZE_BLOCK];
-    FILE* fp = ps->open(SVR_DB_FILE_NAME, "r");
+    FILE* fp = ps->open(path, "r");
     if (fp)
     {
         do
@@ -65,20 +100,26 @@ size_t GetSVRDatabaseSize(OCPersistentStorage* ps)
 }
 
 /**
- * Reads the Secure Virtual Database from PS into dynamically allocated
- * memory buffer.
+ * Gets the Secure Virtual Database size.
  *
- * @note Caller of this method MUST use OICFree() method to release memory
- *       referenced by return value.
+ * @param ps  pointer of OCPersistentStorage for the SVR name ("acl", "cred", "pstat" etc).
  *
- * @retval  reference to memory buffer containing SVR database.
+ * @retval  total size of the SVR database.
  */
-char * GetSVRDatabase()
+size_t GetSVRDatabaseSize(OCPersistentStorage* ps)
+{
+    return GetSVRDatabaseFileSize(ps, SVR_DB_FILE_NAME);
+}
+
+/**
+ * Reads the SVR database file, document and update records, as it is on disk,
+ * or the file 'ps' opens for 'path'.
+ */
+static char * ReadSVRDatabaseFile(OCPersistentStorage* ps, const char *path)
 {
     char * jsonStr = NULL;
     FILE * fp = NULL;
-    OCPersistentStorage* ps = SRMGetPersistentStorageHandler();
-    int size = GetSVRDatabaseSize(ps);
+    size_t size = GetSVRDatabaseFileSize(ps, path);
     if (0 == size)
     {
         OC_LOG (ERROR, TAG, "FindSVRDatabaseSize failed");
@@ -88,7 +129,7 @@ char * GetSVRDatabase()
     if (ps && ps->open)
     {
         // Open default SRM database file. An app could change the path for its server.
-        fp = ps->open(SVR_DB_FILE_NAME, "r");
+        fp = ps->open(path, "r");
         if (fp)
         {
             jsonStr = (char*)OICMalloc(size + 1);
@@ -114,6 +155,344 @@ exit:
     return jsonStr;
 }
 
+static const char * SkipWhitespace(const char *str)
+{
+    while (*str && (unsigned char)*str <= ' ')
+    {
+        str++;
+    }
+    return str;
+}
+
+/**
+ * Applies one update record to the SVR database document.
+ *
+ * @retval  true if 'record' was a well formed update record.
+ */
+static bool ApplySVRDatabaseRecord(cJSON *jsonSVRDb, cJSON *record)
+{
+    if (!record || cJSON_Object != record->type || !record->child ||
+        !record->child->string || record->child->next)
+    {
+        return false;
+    }
+
+    // The detached item keeps its name, so it can be linked in as it is
+    cJSON *item = cJSON_DetachItemFromArray(record, 0);
+    cJSON_DeleteItemFromObject(jsonSVRDb, item->string);
+    if (cJSON_NULL == item->type)
+    {
+        cJSON_Delete(item);
+    }
+    else
+    {
+        cJSON_AddItemToArray(jsonSVRDb, item);
+    }
+    return true;
+}
+
+static bool SVRDatabaseExists(OCPersistentStorage *ps)
+{
+    FILE* fp = ps->open(SVR_DB_FILE_NAME, "r");
+    if (fp)
+    {
+        ps->close(fp);
+        return true;
+    }
+    return false;
+}
+
+static bool WriteSVRDatabaseFile(OCPersistentStorage *ps, const char *path,
+                                 const char *mode, const char *data)
+{
+    bool ret = false;
+    FILE* fp = ps->open(path, mode);
+    if (fp)
+    {
+        size_t length = strlen(data);
+        size_t bytesWritten = ps->write(data, 1, length, fp);
+        ret = (bytesWritten == length);
+        OC_LOG_V(DEBUG, TAG, "Written %d bytes into SVR database file", bytesWritten);
+        ret = (0 == ps->close(fp)) && ret;
+    }
+    else
+    {
+        OC_LOG (ERROR, TAG, "Unable to open SVR database file!! ");
+    }
+    return ret;
+}
+
+static void RemoveSVRDatabaseFile(OCPersistentStorage *ps, const char *path)
+{
+    if (ps->unlink)
+    {
+        ps->unlink(path);
+    }
+    else
+    {
+        remove(path);
+    }
+}
+
+/**
+ * Builds the path of the file a compacted database is written to first.
+ * Caller must OICFree() it.
+ */
+static char * GetSVRDatabaseTempPath()
+{
+    size_t pathSize = strlen(SVR_DB_FILE_NAME) + sizeof(SVR_DB_TEMP_SUFFIX);
+    char *tempPath = (char*)OICMalloc(pathSize);
+    if (tempPath)
+    {
+        snprintf(tempPath, pathSize, "%s%s", SVR_DB_FILE_NAME, SVR_DB_TEMP_SUFFIX);
+    }
+    return tempPath;
+}
+
+/**
+ * Puts back the document of a compaction that was cut short while rewriting
+ * the database in place. Its temporary file still holds the whole document.
+ *
+ * @retval  true if the database was restored.
+ */
+static bool RestoreSVRDatabase(OCPersistentStorage *ps)
+{
+    bool restored = false;
+    char *tempPath = GetSVRDatabaseTempPath();
+    char *tempStr = tempPath ? ReadSVRDatabaseFile(ps, tempPath) : NULL;
+    cJSON *jsonSVRDb = tempStr ? cJSON_Parse(tempStr) : NULL;
+
+    // A handler that ignores the path reads the broken database back instead
+    if (jsonSVRDb)
+    {
+        OC_LOG (WARNING, TAG, "Restoring SVR database from its temporary copy");
+        restored = WriteSVRDatabaseFile(ps, SVR_DB_FILE_NAME, "w", tempStr);
+        if (restored)
+        {
+            RemoveSVRDatabaseFile(ps, tempPath);
+        }
+    }
+
+    cJSON_Delete(jsonSVRDb);
+    OICFree(tempStr);
+    OICFree(tempPath);
+    return restored;
+}
+
+/**
+ * Reads the SVR database and folds any update records into its document.
+ *
+ * @param ps        persistent storage handler to read through.
+ * @param document  set to the merged document, or NULL if there were no
+ *                  records and 'fileStr' can be used as it is.
+ * @param fileStr   set to the file contents. Caller must OICFree() it.
+ *
+ * @retval  OC_STACK_OK for Success, otherwise some error value
+ */
+static OCStackResult LoadSVRDatabase(OCPersistentStorage *ps, cJSON **document, char **fileStr)
+{
+    *document = NULL;
+    *fileStr = ReadSVRDatabaseFile(ps, SVR_DB_FILE_NAME);
+
+    const char *end = NULL;
+    cJSON *jsonSVRDb = *fileStr ? cJSON_ParseWithOpts(*fileStr, &end, 0) : NULL;
+    if (NULL == jsonSVRDb && RestoreSVRDatabase(ps))
+    {
+        OICFree(*fileStr);
+        *fileStr = ReadSVRDatabaseFile(ps, SVR_DB_FILE_NAME);
+        jsonSVRDb = *fileStr ? cJSON_ParseWithOpts(*fileStr, &end, 0) : NULL;
+    }
+    if (NULL == *fileStr)
+    {
+        return OC_STACK_ERROR;
+    }
+    if (NULL == jsonSVRDb)
+    {
+        OC_LOG (ERROR, TAG, "SVR database is not valid JSON");
+        gSVRDbState.ps = NULL;
+        return OC_STACK_ERROR;
+    }
+
+    size_t documentSize = end - *fileStr;
+    const char *record = SkipWhitespace(end);
+    bool damaged = false;
+
+    if ('\0' == *record)
+    {
+        cJSON_Delete(jsonSVRDb);
+        jsonSVRDb = NULL;
+    }
+
+    while (jsonSVRDb && '\0' != *record)
+    {
+        cJSON *jsonRecord = cJSON_ParseWithOpts(record, &end, 0);
+        bool applied = ApplySVRDatabaseRecord(jsonSVRDb, jsonRecord);
+        cJSON_Delete(jsonRecord);
+        if (!applied)
+        {
+            // Most likely a record cut short by a crash. Records never contain
+            // a raw newline, so the next one starts on the next line.
+            OC_LOG (WARNING, TAG, "Skipping damaged record in SVR database");
+            damaged = true;
+            end = strchr(record, '\n');
+            if (NULL == end)
+            {
+                break;
+            }
+        }
+        record = SkipWhitespace(end);
+    }
+
+    gSVRDbState.ps = ps;
+    gSVRDbState.documentSize = documentSize;
+    gSVRDbState.recordsSize = strlen(*fileStr) - documentSize;
+    gSVRDbState.damaged = damaged;
+
+    *document = jsonSVRDb;
+    return OC_STACK_OK;
+}
+
+/**
+ * Reads the Secure Virtual Database from PS into dynamically allocated
+ * memory buffer.
+ *
+ * @note Caller of this method MUST use OICFree() method to release memory
+ *       referenced by return value.
+ *
+ * @retval  reference to memory buffer containing SVR database.
+ */
+char * GetSVRDatabase()
+{
+    cJSON *jsonSVRDb = NULL;
+    char *jsonStr = NULL;
+
+    if (OC_STACK_OK != LoadSVRDatabase(SRMGetPersistentStorageHandler(), &jsonSVRDb, &jsonStr))
+    {
+        OICFree(jsonStr);
+        return NULL;
+    }
+
+    if (jsonSVRDb)
+    {
+        OICFree(jsonStr);
+        jsonStr = cJSON_PrintUnformatted(jsonSVRDb);
+        cJSON_Delete(jsonSVRDb);
+    }
+    return jsonStr;
+}
+
+/**
+ * Renames 'oldPath' over 'newPath' in one step.
+ */
+static bool ReplaceSVRDatabaseFile(const char *oldPath, const char *newPath)
+{
+    // The C library only finds the file if open used the path as it is
+    FILE *fp = fopen(oldPath, "r");
+    if (!fp)
+    {
+        return false;
+    }
+    fclose(fp);
+#ifdef WIN32
+    // rename() refuses to replace an existing file on Windows
+    return MoveFileExA(oldPath, newPath, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    return 0 == rename(oldPath, newPath);
+#endif
+}
+
+/**
+ * Tells whether the file 'ps' opens for 'path' really is a file of its own.
+ * Many open handlers ignore the path and always open the database.
+ */
+static bool OpenHonoursPath(OCPersistentStorage *ps, const char *tempPath)
+{
+    RemoveSVRDatabaseFile(ps, tempPath);
+    FILE *fp = ps->open(tempPath, "r");
+    if (fp)
+    {
+        ps->close(fp);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Rewrites the SVR database as a single document, through a temporary file
+ * where the handler allows it.
+ *
+ * @param dbWritten  set when the database itself was opened for writing, so a
+ *                   failure may have left it damaged.
+ */
+static OCStackResult CompactSVRDatabase(OCPersistentStorage *ps, cJSON *record,
+                                        bool *dbWritten)
+{
+    OCStackResult ret = OC_STACK_ERROR;
+    cJSON *jsonSVRDb = NULL;
+    char *jsonSVRDbStr = NULL;
+    char *tempPath = NULL;
+    bool tempWritten = false;
+    bool replaced = false;
+
+    *dbWritten = false;
+    VERIFY_SUCCESS(TAG, OC_STACK_OK == LoadSVRDatabase(ps, &jsonSVRDb, &jsonSVRDbStr), ERROR);
+    if (NULL == jsonSVRDb)
+    {
+        jsonSVRDb = cJSON_Parse(jsonSVRDbStr);
+        VERIFY_NON_NULL(TAG, jsonSVRDb, ERROR);
+    }
+    OICFree(jsonSVRDbStr);
+    jsonSVRDbStr = NULL;
+
+    VERIFY_SUCCESS(TAG, ApplySVRDatabaseRecord(jsonSVRDb, record), ERROR);
+
+    // Generate string representation of updated SVR database json object
+    jsonSVRDbStr = cJSON_PrintUnformatted(jsonSVRDb);
+    VERIFY_NON_NULL(TAG, jsonSVRDbStr, ERROR);
+
+    tempPath = GetSVRDatabaseTempPath();
+    VERIFY_NON_NULL(TAG, tempPath, ERROR);
+    if (OpenHonoursPath(ps, tempPath))
+    {
+        // A failed write here leaves the database as it was
+        tempWritten = true;
+        VERIFY_SUCCESS(TAG, WriteSVRDatabaseFile(ps, tempPath, "w", jsonSVRDbStr), ERROR);
+        replaced = ReplaceSVRDatabaseFile(tempPath, SVR_DB_FILE_NAME);
+        tempWritten = !replaced;
+    }
+    else
+    {
+        OC_LOG (INFO, TAG, "Open handler ignores its path; rewriting SVR database in place");
+    }
+
+    if (!replaced)
+    {
+        *dbWritten = true;
+        VERIFY_SUCCESS(TAG, WriteSVRDatabaseFile(ps, SVR_DB_FILE_NAME, "w", jsonSVRDbStr),
+                       ERROR);
+    }
+
+    gSVRDbState.ps = ps;
+    gSVRDbState.documentSize = strlen(jsonSVRDbStr);
+    gSVRDbState.recordsSize = 0;
+    gSVRDbState.damaged = false;
+    ret = OC_STACK_OK;
+
+exit:
+    // The temporary copy outlives a failed rewrite in place so it can be restored
+    if (tempWritten && (OC_STACK_OK == ret || !*dbWritten))
+    {
+        RemoveSVRDatabaseFile(ps, tempPath);
+    }
+    if (OC_STACK_OK != ret && *dbWritten)
+    {
+        gSVRDbState.ps = NULL;
+    }
+    OICFree(tempPath);
+    OICFree(jsonSVRDbStr);
+    cJSON_Delete(jsonSVRDb);
+    return ret;
+}
 
 /**
  * This method is used by a entity handlers of SVR's to update
@@ -127,82 +506,94 @@ exit:
 OCStackResult UpdateSVRDatabase(const char* rsrcName, cJSON* jsonObj)
 {
     OCStackResult ret = OC_STACK_ERROR;
-    cJSON *jsonSVRDb = NULL;
-    OCPersistentStorage* ps = NULL;
-
-    // Read SVR database from PS
-    char* jsonSVRDbStr = GetSVRDatabase();
-    VERIFY_NON_NULL(TAG,jsonSVRDbStr, ERROR);
-
-    // Use cJSON_Parse to parse the existing SVR database
-    jsonSVRDb = cJSON_Parse(jsonSVRDbStr);
-    VERIFY_NON_NULL(TAG,jsonSVRDb, ERROR);
+    cJSON *record = NULL;
+    char *recordStr = NULL;
+    OCPersistentStorage* ps = SRMGetPersistentStorageHandler();
 
-    OICFree(jsonSVRDbStr);
-    jsonSVRDbStr = NULL;
+    VERIFY_NON_NULL(TAG, rsrcName, ERROR);
+    VERIFY_SUCCESS(TAG, ps && ps->open, ERROR);
 
     //If Cred resource gets updated with empty list then delete the Cred
     //object from database.
     if(NULL == jsonObj && (0 == strcmp(rsrcName, OIC_JSON_CRED_NAME)))
     {
-        cJSON_DeleteItemFromObject(jsonSVRDb, rsrcName);
+        record = cJSON_CreateObject();
+        VERIFY_NON_NULL(TAG, record, ERROR);
+        cJSON_AddNullToObject(record, rsrcName);
     }
-    else if (jsonObj->child )
+    else
     {
-        // Create a duplicate of the JSON object which was passed.
-        cJSON* jsonDuplicateObj = cJSON_Duplicate(jsonObj, 1);
-        VERIFY_NON_NULL(TAG,jsonDuplicateObj, ERROR);
-
-        cJSON* jsonObj = cJSON_GetObjectItem(jsonSVRDb, rsrcName);
-
-        /*
-         ACL, PStat & Doxm resources at least have default entries in the database but
-         Cred resource may have no entries. The first cred resource entry (for provisioning tool)
-         is created when the device is owned by provisioning tool and it's ownerpsk is generated.*/
-        if((strcmp(rsrcName, OIC_JSON_CRED_NAME) == 0 || strcmp(rsrcName, OIC_JSON_CRL_NAME) == 0)
-                                                                                    && (!jsonObj))
+        VERIFY_NON_NULL(TAG, jsonObj, ERROR);
+        if (NULL == jsonObj->child)
         {
-            // Add the fist cred object in existing SVR database json
-            cJSON_AddItemToObject(jsonSVRDb, rsrcName, jsonDuplicateObj->child);
+            // Nothing to change
+            return OC_STACK_OK;
         }
-        else
-        {
-            VERIFY_NON_NULL(TAG,jsonObj, ERROR);
+        record = cJSON_CreateObject();
+        VERIFY_NON_NULL(TAG, record, ERROR);
+        cJSON_AddItemToObject(record, rsrcName, cJSON_Duplicate(jsonObj->child, 1));
+        VERIFY_NON_NULL(TAG, record->child, ERROR);
+    }
 
-            // Replace the modified json object in existing SVR database json
-            cJSON_ReplaceItemInObject(jsonSVRDb, rsrcName, jsonDuplicateObj->child);
-        }
+    recordStr = cJSON_PrintUnformatted(record);
+    VERIFY_NON_NULL(TAG, recordStr, ERROR);
+
+    if (gSVRDbState.ps != ps)
+    {
+        // Learn the layout of the file before adding to it
+        cJSON *jsonSVRDb = NULL;
+        char *jsonSVRDbStr = NULL;
+        OCStackResult loaded = LoadSVRDatabase(ps, &jsonSVRDb, &jsonSVRDbStr);
+        cJSON_Delete(jsonSVRDb);
+        OICFree(jsonSVRDbStr);
+        VERIFY_SUCCESS(TAG, OC_STACK_OK == loaded, ERROR);
     }
 
-    // Generate string representation of updated SVR database json object
-    jsonSVRDbStr = cJSON_PrintUnformatted(jsonSVRDb);
-    VERIFY_NON_NULL(TAG,jsonSVRDbStr, ERROR);
+    size_t recordSize = strlen(recordStr) + 1;
+    size_t recordsLimit = gSVRDbState.documentSize > SVR_DB_MIN_COMPACTION_SIZE ?
+                          gSVRDbState.documentSize : SVR_DB_MIN_COMPACTION_SIZE;
 
-    // Update the persistent storage with new SVR database
-    ps = SRMGetPersistentStorageHandler();
-    if (ps && ps->open)
+    if (gSVRDbState.damaged || gSVRDbState.recordsSize + recordSize > recordsLimit)
     {
-        FILE* fp = ps->open(SVR_DB_FILE_NAME, "w");
-        if (fp)
+        bool dbWritten = false;
+        ret = CompactSVRDatabase(ps, record, &dbWritten);
+        if (OC_STACK_OK == ret || dbWritten)
         {
-            size_t bytesWritten = ps->write(jsonSVRDbStr, 1, strlen(jsonSVRDbStr), fp);
-            if (bytesWritten == strlen(jsonSVRDbStr))
-            {
-                ret = OC_STACK_OK;
-            }
-            OC_LOG_V(DEBUG, TAG, "Written %d bytes into SVR database file", bytesWritten);
-            ps->close(fp);
-            fp = NULL;
+            goto exit;
+        }
+        // The database is as it was; keep the update as a record instead
+        OC_LOG (WARNING, TAG, "SVR database not compacted, appending update");
+    }
+
+    if (!SVRDatabaseExists(ps))
+    {
+        OC_LOG (ERROR, TAG, "SVR database is missing");
+        gSVRDbState.ps = NULL;
+    }
+    else
+    {
+        // Records start on a new line so a torn one never swallows the next
+        char *line = (char*)OICMalloc(recordSize + 1);
+        VERIFY_NON_NULL(TAG, line, ERROR);
+        line[0] = '\n';
+        memcpy(line + 1, recordStr, recordSize);
+
+        if (WriteSVRDatabaseFile(ps, SVR_DB_FILE_NAME, "a", line))
+        {
+            gSVRDbState.recordsSize += recordSize;
+            ret = OC_STACK_OK;
         }
         else
         {
-            OC_LOG (ERROR, TAG, "Unable to open SVR database file!! ");
+            // The file may now end in a partial record
+            gSVRDbState.ps = NULL;
         }
+        OICFree(line);
     }
 
 exit:
-    OICFree(jsonSVRDbStr);
-    cJSON_Delete(jsonSVRDb);
+    OICFree(recordStr);
+    cJSON_Delete(record);
 
     return ret;
 }
@@ -183,6 +183,7 @@ TEST(ACLResourceTest, GetACLResourceTests)
     if (jsonStr)
     {
         gAcl = JSONToAclBin(jsonStr);
+        InvalidateACLIndex();
         EXPECT_TRUE(NULL != gAcl);
 
         // Verify that ACL file contains 2 ACE entries for 'WILDCARD' subject
@@ -202,6 +203,7 @@ TEST(ACLResourceTest, GetACLResourceTests)
         /* Perform cleanup */
         DeleteACLList(gAcl);
         gAcl = NULL;
+        InvalidateACLIndex();
         OICFree(jsonStr);
     }
 }
@@ -36,10 +36,16 @@ extern "C" {
 
 #include "policyengine.h"
 #include "doxmresource.h"
+#include "aclresource.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
 
 // test parameters
 PEContext_t g_peContext;
 
+// gAcl is a pointer to the the global ACL used by SRM
+extern OicSecAcl_t  *gAcl;
+
 #ifdef __cplusplus
 }
 #endif
@@ -98,6 +104,132 @@ TEST(PolicyEngineCore, CheckDevOwnerRequest)
 
 }
 
+static OicSecAcl_t* CreateAce(const OicUuid_t *subject, const char *resource1,
+                              const char *resource2, uint16_t permission)
+{
+    OicSecAcl_t *ace = (OicSecAcl_t*)OICCalloc(1, sizeof(OicSecAcl_t));
+    memcpy(&ace->subject, subject, sizeof(OicUuid_t));
+    ace->resourcesLen = resource2 ? 2 : 1;
+    ace->resources = (char**)OICCalloc(ace->resourcesLen, sizeof(char*));
+    ace->resources[0] = OICStrdup(resource1);
+    if(resource2)
+    {
+        ace->resources[1] = OICStrdup(resource2);
+    }
+    ace->permission = permission;
+    ace->ownersLen = 1;
+    ace->owners = (OicUuid_t*)OICCalloc(1, sizeof(OicUuid_t));
+    return ace;
+}
+
+TEST(PolicyEngineCore, CheckPermissionUsesFirstMatchingAce)
+{
+    OicSecAcl_t *aclA1 = CreateAce(&g_subjectIdA, g_resource1, NULL, PERMISSION_READ);
+    OicSecAcl_t *aclA2 = CreateAce(&g_subjectIdA, "*", NULL, PERMISSION_FULL_CONTROL);
+    aclA1->next = aclA2;
+    gAcl = aclA1;
+    InvalidateACLIndex();
+
+    // The resource-specific ACE comes first, so it decides.
+    EXPECT_EQ(ACCESS_DENIED_INSUFFICIENT_PERMISSION,
+        CheckPermission(&g_peContext, &g_subjectIdA, g_resource1, PERMISSION_WRITE));
+    EXPECT_EQ(ACCESS_GRANTED,
+        CheckPermission(&g_peContext, &g_subjectIdA, g_resource1, PERMISSION_READ));
+    EXPECT_EQ(ACCESS_GRANTED,
+        CheckPermission(&g_peContext, &g_subjectIdA, g_resource2, PERMISSION_WRITE));
+    EXPECT_EQ(ACCESS_DENIED_SUBJECT_NOT_FOUND,
+        CheckPermission(&g_peContext, &g_subjectIdB, g_resource1, PERMISSION_READ));
+
+    // Installing an ACE for subject B must not be masked by the cached denial.
+    OicSecAcl_t *aclB = CreateAce(&g_subjectIdB, g_resource1, NULL, PERMISSION_READ);
+    char *jsonStr = BinToAclJSON(aclB);
+    ASSERT_TRUE(NULL != jsonStr);
+    InstallNewACL(jsonStr);
+    EXPECT_EQ(ACCESS_GRANTED,
+        CheckPermission(&g_peContext, &g_subjectIdB, g_resource1, PERMISSION_READ));
+
+    OICFree(jsonStr);
+    DeleteACLList(aclB);
+    DeleteACLList(gAcl);
+    gAcl = NULL;
+    InvalidateACLIndex();
+}
+
+// The index and the decision cache hold pointers into gAcl, so replacing the
+// list must drop them even if the new ACEs land at the old addresses.
+TEST(PolicyEngineCore, CheckPermissionAfterAclReplaced)
+{
+    gAcl = CreateAce(&g_subjectIdA, g_resource1, NULL, PERMISSION_READ);
+    InvalidateACLIndex();
+    EXPECT_EQ(ACCESS_GRANTED,
+        CheckPermission(&g_peContext, &g_subjectIdA, g_resource1, PERMISSION_READ));
+
+    DeleteACLList(gAcl);
+    gAcl = NULL;
+    InvalidateACLIndex();
+    EXPECT_EQ(ACCESS_DENIED_SUBJECT_NOT_FOUND,
+        CheckPermission(&g_peContext, &g_subjectIdA, g_resource1, PERMISSION_READ));
+
+    gAcl = CreateAce(&g_subjectIdB, g_resource2, NULL, PERMISSION_FULL_CONTROL);
+    InvalidateACLIndex();
+    EXPECT_EQ(ACCESS_DENIED_SUBJECT_NOT_FOUND,
+        CheckPermission(&g_peContext, &g_subjectIdA, g_resource1, PERMISSION_READ));
+    EXPECT_EQ(ACCESS_GRANTED,
+        CheckPermission(&g_peContext, &g_subjectIdB, g_resource2, PERMISSION_WRITE));
+
+    DeleteACLList(gAcl);
+    gAcl = NULL;
+    InvalidateACLIndex();
+}
+
+TEST(PolicyEngineCore, CheckPermissionWithLargeAcl)
+{
+    const int aceCount = 10000;
+    OicSecAcl_t *tail = NULL;
+    char resource[MAX_URI_LENGTH];
+
+    gAcl = NULL;
+    for(int i = 0; i < aceCount; i++)
+    {
+        OicUuid_t subject = {{0}};
+        snprintf((char*)subject.id, sizeof(subject.id), "Subject%08d", i);
+        snprintf(resource, sizeof(resource), "/a/light/%d", i);
+        OicSecAcl_t *ace = CreateAce(&subject, resource, "/a/fan", PERMISSION_READ);
+        if(tail)
+        {
+            tail->next = ace;
+        }
+        else
+        {
+            gAcl = ace;
+        }
+        tail = ace;
+    }
+    InvalidateACLIndex();
+
+    for(int i = 0; i < aceCount; i += 97)
+    {
+        OicUuid_t subject = {{0}};
+        snprintf((char*)subject.id, sizeof(subject.id), "Subject%08d", i);
+        snprintf(resource, sizeof(resource), "/a/light/%d", i);
+        EXPECT_EQ(ACCESS_GRANTED,
+            CheckPermission(&g_peContext, &subject, resource, PERMISSION_READ));
+        EXPECT_EQ(ACCESS_GRANTED,
+            CheckPermission(&g_peContext, &subject, "/a/fan", PERMISSION_READ));
+        EXPECT_EQ(ACCESS_DENIED_INSUFFICIENT_PERMISSION,
+            CheckPermission(&g_peContext, &subject, resource, PERMISSION_WRITE));
+
+        // another subject's resource is not covered by this subject's ACE
+        snprintf(resource, sizeof(resource), "/a/light/%d", (i + 1) % aceCount);
+        EXPECT_NE(ACCESS_GRANTED,
+            CheckPermission(&g_peContext, &subject, resource, PERMISSION_READ));
+    }
+
+    DeleteACLList(gAcl);
+    gAcl = NULL;
+    InvalidateACLIndex();
+}
+
 TEST(PolicyEngineCore, DeInitPolicyEngine)
 {
     DeInitPolicyEngine(&g_peContext);
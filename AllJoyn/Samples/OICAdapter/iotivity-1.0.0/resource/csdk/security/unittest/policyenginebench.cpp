@@ -0,0 +1,116 @@
+//******************************************************************
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+// Cost of CheckPermission against ACLs of different sizes. Not a test: it
+// prints the time per request so the ACL index and decision cache can be
+// compared before and after a change.
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <linux/limits.h>
+#include "ocstack.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "policyengine.h"
+#include "aclresource.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
+
+extern OicSecAcl_t  *gAcl;
+
+#ifdef __cplusplus
+}
+#endif
+
+static OicSecAcl_t* CreateAce(const OicUuid_t *subject, const char *resource1,
+                              const char *resource2, uint16_t permission)
+{
+    OicSecAcl_t *ace = (OicSecAcl_t*)OICCalloc(1, sizeof(OicSecAcl_t));
+    memcpy(&ace->subject, subject, sizeof(OicUuid_t));
+    ace->resourcesLen = 2;
+    ace->resources = (char**)OICCalloc(ace->resourcesLen, sizeof(char*));
+    ace->resources[0] = OICStrdup(resource1);
+    ace->resources[1] = OICStrdup(resource2);
+    ace->permission = permission;
+    ace->ownersLen = 1;
+    ace->owners = (OicUuid_t*)OICCalloc(1, sizeof(OicUuid_t));
+    return ace;
+}
+
+static void BenchCheckPermission(PEContext_t *context, int aceCount, int requestCount)
+{
+    OicSecAcl_t *tail = NULL;
+    char resource[MAX_URI_LENGTH];
+
+    gAcl = NULL;
+    for(int i = 0; i < aceCount; i++)
+    {
+        OicUuid_t subject = {{0}};
+        snprintf((char*)subject.id, sizeof(subject.id), "Subject%08d", i);
+        snprintf(resource, sizeof(resource), "/a/light/%d", i);
+        OicSecAcl_t *ace = CreateAce(&subject, resource, "/a/fan", PERMISSION_READ);
+        if(tail)
+        {
+            tail->next = ace;
+        }
+        else
+        {
+            gAcl = ace;
+        }
+        tail = ace;
+    }
+    InvalidateACLIndex();
+
+    int denied = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < requestCount; i++)
+    {
+        int n = (int)(((long long)i * 7919) % aceCount);
+        OicUuid_t subject = {{0}};
+        snprintf((char*)subject.id, sizeof(subject.id), "Subject%08d", n);
+        snprintf(resource, sizeof(resource), "/a/light/%d", n);
+        if(ACCESS_GRANTED != CheckPermission(context, &subject, resource, PERMISSION_READ))
+        {
+            denied++;
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    printf("CheckPermission with %d ACEs: %.2f us per request%s\n", aceCount,
+           std::chrono::duration<double, std::micro>(elapsed).count() / requestCount,
+           denied ? " (unexpected denials)" : "");
+
+    DeleteACLList(gAcl);
+    gAcl = NULL;
+    InvalidateACLIndex();
+}
+
+int main()
+{
+    PEContext_t context;
+    InitPolicyEngine(&context);
+
+    BenchCheckPermission(&context, 10, 100000);
+    BenchCheckPermission(&context, 1000, 100000);
+    BenchCheckPermission(&context, 10000, 100000);
+
+    DeInitPolicyEngine(&context);
+    return 0;
+}
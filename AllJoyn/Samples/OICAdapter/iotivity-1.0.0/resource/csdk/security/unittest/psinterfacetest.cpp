@@ -0,0 +1,378 @@
+//******************************************************************
+//
+// Copyright 2016 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+#include <string>
+#include <stdlib.h>
+#include <unistd.h>
+#include "ocstack.h"
+#include "oic_malloc.h"
+#include "cJSON.h"
+#include "psinterface.h"
+#include "srmresourcestrings.h"
+
+using namespace std;
+
+// The tests keep their database apart from the one used by the other SRM tests
+#define PSI_TEST_PREFIX "psinterfacetest_"
+
+static string TestPath(const char *path)
+{
+    return string(PSI_TEST_PREFIX) + path;
+}
+
+static FILE *psiopen(const char *path, const char *mode)
+{
+    return fopen(TestPath(path).c_str(), mode);
+}
+
+static int psiunlink(const char *path)
+{
+    return unlink(TestPath(path).c_str());
+}
+
+static OCPersistentStorage gPsi = { psiopen, fread, fwrite, fclose, psiunlink };
+
+// Writes to the temporary database file stop halfway, as on a full disk
+static FILE *gTempFile = NULL;
+
+static FILE *psiopenfailing(const char *path, const char *mode)
+{
+    FILE *fp = psiopen(path, mode);
+    size_t length = strlen(path);
+    if (length > 4 && 0 == strcmp(path + length - 4, ".tmp"))
+    {
+        gTempFile = fp;
+    }
+    return fp;
+}
+
+static size_t psiwritefailing(const void *ptr, size_t size, size_t count, FILE *fp)
+{
+    if (fp == gTempFile)
+    {
+        return fwrite(ptr, size, count / 2, fp);
+    }
+    return fwrite(ptr, size, count, fp);
+}
+
+static OCPersistentStorage gFailingPsi = { psiopenfailing, fread, psiwritefailing, fclose,
+                                           psiunlink };
+
+// Like most applications' handlers, this one always opens the database
+static FILE *psiopendatabase(const char *path, const char *mode)
+{
+    (void)path;
+    return psiopen(SVR_DB_FILE_NAME, mode);
+}
+
+static OCPersistentStorage gPathIgnoringPsi = { psiopendatabase, fread, fwrite, fclose,
+                                                psiunlink };
+
+static const char *TEST_SVR_DB =
+    "{\"acl\":[{\"sub\":\"Kg==\",\"rsrc\":[\"/oic/res\"],\"perms\":2}],"
+    "\"pstat\":{\"isop\":false,\"cm\":0,\"tm\":0}}";
+
+static void WriteTestFile(const char *contents)
+{
+    FILE *fp = fopen(TestPath(SVR_DB_FILE_NAME).c_str(), "w");
+    ASSERT_TRUE(fp != NULL);
+    fputs(contents, fp);
+    fclose(fp);
+}
+
+static string ReadTestFile()
+{
+    string contents;
+    FILE *fp = fopen(TestPath(SVR_DB_FILE_NAME).c_str(), "r");
+    if (fp)
+    {
+        char buf[256];
+        size_t len;
+        while ((len = fread(buf, 1, sizeof(buf), fp)) > 0)
+        {
+            contents.append(buf, len);
+        }
+        fclose(fp);
+    }
+    return contents;
+}
+
+static cJSON *GetTestDatabase()
+{
+    char *jsonStr = GetSVRDatabase();
+    cJSON *jsonSVRDb = jsonStr ? cJSON_Parse(jsonStr) : NULL;
+    OICFree(jsonStr);
+    return jsonSVRDb;
+}
+
+static OCStackResult UpdatePstat(int cm)
+{
+    cJSON *jsonRoot = cJSON_CreateObject();
+    cJSON *jsonPstat = cJSON_CreateObject();
+    cJSON_AddFalseToObject(jsonPstat, "isop");
+    cJSON_AddNumberToObject(jsonPstat, "cm", cm);
+    cJSON_AddNumberToObject(jsonPstat, "tm", 0);
+    cJSON_AddItemToObject(jsonRoot, OIC_JSON_PSTAT_NAME, jsonPstat);
+
+    OCStackResult ret = UpdateSVRDatabase(OIC_JSON_PSTAT_NAME, jsonRoot);
+    cJSON_Delete(jsonRoot);
+    return ret;
+}
+
+static int GetPstatCm(cJSON *jsonSVRDb)
+{
+    cJSON *jsonPstat = cJSON_GetObjectItem(jsonSVRDb, OIC_JSON_PSTAT_NAME);
+    cJSON *jsonCm = jsonPstat ? cJSON_GetObjectItem(jsonPstat, "cm") : NULL;
+    return jsonCm ? jsonCm->valueint : -1;
+}
+
+class PSInterfaceTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        ASSERT_EQ(OC_STACK_OK, OCRegisterPersistentStorageHandler(&gPsi));
+        WriteTestFile(TEST_SVR_DB);
+    }
+
+    virtual void TearDown()
+    {
+        unlink(TestPath(SVR_DB_FILE_NAME).c_str());
+    }
+};
+
+TEST_F(PSInterfaceTest, UpdateIsAppended)
+{
+    // Reading the database lets the updates below append to it
+    cJSON *jsonSVRDb = GetTestDatabase();
+    ASSERT_TRUE(jsonSVRDb != NULL);
+    cJSON_Delete(jsonSVRDb);
+
+    ASSERT_EQ(OC_STACK_OK, UpdatePstat(1));
+    ASSERT_EQ(OC_STACK_OK, UpdatePstat(2));
+
+    string contents = ReadTestFile();
+    EXPECT_EQ(0u, contents.find(TEST_SVR_DB));
+    EXPECT_GT(contents.size(), strlen(TEST_SVR_DB));
+
+    jsonSVRDb = GetTestDatabase();
+    ASSERT_TRUE(jsonSVRDb != NULL);
+    EXPECT_EQ(2, GetPstatCm(jsonSVRDb));
+    EXPECT_TRUE(cJSON_GetObjectItem(jsonSVRDb, OIC_JSON_ACL_NAME) != NULL);
+    cJSON_Delete(jsonSVRDb);
+}
+
+TEST_F(PSInterfaceTest, CredIsDeleted)
+{
+    cJSON *jsonRoot = cJSON_CreateObject();
+    cJSON_AddItemToObject(jsonRoot, OIC_JSON_CRED_NAME, cJSON_CreateArray());
+    ASSERT_EQ(OC_STACK_OK, UpdateSVRDatabase(OIC_JSON_CRED_NAME, jsonRoot));
+    cJSON_Delete(jsonRoot);
+
+    cJSON *jsonSVRDb = GetTestDatabase();
+    ASSERT_TRUE(jsonSVRDb != NULL);
+    EXPECT_TRUE(cJSON_GetObjectItem(jsonSVRDb, OIC_JSON_CRED_NAME) != NULL);
+    cJSON_Delete(jsonSVRDb);
+
+    ASSERT_EQ(OC_STACK_OK, UpdateSVRDatabase(OIC_JSON_CRED_NAME, NULL));
+
+    jsonSVRDb = GetTestDatabase();
+    ASSERT_TRUE(jsonSVRDb != NULL);
+    EXPECT_TRUE(cJSON_GetObjectItem(jsonSVRDb, OIC_JSON_CRED_NAME) == NULL);
+    cJSON_Delete(jsonSVRDb);
+}
+
+TEST_F(PSInterfaceTest, RecordsAreCompacted)
+{
+    cJSON *jsonSVRDb = GetTestDatabase();
+    cJSON_Delete(jsonSVRDb);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        ASSERT_EQ(OC_STACK_OK, UpdatePstat(i));
+    }
+
+    // Only a bounded number of records is ever kept behind the document
+    EXPECT_LT(ReadTestFile().size(), 2u * 4096u + 2u * strlen(TEST_SVR_DB));
+
+    jsonSVRDb = GetTestDatabase();
+    ASSERT_TRUE(jsonSVRDb != NULL);
+    EXPECT_EQ(999, GetPstatCm(jsonSVRDb));
+    cJSON_Delete(jsonSVRDb);
+
+    FILE *fp = fopen(TestPath(SVR_DB_FILE_NAME).append(".tmp").c_str(), "r");
+    EXPECT_TRUE(fp == NULL);
+    if (fp)
+    {
+        fclose(fp);
+    }
+}
+
+TEST_F(PSInterfaceTest, TornRecordIsIgnored)
+{
+    string contents = string(TEST_SVR_DB) +
+                      "\n{\"pstat\":{\"isop\":false,\"cm\":7,\"tm\":0}}"
+                      "\n{\"pstat\":{\"isop\":false,\"cm\":8,";
+    WriteTestFile(contents.c_str());
+
+    cJSON *jsonSVRDb = GetTestDatabase();
+    ASSERT_TRUE(jsonSVRDb != NULL);
+    EXPECT_EQ(7, GetPstatCm(jsonSVRDb));
+    cJSON_Delete(jsonSVRDb);
+
+    // Nothing can be appended after a damaged record, so this rewrites the file
+    ASSERT_EQ(OC_STACK_OK, UpdatePstat(9));
+    jsonSVRDb = cJSON_Parse(ReadTestFile().c_str());
+    ASSERT_TRUE(jsonSVRDb != NULL);
+    EXPECT_EQ(9, GetPstatCm(jsonSVRDb));
+    cJSON_Delete(jsonSVRDb);
+}
+
+TEST_F(PSInterfaceTest, RecordAfterTornRecordIsApplied)
+{
+    string contents = string(TEST_SVR_DB) +
+                      "\n{\"pstat\":{\"isop\":false,\"cm\":8,"
+                      "\n{\"pstat\":{\"isop\":false,\"cm\":9,\"tm\":0}}";
+    WriteTestFile(contents.c_str());
+
+    cJSON *jsonSVRDb = GetTestDatabase();
+    ASSERT_TRUE(jsonSVRDb != NULL);
+    EXPECT_EQ(9, GetPstatCm(jsonSVRDb));
+    cJSON_Delete(jsonSVRDb);
+}
+
+TEST_F(PSInterfaceTest, FailedCompactionKeepsDatabase)
+{
+    ASSERT_EQ(OC_STACK_OK, OCRegisterPersistentStorageHandler(&gFailingPsi));
+
+    // The damaged record makes the next update compact the file
+    string contents = string(TEST_SVR_DB) + "\n{\"pstat\":{\"isop\":false,\"cm\":8,";
+    WriteTestFile(contents.c_str());
+    cJSON *jsonSVRDb = GetTestDatabase();
+    cJSON_Delete(jsonSVRDb);
+
+    ASSERT_EQ(OC_STACK_OK, UpdatePstat(9));
+    gTempFile = NULL;
+
+    // The half written copy went nowhere and the update was appended instead
+    EXPECT_EQ(0u, ReadTestFile().find(contents));
+    FILE *fp = fopen(TestPath(SVR_DB_FILE_NAME).append(".tmp").c_str(), "r");
+    EXPECT_TRUE(fp == NULL);
+    if (fp)
+    {
+        fclose(fp);
+    }
+
+    jsonSVRDb = GetTestDatabase();
+    ASSERT_TRUE(jsonSVRDb != NULL);
+    EXPECT_EQ(9, GetPstatCm(jsonSVRDb));
+    cJSON_Delete(jsonSVRDb);
+}
+
+TEST_F(PSInterfaceTest, PathIgnoringHandlerRewritesDatabase)
+{
+    ASSERT_EQ(OC_STACK_OK, OCRegisterPersistentStorageHandler(&gPathIgnoringPsi));
+
+    string contents = string(TEST_SVR_DB) + "\n{\"pstat\":{\"isop\":false,\"cm\":8,";
+    WriteTestFile(contents.c_str());
+    cJSON *jsonSVRDb = GetTestDatabase();
+    cJSON_Delete(jsonSVRDb);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        ASSERT_EQ(OC_STACK_OK, UpdatePstat(i));
+    }
+
+    // The records were still folded back into the document
+    EXPECT_LT(ReadTestFile().size(), 2u * 4096u + 2u * strlen(TEST_SVR_DB));
+
+    jsonSVRDb = GetTestDatabase();
+    ASSERT_TRUE(jsonSVRDb != NULL);
+    EXPECT_EQ(999, GetPstatCm(jsonSVRDb));
+    cJSON_Delete(jsonSVRDb);
+}
+
+TEST_F(PSInterfaceTest, InterruptedRewriteIsRestored)
+{
+    // gPsi maps paths to files the C library can't see, so the database is
+    // rewritten in place while the temporary copy is kept. Here the rewrite
+    // stopped halfway.
+    string tempPath = TestPath(SVR_DB_FILE_NAME).append(".tmp");
+    FILE *fp = fopen(tempPath.c_str(), "w");
+    ASSERT_TRUE(fp != NULL);
+    fputs(TEST_SVR_DB, fp);
+    fclose(fp);
+    WriteTestFile(string(TEST_SVR_DB).substr(0, 20).c_str());
+
+    cJSON *jsonSVRDb = GetTestDatabase();
+    ASSERT_TRUE(jsonSVRDb != NULL);
+    EXPECT_EQ(0, GetPstatCm(jsonSVRDb));
+    cJSON_Delete(jsonSVRDb);
+
+    EXPECT_EQ(string(TEST_SVR_DB), ReadTestFile());
+    fp = fopen(tempPath.c_str(), "r");
+    EXPECT_TRUE(fp == NULL);
+    if (fp)
+    {
+        fclose(fp);
+    }
+}
+
+TEST_F(PSInterfaceTest, CompactionRenamesTemporaryFile)
+{
+    static OCPersistentStorage psi = { fopen, fread, fwrite, fclose, unlink };
+    ASSERT_EQ(OC_STACK_OK, OCRegisterPersistentStorageHandler(&psi));
+
+    // This handler uses the real file names, so work in a directory of our own
+    char dir[] = "psinterfacetestXXXXXX";
+    ASSERT_TRUE(NULL != mkdtemp(dir));
+    ASSERT_EQ(0, chdir(dir));
+
+    FILE *fp = fopen(SVR_DB_FILE_NAME, "w");
+    ASSERT_TRUE(fp != NULL);
+    fprintf(fp, "%s\n{\"pstat\":{\"isop\":false,\"cm\":8,", TEST_SVR_DB);
+    fclose(fp);
+
+    EXPECT_EQ(OC_STACK_OK, UpdatePstat(9));
+
+    char contents[1024] = {0};
+    fp = fopen(SVR_DB_FILE_NAME, "r");
+    if (fp)
+    {
+        size_t length = fread(contents, 1, sizeof(contents) - 1, fp);
+        contents[length] = '\0';
+        fclose(fp);
+    }
+    cJSON *jsonSVRDb = cJSON_Parse(contents);
+    EXPECT_TRUE(jsonSVRDb != NULL);
+    EXPECT_EQ(9, GetPstatCm(jsonSVRDb));
+    cJSON_Delete(jsonSVRDb);
+
+    unlink(SVR_DB_FILE_NAME);
+    EXPECT_EQ(0, chdir(".."));
+    rmdir(dir);
+}
+
+TEST_F(PSInterfaceTest, UpdateWithoutDatabaseFails)
+{
+    unlink(TestPath(SVR_DB_FILE_NAME).c_str());
+    EXPECT_NE(OC_STACK_OK, UpdatePstat(1));
+}
@@ -35,6 +35,7 @@
 
 #include "ocresource.h"
 #include "cacommon.h"
+#include "uthash.h"
 
 /**
  * Data structure For presence Discovery.
@@ -128,6 +129,18 @@ typedef struct ClientCB {
 
     /** next node in this list.*/
     struct ClientCB    *next;
+
+    /** Handle into the callback index keyed by token.*/
+    UT_hash_handle hhToken;
+
+    /** Handle into the callback index keyed by handle.*/
+    UT_hash_handle hhHandle;
+
+    /** Key of the node index; always points back at this node.*/
+    struct ClientCB *nodeKey;
+
+    /** Handle into the callback index keyed by node.*/
+    UT_hash_handle hhNode;
 } ClientCB;
 
 /**
@@ -192,6 +205,11 @@ bool ClientTokenExist(const CAToken_t token, uint8_t tokenLength);
  *
  * @brief You can search by token OR by handle, but not both.
  *
+ * If several callbacks have the token or handle, the oldest one is returned.
+ * A search by token or handle also deletes callbacks whose TTL has expired: all of
+ * them when nothing is found, otherwise at most once a second. The callback that is
+ * returned is never deleted.
+ *
  * @return address of the node if found, otherwise NULL
  */
 ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
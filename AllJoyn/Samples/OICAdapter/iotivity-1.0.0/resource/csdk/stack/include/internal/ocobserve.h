@@ -29,6 +29,8 @@
 #ifndef OC_OBSERVE_H
 #define OC_OBSERVE_H
 
+#include "uthash.h"
+
 /** Sequence number is a 24 bit field, per https://tools.ietf.org/html/draft-ietf-core-observe-16.*/
 #define MAX_SEQUENCE_NUMBER              (0xFFFFFF)
 
@@ -83,6 +85,12 @@ typedef struct ResourceObserver
     /** requested payload encoding format. */
     OCPayloadFormat acceptFormat;
 
+    /** Handle into the observer index keyed by token.*/
+    UT_hash_handle hhToken;
+
+    /** Handle into the observer index keyed by observation id.*/
+    UT_hash_handle hhId;
+
 } ResourceObserver;
 
 #ifdef WITH_PRESENCE
@@ -23,6 +23,8 @@
 
 #include "octypes.h"
 
+typedef struct OCPayloadArena OCPayloadArena;
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -30,6 +32,34 @@ extern "C"
 OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType type,
         const uint8_t* payload, size_t payloadSize);
 
+/**
+ * Same as OCParsePayload, except that a representation payload is built in a
+ * single arena sized from the message instead of one allocation per node and
+ * string. Meant for callers that only read the result and then drop it.
+ *
+ * The result is read-only: the OCRepPayload setters, OCRepPayloadAppend and
+ * OCRepPayloadDestroy must not be used on it or on anything nested in it, and
+ * it must be freed with OCArenaPayloadDestroy rather than OCPayloadDestroy.
+ * Properties appear in wire order; a name repeated in the message is not
+ * merged and lookups see its first occurrence. Other payload types are parsed
+ * exactly as OCParsePayload does.
+ */
+OCStackResult OCParsePayloadInArena(OCPayload** outPayload, OCPayloadType type,
+        const uint8_t* payload, size_t payloadSize);
+
+OCPayloadArena* OCPayloadArenaCreate(size_t sizeHint);
+
+/** Returns zero-filled memory that lives until the arena is destroyed. */
+void* OCPayloadArenaAlloc(OCPayloadArena* arena, size_t size);
+
+void OCPayloadArenaDestroy(OCPayloadArena* arena);
+
+/** The first payload created in an arena is the one OCArenaPayloadDestroy releases it by. */
+OCRepPayload* OCRepPayloadCreateInArena(OCPayloadArena* arena);
+
+/** Frees a payload returned by OCParsePayloadInArena. */
+void OCArenaPayloadDestroy(OCPayload* payload);
+
 OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t* size);
 
 #ifdef __cplusplus
@@ -31,6 +31,7 @@
 
 #include "ocstackconfig.h"
 #include "occlientcb.h"
+#include "uthash.h"
 
 /** Macro Definitions for observers */
 
@@ -232,6 +233,15 @@ typedef struct OCResource {
 
     /** Pointer of ActionSet which to support group action.*/
     OCActionSet *actionsetHead;
+
+    /** Key of the handle index; always points back at this resource.*/
+    struct OCResource *handleKey;
+
+    /** Handle into the resource index keyed by uri.*/
+    UT_hash_handle hhUri;
+
+    /** Handle into the resource index keyed by handle.*/
+    UT_hash_handle hhHandle;
 } OCResource;
 
 
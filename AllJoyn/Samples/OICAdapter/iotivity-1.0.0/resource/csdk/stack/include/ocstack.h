@@ -114,6 +114,32 @@ OCStackResult OCStopMulticastServer();
  */
 OCStackResult OCProcess();
 
+/**
+ * This function blocks until the stack has received data for ::OCProcess to handle
+ * or until the timeout expires. It allows the main loop of an OC client or server to
+ * sleep instead of polling ::OCProcess on a fixed period. It must not be called while
+ * holding any lock that ::OCProcess callbacks also take.
+ *
+ * @param timeoutMs     Maximum time to wait in milliseconds. Bounds the latency of
+ *                      time driven work such as presence timeouts.
+ *
+ * @return ::OC_STACK_OK if there is work pending, ::OC_STACK_TIMEOUT if the timeout
+ *         expired and ::OC_STACK_NOTIMPL if the stack was built in the single thread model.
+ */
+OCStackResult OCWaitForEvent(uint32_t timeoutMs);
+
+/**
+ * This function makes the stack parse the representation payloads of responses into
+ * a single arena per message instead of one allocation per value and string. It is
+ * off by default.
+ *
+ * Only enable it when every response callback reads the payload without keeping,
+ * modifying or freeing any part of it; the arena is released when the callback returns.
+ *
+ * @param enabled       true to parse response representations into an arena.
+ */
+void OCSetResponseArenaParsing(bool enabled);
+
 /**
  * This function discovers or Perform requests on a specified resource
  * (specified by that Resource's respective URI).
@@ -36,10 +36,11 @@ extern "C" {
  * @param rdPayload Contains structure holding values of OCRDPayload.
  * @param outPayload The payload in the CBOR format converting OCRDPayload
  * structure.
- * @param size Length of the payload.
+ * @param size Size of outPayload on input, length of the payload on output.
  *
- * @return ::OC_STACK_OK returns if successful and OC_STACK_ERROR returns if
- * failed in creating CBOR.
+ * @return 0 if successful. CborErrorOutOfMemory if outPayload is too small, in
+ * which case size is set to the size needed. Another CborError, or a negative
+ * OCStackResult, if failed in creating CBOR.
  */
 int64_t OCRDPayloadToCbor(const OCRDPayload *rdPayload, uint8_t *outPayload, size_t *size);
 
@@ -49,10 +50,10 @@ int64_t OCRDPayloadToCbor(const OCRDPayload *rdPayload, uint8_t *outPayload, siz
  * @param tags Allocated Tag structure
  * @param setMap The cbor map where result will be stored.
  *
- * @return ::OC_STACK_OK returns if successful and OC_STACK_ERROR returns if
- * failed in creating CBOR.
+ * @return 0 if successful. CborErrorOutOfMemory if the buffer of setMap is too
+ * small; encoding carries on so that the encoder counts the size needed.
  */
-OCStackResult OCTagsPayloadToCbor(OCTagsPayload *tags, CborEncoder *setMap);
+int64_t OCTagsPayloadToCbor(OCTagsPayload *tags, CborEncoder *setMap);
 
 /**
  * Converts links structure to cbor map structure
@@ -60,10 +61,10 @@ OCStackResult OCTagsPayloadToCbor(OCTagsPayload *tags, CborEncoder *setMap);
  * @param links Allocated links structure.
  * @param setMap The cbor map where result will be stored.
  *
- * @return ::OC_STACK_OK returns if successful and OC_STACK_ERROR returns if
- * failed in creating CBOR.
+ * @return 0 if successful. CborErrorOutOfMemory if the buffer of setMap is too
+ * small; encoding carries on so that the encoder counts the size needed.
  */
-OCStackResult OCLinksPayloadToCbor(OCLinksPayload *rtPtr, CborEncoder *setMap);
+int64_t OCLinksPayloadToCbor(OCLinksPayload *rtPtr, CborEncoder *setMap);
 
 /**
  * Converts CBOR to OCRDPayload.
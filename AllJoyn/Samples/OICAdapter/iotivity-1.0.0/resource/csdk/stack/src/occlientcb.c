@@ -42,8 +42,119 @@
 /// Module Name
 #define TAG "occlientcb"
 
+/// Interval in coap ticks between sweeps for timed-out callbacks during lookups.
+#define CB_SWEEP_INTERVAL (COAP_TICKS_PER_SECOND)
+
 struct ClientCB *cbList = NULL;
 static OCMulticastNode * mcPresenceNodes = NULL;
+/// Indexes of cbList keyed by token, by handle and by node.
+static struct ClientCB *cbTokenIndex = NULL;
+static struct ClientCB *cbHandleIndex = NULL;
+static struct ClientCB *cbNodeIndex = NULL;
+/// Number of callbacks left out of the token and handle indexes because an older
+/// callback has the same key.
+static size_t cbTokenShadowed = 0;
+static size_t cbHandleShadowed = 0;
+static coap_tick_t lastTimeoutSweep = 0;
+
+/*
+ * The token and handle indexes hold the oldest callback for each key, which is
+ * the one a walk of cbList finds first. A newer callback with the same key only
+ * takes its place in the index when the older one is deleted.
+ */
+static void IndexClientCB(ClientCB *cbNode)
+{
+    ClientCB *indexed = NULL;
+
+    if (cbNode->tokenLength)
+    {
+        HASH_FIND(hhToken, cbTokenIndex, cbNode->token, cbNode->tokenLength, indexed);
+        if (indexed)
+        {
+            cbTokenShadowed++;
+        }
+        else
+        {
+            HASH_ADD_KEYPTR(hhToken, cbTokenIndex, cbNode->token, cbNode->tokenLength,
+                            cbNode);
+        }
+    }
+
+    indexed = NULL;
+    HASH_FIND(hhHandle, cbHandleIndex, &cbNode->handle, sizeof(OCDoHandle), indexed);
+    if (indexed)
+    {
+        cbHandleShadowed++;
+    }
+    else
+    {
+        HASH_ADD(hhHandle, cbHandleIndex, handle, sizeof(OCDoHandle), cbNode);
+    }
+
+    cbNode->nodeKey = cbNode;
+    HASH_ADD(hhNode, cbNodeIndex, nodeKey, sizeof(ClientCB *), cbNode);
+}
+
+/*
+ * Must be called after cbNode has been taken out of cbList.
+ */
+static void UnindexClientCB(ClientCB *cbNode)
+{
+    ClientCB *indexed = NULL;
+    ClientCB *out = NULL;
+
+    if (cbNode->tokenLength)
+    {
+        HASH_FIND(hhToken, cbTokenIndex, cbNode->token, cbNode->tokenLength, indexed);
+        if (indexed != cbNode)
+        {
+            cbTokenShadowed--;
+        }
+        else
+        {
+            HASH_DELETE(hhToken, cbTokenIndex, cbNode);
+            if (cbTokenShadowed)
+            {
+                LL_FOREACH(cbList, out)
+                {
+                    if (out->tokenLength == cbNode->tokenLength &&
+                        memcmp(out->token, cbNode->token, cbNode->tokenLength) == 0)
+                    {
+                        HASH_ADD_KEYPTR(hhToken, cbTokenIndex, out->token, out->tokenLength,
+                                        out);
+                        cbTokenShadowed--;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    indexed = NULL;
+    HASH_FIND(hhHandle, cbHandleIndex, &cbNode->handle, sizeof(OCDoHandle), indexed);
+    if (indexed != cbNode)
+    {
+        cbHandleShadowed--;
+    }
+    else
+    {
+        HASH_DELETE(hhHandle, cbHandleIndex, cbNode);
+        if (cbHandleShadowed)
+        {
+            LL_FOREACH(cbList, out)
+            {
+                if (out->handle == cbNode->handle)
+                {
+                    HASH_ADD(hhHandle, cbHandleIndex, handle, sizeof(OCDoHandle), out);
+                    cbHandleShadowed--;
+                    break;
+                }
+            }
+        }
+    }
+
+    HASH_DELETE(hhNode, cbNodeIndex, cbNode);
+}
 
 OCStackResult
 AddClientCB (ClientCB** clientCB, OCCallbackData* cbData,
@@ -107,6 +218,7 @@ AddClientCB (ClientCB** clientCB, OCCallbackData* cbData,
             cbNode->devAddr = devAddr;          // I own it now
             OC_LOG_V(INFO, TAG, "Added Callback for uri : %s", requestUri);
             LL_APPEND(cbList, cbNode);
+            IndexClientCB(cbNode);
             *clientCB = cbNode;
         }
     }
@@ -154,6 +266,7 @@ void DeleteClientCB(ClientCB * cbNode)
     if(cbNode)
     {
         LL_DELETE(cbList, cbNode);
+        UnindexClientCB(cbNode);
         OC_LOG (INFO, TAG, "Deleting token");
         OC_LOG_BUFFER(INFO, TAG, (const uint8_t *)cbNode->token, cbNode->tokenLength);
         CADestroyToken (cbNode->token);
@@ -217,6 +330,34 @@ static void CheckAndDeleteTimedOutCB(ClientCB* cbNode)
     }
 }
 
+/*
+ * Lookups used to delete timed-out callbacks they walked past. Now that they go
+ * through the indexes, the whole list is swept instead whenever a lookup misses
+ * or at most once every CB_SWEEP_INTERVAL. The node being returned by the lookup,
+ * if any, is never deleted.
+ */
+static void CheckAndDeleteTimedOutCBs(const ClientCB* found)
+{
+    coap_tick_t now;
+    coap_ticks(&now);
+
+    if (found && now - lastTimeoutSweep < CB_SWEEP_INTERVAL)
+    {
+        return;
+    }
+    lastTimeoutSweep = now;
+
+    ClientCB* out = NULL;
+    ClientCB* tmp = NULL;
+    LL_FOREACH_SAFE(cbList, out, tmp)
+    {
+        if (out != found)
+        {
+            CheckAndDeleteTimedOutCB(out);
+        }
+    }
+}
+
 bool ClientTokenExist(const CAToken_t token, uint8_t tokenLength)
 {
     bool bRet = false;
@@ -226,17 +367,8 @@ bool ClientTokenExist(const CAToken_t token, uint8_t tokenLength)
     {
         OC_LOG(INFO, TAG, "Looking for token");
         OC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
-        OC_LOG(INFO, TAG, "\tFound in callback list");
-        LL_FOREACH(cbList, out)
-        {
-            OC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->token, tokenLength);
-
-            if (memcmp(out->token, token, tokenLength) == 0)
-            {
-                bRet = true;
-                break;
-            }
-        }
+        HASH_FIND(hhToken, cbTokenIndex, token, tokenLength, out);
+        bRet = (NULL != out);
     }
 
     return bRet;
@@ -252,27 +384,21 @@ ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
     {
         OC_LOG (INFO, TAG,  "Looking for token");
         OC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
-        OC_LOG(INFO, TAG, "\tFound in callback list");
-        LL_FOREACH(cbList, out)
+        HASH_FIND(hhToken, cbTokenIndex, token, tokenLength, out);
+        CheckAndDeleteTimedOutCBs(out);
+        if(out)
         {
-            OC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->token, tokenLength);
-
-            if(memcmp(out->token, token, tokenLength) == 0)
-            {
-                return out;
-            }
-            CheckAndDeleteTimedOutCB(out);
+            OC_LOG(INFO, TAG, "\tFound in callback list");
+            return out;
         }
     }
     else if(handle)
     {
-        LL_FOREACH(cbList, out)
+        HASH_FIND(hhHandle, cbHandleIndex, &handle, sizeof(OCDoHandle), out);
+        CheckAndDeleteTimedOutCBs(out);
+        if(out)
         {
-            if(out->handle == handle)
-            {
-                return out;
-            }
-            CheckAndDeleteTimedOutCB(out);
+            return out;
         }
     }
     else if(requestUri)
@@ -324,20 +450,23 @@ void DeleteClientCBList()
         DeleteClientCB(out);
     }
     cbList = NULL;
+    cbTokenIndex = NULL;
+    cbHandleIndex = NULL;
+    cbNodeIndex = NULL;
+    cbTokenShadowed = 0;
+    cbHandleShadowed = 0;
 }
 
 void FindAndDeleteClientCB(ClientCB * cbNode)
 {
-    ClientCB* tmp;
+    ClientCB* tmp = NULL;
     if(cbNode)
     {
-        LL_FOREACH(cbList, tmp)
+        // cbNode may already have been deleted, so look it up by address only
+        HASH_FIND(hhNode, cbNodeIndex, &cbNode, sizeof(ClientCB *), tmp);
+        if (tmp)
         {
-            if (cbNode == tmp)
-            {
-                DeleteClientCB(tmp);
-                break;
-            }
+            DeleteClientCB(tmp);
         }
     }
 }
@@ -43,6 +43,12 @@
 #define VERIFY_NON_NULL(arg) { if (!arg) {OC_LOG(FATAL, TAG, #arg " is NULL"); goto exit;} }
 
 static struct ResourceObserver * serverObsList = NULL;
+/** Indexes of serverObsList keyed by token and by observation id. */
+static struct ResourceObserver * serverObsTokenIndex = NULL;
+static struct ResourceObserver * serverObsIdIndex = NULL;
+/** Number of observers left out of the token index because an older one has the
+ *  same token; tokens are chosen by the clients, so two of them may collide. */
+static size_t serverObsTokenShadowed = 0;
 /**
  * Determine observe QOS based on the QOS of the request.
  * The qos passed as a parameter overrides what the client requested.
@@ -411,6 +417,20 @@ OCStackResult AddObserver (const char         *resUri,
         obsNode->resource = resHandle;
 
         LL_APPEND (serverObsList, obsNode);
+        // the index keeps the oldest observer for a token, which a walk of
+        // serverObsList finds first
+        ResourceObserver *indexed = NULL;
+        HASH_FIND (hhToken, serverObsTokenIndex, obsNode->token, tokenLength, indexed);
+        if (indexed)
+        {
+            serverObsTokenShadowed++;
+        }
+        else
+        {
+            HASH_ADD_KEYPTR (hhToken, serverObsTokenIndex, obsNode->token, tokenLength,
+                             obsNode);
+        }
+        HASH_ADD (hhId, serverObsIdIndex, observeId, sizeof(OCObservationId), obsNode);
 
         return OC_STACK_OK;
     }
@@ -431,12 +451,10 @@ ResourceObserver* GetObserverUsingId (const OCObservationId observeId)
 
     if (observeId)
     {
-        LL_FOREACH (serverObsList, out)
+        HASH_FIND (hhId, serverObsIdIndex, &observeId, sizeof(OCObservationId), out);
+        if (out)
         {
-            if (out->observeId == observeId)
-            {
-                return out;
-            }
+            return out;
         }
     }
     OC_LOG(INFO, TAG, "Observer node not found!!");
@@ -451,15 +469,13 @@ ResourceObserver* GetObserverUsingToken (const CAToken_t token, uint8_t tokenLen
     {
         OC_LOG(INFO, TAG, "Looking for token");
         OC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
-        OC_LOG(INFO, TAG, "\tFound token:");
 
-        LL_FOREACH (serverObsList, out)
+        HASH_FIND (hhToken, serverObsTokenIndex, token, tokenLength, out);
+        if (out)
         {
+            OC_LOG(INFO, TAG, "\tFound token:");
             OC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->token, tokenLength);
-            if((memcmp(out->token, token, tokenLength) == 0))
-            {
-                return out;
-            }
+            return out;
         }
     }
     else
@@ -486,6 +502,24 @@ OCStackResult DeleteObserverUsingToken (CAToken_t token, uint8_t tokenLength)
         OC_LOG_V(INFO, TAG, "deleting observer id  %u with token", obsNode->observeId);
         OC_LOG_BUFFER(INFO, TAG, (const uint8_t *)obsNode->token, tokenLength);
         LL_DELETE (serverObsList, obsNode);
+        HASH_DELETE (hhToken, serverObsTokenIndex, obsNode);
+        HASH_DELETE (hhId, serverObsIdIndex, obsNode);
+        if (serverObsTokenShadowed)
+        {
+            // let the next oldest observer with this token take its place
+            ResourceObserver *out = NULL;
+            LL_FOREACH (serverObsList, out)
+            {
+                if (out->tokenLength == obsNode->tokenLength &&
+                    memcmp(out->token, obsNode->token, obsNode->tokenLength) == 0)
+                {
+                    HASH_ADD_KEYPTR (hhToken, serverObsTokenIndex, out->token,
+                                     out->tokenLength, out);
+                    serverObsTokenShadowed--;
+                    break;
+                }
+            }
+        }
         OICFree(obsNode->resUri);
         OICFree(obsNode->query);
         OICFree(obsNode->token);
@@ -507,6 +541,9 @@ void DeleteObserverList()
         }
     }
     serverObsList = NULL;
+    serverObsTokenIndex = NULL;
+    serverObsIdIndex = NULL;
+    serverObsTokenShadowed = 0;
 }
 
 /*
@@ -21,6 +21,7 @@
 
 #include "ocpayload.h"
 #include "octypes.h"
+#include <stddef.h>
 #include <string.h>
 #include "oic_malloc.h"
 #include "oic_string.h"
@@ -28,11 +29,121 @@
 #include "ocresource.h"
 #include "logger.h"
 #include "rdpayload.h"
+#include "ocpayloadcbor.h"
 
 #define TAG "OCPayload"
+
+// Alignment of every block handed out by a payload arena
+#define ARENA_ALIGNMENT 8
+// Smallest chunk an arena allocates
+#define ARENA_MIN_CHUNK_SIZE 256
+
+typedef struct OCPayloadArenaChunk
+{
+    struct OCPayloadArenaChunk* next;
+    size_t size;
+    size_t used;
+} OCPayloadArenaChunk;
+
+struct OCPayloadArena
+{
+    OCPayloadArenaChunk* chunks; // the chunk currently allocated from comes first
+    bool rootUsed;
+    OCRepPayload root;           // first payload created; handed out to the caller
+};
+
 static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val);
 static void FreeOCDiscoveryResource(OCResourcePayload* payload);
 
+static size_t ArenaHeaderSize()
+{
+    return (sizeof(OCPayloadArenaChunk) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+static OCPayloadArenaChunk* OCPayloadArenaNewChunk(size_t size)
+{
+    if (size < ARENA_MIN_CHUNK_SIZE)
+    {
+        size = ARENA_MIN_CHUNK_SIZE;
+    }
+
+    OCPayloadArenaChunk* chunk = (OCPayloadArenaChunk*)OICMalloc(ArenaHeaderSize() + size);
+    if (!chunk)
+    {
+        return NULL;
+    }
+
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    return chunk;
+}
+
+OCPayloadArena* OCPayloadArenaCreate(size_t sizeHint)
+{
+    size_t headerSize = (sizeof(OCPayloadArena) + ARENA_ALIGNMENT - 1) &
+                        ~(size_t)(ARENA_ALIGNMENT - 1);
+    OCPayloadArenaChunk* chunk = OCPayloadArenaNewChunk(headerSize + sizeHint);
+    if (!chunk)
+    {
+        return NULL;
+    }
+
+    // the arena lives at the start of its own first chunk
+    OCPayloadArena* arena = (OCPayloadArena*)((uint8_t*)chunk + ArenaHeaderSize());
+    chunk->used = headerSize;
+    arena->chunks = chunk;
+    arena->rootUsed = false;
+    memset(&arena->root, 0, sizeof(arena->root));
+    return arena;
+}
+
+void* OCPayloadArenaAlloc(OCPayloadArena* arena, size_t size)
+{
+    if (!arena)
+    {
+        return NULL;
+    }
+
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+
+    OCPayloadArenaChunk* chunk = arena->chunks;
+    if (chunk->size - chunk->used < size)
+    {
+        // grow geometrically so a badly underestimated hint costs O(log n) chunks
+        size_t chunkSize = chunk->size * 2;
+        OCPayloadArenaChunk* newChunk = OCPayloadArenaNewChunk(chunkSize > size ? chunkSize : size);
+        if (!newChunk)
+        {
+            return NULL;
+        }
+        newChunk->next = chunk;
+        arena->chunks = newChunk;
+        chunk = newChunk;
+    }
+
+    void* block = (uint8_t*)chunk + ArenaHeaderSize() + chunk->used;
+    chunk->used += size;
+    memset(block, 0, size);
+    return block;
+}
+
+void OCPayloadArenaDestroy(OCPayloadArena* arena)
+{
+    if (!arena)
+    {
+        return;
+    }
+
+    OCPayloadArenaChunk* chunk = arena->chunks;
+    while (chunk)
+    {
+        OCPayloadArenaChunk* next = chunk->next;
+        OICFree(chunk);
+        chunk = next;
+    }
+}
+
 void OCPayloadDestroy(OCPayload* payload)
 {
     if(!payload)
@@ -83,6 +194,51 @@ OCRepPayload* OCRepPayloadCreate()
     return payload;
 }
 
+OCRepPayload* OCRepPayloadCreateInArena(OCPayloadArena* arena)
+{
+    if(!arena)
+    {
+        return NULL;
+    }
+
+    OCRepPayload* payload = NULL;
+    if(!arena->rootUsed)
+    {
+        // the first payload is the arena's own, so destroying it can find the arena
+        payload = &arena->root;
+        arena->rootUsed = true;
+    }
+    else
+    {
+        payload = (OCRepPayload*)OCPayloadArenaAlloc(arena, sizeof(OCRepPayload));
+    }
+
+    if(!payload)
+    {
+        return NULL;
+    }
+
+    payload->base.type = PAYLOAD_TYPE_REPRESENTATION;
+    return payload;
+}
+
+void OCArenaPayloadDestroy(OCPayload* payload)
+{
+    if(!payload)
+    {
+        return;
+    }
+
+    if(payload->type != PAYLOAD_TYPE_REPRESENTATION)
+    {
+        OCPayloadDestroy(payload);
+        return;
+    }
+
+    OCPayloadArenaDestroy((OCPayloadArena*)((uint8_t*)payload -
+                offsetof(OCPayloadArena, root)));
+}
+
 void OCRepPayloadAppend(OCRepPayload* parent, OCRepPayload* child)
 {
     if(!parent)
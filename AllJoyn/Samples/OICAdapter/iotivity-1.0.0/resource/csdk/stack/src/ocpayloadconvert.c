@@ -21,6 +21,7 @@
 #include "ocpayloadcbor.h"
 #include "platform_features.h"
 #include <stdlib.h>
+#include <string.h>
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "logger.h"
@@ -85,45 +86,46 @@ OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t*
 
     OC_LOG_V(INFO, TAG, "Converting payload of type %d", payload->type);
 
-    size_t curSize = INIT_SIZE;
-    uint8_t* out = (uint8_t*)OICCalloc(1, curSize);
-    int64_t err = OCConvertPayloadHelper(payload, out, &curSize);
+    size_t curSize = 0;
+    uint8_t* out = NULL;
+    int64_t err = 0;
 
-    if (err == CborErrorOutOfMemory)
-    {
-        // reallocate "out" and try again!
-        uint8_t* out2 = (uint8_t*)OICRealloc(out, curSize);
+    // Encode into a scratch buffer on the stack first and copy the result out.
+    // When the payload does not fit, tinycbor keeps counting the bytes it would
+    // have written, so the output is allocated at its exact size and encoded a
+    // second time directly into it. Either way there is a single allocation.
+    uint8_t scratch[INIT_SIZE];
+    curSize = sizeof(scratch);
+    err = OCConvertPayloadHelper(payload, scratch, &curSize);
 
-        if (!out2)
+    if (err == 0)
+    {
+        out = (uint8_t*)OICMalloc(curSize);
+        if (!out)
         {
-            OICFree(out);
             return OC_STACK_NO_MEMORY;
         }
-
-        out = out2;
-        err = OCConvertPayloadHelper(payload, out, &curSize);
+        memcpy(out, scratch, curSize);
     }
-
-    if (err == 0)
+    else if (err == CborErrorOutOfMemory)
     {
-        if (curSize < INIT_SIZE)
+        out = (uint8_t*)OICMalloc(curSize);
+        if (!out)
         {
-            uint8_t* out2 = (uint8_t*)OICRealloc(out, curSize);
-
-            if (!out2)
-            {
-                OICFree(out);
-                return OC_STACK_NO_MEMORY;
-            }
-
-            out = out2;
+            return OC_STACK_NO_MEMORY;
         }
+        err = OCConvertPayloadHelper(payload, out, &curSize);
+    }
 
+    if (err == 0 && out)
+    {
         *size = curSize;
         *outPayload = out;
         return OC_STACK_OK;
     }
-    else if (err < 0)
+
+    OICFree(out);
+    if (err < 0)
     {
         return (OCStackResult)-err;
     }
@@ -243,62 +245,30 @@ static int64_t OCConvertDiscoveryPayload(OCDiscoveryPayload* payload, uint8_t* o
 
     if (payload->collectionResources)
     {
-        CborError cborEncoderResult;
-        cborEncoderResult = cbor_encoder_create_array(&encoder, &rootArray, DISCOVERY_CBOR_ARRAY_LEN);
-        if (CborNoError != cborEncoderResult)
-        {
-            OC_LOG(ERROR, TAG, "Failed creating root array.");
-            goto cbor_error;
-        }
+        err = err | cbor_encoder_create_array(&encoder, &rootArray, DISCOVERY_CBOR_ARRAY_LEN);
 
         CborEncoder colArray;
-        cborEncoderResult = cbor_encoder_create_array(&rootArray, &colArray, CborIndefiniteLength);
-        if (CborNoError != cborEncoderResult)
-        {
-            OC_LOG(ERROR, TAG, "Failed creating collection array.");
-            goto cbor_error;
-        }
+        err = err | cbor_encoder_create_array(&rootArray, &colArray, CborIndefiniteLength);
 
         OCResourceCollectionPayload *colResources = payload->collectionResources;
         while (colResources)
         {
-            if (OC_STACK_OK != OCTagsPayloadToCbor(colResources->tags, &colArray))
-            {
-                goto cbor_error;
-            }
-            if (OC_STACK_OK != OCLinksPayloadToCbor(colResources->setLinks, &colArray))
-            {
-                goto cbor_error;
-            }
+            err = err | OCTagsPayloadToCbor(colResources->tags, &colArray);
+            err = err | OCLinksPayloadToCbor(colResources->setLinks, &colArray);
             colResources = colResources->next;
         }
-        cborEncoderResult = cbor_encoder_close_container(&rootArray, &colArray);
-        if (CborNoError != cborEncoderResult)
-        {
-            OC_LOG(ERROR, TAG, "Failed closing collection array.");
-            goto cbor_error;
-        }
-        cborEncoderResult = cbor_encoder_close_container(&encoder, &rootArray);
-        if (CborNoError != cborEncoderResult)
-        {
-            OC_LOG(ERROR, TAG, "Failed closing root array.");
-            goto cbor_error;
-        }
+        err = err | cbor_encoder_close_container(&rootArray, &colArray);
+        err = err | cbor_encoder_close_container(&encoder, &rootArray);
     }
     else if (payload->resources)
     {
         size_t resourceCount =  OCDiscoveryPayloadGetResourceCount(payload);
         err = err | cbor_encoder_create_array(&encoder, &rootArray, resourceCount);
 
-        for(size_t i = 0; i < resourceCount; ++i)
+        // walk the list once instead of looking every resource up by index
+        for(OCResourcePayload* resource = payload->resources; resource; resource = resource->next)
         {
             CborEncoder map;
-            OCResourcePayload* resource = OCDiscoveryPayloadGetResource(payload, i);
-            if(!resource)
-            {
-                OICFree(outPayload);
-                return OC_STACK_INVALID_PARAM;
-            }
 
             err = err | cbor_encoder_create_map(&rootArray, &map, DISCOVERY_CBOR_RES_MAP_LEN);
 
@@ -395,9 +365,6 @@ static int64_t OCConvertDiscoveryPayload(OCDiscoveryPayload* payload, uint8_t* o
     }
 
     return checkError(err, &encoder, outPayload, size);
-cbor_error:
-    OICFree(outPayload);
-    return OC_STACK_ERROR;
 }
 
 static int64_t OCConvertDevicePayload(OCDevicePayload* payload, uint8_t* outPayload,
@@ -41,16 +41,22 @@
 
 #define TAG "OCPayloadParse"
 
+// Representation trees take roughly this many times the size of their CBOR
+// encoding, so most messages fit in the first arena chunk.
+#define ARENA_SIZE_PER_PAYLOAD_BYTE 8
+
 static OCStackResult OCParseDiscoveryPayload(OCPayload** outPayload, CborValue* arrayVal);
 static OCStackResult OCParseDevicePayload(OCPayload** outPayload, CborValue* arrayVal);
 static OCStackResult OCParsePlatformPayload(OCPayload** outPayload, CborValue* arrayVal);
-static bool OCParseSingleRepPayload(OCRepPayload** outPayload, CborValue* repParent);
-static OCStackResult OCParseRepPayload(OCPayload** outPayload, CborValue* arrayVal);
+static bool OCParseSingleRepPayload(OCRepPayload** outPayload, CborValue* repParent,
+        OCPayloadArena* arena);
+static OCStackResult OCParseRepPayload(OCPayload** outPayload, CborValue* arrayVal,
+        OCPayloadArena* arena);
 static OCStackResult OCParsePresencePayload(OCPayload** outPayload, CborValue* arrayVal);
 static OCStackResult OCParseSecurityPayload(OCPayload** outPayload, CborValue* arrayVal);
 
-OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType payloadType,
-        const uint8_t* payload, size_t payloadSize)
+static OCStackResult OCParsePayloadWithArena(OCPayload** outPayload, OCPayloadType payloadType,
+        const uint8_t* payload, size_t payloadSize, OCPayloadArena* arena)
 {
     CborParser parser;
     CborValue rootValue;
@@ -92,7 +98,7 @@ OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType payloadType,
             result = OCParsePlatformPayload(outPayload, &arrayValue);
             break;
         case PAYLOAD_TYPE_REPRESENTATION:
-            result = OCParseRepPayload(outPayload, &arrayValue);
+            result = OCParseRepPayload(outPayload, &arrayValue, arena);
             break;
         case PAYLOAD_TYPE_PRESENCE:
             result = OCParsePresencePayload(outPayload, &arrayValue);
@@ -125,6 +131,46 @@ OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType payloadType,
     return result;
 }
 
+OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType payloadType,
+        const uint8_t* payload, size_t payloadSize)
+{
+    return OCParsePayloadWithArena(outPayload, payloadType, payload, payloadSize, NULL);
+}
+
+OCStackResult OCParsePayloadInArena(OCPayload** outPayload, OCPayloadType payloadType,
+        const uint8_t* payload, size_t payloadSize)
+{
+    if (!outPayload)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    if (payloadType != PAYLOAD_TYPE_REPRESENTATION)
+    {
+        return OCParsePayload(outPayload, payloadType, payload, payloadSize);
+    }
+
+    OCPayloadArena* arena = OCPayloadArenaCreate(payloadSize * ARENA_SIZE_PER_PAYLOAD_BYTE);
+    if (!arena)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+
+    *outPayload = NULL;
+    OCStackResult result = OCParsePayloadWithArena(outPayload, payloadType, payload,
+            payloadSize, arena);
+
+    // On success the first payload owns the arena. Anything else, including a
+    // message with no representation in it, leaves nothing to hand back.
+    if (result != OC_STACK_OK || !*outPayload)
+    {
+        OCPayloadArenaDestroy(arena);
+        *outPayload = NULL;
+    }
+
+    return result;
+}
+
 void OCFreeOCStringLL(OCStringLL* ll);
 
 static OCStackResult OCParseSecurityPayload(OCPayload** outPayload, CborValue* arrayVal)
@@ -818,8 +864,38 @@ static size_t arrayStep(size_t dimensions[MAX_REP_ARRAY_DEPTH], size_t elementNu
         elementNum;
 }
 
+static bool OCParseTextString(const CborValue* value, char** outStr, OCPayloadArena* arena)
+{
+    size_t len = 0;
+    if (!arena)
+    {
+        return cbor_value_dup_text_string(value, outStr, &len, NULL) != CborNoError;
+    }
+
+    // CBOR text isn't NUL terminated, so it can't be referenced in place
+    if (cbor_value_calculate_string_length(value, &len) != CborNoError)
+    {
+        return true;
+    }
+
+    char* str = (char*)OCPayloadArenaAlloc(arena, len + 1);
+    if (!str)
+    {
+        return true;
+    }
+
+    ++len;
+    if (cbor_value_copy_text_string(value, str, &len, NULL) != CborNoError)
+    {
+        return true;
+    }
+
+    *outStr = str;
+    return false;
+}
+
 static bool OCParseArrayFillArray(const CborValue* parent, size_t dimensions[MAX_REP_ARRAY_DEPTH],
-        OCRepPayloadPropType type, void* targetArray)
+        OCRepPayloadPropType type, void* targetArray, OCPayloadArena* arena)
 {
     bool err = false;
     CborValue insideArray;
@@ -828,7 +904,6 @@ static bool OCParseArrayFillArray(const CborValue* parent, size_t dimensions[MAX
 
     size_t i = 0;
     char* tempStr = NULL;
-    size_t tempLen = 0;
     OCRepPayload* tempPl = NULL;
 
     size_t newdim[MAX_REP_ARRAY_DEPTH];
@@ -852,7 +927,8 @@ static bool OCParseArrayFillArray(const CborValue* parent, size_t dimensions[MAX
                     {
                         err = err || OCParseArrayFillArray(&insideArray, newdim,
                             type,
-                            &(((int64_t*)targetArray)[arrayStep(dimensions, i)])
+                            &(((int64_t*)targetArray)[arrayStep(dimensions, i)]),
+                            arena
                             );
                     }
                     break;
@@ -866,7 +942,8 @@ static bool OCParseArrayFillArray(const CborValue* parent, size_t dimensions[MAX
                     {
                         err = err || OCParseArrayFillArray(&insideArray, newdim,
                             type,
-                            &(((double*)targetArray)[arrayStep(dimensions, i)])
+                            &(((double*)targetArray)[arrayStep(dimensions, i)]),
+                            arena
                             );
                     }
                     break;
@@ -880,15 +957,15 @@ static bool OCParseArrayFillArray(const CborValue* parent, size_t dimensions[MAX
                     {
                         err = err || OCParseArrayFillArray(&insideArray, newdim,
                             type,
-                            &(((bool*)targetArray)[arrayStep(dimensions, i)])
+                            &(((bool*)targetArray)[arrayStep(dimensions, i)]),
+                            arena
                             );
                     }
                     break;
                 case OCREP_PROP_STRING:
                     if (dimensions[1] == 0)
                     {
-                        err = err || cbor_value_dup_text_string(&insideArray,
-                                &tempStr, &tempLen, NULL);
+                        err = err || OCParseTextString(&insideArray, &tempStr, arena);
                         ((char**)targetArray)[i] = tempStr;
                         tempStr = NULL;
                     }
@@ -896,14 +973,15 @@ static bool OCParseArrayFillArray(const CborValue* parent, size_t dimensions[MAX
                     {
                         err = err || OCParseArrayFillArray(&insideArray, newdim,
                             type,
-                            &(((char**)targetArray)[arrayStep(dimensions, i)])
+                            &(((char**)targetArray)[arrayStep(dimensions, i)]),
+                            arena
                             );
                     }
                     break;
                 case OCREP_PROP_OBJECT:
                     if (dimensions[1] == 0)
                     {
-                        err = err || OCParseSingleRepPayload(&tempPl, &insideArray);
+                        err = err || OCParseSingleRepPayload(&tempPl, &insideArray, arena);
                         ((OCRepPayload**)targetArray)[i] = tempPl;
                         tempPl = NULL;
                     }
@@ -911,7 +989,8 @@ static bool OCParseArrayFillArray(const CborValue* parent, size_t dimensions[MAX
                     {
                         err = err || OCParseArrayFillArray(&insideArray, newdim,
                             type,
-                            &(((OCRepPayload**)targetArray)[arrayStep(dimensions, i)])
+                            &(((OCRepPayload**)targetArray)[arrayStep(dimensions, i)]),
+                            arena
                             );
                     }
                     break;
@@ -957,7 +1036,7 @@ static bool OCParseArray(OCRepPayload* out, const char* name, CborValue* contain
         return true;
     }
 
-    err = err || OCParseArrayFillArray(container, dimensions, type, arr);
+    err = err || OCParseArrayFillArray(container, dimensions, type, arr, NULL);
 
     switch (type)
     {
@@ -1013,14 +1092,149 @@ static bool OCParseArray(OCRepPayload* out, const char* name, CborValue* contain
     return err;
 }
 
-static bool OCParseSingleRepPayload(OCRepPayload** outPayload, CborValue* repParent)
+// Parses a property value straight into an arena value node
+static bool OCParseArenaValue(OCRepPayloadValue* out, CborValue* value, OCPayloadArena* arena)
+{
+    bool err = false;
+
+    switch(cbor_value_get_type(value))
+    {
+        case CborNullType:
+            out->type = OCREP_PROP_NULL;
+            break;
+        case CborIntegerType:
+            out->type = OCREP_PROP_INT;
+            err = cbor_value_get_int64(value, &out->i);
+            break;
+        case CborDoubleType:
+            out->type = OCREP_PROP_DOUBLE;
+            err = cbor_value_get_double(value, &out->d);
+            break;
+        case CborBooleanType:
+            out->type = OCREP_PROP_BOOL;
+            err = cbor_value_get_boolean(value, &out->b);
+            break;
+        case CborTextStringType:
+            out->type = OCREP_PROP_STRING;
+            err = OCParseTextString(value, &out->str, arena);
+            break;
+        case CborMapType:
+            out->type = OCREP_PROP_OBJECT;
+            err = OCParseSingleRepPayload(&out->obj, value, arena);
+            break;
+        case CborArrayType:
+        {
+            OCRepPayloadPropType type;
+            size_t dimensions[MAX_REP_ARRAY_DEPTH];
+            err = OCParseArrayFindDimensionsAndType(value, dimensions, &type);
+            if (err)
+            {
+                OC_LOG(ERROR, TAG, "Array details weren't clear");
+                break;
+            }
+
+            if (type == OCREP_PROP_NULL)
+            {
+                out->type = OCREP_PROP_NULL;
+                break;
+            }
+
+            void* arr = OCPayloadArenaAlloc(arena, calcDimTotal(dimensions) * getAllocSize(type));
+            if (!arr)
+            {
+                OC_LOG(ERROR, TAG, "Array Parse allocation failed");
+                err = true;
+                break;
+            }
+
+            err = OCParseArrayFillArray(value, dimensions, type, arr, arena);
+
+            out->type = OCREP_PROP_ARRAY;
+            out->arr.type = type;
+            memcpy(out->arr.dimensions, dimensions, sizeof(out->arr.dimensions));
+            switch (type)
+            {
+                case OCREP_PROP_INT:
+                    out->arr.iArray = (int64_t*)arr;
+                    break;
+                case OCREP_PROP_DOUBLE:
+                    out->arr.dArray = (double*)arr;
+                    break;
+                case OCREP_PROP_BOOL:
+                    out->arr.bArray = (bool*)arr;
+                    break;
+                case OCREP_PROP_STRING:
+                    out->arr.strArray = (char**)arr;
+                    break;
+                case OCREP_PROP_OBJECT:
+                    out->arr.objArray = (OCRepPayload**)arr;
+                    break;
+                default:
+                    OC_LOG(ERROR, TAG, "Invalid Array type in Parse Array");
+                    err = true;
+                    break;
+            }
+            break;
+        }
+        default:
+            OC_LOG_V(ERROR, TAG, "Parsing rep property, unknown type %d", value->type);
+            err = true;
+            break;
+    }
+
+    return err;
+}
+
+// Appends the space separated tokens of a resource type or interface value to list.
+// In arena mode the tokens point into allValues itself.
+static bool OCParseStringList(OCStringLL** list, char* allValues, OCPayloadArena* arena)
+{
+    OCStringLL** tail = list;
+    while (*tail)
+    {
+        tail = &(*tail)->next;
+    }
+
+    char* savePtr;
+    char* curPtr = strtok_r(allValues, " ", &savePtr);
+    while (curPtr)
+    {
+        char* trimmed = InPlaceStringTrim(curPtr);
+        if (trimmed[0] != '\0')
+        {
+            OCStringLL* node = arena ?
+                (OCStringLL*)OCPayloadArenaAlloc(arena, sizeof(OCStringLL)) :
+                (OCStringLL*)OICCalloc(1, sizeof(OCStringLL));
+            if (!node)
+            {
+                return true;
+            }
+
+            node->value = arena ? trimmed : OICStrdup(trimmed);
+            if (!node->value)
+            {
+                OICFree(node);
+                return true;
+            }
+
+            *tail = node;
+            tail = &node->next;
+        }
+        curPtr = strtok_r(NULL, " ", &savePtr);
+    }
+
+    return false;
+}
+
+static bool OCParseSingleRepPayload(OCRepPayload** outPayload, CborValue* repParent,
+        OCPayloadArena* arena)
 {
     if (!outPayload)
     {
         return false;
     }
 
-    *outPayload = OCRepPayloadCreate();
+    *outPayload = arena ? OCRepPayloadCreateInArena(arena) : OCRepPayloadCreate();
     OCRepPayload* curPayload = *outPayload;
     bool err = false;
     if(!*outPayload)
@@ -1033,8 +1247,7 @@ static bool OCParseSingleRepPayload(OCRepPayload** outPayload, CborValue* repPar
     err = err || cbor_value_map_find_value(repParent, OC_RSRVD_HREF, &curVal);
     if(cbor_value_is_valid(&curVal))
     {
-        err = err || cbor_value_dup_text_string(&curVal, &curPayload->uri, &len,
-            NULL);
+        err = err || OCParseTextString(&curVal, &curPayload->uri, arena);
     }
 
     err = err || cbor_value_map_find_value(repParent, OC_RSRVD_PROPERTY, &curVal);
@@ -1047,25 +1260,16 @@ static bool OCParseSingleRepPayload(OCRepPayload** outPayload, CborValue* repPar
         if(cbor_value_is_text_string(&insidePropValue))
         {
             char* allRt = NULL;
-            err = err || cbor_value_dup_text_string(&insidePropValue, &allRt, &len, NULL);
-
-            char* savePtr;
+            err = err || OCParseTextString(&insidePropValue, &allRt, arena);
 
             if (allRt)
             {
-                char* curPtr = strtok_r(allRt, " ", &savePtr);
-
-                while (curPtr)
-                {
-                    char* trimmed = InPlaceStringTrim(curPtr);
-                    if (trimmed[0] != '\0')
-                    {
-                        OCRepPayloadAddResourceType(curPayload, curPtr);
-                    }
-                    curPtr = strtok_r(NULL, " ", &savePtr);
-                }
+                err = err || OCParseStringList(&curPayload->types, allRt, arena);
+            }
+            if (!arena)
+            {
+                OICFree(allRt);
             }
-            OICFree(allRt);
         }
 
         err = err || cbor_value_map_find_value(&curVal, OC_RSRVD_INTERFACE, &insidePropValue);
@@ -1073,25 +1277,16 @@ static bool OCParseSingleRepPayload(OCRepPayload** outPayload, CborValue* repPar
         if(cbor_value_is_text_string(&insidePropValue))
         {
             char* allIf = NULL;
-            err = err || cbor_value_dup_text_string(&insidePropValue, &allIf, &len, NULL);
-
-            char* savePtr;
+            err = err || OCParseTextString(&insidePropValue, &allIf, arena);
 
             if (allIf)
             {
-                char* curPtr = strtok_r(allIf, " ", &savePtr);
-
-                while (curPtr)
-                {
-                    char* trimmed = InPlaceStringTrim(curPtr);
-                    if (trimmed[0] != '\0')
-                    {
-                        OCRepPayloadAddInterface(curPayload, curPtr);
-                    }
-                    curPtr = strtok_r(NULL, " ", &savePtr);
-                }
+                err = err || OCParseStringList(&curPayload->interfaces, allIf, arena);
+            }
+            if (!arena)
+            {
+                OICFree(allIf);
             }
-            OICFree(allIf);
         }
     }
 
@@ -1101,7 +1296,26 @@ static bool OCParseSingleRepPayload(OCRepPayload** outPayload, CborValue* repPar
         CborValue repMap;
         err = err || cbor_value_enter_container(&curVal, &repMap);
 
-        while(!err && cbor_value_is_valid(&repMap))
+        // Arena nodes are appended in wire order; no lookup, no per-name copies
+        OCRepPayloadValue** valueTail = &curPayload->values;
+        while(arena && !err && cbor_value_is_valid(&repMap))
+        {
+            OCRepPayloadValue* value =
+                (OCRepPayloadValue*)OCPayloadArenaAlloc(arena, sizeof(OCRepPayloadValue));
+            err = !value;
+            err = err || OCParseTextString(&repMap, &value->name, arena);
+            err = err || cbor_value_advance(&repMap);
+            err = err || OCParseArenaValue(value, &repMap, arena);
+            err = err || cbor_value_advance(&repMap);
+
+            if (!err)
+            {
+                *valueTail = value;
+                valueTail = &value->next;
+            }
+        }
+
+        while(!arena && !err && cbor_value_is_valid(&repMap))
         {
             char* name = NULL;
             err = err || cbor_value_dup_text_string(&repMap, &name, &len, NULL);
@@ -1148,7 +1362,7 @@ static bool OCParseSingleRepPayload(OCRepPayload** outPayload, CborValue* repPar
                     }
                     break;
                 case CborMapType:
-                    err = err || OCParseSingleRepPayload(&pl, &repMap);
+                    err = err || OCParseSingleRepPayload(&pl, &repMap, NULL);
                     if (!err)
                     {
                         err = !OCRepPayloadSetPropObjectAsOwner(curPayload, name, pl);
@@ -1170,13 +1384,18 @@ static bool OCParseSingleRepPayload(OCRepPayload** outPayload, CborValue* repPar
 
     if(err)
     {
-        OCRepPayloadDestroy(*outPayload);
+        // arena payloads are released by whoever owns the arena
+        if (!arena)
+        {
+            OCRepPayloadDestroy(*outPayload);
+        }
         *outPayload = NULL;
     }
 
     return err;
 }
-static OCStackResult OCParseRepPayload(OCPayload** outPayload, CborValue* arrayVal)
+static OCStackResult OCParseRepPayload(OCPayload** outPayload, CborValue* arrayVal,
+        OCPayloadArena* arena)
 {
     if (!outPayload)
     {
@@ -1190,7 +1409,7 @@ static OCStackResult OCParseRepPayload(OCPayload** outPayload, CborValue* arrayV
     OCRepPayload* temp = NULL;
     while(!err && cbor_value_is_map(arrayVal))
     {
-         err = err || OCParseSingleRepPayload(&temp, arrayVal);
+         err = err || OCParseSingleRepPayload(&temp, arrayVal, arena);
 
         if(rootPayload == NULL)
         {
@@ -1207,7 +1426,10 @@ static OCStackResult OCParseRepPayload(OCPayload** outPayload, CborValue* arrayV
          err = err || cbor_value_advance(arrayVal);
         if(err)
         {
-            OCRepPayloadDestroy(rootPayload);
+            if (!arena)
+            {
+                OCRepPayloadDestroy(rootPayload);
+            }
             OC_LOG(ERROR, TAG, "CBOR error in ParseRepPayload");
             return OC_STACK_MALFORMED_RESPONSE;
         }
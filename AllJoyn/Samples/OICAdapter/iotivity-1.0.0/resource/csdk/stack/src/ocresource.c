@@ -61,6 +61,7 @@
              TAG, #arg " is NULL"); return (retVal); } }
 
 extern OCResource *headResource;
+extern OCResource *resourceUriIndex;
 static OCPlatformInfo savedPlatformInfo = {0};
 static OCDeviceInfo savedDeviceInfo = {0};
 
@@ -338,14 +339,11 @@ OCResource *FindResourceByUri(const char* resourceUri)
         return NULL;
     }
 
-    OCResource * pointer = headResource;
-    while (pointer)
+    OCResource * pointer = NULL;
+    HASH_FIND(hhUri, resourceUriIndex, resourceUri, strlen(resourceUri), pointer);
+    if (pointer)
     {
-        if (strcmp(resourceUri, pointer->uri) == 0)
-        {
-            return pointer;
-        }
-        pointer = pointer->next;
+        return pointer;
     }
     OC_LOG_V(INFO, TAG, "Resource %s not found", resourceUri);
     return NULL;
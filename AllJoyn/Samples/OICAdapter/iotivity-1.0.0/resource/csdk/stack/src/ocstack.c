@@ -99,6 +99,10 @@ static OCStackState stackState = OC_STACK_UNINITIALIZED;
 
 OCResource *headResource = NULL;
 static OCResource *tailResource = NULL;
+/** Index of the resource list keyed by uri; used by FindResourceByUri. */
+OCResource *resourceUriIndex = NULL;
+/** Index of the resource list keyed by handle. */
+static OCResource *resourceHandleIndex = NULL;
 #ifdef WITH_PRESENCE
 static OCPresenceState presenceState = OC_PRESENCE_UNINITIALIZED;
 static PresenceResource presenceResource;
@@ -107,6 +111,8 @@ static uint32_t PresenceTimeOut[] = {50, 75, 85, 95, 100};
 #endif
 
 static OCMode myStackMode;
+/** Parse response representations with OCParsePayloadInArena; see OCSetResponseArenaParsing. */
+static bool responseArenaParsing = false;
 #ifdef RA_ADAPTER
 //TODO: revisit this design
 static bool gRASetInfo = false;
@@ -155,14 +161,14 @@ static OCDoHandle GenerateInvocationHandle();
 static OCStackResult initResources();
 
 /**
- * Add a resource to the end of the linked list of resources.
+ * Add a resource to the end of the linked list of resources and to the handle index.
  *
  * @param resource Resource to be added
  */
 static void insertResource(OCResource *resource);
 
 /**
- * Find a resource in the linked list of resources.
+ * Find a resource in the handle index of resources.
  *
  * @param resource Resource to be found.
  * @return Pointer to resource that was found in the linked list or NULL if the resource was not
@@ -1052,6 +1058,18 @@ exit:
     return result;
 }
 
+static void DestroyResponsePayload(OCPayload* payload, bool inArena)
+{
+    if (inArena)
+    {
+        OCArenaPayloadDestroy(payload);
+    }
+    else
+    {
+        OCPayloadDestroy(payload);
+    }
+}
+
 void HandleCAResponses(const CAEndpoint_t* endPoint, const CAResponseInfo_t* responseInfo)
 {
     VERIFY_NON_NULL_NR(endPoint, FATAL);
@@ -1151,6 +1169,7 @@ void HandleCAResponses(const CAEndpoint_t* endPoint, const CAResponseInfo_t* res
 
             response.result = CAToOCStackResult(responseInfo->result);
 
+            bool payloadInArena = false;
             if(responseInfo->info.payload &&
                responseInfo->info.payloadSize)
             {
@@ -1220,10 +1239,23 @@ void HandleCAResponses(const CAEndpoint_t* endPoint, const CAResponseInfo_t* res
                     return;
                 }
 
-                if(OC_STACK_OK != OCParsePayload(&response.payload,
+                OCStackResult parseResult;
+                if (responseArenaParsing && type == PAYLOAD_TYPE_REPRESENTATION)
+                {
+                    parseResult = OCParsePayloadInArena(&response.payload,
+                            type,
+                            responseInfo->info.payload,
+                            responseInfo->info.payloadSize);
+                    payloadInArena = (OC_STACK_OK == parseResult);
+                }
+                else
+                {
+                    parseResult = OCParsePayload(&response.payload,
                             type,
                             responseInfo->info.payload,
-                            responseInfo->info.payloadSize))
+                            responseInfo->info.payloadSize);
+                }
+                if(OC_STACK_OK != parseResult)
                 {
                     OC_LOG(ERROR, TAG, "Error converting payload");
                     OCPayloadDestroy(response.payload);
@@ -1261,7 +1293,7 @@ void HandleCAResponses(const CAEndpoint_t* endPoint, const CAResponseInfo_t* res
                 if(response.numRcvdVendorSpecificHeaderOptions > MAX_HEADER_OPTIONS)
                 {
                     OC_LOG(ERROR, TAG, "#header options are more than MAX_HEADER_OPTIONS");
-                    OCPayloadDestroy(response.payload);
+                    DestroyResponsePayload(response.payload, payloadInArena);
                     return;
                 }
 
@@ -1305,7 +1337,7 @@ void HandleCAResponses(const CAEndpoint_t* endPoint, const CAResponseInfo_t* res
                         CA_MSG_ACKNOWLEDGE, 0, NULL, NULL, 0, NULL);
             }
 
-            OCPayloadDestroy(response.payload);
+            DestroyResponsePayload(response.payload, payloadInArena);
         }
         return;
     }
@@ -2806,6 +2838,33 @@ OCStackResult OCProcess()
     return OC_STACK_OK;
 }
 
+OCStackResult OCWaitForEvent(uint32_t timeoutMs)
+{
+    if (stackState != OC_STACK_INITIALIZED)
+    {
+        OC_LOG(ERROR, TAG, "OCStack not initialized");
+        return OC_STACK_ERROR;
+    }
+
+    CAResult_t caResult = CAWaitForRequestResponse(timeoutMs);
+    switch (caResult)
+    {
+        case CA_STATUS_OK:
+            return OC_STACK_OK;
+        case CA_STATUS_FAILED:
+            return OC_STACK_TIMEOUT;
+        case CA_NOT_SUPPORTED:
+            return OC_STACK_NOTIMPL;
+        default:
+            return CAResultToOCResult(caResult);
+    }
+}
+
+void OCSetResponseArenaParsing(bool enabled)
+{
+    responseArenaParsing = enabled;
+}
+
 #ifdef WITH_PRESENCE
 OCStackResult OCStartPresence(const uint32_t ttl)
 {
@@ -2978,21 +3037,12 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
         return OC_STACK_INVALID_PARAM;
     }
 
-    // If the headResource is NULL, then no resources have been created...
-    pointer = headResource;
+    // Repeated URLs are not allowed.  If a repeat is found, exit with an error
+    HASH_FIND(hhUri, resourceUriIndex, uri, strlen(uri), pointer);
     if (pointer)
     {
-        // At least one resources is in the resource list, so we need to search for
-        // repeated URLs, which are not allowed.  If a repeat is found, exit with an error
-        while (pointer)
-        {
-            if (strncmp(uri, pointer->uri, MAX_URI_LENGTH) == 0)
-            {
-                OC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
-                return OC_STACK_INVALID_PARAM;
-            }
-            pointer = pointer->next;
-        }
+        OC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
+        return OC_STACK_INVALID_PARAM;
     }
     // Create the pointer and insert it into the resource list
     pointer = (OCResource *) OICCalloc(1, sizeof(OCResource));
@@ -3012,6 +3062,7 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
         result = OC_STACK_NO_MEMORY;
         goto exit;
     }
+    HASH_ADD_KEYPTR(hhUri, resourceUriIndex, pointer->uri, strlen(pointer->uri), pointer);
 
     // Set properties.  Set OC_ACTIVE
     pointer->resourceProperties = (OCResourceProperty) (resourceProperties
@@ -3743,6 +3794,8 @@ OCStackResult initResources()
 
     headResource = NULL;
     tailResource = NULL;
+    resourceUriIndex = NULL;
+    resourceHandleIndex = NULL;
     // Init Virtual Resources
 #ifdef WITH_PRESENCE
     presenceResource.presenceTTL = OC_DEFAULT_PRESENCE_TTL_SECONDS;
@@ -3781,21 +3834,17 @@ void insertResource(OCResource *resource)
         tailResource = resource;
     }
     resource->next = NULL;
+
+    resource->handleKey = resource;
+    HASH_ADD(hhHandle, resourceHandleIndex, handleKey, sizeof(OCResource *), resource);
 }
 
 OCResource *findResource(OCResource *resource)
 {
-    OCResource *pointer = headResource;
+    OCResource *pointer = NULL;
 
-    while (pointer)
-    {
-        if (pointer == resource)
-        {
-            return resource;
-        }
-        pointer = pointer->next;
-    }
-    return NULL;
+    HASH_FIND(hhHandle, resourceHandleIndex, &resource, sizeof(OCResource *), pointer);
+    return pointer;
 }
 
 void deleteAllResources()
@@ -3838,6 +3887,11 @@ OCStackResult deleteResource(OCResource *resource)
 
     OC_LOG_V (INFO, TAG, "Deleting resource %s", resource->uri);
 
+    if (!findResource(resource))
+    {
+        return OC_STACK_ERROR;
+    }
+
     temp = headResource;
     while (temp)
     {
@@ -3881,6 +3935,12 @@ OCStackResult deleteResource(OCResource *resource)
                 prev->next = temp->next;
             }
 
+            HASH_DELETE(hhHandle, resourceHandleIndex, temp);
+            if (temp->uri)
+            {
+                HASH_DELETE(hhUri, resourceUriIndex, temp);
+            }
+
             deleteResourceElements(temp);
             OICFree(temp);
             return OC_STACK_OK;
@@ -0,0 +1,211 @@
+/* ****************************************************************
+ *
+ * Copyright 2016 Microsoft Corporation All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/*
+ * Request latency of the loop that drives OCProcess: a server resource and
+ * a client in one process exchange GET requests over loopback, while a
+ * thread runs OCProcess either with the old fixed 10 ms sleep or waiting in
+ * OCWaitForEvent as the C++ wrappers do. Prints the latency percentiles of
+ * each loop; it is not a pass/fail test.
+ *
+ *   ocprocessbench [requests]
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ocstack.h"
+#include "ocpayload.h"
+#include "cacommon.h"
+
+#define DEFAULT_REQUESTS    200
+#define MAX_REQUESTS        10000
+/* the sleep of the loop before OCWaitForEvent */
+#define POLL_SLEEP_MS       10
+/* the bound on OCWaitForEvent used by the C++ wrappers */
+#define EVENT_MAX_WAIT_MS   100
+
+/* serializes the stack between the process thread and the client, as the
+ * C++ wrappers do with their csdk lock */
+static pthread_mutex_t g_stackLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_responseCond = PTHREAD_COND_INITIALIZER;
+static volatile int g_running = 0;
+static int g_eventDriven = 0;
+static int g_responded = 0;
+
+static double Now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void *ProcessLoop(void *arg)
+{
+    (void)arg;
+    while (g_running)
+    {
+        pthread_mutex_lock(&g_stackLock);
+        OCProcess();
+        pthread_mutex_unlock(&g_stackLock);
+
+        if (!g_eventDriven || OC_STACK_NOTIMPL == OCWaitForEvent(EVENT_MAX_WAIT_MS))
+        {
+            usleep(POLL_SLEEP_MS * 1000);
+        }
+    }
+    return NULL;
+}
+
+static OCEntityHandlerResult EntityHandler(OCEntityHandlerFlag flag,
+                                           OCEntityHandlerRequest *request, void *param)
+{
+    (void)param;
+    if (!(flag & OC_REQUEST_FLAG) || !request || OC_REST_GET != request->method)
+    {
+        return OC_EH_ERROR;
+    }
+
+    OCRepPayload *payload = OCRepPayloadCreate();
+    OCRepPayloadSetPropInt(payload, "value", 1);
+
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = request->requestHandle;
+    response.resourceHandle = request->resource;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *)payload;
+    OCEntityHandlerResult result = (OC_STACK_OK == OCDoResponse(&response)) ?
+                                   OC_EH_OK : OC_EH_ERROR;
+    OCRepPayloadDestroy(payload);
+    return result;
+}
+
+static OCStackApplicationResult ResponseHandler(void *ctx, OCDoHandle handle,
+                                                OCClientResponse *clientResponse)
+{
+    (void)ctx;
+    (void)handle;
+    (void)clientResponse;
+    /* runs in OCProcess, with g_stackLock held */
+    g_responded = 1;
+    pthread_cond_signal(&g_responseCond);
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+static int CompareLatency(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void BenchLoop(const char *name, int eventDriven, int requests, double *latency)
+{
+    OCDevAddr dest;
+    memset(&dest, 0, sizeof(dest));
+    dest.adapter = OC_ADAPTER_IP;
+    dest.flags = OC_IP_USE_V4;
+    dest.port = caglobals.ip.u4.port;
+    strcpy(dest.addr, "127.0.0.1");
+
+    OCCallbackData cbData;
+    memset(&cbData, 0, sizeof(cbData));
+    cbData.cb = ResponseHandler;
+
+    pthread_t thread;
+    g_eventDriven = eventDriven;
+    g_running = 1;
+    pthread_create(&thread, NULL, ProcessLoop, NULL);
+
+    int completed = 0;
+    for (int i = 0; i < requests; i++)
+    {
+        /* requests do not all start in step with the loop */
+        usleep((unsigned)(rand() % (POLL_SLEEP_MS * 1000)));
+
+        pthread_mutex_lock(&g_stackLock);
+        g_responded = 0;
+        double start = Now();
+        OCStackResult result = OCDoResource(NULL, OC_REST_GET, "/a/bench", &dest, NULL,
+                                            CT_ADAPTER_IP, OC_LOW_QOS, &cbData, NULL, 0);
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += 2;
+        while (OC_STACK_OK == result && !g_responded &&
+               0 == pthread_cond_timedwait(&g_responseCond, &g_stackLock, &deadline))
+        {
+        }
+        if (g_responded)
+        {
+            latency[completed++] = Now() - start;
+        }
+        pthread_mutex_unlock(&g_stackLock);
+    }
+
+    g_running = 0;
+    pthread_join(thread, NULL);
+
+    if (0 == completed)
+    {
+        printf("%-12s no responses\n", name);
+        return;
+    }
+    qsort(latency, completed, sizeof(double), CompareLatency);
+    printf("%-12s %d requests: p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+           name, completed, latency[completed / 2], latency[completed * 90 / 100],
+           latency[completed * 99 / 100], latency[completed - 1]);
+}
+
+int main(int argc, char **argv)
+{
+    int requests = argc > 1 ? atoi(argv[1]) : DEFAULT_REQUESTS;
+    if (requests <= 0 || requests > MAX_REQUESTS)
+    {
+        fprintf(stderr, "usage: %s [requests 1..%d]\n", argv[0], MAX_REQUESTS);
+        return 1;
+    }
+
+    if (OC_STACK_OK != OCInit(NULL, 0, OC_CLIENT_SERVER))
+    {
+        fprintf(stderr, "OCInit failed\n");
+        return 1;
+    }
+    OCResourceHandle handle;
+    if (OC_STACK_OK != OCCreateResource(&handle, "core.bench", "oic.if.baseline", "/a/bench",
+                                        EntityHandler, NULL, OC_DISCOVERABLE))
+    {
+        fprintf(stderr, "OCCreateResource failed\n");
+        return 1;
+    }
+
+    double *latency = (double *)malloc(requests * sizeof(double));
+    BenchLoop("sleep loop", 0, requests, latency);
+    BenchLoop("event loop", 1, requests, latency);
+    free(latency);
+
+    OCStop();
+    return 0;
+}
@@ -0,0 +1,189 @@
+//******************************************************************
+//
+// Copyright 2016 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+// Cost of the stack's lookups of resources, client callbacks and observers
+// as their number grows. Not a test: it prints the time per lookup so the
+// indexes can be compared before and after a change.
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+extern "C"
+{
+    #include "ocstack.h"
+    #include "ocstackinternal.h"
+    #include "ocresourcehandler.h"
+    #include "ocobserve.h"
+    #include "occlientcb.h"
+    #include "oic_malloc.h"
+}
+
+namespace
+{
+    const int ITERATIONS = 100000;
+
+    // token of entry i; the first byte is never zero
+    void MakeToken(uint8_t *token, int i)
+    {
+        memset(token, 0, CA_MAX_TOKEN_LEN);
+        token[0] = 0xA5;
+        memcpy(&token[1], &i, sizeof(i));
+    }
+
+    template<typename _TLookup>
+    double TimeLookups(_TLookup lookup)
+    {
+        double best = 0;
+        for(int run = 0; run < 3; ++run)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for(int i = 0; i < ITERATIONS; ++i)
+            {
+                lookup(i);
+            }
+            double ns = std::chrono::duration<double, std::nano>(
+                    std::chrono::steady_clock::now() - start).count() / ITERATIONS;
+            if(run == 0 || ns < best)
+            {
+                best = ns;
+            }
+        }
+        return best;
+    }
+
+    void BenchResources(int count)
+    {
+        OCInit(NULL, 0, OC_SERVER);
+
+        char uri[MAX_URI_LENGTH];
+        OCResourceHandle handle = NULL;
+        for(int i = 0; i < count; ++i)
+        {
+            snprintf(uri, sizeof(uri), "/a/bench/%d", i);
+            OCCreateResource(&handle, "core.bench", "core.r", uri, 0, NULL, OC_DISCOVERABLE);
+        }
+
+        int misses = 0;
+        double byUri = TimeLookups([&](int i)
+        {
+            snprintf(uri, sizeof(uri), "/a/bench/%d", (i * 7919) % count);
+            misses += (NULL == FindResourceByUri(uri));
+        });
+        uint8_t numTypes = 0;
+        double byHandle = TimeLookups([&](int)
+        {
+            misses += (OC_STACK_OK != OCGetNumberOfResourceTypes(handle, &numTypes));
+        });
+
+        printf("%6d resources:        by uri %7.1f ns, by handle %7.1f ns%s\n",
+               count, byUri, byHandle, misses ? " (unexpected misses)" : "");
+        OCStop();
+    }
+
+    void BenchClientCBs(int count)
+    {
+        OCInit(NULL, 0, OC_CLIENT);
+
+        OCDoHandle *handles = (OCDoHandle *)OICCalloc(count, sizeof(OCDoHandle));
+        OCCallbackData cbData;
+        memset(&cbData, 0, sizeof(cbData));
+        for(int i = 0; i < count; ++i)
+        {
+            CAToken_t token = (CAToken_t)OICMalloc(CA_MAX_TOKEN_LEN);
+            MakeToken((uint8_t *)token, i);
+            handles[i] = OICMalloc(1);
+            char *uri = (char *)OICMalloc(sizeof("/a/cb"));
+            strcpy(uri, "/a/cb");
+            OCDevAddr *devAddr = (OCDevAddr *)OICCalloc(1, sizeof(OCDevAddr));
+            ClientCB *cbNode = NULL;
+            AddClientCB(&cbNode, &cbData, token, CA_MAX_TOKEN_LEN, &handles[i],
+                        OC_REST_GET, devAddr, uri, NULL, 0);
+        }
+
+        int misses = 0;
+        uint8_t token[CA_MAX_TOKEN_LEN];
+        double byToken = TimeLookups([&](int i)
+        {
+            MakeToken(token, (i * 7919) % count);
+            misses += (NULL == GetClientCB((CAToken_t)token, sizeof(token), NULL, NULL));
+        });
+        double byHandle = TimeLookups([&](int i)
+        {
+            misses += (NULL == GetClientCB(NULL, 0, handles[(i * 7919) % count], NULL));
+        });
+
+        printf("%6d client callbacks: by token %7.1f ns, by handle %7.1f ns%s\n",
+               count, byToken, byHandle, misses ? " (unexpected misses)" : "");
+        DeleteClientCBList();
+        OICFree(handles);
+        OCStop();
+    }
+
+    // observation IDs are 8 bits, so there are at most 255 observers
+    void BenchObservers(int count)
+    {
+        OCInit(NULL, 0, OC_SERVER);
+
+        OCResourceHandle handle = NULL;
+        OCCreateResource(&handle, "core.bench", "core.r", "/a/bench", 0, NULL,
+                         OC_DISCOVERABLE | OC_OBSERVABLE);
+        OCDevAddr devAddr;
+        memset(&devAddr, 0, sizeof(devAddr));
+        uint8_t token[CA_MAX_TOKEN_LEN];
+        for(int i = 0; i < count; ++i)
+        {
+            MakeToken(token, i);
+            AddObserver("/a/bench", NULL, (OCObservationId)(i + 1), (CAToken_t)token,
+                        sizeof(token), (OCResource *)handle, OC_LOW_QOS, OC_FORMAT_CBOR,
+                        &devAddr);
+        }
+
+        int misses = 0;
+        double byToken = TimeLookups([&](int i)
+        {
+            MakeToken(token, (i * 7919) % count);
+            misses += (NULL == GetObserverUsingToken((CAToken_t)token, sizeof(token)));
+        });
+        double byId = TimeLookups([&](int i)
+        {
+            misses += (NULL == GetObserverUsingId((OCObservationId)((i * 7919) % count + 1)));
+        });
+
+        printf("%6d observers:        by token %7.1f ns, by id     %7.1f ns%s\n",
+               count, byToken, byId, misses ? " (unexpected misses)" : "");
+        DeleteObserverList();
+        OCStop();
+    }
+}
+
+int main()
+{
+    BenchResources(10);
+    BenchResources(1000);
+    BenchResources(10000);
+    BenchClientCBs(10);
+    BenchClientCBs(1000);
+    BenchClientCBs(10000);
+    BenchObservers(10);
+    BenchObservers(100);
+    BenchObservers(255);
+    return 0;
+}
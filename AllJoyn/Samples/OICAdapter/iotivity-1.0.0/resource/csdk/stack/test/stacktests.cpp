@@ -23,6 +23,8 @@ extern "C"
 {
     #include "ocstack.h"
     #include "ocstackinternal.h"
+    #include "ocresourcehandler.h"
+    #include "ocobserve.h"
     #include "logger.h"
     #include "oic_malloc.h"
 }
@@ -42,6 +44,7 @@ extern "C"
 #include <string.h>
 
 #include <iostream>
+#include <vector>
 #include <stdint.h>
 
 #include "gtest_helper.h"
@@ -1609,6 +1612,211 @@ TEST(StackResourceAccess, DeleteMiddleResource)
     EXPECT_EQ(OC_STACK_OK, OCStop());
 }
 
+// Lookup timings are in stacklookupbench; these only check the indexes find
+// the right entry among many.
+TEST(StackResource, LookupAmongManyResources)
+{
+    itst::DeadmanTimer killSwitch(std::chrono::seconds(60));
+    OC_LOG(INFO, TAG, "Starting LookupAmongManyResources test");
+    InitStack(OC_SERVER);
+
+    const int numResources = 10000;
+    std::vector<OCResourceHandle> handles(numResources);
+    char uri[MAX_URI_LENGTH];
+    for (int i = 0; i < numResources; ++i)
+    {
+        snprintf(uri, sizeof(uri), "/a/many/%d", i);
+        EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handles[i], "core.many", "core.r", uri,
+                                                0, NULL, OC_DISCOVERABLE));
+    }
+
+    for (int i = 0; i < numResources; i += 97)
+    {
+        snprintf(uri, sizeof(uri), "/a/many/%d", i);
+        EXPECT_EQ((OCResource *)handles[i], FindResourceByUri(uri));
+    }
+    EXPECT_TRUE(NULL == FindResourceByUri("/a/many/none"));
+
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handles[5000]));
+    EXPECT_TRUE(NULL == FindResourceByUri("/a/many/5000"));
+    EXPECT_EQ((OCResource *)handles[5001], FindResourceByUri("/a/many/5001"));
+    uint8_t numResourceTypes = 0;
+    EXPECT_EQ(OC_STACK_OK, OCGetNumberOfResourceTypes(handles[numResources - 1],
+                                                      &numResourceTypes));
+    EXPECT_EQ(1, numResourceTypes);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+static ClientCB* AddTestClientCB(uint8_t tokenByte, uint32_t ttl)
+{
+    OCCallbackData cbData;
+    memset(&cbData, 0, sizeof(cbData));
+
+    CAToken_t token = (CAToken_t)OICMalloc(CA_MAX_TOKEN_LEN);
+    memset(token, tokenByte, CA_MAX_TOKEN_LEN);
+    OCDoHandle handle = OICMalloc(1);
+    char *uri = (char *)OICMalloc(sizeof("/a/cb"));
+    strcpy(uri, "/a/cb");
+    OCDevAddr *devAddr = (OCDevAddr *)OICCalloc(1, sizeof(OCDevAddr));
+
+    ClientCB *cbNode = NULL;
+    EXPECT_EQ(OC_STACK_OK, AddClientCB(&cbNode, &cbData, token, CA_MAX_TOKEN_LEN, &handle,
+                                       OC_REST_GET, devAddr, uri, NULL, ttl));
+    return cbNode;
+}
+
+TEST(StackClientCB, DuplicateTokenFindsOldest)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_CLIENT);
+
+    uint8_t token[CA_MAX_TOKEN_LEN];
+    memset(token, 0x11, sizeof(token));
+    ClientCB *first = AddTestClientCB(0x11, 0);
+    ClientCB *second = AddTestClientCB(0x11, 0);
+    ClientCB *third = AddTestClientCB(0x11, 0);
+
+    EXPECT_EQ(first, GetClientCB((CAToken_t)token, sizeof(token), NULL, NULL));
+    DeleteClientCB(first);
+    EXPECT_EQ(second, GetClientCB((CAToken_t)token, sizeof(token), NULL, NULL));
+    DeleteClientCB(third);
+    EXPECT_EQ(second, GetClientCB((CAToken_t)token, sizeof(token), NULL, NULL));
+    DeleteClientCB(second);
+    EXPECT_TRUE(NULL == GetClientCB((CAToken_t)token, sizeof(token), NULL, NULL));
+    EXPECT_FALSE(ClientTokenExist((CAToken_t)token, sizeof(token)));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackClientCB, LookupDeletesTimedOutCallbacks)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_CLIENT);
+
+    uint8_t token[CA_MAX_TOKEN_LEN];
+    memset(token, 0x22, sizeof(token));
+    // a TTL of one tick has passed by the time of the lookup
+    ClientCB *expired = AddTestClientCB(0x22, 1);
+    ClientCB *live = AddTestClientCB(0x33, 0);
+    OCDoHandle expiredHandle = expired->handle;
+
+    // the callback that is found is returned even if it has timed out...
+    EXPECT_EQ(expired, GetClientCB((CAToken_t)token, sizeof(token), NULL, NULL));
+
+    // ...but a lookup that finds nothing deletes it
+    memset(token, 0x44, sizeof(token));
+    EXPECT_TRUE(NULL == GetClientCB((CAToken_t)token, sizeof(token), NULL, NULL));
+    EXPECT_TRUE(NULL == GetClientCB(NULL, 0, expiredHandle, NULL));
+    EXPECT_EQ(live, GetClientCB(NULL, 0, live->handle, NULL));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackObserve, DuplicateTokenFindsOldest)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.led", "core.rw", "/a/led",
+                                            0, NULL, OC_DISCOVERABLE|OC_OBSERVABLE));
+    OCDevAddr devAddr;
+    memset(&devAddr, 0, sizeof(devAddr));
+    uint8_t token[CA_MAX_TOKEN_LEN];
+    memset(token, 0x55, sizeof(token));
+
+    // two clients may choose the same token
+    for (OCObservationId id = 1; id <= 2; ++id)
+    {
+        EXPECT_EQ(OC_STACK_OK, AddObserver("/a/led", NULL, id, (CAToken_t)token,
+                                           sizeof(token), (OCResource *)handle,
+                                           OC_LOW_QOS, OC_FORMAT_CBOR, &devAddr));
+    }
+
+    ResourceObserver *observer = GetObserverUsingToken((CAToken_t)token, sizeof(token));
+    ASSERT_TRUE(NULL != observer);
+    EXPECT_EQ(1, observer->observeId);
+    EXPECT_EQ(OC_STACK_OK, DeleteObserverUsingToken((CAToken_t)token, sizeof(token)));
+    observer = GetObserverUsingToken((CAToken_t)token, sizeof(token));
+    ASSERT_TRUE(NULL != observer);
+    EXPECT_EQ(2, observer->observeId);
+    EXPECT_EQ(observer, GetObserverUsingId(2));
+    EXPECT_EQ(OC_STACK_OK, DeleteObserverUsingToken((CAToken_t)token, sizeof(token)));
+    EXPECT_TRUE(NULL == GetObserverUsingToken((CAToken_t)token, sizeof(token)));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackClientCB, LookupAmongManyCallbacks)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_CLIENT);
+
+    // the helper fills the token with one byte, so there are 255 distinct ones
+    std::vector<ClientCB *> callbacks;
+    for (int i = 1; i <= 255; ++i)
+    {
+        callbacks.push_back(AddTestClientCB((uint8_t)i, 0));
+    }
+
+    uint8_t token[CA_MAX_TOKEN_LEN];
+    for (int i = 1; i <= 255; ++i)
+    {
+        memset(token, i, sizeof(token));
+        EXPECT_EQ(callbacks[i - 1], GetClientCB((CAToken_t)token, sizeof(token), NULL, NULL));
+        EXPECT_EQ(callbacks[i - 1], GetClientCB(NULL, 0, callbacks[i - 1]->handle, NULL));
+    }
+
+    DeleteClientCB(callbacks[99]);
+    memset(token, 100, sizeof(token));
+    EXPECT_TRUE(NULL == GetClientCB((CAToken_t)token, sizeof(token), NULL, NULL));
+    memset(token, 101, sizeof(token));
+    EXPECT_EQ(callbacks[100], GetClientCB((CAToken_t)token, sizeof(token), NULL, NULL));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackObserve, LookupAmongManyObservers)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.led", "core.rw", "/a/led",
+                                            0, NULL, OC_DISCOVERABLE|OC_OBSERVABLE));
+    OCDevAddr devAddr;
+    memset(&devAddr, 0, sizeof(devAddr));
+    uint8_t token[CA_MAX_TOKEN_LEN];
+
+    // observation IDs are 8 bits, so there are at most 255 observers
+    for (int id = 1; id <= 255; ++id)
+    {
+        memset(token, id, sizeof(token));
+        EXPECT_EQ(OC_STACK_OK, AddObserver("/a/led", NULL, (OCObservationId)id,
+                                           (CAToken_t)token, sizeof(token),
+                                           (OCResource *)handle, OC_LOW_QOS,
+                                           OC_FORMAT_CBOR, &devAddr));
+    }
+
+    for (int id = 1; id <= 255; ++id)
+    {
+        memset(token, id, sizeof(token));
+        ResourceObserver *observer = GetObserverUsingToken((CAToken_t)token, sizeof(token));
+        ASSERT_TRUE(NULL != observer);
+        EXPECT_EQ(id, observer->observeId);
+        EXPECT_EQ(observer, GetObserverUsingId((OCObservationId)id));
+    }
+
+    memset(token, 42, sizeof(token));
+    EXPECT_EQ(OC_STACK_OK, DeleteObserverUsingToken((CAToken_t)token, sizeof(token)));
+    EXPECT_TRUE(NULL == GetObserverUsingToken((CAToken_t)token, sizeof(token)));
+    EXPECT_TRUE(NULL == GetObserverUsingId(42));
+    EXPECT_TRUE(NULL != GetObserverUsingId(43));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
 TEST(PODTests, OCHeaderOption)
 {
     EXPECT_TRUE(std::is_pod<OCHeaderOption>::value);
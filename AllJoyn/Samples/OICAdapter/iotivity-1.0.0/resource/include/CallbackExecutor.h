@@ -0,0 +1,147 @@
+//******************************************************************
+//
+// Copyright 2016 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the declaration of the executor used by InProcClientWrapper to
+ * deliver discovery, response, observe and presence callbacks to the application.
+ */
+
+#ifndef OC_CALLBACK_EXECUTOR_H_
+#define OC_CALLBACK_EXECUTOR_H_
+
+#include <cstdint>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace OC
+{
+    /**
+     * Counters describing the work handled by a callback executor.
+     */
+    struct CallbackExecutorMetrics
+    {
+        /** number of callbacks currently queued. */
+        size_t queueDepth;
+
+        /** largest queue depth observed. */
+        size_t peakQueueDepth;
+
+        /** number of callbacks run on a worker thread. */
+        uint64_t executed;
+
+        /** number of droppable callbacks discarded because the queue was full. */
+        uint64_t dropped;
+
+        CallbackExecutorMetrics()
+            : queueDepth(0), peakQueueDepth(0), executed(0), dropped(0)
+        {}
+    };
+
+    /**
+     * Interface used to run client callbacks off the thread that calls OCProcess.
+     * An implementation can be supplied through PlatformConfig::callbackExecutor.
+     */
+    class ICallbackExecutor
+    {
+    public:
+        typedef std::function<void()> Task;
+        typedef std::shared_ptr<ICallbackExecutor> Ptr;
+
+        virtual ~ICallbackExecutor() {}
+
+        /**
+         * Schedule a callback. This must not block or run the task on the calling
+         * thread, which is usually the one running OCProcess with the stack locked.
+         *
+         * @param task          callback to run.
+         * @param orderingKey   tasks posted with the same non-null key run one at a time
+         *                      in the order they were posted. Tasks with a null key may
+         *                      run in any order.
+         * @param droppable     true if the task may be discarded when the executor is
+         *                      saturated, e.g. an observe notification that a later one
+         *                      supersedes. Other tasks are always queued.
+         *
+         * @return false if the task was dropped.
+         */
+        virtual bool post(Task task, const void* orderingKey = nullptr,
+                          bool droppable = false) = 0;
+
+        virtual CallbackExecutorMetrics getMetrics() const = 0;
+    };
+
+    /**
+     * Default executor: a fixed pool of worker threads with one queue per worker.
+     *
+     * Ordered tasks are pinned to a worker chosen from their key, so observe
+     * notifications for a resource are delivered in sequence. When the total queue
+     * depth, ordered tasks included, reaches the limit droppable tasks are discarded.
+     * Tasks that must run are still queued; there is at most one of those for each
+     * request the application has outstanding.
+     *
+     * The executor may be destroyed from one of its own callbacks. That worker is
+     * then detached and finishes its queue on its own.
+     */
+    class ThreadPoolCallbackExecutor : public ICallbackExecutor
+    {
+    public:
+        ThreadPoolCallbackExecutor(size_t threadCount, size_t maxQueueDepth);
+        virtual ~ThreadPoolCallbackExecutor();
+
+        virtual bool post(Task task, const void* orderingKey = nullptr,
+                          bool droppable = false);
+        virtual CallbackExecutorMetrics getMetrics() const;
+
+    private:
+        struct Worker
+        {
+            std::deque<Task> queue;
+            std::condition_variable cond;
+            std::thread thread;
+        };
+
+        // shared with the workers, so a worker that outlives the executor
+        // can still finish its queue
+        struct State
+        {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<Worker>> workers;
+            size_t maxQueueDepth;
+            size_t nextWorker;
+            bool stop;
+            CallbackExecutorMetrics metrics;
+        };
+
+        static void workerFunc(std::shared_ptr<State> state, Worker& worker);
+
+        ThreadPoolCallbackExecutor(const ThreadPoolCallbackExecutor&) = delete;
+        ThreadPoolCallbackExecutor& operator=(const ThreadPoolCallbackExecutor&) = delete;
+
+        std::shared_ptr<State> m_state;
+    };
+}
+
+#endif // OC_CALLBACK_EXECUTOR_H_
@@ -27,6 +27,7 @@
 #include <iostream>
 
 #include <OCApi.h>
+#include <CallbackExecutor.h>
 #include <IClientWrapper.h>
 #include <InitializeException.h>
 #include <ResourceInitException.h>
@@ -38,48 +39,66 @@ namespace OC
         struct GetContext
         {
             GetCallback callback;
-            GetContext(GetCallback cb) : callback(cb){}
+            ICallbackExecutor::Ptr executor;
+            GetContext(GetCallback cb, ICallbackExecutor::Ptr ex)
+                : callback(cb), executor(ex){}
         };
 
         struct SetContext
         {
             PutCallback callback;
-            SetContext(PutCallback cb) : callback(cb){}
+            ICallbackExecutor::Ptr executor;
+            SetContext(PutCallback cb, ICallbackExecutor::Ptr ex)
+                : callback(cb), executor(ex){}
         };
 
         struct ListenContext
         {
             FindCallback callback;
             std::weak_ptr<IClientWrapper> clientWrapper;
+            ICallbackExecutor::Ptr executor;
+            bool droppable;
 
-            ListenContext(FindCallback cb, std::weak_ptr<IClientWrapper> cw)
-                : callback(cb), clientWrapper(cw){}
+            ListenContext(FindCallback cb, std::weak_ptr<IClientWrapper> cw,
+                          ICallbackExecutor::Ptr ex, bool drop)
+                : callback(cb), clientWrapper(cw), executor(ex), droppable(drop){}
         };
 
         struct DeviceListenContext
         {
             FindDeviceCallback callback;
             IClientWrapper::Ptr clientWrapper;
-            DeviceListenContext(FindDeviceCallback cb, IClientWrapper::Ptr cw)
-                    : callback(cb), clientWrapper(cw){}
+            ICallbackExecutor::Ptr executor;
+            DeviceListenContext(FindDeviceCallback cb, IClientWrapper::Ptr cw,
+                                ICallbackExecutor::Ptr ex)
+                    : callback(cb), clientWrapper(cw), executor(ex){}
         };
 
         struct SubscribePresenceContext
         {
             SubscribeCallback callback;
-            SubscribePresenceContext(SubscribeCallback cb) : callback(cb){}
+            ICallbackExecutor::Ptr executor;
+            bool droppable;
+            SubscribePresenceContext(SubscribeCallback cb, ICallbackExecutor::Ptr ex,
+                                     bool drop)
+                : callback(cb), executor(ex), droppable(drop){}
         };
 
         struct DeleteContext
         {
             DeleteCallback callback;
-            DeleteContext(DeleteCallback cb) : callback(cb){}
+            ICallbackExecutor::Ptr executor;
+            DeleteContext(DeleteCallback cb, ICallbackExecutor::Ptr ex)
+                : callback(cb), executor(ex){}
         };
 
         struct ObserveContext
         {
             ObserveCallback callback;
-            ObserveContext(ObserveCallback cb) : callback(cb){}
+            ICallbackExecutor::Ptr executor;
+            bool droppable;
+            ObserveContext(ObserveCallback cb, ICallbackExecutor::Ptr ex, bool drop)
+                : callback(cb), executor(ex), droppable(drop){}
         };
     }
 
@@ -146,6 +165,9 @@ namespace OC
 
         virtual OCStackResult UnsubscribePresence(OCDoHandle handle);
         OCStackResult GetDefaultQos(QualityOfService& QoS);
+
+        /** Counters of the executor that delivers this wrapper's callbacks. */
+        CallbackExecutorMetrics GetCallbackMetrics() const;
     private:
         void listeningFunc();
         std::string assembleSetResourceUri(std::string uri, const QueryParamsMap& queryParams);
@@ -155,6 +177,7 @@ namespace OC
         std::thread m_listeningThread;
         bool m_threadRun;
         std::weak_ptr<std::recursive_mutex> m_csdkLock;
+        ICallbackExecutor::Ptr m_callbackExecutor;
 
     private:
         PlatformConfig  m_cfg;
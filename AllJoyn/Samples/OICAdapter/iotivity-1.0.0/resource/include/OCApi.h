@@ -42,6 +42,7 @@ namespace OC
     class OCResource;
     class OCResourceRequest;
     class OCResourceResponse;
+    class ICallbackExecutor;
 } // namespace OC
 
 namespace OC
@@ -152,6 +153,14 @@ namespace OC
         /** persistant storage Handler structure (open/read/write/close/unlink). */
         OCPersistentStorage        *ps;
 
+        /** executor for client callbacks; a default thread pool is used if not set. */
+        std::shared_ptr<ICallbackExecutor> callbackExecutor;
+
+        /** let a saturated callback executor discard discovery results, observe
+            notifications and presence events instead of queuing them. Replies to
+            a single request are never discarded. */
+        bool                       dropCallbacksWhenBusy;
+
         public:
             PlatformConfig()
                 : serviceType(ServiceType::InProc),
@@ -161,7 +170,8 @@ namespace OC
                 ipAddress("0.0.0.0"),
                 port(0),
                 QoS(QualityOfService::NaQos),
-                ps(nullptr)
+                ps(nullptr),
+                dropCallbacksWhenBusy(false)
         {}
             PlatformConfig(const ServiceType serviceType_,
             const ModeType mode_,
@@ -176,7 +186,8 @@ namespace OC
                 ipAddress(""),
                 port(0),
                 QoS(QoS_),
-                ps(ps_)
+                ps(ps_),
+                dropCallbacksWhenBusy(false)
         {}
             // for backward compatibility
             PlatformConfig(const ServiceType serviceType_,
@@ -192,7 +203,8 @@ namespace OC
                 ipAddress(ipAddress_),
                 port(port_),
                 QoS(QoS_),
-                ps(ps_)
+                ps(ps_),
+                dropCallbacksWhenBusy(false)
         {}
     };
 
@@ -0,0 +1,162 @@
+//******************************************************************
+//
+// Copyright 2016 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "CallbackExecutor.h"
+
+namespace OC
+{
+    ThreadPoolCallbackExecutor::ThreadPoolCallbackExecutor(size_t threadCount,
+                                                           size_t maxQueueDepth)
+        : m_state(std::make_shared<State>())
+    {
+        m_state->maxQueueDepth = maxQueueDepth ? maxQueueDepth : 1;
+        m_state->nextWorker = 0;
+        m_state->stop = false;
+
+        if(threadCount == 0)
+        {
+            threadCount = 1;
+        }
+
+        for(size_t i = 0; i < threadCount; ++i)
+        {
+            m_state->workers.emplace_back(new Worker());
+        }
+
+        for(auto& worker : m_state->workers)
+        {
+            worker->thread = std::thread(&ThreadPoolCallbackExecutor::workerFunc, m_state,
+                                         std::ref(*worker));
+        }
+    }
+
+    ThreadPoolCallbackExecutor::~ThreadPoolCallbackExecutor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            m_state->stop = true;
+        }
+
+        for(auto& worker : m_state->workers)
+        {
+            worker->cond.notify_all();
+        }
+
+        // workers drain their queues before exiting so no callback is lost. A worker
+        // can't join itself, so when the last reference is released by a callback
+        // that worker is left to finish on its own.
+        std::thread::id self = std::this_thread::get_id();
+        for(auto& worker : m_state->workers)
+        {
+            if(worker->thread.get_id() == self)
+            {
+                worker->thread.detach();
+            }
+            else if(worker->thread.joinable())
+            {
+                worker->thread.join();
+            }
+        }
+    }
+
+    bool ThreadPoolCallbackExecutor::post(Task task, const void* orderingKey, bool droppable)
+    {
+        if(!task)
+        {
+            return false;
+        }
+
+        // the task may release the executor before this returns
+        std::shared_ptr<State> state = m_state;
+        Worker* worker = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            CallbackExecutorMetrics& metrics = state->metrics;
+
+            if(state->stop ||
+               (droppable && metrics.queueDepth >= state->maxQueueDepth))
+            {
+                ++metrics.dropped;
+                return false;
+            }
+
+            size_t index;
+            if(orderingKey)
+            {
+                index = std::hash<const void*>()(orderingKey) % state->workers.size();
+            }
+            else
+            {
+                index = state->nextWorker++ % state->workers.size();
+            }
+
+            worker = state->workers[index].get();
+            worker->queue.push_back(std::move(task));
+
+            if(++metrics.queueDepth > metrics.peakQueueDepth)
+            {
+                metrics.peakQueueDepth = metrics.queueDepth;
+            }
+        }
+
+        worker->cond.notify_one();
+        return true;
+    }
+
+    CallbackExecutorMetrics ThreadPoolCallbackExecutor::getMetrics() const
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->metrics;
+    }
+
+    void ThreadPoolCallbackExecutor::workerFunc(std::shared_ptr<State> state, Worker& worker)
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        while(true)
+        {
+            worker.cond.wait(lock, [&]{ return state->stop || !worker.queue.empty(); });
+
+            if(worker.queue.empty())
+            {
+                break;
+            }
+
+            Task task = std::move(worker.queue.front());
+            worker.queue.pop_front();
+            --state->metrics.queueDepth;
+            ++state->metrics.executed;
+
+            lock.unlock();
+            try
+            {
+                task();
+            }
+            catch(...)
+            {
+                // an application callback must not take down the worker
+            }
+            // release whatever the callback captured before taking the lock again,
+            // it may hold the last reference to the executor
+            task = nullptr;
+            lock.lock();
+        }
+    }
+}
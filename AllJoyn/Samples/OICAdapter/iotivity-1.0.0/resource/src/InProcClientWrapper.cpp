@@ -27,13 +27,34 @@
 #include <OCSerialization.h>
 using namespace std;
 
+namespace
+{
+    // upper bound on how long listeningFunc sleeps when no data arrives
+    const uint32_t OC_PROCESS_MAX_WAIT_MS = 100;
+
+    // sizing of the callback executor used when PlatformConfig does not supply one
+    const size_t DEFAULT_CALLBACK_THREADS = 4;
+    const size_t DEFAULT_CALLBACK_QUEUE_DEPTH = 1024;
+}
+
 namespace OC
 {
     InProcClientWrapper::InProcClientWrapper(
         std::weak_ptr<std::recursive_mutex> csdkLock, PlatformConfig cfg)
             : m_threadRun(false), m_csdkLock(csdkLock),
+              m_callbackExecutor(cfg.callbackExecutor),
               m_cfg { cfg }
     {
+        if(!m_callbackExecutor)
+        {
+            m_callbackExecutor = std::make_shared<ThreadPoolCallbackExecutor>(
+                                    DEFAULT_CALLBACK_THREADS, DEFAULT_CALLBACK_QUEUE_DEPTH);
+        }
+
+        // the callbacks below only read a response payload, converting it into
+        // OCRepresentations before they return, so it can be parsed into an arena
+        OCSetResponseArenaParsing(true);
+
         // if the config type is server, we ought to never get called.  If the config type
         // is both, we count on the server to run the thread and do the initialize
 
@@ -92,8 +113,12 @@ namespace OC
                 // TODO: do something with result if failed?
             }
 
-            // To minimize CPU utilization we may wish to do this with sleep
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // Sleep until the connectivity layer queues received data. The wait is
+            // bounded so that presence timers and shutdown are still serviced.
+            if(OC_STACK_NOTIMPL == OCWaitForEvent(OC_PROCESS_MAX_WAIT_MS))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
         }
     }
 
@@ -165,11 +190,12 @@ namespace OC
 
         ListenOCContainer container(clientWrapper, clientResponse->devAddr,
                                 reinterpret_cast<OCDiscoveryPayload*>(clientResponse->payload));
-        // loop to ensure valid construction of all resources
+        // loop to ensure valid construction of all resources. Results are only shed
+        // when callbacks back up if the application opted in through PlatformConfig.
         for(auto resource : container.Resources())
         {
-            std::thread exec(context->callback, resource);
-            exec.detach();
+            context->executor->post(std::bind(context->callback, resource), nullptr,
+                                    context->droppable);
         }
 
 
@@ -192,7 +218,9 @@ namespace OC
         resourceUri << serviceUrl << resourceType;
 
         ClientCallbackContext::ListenContext* context =
-            new ClientCallbackContext::ListenContext(callback, shared_from_this());
+            new ClientCallbackContext::ListenContext(callback, shared_from_this(),
+                                                    m_callbackExecutor,
+                                                    m_cfg.dropCallbacksWhenBusy);
         OCCallbackData cbdata{
                 static_cast<void*>(context),
                 listenCallback,
@@ -228,8 +256,7 @@ namespace OC
         try
         {
             OCRepresentation rep = parseGetSetCallback(clientResponse);
-            std::thread exec(context->callback, rep);
-            exec.detach();
+            context->executor->post(std::bind(context->callback, rep));
         }
         catch(OC::OCException& e)
         {
@@ -256,7 +283,8 @@ namespace OC
         deviceUri << serviceUrl << deviceURI;
 
         ClientCallbackContext::DeviceListenContext* context =
-            new ClientCallbackContext::DeviceListenContext(callback, shared_from_this());
+            new ClientCallbackContext::DeviceListenContext(callback, shared_from_this(),
+                                                          m_callbackExecutor);
         OCCallbackData cbdata{
                 static_cast<void*>(context),
                 listenDeviceCallback,
@@ -331,8 +359,7 @@ namespace OC
             }
         }
 
-        std::thread exec(context->callback, serverHeaderOptions, rep, result);
-        exec.detach();
+        context->executor->post(std::bind(context->callback, serverHeaderOptions, rep, result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -348,7 +375,7 @@ namespace OC
         }
         OCStackResult result;
         ClientCallbackContext::GetContext* ctx =
-            new ClientCallbackContext::GetContext(callback);
+            new ClientCallbackContext::GetContext(callback, m_callbackExecutor);
         OCCallbackData cbdata{
                 static_cast<void*>(ctx),
                 getResourceCallback,
@@ -408,8 +435,8 @@ namespace OC
             }
         }
 
-        std::thread exec(context->callback, serverHeaderOptions, attrs, result);
-        exec.detach();
+        context->executor->post(std::bind(context->callback, serverHeaderOptions, attrs,
+                                          result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -461,7 +488,8 @@ namespace OC
             return OC_STACK_INVALID_PARAM;
         }
         OCStackResult result;
-        ClientCallbackContext::SetContext* ctx = new ClientCallbackContext::SetContext(callback);
+        ClientCallbackContext::SetContext* ctx =
+            new ClientCallbackContext::SetContext(callback, m_callbackExecutor);
         OCCallbackData cbdata{
                 static_cast<void*>(ctx),
                 setResourceCallback,
@@ -507,7 +535,8 @@ namespace OC
             return OC_STACK_INVALID_PARAM;
         }
         OCStackResult result;
-        ClientCallbackContext::SetContext* ctx = new ClientCallbackContext::SetContext(callback);
+        ClientCallbackContext::SetContext* ctx =
+            new ClientCallbackContext::SetContext(callback, m_callbackExecutor);
         OCCallbackData cbdata{
                 static_cast<void*>(ctx),
                 setResourceCallback,
@@ -554,8 +583,8 @@ namespace OC
         {
             parseServerHeaderOptions(clientResponse, serverHeaderOptions);
         }
-        std::thread exec(context->callback, serverHeaderOptions, clientResponse->result);
-        exec.detach();
+        context->executor->post(std::bind(context->callback, serverHeaderOptions,
+                                          clientResponse->result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -572,7 +601,7 @@ namespace OC
         }
         OCStackResult result;
         ClientCallbackContext::DeleteContext* ctx =
-            new ClientCallbackContext::DeleteContext(callback);
+            new ClientCallbackContext::DeleteContext(callback, m_callbackExecutor);
         OCCallbackData cbdata{
                 static_cast<void*>(ctx),
                 deleteResourceCallback,
@@ -627,9 +656,13 @@ namespace OC
                 result = e.code();
             }
         }
-        std::thread exec(context->callback, serverHeaderOptions, attrs,
-                    result, sequenceNumber);
-        exec.detach();
+        // notifications for one observation are delivered in sequence. If the application
+        // opted in, a notification may be shed when callbacks back up, the next one carries
+        // the newer state, but the one that ends the observation is always delivered.
+        context->executor->post(std::bind(context->callback, serverHeaderOptions, attrs,
+                                          result, sequenceNumber), context,
+                                context->droppable &&
+                                sequenceNumber != OC_OBSERVE_DEREGISTER);
         if(sequenceNumber == OC_OBSERVE_DEREGISTER)
         {
             return OC_STACK_DELETE_TRANSACTION;
@@ -650,7 +683,8 @@ namespace OC
         OCStackResult result;
 
         ClientCallbackContext::ObserveContext* ctx =
-            new ClientCallbackContext::ObserveContext(callback);
+            new ClientCallbackContext::ObserveContext(callback, m_callbackExecutor,
+                                                      m_cfg.dropCallbacksWhenBusy);
         OCCallbackData cbdata{
                 static_cast<void*>(ctx),
                 observeResourceCallback,
@@ -738,10 +772,9 @@ namespace OC
          */
         std::string url = clientResponse->devAddr.addr;
 
-        std::thread exec(context->callback, clientResponse->result,
-                    clientResponse->sequenceNumber, url);
-
-        exec.detach();
+        context->executor->post(std::bind(context->callback, clientResponse->result,
+                                          clientResponse->sequenceNumber, url), context,
+                                context->droppable);
 
         return OC_STACK_KEEP_TRANSACTION;
     }
@@ -756,7 +789,9 @@ namespace OC
         }
 
         ClientCallbackContext::SubscribePresenceContext* ctx =
-            new ClientCallbackContext::SubscribePresenceContext(presenceHandler);
+            new ClientCallbackContext::SubscribePresenceContext(presenceHandler,
+                                                                m_callbackExecutor,
+                                                                m_cfg.dropCallbacksWhenBusy);
         OCCallbackData cbdata{
                 static_cast<void*>(ctx),
                 subscribePresenceCallback,
@@ -810,6 +845,11 @@ namespace OC
         return OC_STACK_OK;
     }
 
+    CallbackExecutorMetrics InProcClientWrapper::GetCallbackMetrics() const
+    {
+        return m_callbackExecutor->getMetrics();
+    }
+
     OCHeaderOption* InProcClientWrapper::assembleHeaderOptions(OCHeaderOption options[],
            const HeaderOptions& headerOptions)
     {
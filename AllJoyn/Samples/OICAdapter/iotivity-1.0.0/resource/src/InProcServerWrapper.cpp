@@ -40,6 +40,12 @@
 using namespace std;
 using namespace OC;
 
+namespace
+{
+    // upper bound on how long processFunc sleeps when no data arrives
+    const uint32_t OC_PROCESS_MAX_WAIT_MS = 100;
+}
+
 namespace OC
 {
     namespace details
@@ -306,7 +312,12 @@ namespace OC
                 // ...the value of variable result is simply ignored for now.
             }
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // Sleep until the connectivity layer queues received data. The wait is
+            // bounded so that presence timers and shutdown are still serviced.
+            if(OC_STACK_NOTIMPL == OCWaitForEvent(OC_PROCESS_MAX_WAIT_MS))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
         }
     }
 
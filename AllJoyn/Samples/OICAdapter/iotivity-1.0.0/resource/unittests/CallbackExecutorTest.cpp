@@ -0,0 +1,139 @@
+//******************************************************************
+//
+// Copyright 2016 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <gtest/gtest.h>
+#include <CallbackExecutor.h>
+
+namespace OC
+{
+    namespace test
+    {
+        namespace CallbackExecutorTests
+        {
+            using namespace OC;
+
+            TEST(CallbackExecutorTest, RunsAllTasksBeforeDestruction)
+            {
+                std::atomic<int> count(0);
+                {
+                    ThreadPoolCallbackExecutor executor(4, 64);
+                    for(int i = 0; i < 1000; ++i)
+                    {
+                        executor.post([&count]{ ++count; });
+                    }
+                }
+                EXPECT_EQ(1000, count);
+            }
+
+            TEST(CallbackExecutorTest, OrderedTasksRunInSequence)
+            {
+                std::vector<int> seen;
+                int key1 = 0;
+                {
+                    ThreadPoolCallbackExecutor executor(4, 8);
+                    for(int i = 0; i < 1000; ++i)
+                    {
+                        executor.post([&seen, i]{ seen.push_back(i); }, &key1);
+                    }
+                }
+                ASSERT_EQ(1000u, seen.size());
+                for(int i = 0; i < 1000; ++i)
+                {
+                    EXPECT_EQ(i, seen[i]);
+                }
+            }
+
+            // occupies the only worker of an executor until released
+            static void BlockWorker(ThreadPoolCallbackExecutor& executor,
+                                    std::atomic<bool>& release)
+            {
+                std::atomic<bool> started(false);
+                executor.post([&]{ started = true; while(!release) std::this_thread::yield(); });
+                while(!started)
+                {
+                    std::this_thread::yield();
+                }
+            }
+
+            TEST(CallbackExecutorTest, FullQueueDropsDroppableTasks)
+            {
+                std::atomic<bool> release(false);
+                std::atomic<int> ran(0);
+                {
+                    ThreadPoolCallbackExecutor executor(1, 1);
+                    BlockWorker(executor, release);
+
+                    // the worker is busy, so this one fills the queue...
+                    EXPECT_TRUE(executor.post([&]{ ++ran; }, nullptr, true));
+                    // ...and this one is discarded without running on the poster
+                    EXPECT_FALSE(executor.post([&]{ ++ran; }, nullptr, true));
+                    // but a task that must run is still queued
+                    EXPECT_TRUE(executor.post([&]{ ++ran; }));
+
+                    CallbackExecutorMetrics metrics = executor.getMetrics();
+                    EXPECT_EQ(1u, metrics.dropped);
+                    EXPECT_EQ(2u, metrics.queueDepth);
+                    release = true;
+                }
+                EXPECT_EQ(2, ran);
+            }
+
+            TEST(CallbackExecutorTest, OrderedTasksCountAgainstQueueLimit)
+            {
+                std::atomic<bool> release(false);
+                int key1 = 0;
+                ThreadPoolCallbackExecutor executor(1, 2);
+                BlockWorker(executor, release);
+
+                EXPECT_TRUE(executor.post([]{}, &key1, true));
+                EXPECT_TRUE(executor.post([]{}, &key1, true));
+                EXPECT_FALSE(executor.post([]{}, &key1, true));
+
+                CallbackExecutorMetrics metrics = executor.getMetrics();
+                EXPECT_EQ(1u, metrics.dropped);
+                EXPECT_EQ(2u, metrics.peakQueueDepth);
+                release = true;
+            }
+
+            TEST(CallbackExecutorTest, DestroyedFromOwnCallback)
+            {
+                std::promise<void> destroyed;
+                // the only reference to the executor is held by a queued callback
+                std::shared_ptr<ICallbackExecutor::Ptr> holder =
+                    std::make_shared<ICallbackExecutor::Ptr>(
+                        std::make_shared<ThreadPoolCallbackExecutor>(2, 8));
+                ICallbackExecutor* executor = holder->get();
+
+                executor->post([holder, &destroyed]
+                               {
+                                   holder->reset();
+                                   destroyed.set_value();
+                               });
+                holder.reset();
+
+                std::future<void> done = destroyed.get_future();
+                ASSERT_EQ(std::future_status::ready, done.wait_for(std::chrono::seconds(10)));
+            }
+        }
+    }
+}
@@ -24,6 +24,7 @@
 #include <octypes.h>
 #include <ocpayload.h>
 #include <ocpayloadcbor.h>
+#include <rdpayload.h>
 #include <oic_malloc.h>
 #include <oic_string.h>
 
@@ -1142,4 +1143,269 @@ namespace OCRepresentationEncodingTest
         OCRepPayloadDestroy(payload);
         OCPayloadDestroy(cparsed);
     }
+
+    static OCDiscoveryPayload* CreateDiscoveryPayload(size_t numResources)
+    {
+        OCDiscoveryPayload* payload = OCDiscoveryPayloadCreate();
+        char uri[32];
+        for(size_t i = 0; i < numResources; ++i)
+        {
+            OCResourcePayload* resource =
+                (OCResourcePayload*)OICCalloc(1, sizeof(OCResourcePayload));
+            OCResourcePayloadAddResourceType(resource, "core.light");
+            OCResourcePayloadAddInterface(resource, "oic.if.baseline");
+            snprintf(uri, sizeof(uri), "/a/light/%u", (unsigned)i);
+            resource->uri = OICStrdup(uri);
+            resource->sid = (uint8_t*)OICMalloc(sizeof(sid1));
+            memcpy(resource->sid, sid1, sizeof(sid1));
+            resource->bitmap = OC_DISCOVERABLE | OC_OBSERVABLE;
+            OCDiscoveryPayloadAddNewResource(payload, resource);
+        }
+        return payload;
+    }
+
+    static size_t EncodedDiscoverySize(size_t numResources)
+    {
+        OCDiscoveryPayload* payload = CreateDiscoveryPayload(numResources);
+        uint8_t* cborData = NULL;
+        size_t cborSize = 0;
+        EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)payload, &cborData, &cborSize));
+
+        OCPayload* cparsed = NULL;
+        EXPECT_EQ(OC_STACK_OK, OCParsePayload(&cparsed, PAYLOAD_TYPE_DISCOVERY,
+                    cborData, cborSize));
+        EXPECT_EQ(numResources, OCDiscoveryPayloadGetResourceCount((OCDiscoveryPayload*)cparsed));
+
+        OICFree(cborData);
+        OCPayloadDestroy(cparsed);
+        OCDiscoveryPayloadDestroy(payload);
+        return cborSize;
+    }
+
+    // Payloads that outgrow the scratch buffer are encoded a second time
+    // into an allocation of the size counted by the first pass; that size
+    // must be exact and the output must still parse.
+    TEST(DiscoveryEncoding, ResourceCounts)
+    {
+        // uris /a/light/0 to /a/light/9 are the same length, so every
+        // resource adds the same number of bytes
+        size_t first = EncodedDiscoverySize(1);
+        size_t perResource = EncodedDiscoverySize(2) - first;
+        ASSERT_GT(perResource, 0u);
+        for(size_t n = 3; n <= 10; ++n)
+        {
+            EXPECT_EQ(first + (n - 1) * perResource, EncodedDiscoverySize(n)) << n;
+        }
+        EXPECT_LT(first + perResource, 255u);
+        EXPECT_GT(first + 9 * perResource, 255u);
+
+        EncodedDiscoverySize(1000);
+    }
+
+    static OCResourceCollectionPayload* CreateCollection(size_t index)
+    {
+        char uri[32];
+        snprintf(uri, sizeof(uri), "/a/light/%u", (unsigned)index);
+        OCStringLL rt = {NULL, (char*)"core.light"};
+        OCStringLL itf = {NULL, (char*)"oic.if.baseline"};
+        OCTagsPayload* tags = OCCopyTagsResources(devicename1, (const unsigned char*)"id",
+                NULL, OC_DISCOVERABLE, 0, 0, NULL, NULL, 0);
+        OCLinksPayload* links = OCCopyLinksResources(uri, &rt, &itf, NULL, false, NULL,
+                NULL, 0, NULL);
+        return OCCopyCollectionResource(tags, links);
+    }
+
+    static size_t EncodedCollectionSize(OCPayloadType type, size_t numCollections)
+    {
+        OCPayload* payload = NULL;
+        if (type == PAYLOAD_TYPE_RD)
+        {
+            OCRDPayload* rd = OCRDPayloadCreate();
+            OCResourceCollectionPayload** next = &rd->rdPublish;
+            for(size_t i = 0; i < numCollections; ++i, next = &(*next)->next)
+            {
+                *next = CreateCollection(i);
+            }
+            payload = (OCPayload*)rd;
+        }
+        else
+        {
+            OCDiscoveryPayload* discovery = OCDiscoveryPayloadCreate();
+            OCResourceCollectionPayload** next = &discovery->collectionResources;
+            for(size_t i = 0; i < numCollections; ++i, next = &(*next)->next)
+            {
+                *next = CreateCollection(i);
+            }
+            payload = (OCPayload*)discovery;
+        }
+
+        uint8_t* cborData = NULL;
+        size_t cborSize = 0;
+        EXPECT_EQ(OC_STACK_OK, OCConvertPayload(payload, &cborData, &cborSize));
+
+        OCPayload* cparsed = NULL;
+        EXPECT_EQ(OC_STACK_OK, OCParsePayload(&cparsed, type, cborData, cborSize));
+
+        OICFree(cborData);
+        if (type == PAYLOAD_TYPE_RD)
+        {
+            OCPayloadDestroy(cparsed);
+            OCPayloadDestroy(payload);
+        }
+        else
+        {
+            OCDiscoveryCollectionPayloadDestroy((OCDiscoveryPayload*)cparsed);
+            OCDiscoveryCollectionPayloadDestroy((OCDiscoveryPayload*)payload);
+        }
+        return cborSize;
+    }
+
+    // Collection and RD payloads take the same two passes as the others
+    TEST(CollectionEncoding, CollectionCounts)
+    {
+        const OCPayloadType types[] = {PAYLOAD_TYPE_DISCOVERY, PAYLOAD_TYPE_RD};
+        for(OCPayloadType type : types)
+        {
+            size_t first = EncodedCollectionSize(type, 1);
+            size_t perCollection = EncodedCollectionSize(type, 2) - first;
+            ASSERT_GT(perCollection, 0u);
+            for(size_t n = 3; n <= 10; ++n)
+            {
+                EXPECT_EQ(first + (n - 1) * perCollection, EncodedCollectionSize(type, n))
+                    << type << " " << n;
+            }
+            EXPECT_LT(first + perCollection, 255u);
+            EXPECT_GT(first + 9 * perCollection, 255u);
+        }
+    }
+
+    static OC::OCRepresentation CreateArenaTestRepresentation()
+    {
+        OC::OCRepresentation subRep;
+        subRep.setNULL("NullAttr");
+        subRep.setValue("IntAttr", 77);
+        subRep.setValue("StringAttr", std::string("String attr"));
+
+        OC::OCRepresentation rep;
+        rep.setUri("/a/light");
+        rep.setResourceTypes({"core.light", "core.brightlight"});
+        rep.setResourceInterfaces({"oic.if.baseline"});
+        rep.setValue("power", 10);
+        rep.setValue("level", 0.75);
+        rep.setValue("on", true);
+        rep.setValue("name", std::string("kitchen"));
+        rep.setValue("sub", subRep);
+        rep["strarr"] = std::vector<std::vector<std::string>>
+            {{"item1", "item2"}, {"item3", ""}};
+        rep["objarr"] = std::vector<OC::OCRepresentation>{subRep, subRep};
+        return rep;
+    }
+
+    TEST(RepresentationArenaParsing, MatchesHeapParsing)
+    {
+        OC::MessageContainer mc1;
+        mc1.addRepresentation(CreateArenaTestRepresentation());
+        mc1.addRepresentation(CreateArenaTestRepresentation());
+        OCRepPayload* cstart = mc1.getPayload();
+
+        uint8_t* cborData;
+        size_t cborSize;
+        OCPayload* heapParsed = NULL;
+        OCPayload* arenaParsed = NULL;
+        EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)cstart, &cborData, &cborSize));
+        EXPECT_EQ(OC_STACK_OK, OCParsePayload(&heapParsed, PAYLOAD_TYPE_REPRESENTATION,
+                    cborData, cborSize));
+        EXPECT_EQ(OC_STACK_OK, OCParsePayloadInArena(&arenaParsed, PAYLOAD_TYPE_REPRESENTATION,
+                    cborData, cborSize));
+        OCPayloadDestroy((OCPayload*)cstart);
+        OICFree(cborData);
+
+        ASSERT_NE(nullptr, arenaParsed);
+
+        OC::MessageContainer heapMc;
+        heapMc.setPayload(heapParsed);
+        OC::MessageContainer arenaMc;
+        arenaMc.setPayload(arenaParsed);
+
+        ASSERT_EQ(2u, arenaMc.representations().size());
+        ASSERT_EQ(heapMc.representations().size(), arenaMc.representations().size());
+        for(size_t i = 0; i < arenaMc.representations().size(); ++i)
+        {
+            const OC::OCRepresentation& h = heapMc.representations()[i];
+            const OC::OCRepresentation& a = arenaMc.representations()[i];
+            EXPECT_EQ(h.getUri(), a.getUri());
+            EXPECT_EQ(h.getResourceTypes(), a.getResourceTypes());
+            EXPECT_EQ(h.getResourceInterfaces(), a.getResourceInterfaces());
+            EXPECT_EQ(h.getValue<int>("power"), a.getValue<int>("power"));
+            EXPECT_EQ(h.getValue<double>("level"), a.getValue<double>("level"));
+            EXPECT_EQ(h.getValue<bool>("on"), a.getValue<bool>("on"));
+            EXPECT_EQ(h.getValue<std::string>("name"), a.getValue<std::string>("name"));
+            EXPECT_EQ(h.getValue<OC::OCRepresentation>("sub"),
+                      a.getValue<OC::OCRepresentation>("sub"));
+            std::vector<std::vector<std::string>> hstr = h["strarr"];
+            std::vector<std::vector<std::string>> astr = a["strarr"];
+            EXPECT_EQ(hstr, astr);
+            std::vector<OC::OCRepresentation> hobj = h["objarr"];
+            std::vector<OC::OCRepresentation> aobj = a["objarr"];
+            EXPECT_EQ(hobj, aobj);
+        }
+
+        OCPayloadDestroy(heapParsed);
+        OCArenaPayloadDestroy(arenaParsed);
+    }
+
+    // Responses are parsed on the heap unless a caller opts in to the arena,
+    // so a parsed payload can be modified and taken apart like a built one.
+    TEST(RepresentationArenaParsing, HeapParsedPayloadIsMutable)
+    {
+        OCRepPayload* payload = OCRepPayloadCreate();
+        OCRepPayloadSetUri(payload, "/this/uri");
+        OCRepPayloadSetPropInt(payload, "value", 1);
+        OCRepPayload* child = OCRepPayloadCreate();
+        OCRepPayloadSetPropInt(child, "inner", 2);
+        OCRepPayloadSetPropObjectAsOwner(payload, "child", child);
+
+        uint8_t* cborData;
+        size_t cborSize;
+        OCPayload* cparsed = NULL;
+        EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)payload, &cborData, &cborSize));
+        EXPECT_EQ(OC_STACK_OK, OCParsePayload(&cparsed, PAYLOAD_TYPE_REPRESENTATION,
+                    cborData, cborSize));
+        OICFree(cborData);
+        OCRepPayloadDestroy(payload);
+
+        OCRepPayload* parsedPayload = (OCRepPayload*)cparsed;
+        int64_t value = 0;
+        EXPECT_TRUE(OCRepPayloadSetPropInt(parsedPayload, "value", 2));
+        EXPECT_TRUE(OCRepPayloadAddResourceType(parsedPayload, "core.light"));
+        EXPECT_TRUE(OCRepPayloadGetPropInt(parsedPayload, "value", &value));
+        EXPECT_EQ(2, value);
+        ASSERT_NE(nullptr, parsedPayload->types);
+        EXPECT_STREQ("core.light", parsedPayload->types->value);
+
+        // setting a name again replaces the value rather than adding a second one
+        EXPECT_TRUE(OCRepPayloadSetPropInt(parsedPayload, "value", 3));
+        size_t count = 0;
+        for(OCRepPayloadValue* val = parsedPayload->values; val; val = val->next)
+        {
+            count += strcmp(val->name, "value") == 0;
+        }
+        EXPECT_EQ(1u, count);
+
+        // replacing a nested payload frees it
+        OCRepPayload* parsedChild = NULL;
+        EXPECT_TRUE(OCRepPayloadGetPropObject(parsedPayload, "child", &parsedChild));
+        ASSERT_NE(nullptr, parsedChild);
+        EXPECT_TRUE(OCRepPayloadGetPropInt(parsedChild, "inner", &value));
+        EXPECT_EQ(2, value);
+        OCRepPayloadDestroy(parsedChild);
+        EXPECT_TRUE(OCRepPayloadSetNull(parsedPayload, "child"));
+        EXPECT_TRUE(OCRepPayloadIsNull(parsedPayload, "child"));
+
+        OCRepPayload* sibling = OCRepPayloadCreate();
+        OCRepPayloadAppend(parsedPayload, sibling);
+        EXPECT_EQ(sibling, parsedPayload->next);
+
+        OCPayloadDestroy(cparsed);
+    }
 }
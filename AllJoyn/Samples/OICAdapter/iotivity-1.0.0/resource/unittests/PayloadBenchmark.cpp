@@ -0,0 +1,152 @@
+//******************************************************************
+//
+// Copyright 2016 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+// Timings for payload encoding and parsing. Not a test: it prints the cost
+// per call so that changes to ocpayloadconvert.c and ocpayloadparse.c can
+// be compared before and after.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ocpayload.h>
+#include <ocpayloadcbor.h>
+#include <oic_malloc.h>
+#include <oic_string.h>
+
+namespace
+{
+    const uint8_t sid[] = {1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16};
+
+    OCDiscoveryPayload* CreateDiscoveryPayload(size_t numResources)
+    {
+        OCDiscoveryPayload* payload = OCDiscoveryPayloadCreate();
+        char uri[32];
+        for(size_t i = 0; i < numResources; ++i)
+        {
+            OCResourcePayload* resource =
+                (OCResourcePayload*)OICCalloc(1, sizeof(OCResourcePayload));
+            OCResourcePayloadAddResourceType(resource, "core.light");
+            OCResourcePayloadAddInterface(resource, "oic.if.baseline");
+            snprintf(uri, sizeof(uri), "/a/light/%u", (unsigned)i);
+            resource->uri = OICStrdup(uri);
+            resource->sid = (uint8_t*)OICMalloc(sizeof(sid));
+            memcpy(resource->sid, sid, sizeof(sid));
+            resource->bitmap = OC_DISCOVERABLE | OC_OBSERVABLE;
+            OCDiscoveryPayloadAddNewResource(payload, resource);
+        }
+        return payload;
+    }
+
+    void BenchDiscoveryEncoding(size_t numResources, int iterations)
+    {
+        OCDiscoveryPayload* payload = CreateDiscoveryPayload(numResources);
+        uint8_t* cborData = NULL;
+        size_t cborSize = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for(int i = 0; i < iterations; ++i)
+        {
+            if(OC_STACK_OK != OCConvertPayload((OCPayload*)payload, &cborData, &cborSize))
+            {
+                printf("discovery encoding failed\n");
+                break;
+            }
+            OICFree(cborData);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        printf("discovery encoding: %u resources, %u bytes, %.2f us\n",
+               (unsigned)numResources, (unsigned)cborSize,
+               std::chrono::duration<double, std::micro>(elapsed).count() / iterations);
+
+        OCDiscoveryPayloadDestroy(payload);
+    }
+
+    // Parses the same representation on the heap and, with
+    // OCParsePayloadInArena, into a single arena.
+    void BenchRepresentationParsing(size_t numValues, int iterations)
+    {
+        OCRepPayload* payload = OCRepPayloadCreate();
+        OCRepPayloadSetUri(payload, "/a/light");
+        OCRepPayloadAddResourceType(payload, "core.light");
+        OCRepPayloadAddInterface(payload, "oic.if.baseline");
+        char name[32];
+        for(size_t i = 0; i < numValues; ++i)
+        {
+            snprintf(name, sizeof(name), "attr%u", (unsigned)i);
+            if(i % 2)
+            {
+                OCRepPayloadSetPropInt(payload, name, (int64_t)i);
+            }
+            else
+            {
+                OCRepPayloadSetPropString(payload, name, "some value");
+            }
+        }
+
+        uint8_t* cborData = NULL;
+        size_t cborSize = 0;
+        OCStackResult result = OCConvertPayload((OCPayload*)payload, &cborData, &cborSize);
+        OCRepPayloadDestroy(payload);
+        if(OC_STACK_OK != result)
+        {
+            printf("representation encoding failed\n");
+            return;
+        }
+
+        double elapsed[2];
+        for(int arena = 0; arena < 2; ++arena)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for(int i = 0; i < iterations; ++i)
+            {
+                OCPayload* cparsed = NULL;
+                if(arena)
+                {
+                    OCParsePayloadInArena(&cparsed, PAYLOAD_TYPE_REPRESENTATION,
+                            cborData, cborSize);
+                    OCArenaPayloadDestroy(cparsed);
+                }
+                else
+                {
+                    OCParsePayload(&cparsed, PAYLOAD_TYPE_REPRESENTATION, cborData, cborSize);
+                    OCPayloadDestroy(cparsed);
+                }
+            }
+            elapsed[arena] = std::chrono::duration<double, std::micro>(
+                    std::chrono::steady_clock::now() - start).count() / iterations;
+        }
+
+        printf("representation parsing: %u values, %u bytes, heap %.2f us, arena %.2f us\n",
+               (unsigned)numValues, (unsigned)cborSize, elapsed[0], elapsed[1]);
+
+        OICFree(cborData);
+    }
+}
+
+int main()
+{
+    BenchDiscoveryEncoding(1, 10000);
+    BenchDiscoveryEncoding(100, 1000);
+    BenchDiscoveryEncoding(1000, 100);
+    BenchRepresentationParsing(4, 10000);
+    BenchRepresentationParsing(100, 1000);
+    return 0;
+}
@@ -64,6 +64,12 @@ namespace AdapterLib
     static const std::string AEON__LIGHT_BULB__PRODUCT_TYPE = "0003";
     static const std::string AEON__LIGHT_BULB__PRODUCT_ID = "0018";
 
+    // Key of a device in m_deviceIndex
+    static inline uint64 DeviceKey(uint32 homeId, uint32 nodeId)
+    {
+        return (static_cast<uint64>(homeId) << 8) | (nodeId & 0xff);
+    }
+
     //
     // ZWaveAdapter class.
     // Description:
@@ -278,31 +284,29 @@ namespace AdapterLib
             goto done;
         }
 
+        //get the device first
+        device = GetDevice(adapterProperty->m_valueId.GetHomeId(), adapterProperty->m_valueId.GetNodeId());
+        if (device == nullptr)
         {
-            //get the device first
-            auto iter = FindDevice(m_devices, adapterProperty->m_valueId.GetHomeId(), adapterProperty->m_valueId.GetNodeId());
-            if (iter == m_devices.end())
-            {
-                status = ERROR_INVALID_HANDLE;
-                goto done;
-            }
-
-            device = dynamic_cast<ZWaveAdapterDevice^>(*iter);
+            status = ERROR_INVALID_HANDLE;
+            goto done;
         }
 
         //get the property object from the internal device list
         {
-            auto iter = device->GetProperty(adapterProperty->m_valueId);
-            if (iter == device->m_properties.end())
+            AutoLock sync(m_valueLock);
+
+            ZWaveAdapterProperty^ deviceProperty = device->GetProperty(adapterProperty->m_valueId);
+            if (deviceProperty == nullptr)
             {
                 status = ERROR_INVALID_HANDLE;
                 goto done;
             }
 
             //refresh value
-            dynamic_cast<ZWaveAdapterProperty^>(*iter)->UpdateValue();
+            deviceProperty->UpdateValue();
 
-            auto attributes = dynamic_cast<ZWaveAdapterProperty^>(*iter)->m_attributes;
+            auto attributes = deviceProperty->m_attributes;
             adapterProperty->m_attributes = attributes;
         }
 
@@ -370,31 +374,29 @@ namespace AdapterLib
             goto done;
         }
 
+        //get the device first
+        device = GetDevice(adapterProperty->m_valueId.GetHomeId(), adapterProperty->m_valueId.GetNodeId());
+        if (device == nullptr)
         {
-            //get the device first
-            auto iter = FindDevice(m_devices, adapterProperty->m_valueId.GetHomeId(), adapterProperty->m_valueId.GetNodeId());
-            if (iter == m_devices.end())
-            {
-                status = ERROR_INVALID_HANDLE;
-                goto done;
-            }
-
-            device = dynamic_cast<ZWaveAdapterDevice^>(*iter);
+            status = ERROR_INVALID_HANDLE;
+            goto done;
         }
 
         //get the property object from the internal device list
         {
-            auto iter = device->GetProperty(adapterProperty->m_valueId);
-            if (iter == device->m_properties.end())
+            AutoLock sync(m_valueLock);
+
+            ZWaveAdapterProperty^ deviceProperty = device->GetProperty(adapterProperty->m_valueId);
+            if (deviceProperty == nullptr)
             {
                 status = ERROR_INVALID_HANDLE;
                 goto done;
             }
 
             //refresh value
-            dynamic_cast<ZWaveAdapterProperty^>(*iter)->UpdateValue();
+            deviceProperty->UpdateValue();
 
-            attribute = dynamic_cast<ZWaveAdapterProperty^>(*iter)->GetAttributeByName(AttributeName);;
+            attribute = deviceProperty->GetAttributeByName(AttributeName);
             if (attribute == nullptr)
             {
                 status = ERROR_NOT_FOUND;
@@ -446,7 +448,10 @@ namespace AdapterLib
             goto done;
         }
 
-        status = adapterProperty->SetValue(Value->Data);
+        {
+            AutoLock sync(m_valueLock);
+            status = adapterProperty->SetValue(Value->Data);
+        }
 
     done:
         return status;
@@ -548,25 +553,34 @@ namespace AdapterLib
     _Use_decl_annotations_
     uint32 ZWaveAdapter::NotifySignalListener(IAdapterSignal^ Signal)
     {
-        uint32 status = ERROR_INVALID_HANDLE;
+        return NotifySignalListener(Signal, Signal);
+    }
 
-        // Sync access to listeners list
-        AutoLock sync(m_signalLock);
+
+    _Use_decl_annotations_
+    uint32 ZWaveAdapter::NotifySignalListener(IAdapterSignal^ Signal, IAdapterSignal^ Instance)
+    {
+        uint32 status = ERROR_INVALID_HANDLE;
 
         // We use the hash code as the signal key
         int mmapkey = Signal->GetHashCode();
 
-        // Iterate through listeners
-        auto handlerRange = m_signalListeners.equal_range(mmapkey);
+        // Copy the listeners so they are called without holding the lock
+        vector<pair<int, SIGNAL_LISTENER_ENTRY>> handlers;
+        {
+            AutoLock sync(m_signalLock);
+
+            auto handlerRange = m_signalListeners.equal_range(mmapkey);
+            handlers.assign(handlerRange.first, handlerRange.second);
+        }
 
-        vector<pair<int, SIGNAL_LISTENER_ENTRY>> handlers(handlerRange.first, handlerRange.second);
         for (auto iter = handlers.begin(); iter != handlers.end(); ++iter)
         {
             // Notify the listener
             IAdapterSignalListener^ listener = iter->second.Listener;
             Object^ listenerContext = iter->second.Context;
 
-            listener->AdapterSignalHandler(Signal, listenerContext);
+            listener->AdapterSignalHandler(Instance, listenerContext);
 
             status = ERROR_SUCCESS;
         }
@@ -617,6 +631,19 @@ namespace AdapterLib
         });
     }
 
+    ZWaveAdapterDevice^ ZWaveAdapter::GetDevice(uint32 homeId, uint32 nodeId)
+    {
+        AutoLock sync(m_deviceListLock);
+
+        auto iter = m_deviceIndex.find(DeviceKey(homeId, nodeId));
+        if (iter == m_deviceIndex.end())
+        {
+            return nullptr;
+        }
+
+        return iter->second;
+    }
+
     IAdapterSignal^ ZWaveAdapter::GetSignal(String^ name)
     {
         for (auto signal : m_signals)
@@ -682,6 +709,7 @@ namespace AdapterLib
                 currDevice->Initialize();
 
                 m_devices.push_back(currDevice);
+                m_deviceIndex[DeviceKey(homeId, nodeId)] = currDevice;
                 m_pendingDevices.erase(iter);
 
                 // Create a Control Panel for *any* device
@@ -745,6 +773,7 @@ namespace AdapterLib
             }
 
             //now erase it
+            m_deviceIndex.erase(DeviceKey(homeId, nodeId));
             m_devices.erase(iter);
         }
         else if(!bMoveToPending)
@@ -779,6 +808,7 @@ namespace AdapterLib
 
                     NotifySignalListener(signal);
                 }
+                m_deviceIndex.erase(DeviceKey(device->m_homeId, device->m_nodeId));
                 iter = m_devices.erase(iter);
             }
             else
@@ -923,41 +953,40 @@ namespace AdapterLib
             case Notification::Type_ValueChanged:
             {
                 //look into device list
-                auto iter = adapter->FindDevice(adapter->m_devices, homeId, nodeId);
-                if (iter != adapter->m_devices.end())
+                ZWaveAdapterDevice^ device = adapter->GetDevice(homeId, nodeId);
+                if (device == nullptr)
                 {
-                    ZWaveAdapterDevice^ device = dynamic_cast<ZWaveAdapterDevice^>(*iter);
-
-                    //add the value
-                    device->UpdatePropertyValue(_notification->GetValueID());
+                    break;
+                }
 
-                    //notify the signal
-                    AutoLock sync(adapter->m_signalLock);
+                ZWaveAdapterProperty^ adapterProperty = nullptr;
+                ZWaveAdapterValue^ adapterValue = nullptr;
+                {
+                    AutoLock sync(adapter->m_valueLock);
 
-                    IAdapterSignal^ signal = device->GetSignal(Constants::CHANGE_OF_VALUE_SIGNAL);
-                    if (signal != nullptr)
+                    adapterProperty = device->GetProperty(_notification->GetValueID());
+                    if (adapterProperty == nullptr)
                     {
-                        ZWaveAdapterProperty^ adapterProperty = nullptr;
-                        ZWaveAdapterValue^ adapterValue = nullptr;
-
-                        auto adapterPropertyIter = device->GetProperty(_notification->GetValueID());
-
-                        if (adapterPropertyIter != device->m_properties.end())
-                        {
-                            adapterProperty = dynamic_cast<ZWaveAdapterProperty^>(*adapterPropertyIter);
+                        break;
+                    }
 
-                            //get the AdapterValue
-                            adapterValue = adapterProperty->GetAttributeByName(ref new String(ValueName.c_str()));
+                    //update the value
+                    adapterProperty->UpdateValue();
 
-                            // Set the 'Property_Handle' signal parameter
-                            signal->Params->GetAt(0)->Data = adapterProperty;
+                    //get the AdapterValue
+                    adapterValue = adapterProperty->GetAttributeByName(ref new String(ValueName.c_str()));
+                }
 
-                            // Set the 'Property_Handle' signal parameter
-                            signal->Params->GetAt(1)->Data = adapterValue;
+                //notify the signal
+                IAdapterSignal^ signal = device->GetSignal(Constants::CHANGE_OF_VALUE_SIGNAL);
+                if (signal != nullptr)
+                {
+                    //each change gets its own signal object so concurrent changes don't overwrite each other's parameters
+                    ZWaveAdapterSignal^ covSignal = ref new ZWaveAdapterSignal(Constants::CHANGE_OF_VALUE_SIGNAL);
+                    covSignal->AddParam(ref new ZWaveAdapterValue(Constants::COV__PROPERTY_HANDLE, adapterProperty));
+                    covSignal->AddParam(ref new ZWaveAdapterValue(Constants::COV__ATTRIBUTE_HANDLE, adapterValue));
 
-                            adapter->NotifySignalListener(signal);
-                        }
-                    }
+                    adapter->NotifySignalListener(signal, covSignal);
                 }
                 break;
             }
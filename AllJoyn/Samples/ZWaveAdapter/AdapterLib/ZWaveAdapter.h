@@ -23,6 +23,7 @@
 
 #include <string>
 #include <map>
+#include <unordered_map>
 
 namespace AdapterLib
 {
@@ -31,6 +32,8 @@ namespace AdapterLib
     static const std::wstring cAdapterName = L"ZWave Bridge";
     static const std::wstring cDomainPrefix = L"com";
 
+    ref class ZWaveAdapterDevice;
+
     //
     // ZWaveAdapter class.
     // Description:
@@ -153,6 +156,17 @@ namespace AdapterLib
     internal:
         static void OnNotification(OpenZWave::Notification const * _notification, void * _context);
 
+        //
+        //  Routine Description:
+        //      Notify the listeners registered on Signal, passing them Instance instead.
+        //      Used for signals whose parameters differ on every emission so the
+        //      registered signal object never has to be modified.
+        //
+        uint32 NotifySignalListener(
+            _In_ BridgeRT::IAdapterSignal^ Signal,
+            _In_ BridgeRT::IAdapterSignal^ Instance
+            );
+
     private:
         std::vector<BridgeRT::IAdapterDevice^>::iterator ZWaveAdapter::FindDevice(
             std::vector<BridgeRT::IAdapterDevice^>& deviceList,
@@ -160,6 +174,8 @@ namespace AdapterLib
             uint32 nodeId
             );
 
+        ZWaveAdapterDevice^ GetDevice(uint32 homeId, uint32 nodeId);
+
         uint32 CreateSignals();
         BridgeRT::IAdapterSignal^ GetSignal(Platform::String^ name);
         void StartDeviceDiscovery();
@@ -186,6 +202,9 @@ namespace AdapterLib
         std::vector<BridgeRT::IAdapterDevice^> m_devices;
         std::vector<BridgeRT::IAdapterDevice^> m_pendingDevices;
 
+        // m_devices indexed by home id and node id
+        std::unordered_map<uint64, ZWaveAdapterDevice^> m_deviceIndex;
+
         // Signals
         std::vector<BridgeRT::IAdapterSignal^> m_signals;
 
@@ -194,6 +213,10 @@ namespace AdapterLib
         std::recursive_mutex m_deviceListLock;
         std::recursive_mutex m_signalLock;
 
+        // Serializes the bridge's Get/Set requests and the driver's value
+        // notifications, which all refresh the device properties' values
+        std::recursive_mutex m_valueLock;
+
         //Adapter Config
         AdapterConfig m_adapterConfig;
 
@@ -69,10 +69,11 @@ namespace AdapterLib
         {
             //add it as property
             //get the property
-            auto adapterProperty = GetProperty(value);
-            if (adapterProperty == m_properties.end())
+            if (GetProperty(value) == nullptr)
             {
-                m_properties.push_back(ref new ZWaveAdapterProperty(value));
+                ZWaveAdapterProperty^ adapterProperty = ref new ZWaveAdapterProperty(value);
+                m_properties.push_back(adapterProperty);
+                m_propertyIndex[value.GetId()] = adapterProperty;
             }
         }
     }
@@ -81,20 +82,27 @@ namespace AdapterLib
     void ZWaveAdapterDevice::UpdatePropertyValue(const ValueID& value)
     {
         //get the property
-        auto adapterProperty = GetProperty(value);
-        if (adapterProperty != m_properties.end())
+        ZWaveAdapterProperty^ adapterProperty = GetProperty(value);
+        if (adapterProperty != nullptr)
         {
-            (dynamic_cast<ZWaveAdapterProperty^>(*adapterProperty))->UpdateValue();
+            adapterProperty->UpdateValue();
         }
     }
 
     void ZWaveAdapterDevice::RemovePropertyValue(const ValueID & value)
     {
         //get the property
-        auto adapterProperty = GetProperty(value);
-        if (adapterProperty != m_properties.end())
+        auto index = m_propertyIndex.find(value.GetId());
+        if (index != m_propertyIndex.end())
         {
-            m_properties.erase(adapterProperty);
+            IAdapterProperty^ adapterProperty = index->second;
+            m_propertyIndex.erase(index);
+
+            auto iter = find(m_properties.begin(), m_properties.end(), adapterProperty);
+            if (iter != m_properties.end())
+            {
+                m_properties.erase(iter);
+            }
         }
     }
 
@@ -116,15 +124,16 @@ namespace AdapterLib
         return dynamic_cast<ZWaveAdapterProperty^>(outProperty);
     }
 
-    std::vector<BridgeRT::IAdapterProperty^>::iterator ZWaveAdapterDevice::GetProperty(const ValueID & value)
+    ZWaveAdapterProperty^ ZWaveAdapterDevice::GetProperty(const ValueID & value)
     {
-        //find if the property already exist
-        auto iter = find_if(m_properties.begin(), m_properties.end(), [&value](IAdapterProperty^ adapterProperty)
+        //all the values of a device share its home id, so the 64 bit id is enough as a key
+        auto iter = m_propertyIndex.find(value.GetId());
+        if (iter == m_propertyIndex.end() || iter->second->m_valueId != value)
         {
-            return (dynamic_cast<ZWaveAdapterProperty^>(adapterProperty))->m_valueId == value;
-        });
+            return nullptr;
+        }
 
-        return iter;
+        return iter->second;
     }
 
     void ZWaveAdapterDevice::BuildSignals()
@@ -19,6 +19,8 @@
 
 #include "value_classes\ValueID.h"
 
+#include <unordered_map>
+
 
 namespace AdapterLib
 {
@@ -151,7 +153,7 @@ namespace AdapterLib
         }       
 
     private:
-        std::vector<BridgeRT::IAdapterProperty^>::iterator GetProperty(const OpenZWave::ValueID& value);
+        ZWaveAdapterProperty^ GetProperty(const OpenZWave::ValueID& value);
 
         void BuildSignals();
 
@@ -172,6 +174,9 @@ namespace AdapterLib
         // Device properties
         std::vector<BridgeRT::IAdapterProperty^> m_properties;
 
+        // m_properties indexed by ValueID::GetId()
+        std::unordered_map<uint64, ZWaveAdapterProperty^> m_propertyIndex;
+
         // Device methods
         std::vector<BridgeRT::IAdapterMethod^> m_methods;
 
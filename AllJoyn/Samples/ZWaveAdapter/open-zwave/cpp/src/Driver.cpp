@@ -171,6 +171,10 @@ m_expectedCommandClassId( 0 ),
 m_expectedNodeId( 0 ),
 m_pollThread( new Thread( "poll" ) ),
 m_pollMutex( new Mutex() ),
+m_pollEvent( new Event() ),
+m_pollClockBase( 0 ),
+m_lastPollTime( 0 ),
+m_pollGeneration( 0 ),
 m_pollInterval( 0 ),
 m_bIntervalBetweenPolls( false ),				// if set to true (via SetPollInterval), the pollInterval will be interspersed between each poll (so a much smaller m_pollInterval like 100, 500, or 1,000 may be appropriate)
 m_currentControllerCommand( NULL ),
@@ -179,6 +183,7 @@ m_controllerResetEvent( NULL ),
 m_sendMutex( new Mutex() ),
 m_currentMsg( NULL ),
 m_virtualNeighborsReceived( false ),
+m_notificationsMutex( new Mutex() ),
 m_notificationsEvent( new Event() ),
 m_SOFCnt( 0 ),
 m_ACKWaiting( 0 ),
@@ -201,6 +206,10 @@ m_nondelivery( 0 ),
 m_routedbusy( 0 ),
 m_broadcastReadCnt( 0 ),
 m_broadcastWriteCnt( 0 ),
+m_pollCnt( 0 ),
+m_pollSkipped( 0 ),
+m_pollLagTotal( 0 ),
+m_pollLagMax( 0 ),
 m_nonceReportSent( 0 ),
 m_nonceReportSentAttempt( 0 )
 {
@@ -310,6 +319,7 @@ Driver::~Driver
 	}
 	// Don't release until all nodes have removed their poll values
 	m_pollMutex->Release();
+	m_pollEvent->Release();
 
 	// Clear the send Queue
 	for( int32 i=0; i<MsgQueue_Count; ++i )
@@ -350,6 +360,14 @@ Driver::~Driver
 	if (m_controllerReplication)
 		delete m_controllerReplication;
 
+	// Discard the notifications that were never delivered
+	for( vector<Notification*>::iterator nit = m_notifications.begin(); nit != m_notifications.end(); ++nit )
+	{
+		delete *nit;
+	}
+	m_notifications.clear();
+
+	m_notificationsMutex->Release();
 	m_notificationsEvent->Release();
 	m_nodeMutex->Release();
 
@@ -3918,6 +3936,27 @@ void Driver::CommonAddNodeStatusRequestHandler
 //	Polling Z-Wave devices
 //-----------------------------------------------------------------------------
 
+//-----------------------------------------------------------------------------
+// <Driver::SetPollInterval>
+// Set the poll interval, and move the polled values onto the new schedule
+//-----------------------------------------------------------------------------
+void Driver::SetPollInterval
+(
+		int32 const _milliseconds,
+		bool const _bIntervalBetweenPolls
+)
+{
+	LockGuard LG(m_pollMutex);
+
+	m_pollInterval = _milliseconds;
+	m_bIntervalBetweenPolls = _bIntervalBetweenPolls;
+
+	for( map<ValueID,PollEntry>::iterator it = m_pollList.begin(); it != m_pollList.end(); ++it )
+	{
+		SchedulePoll( it->first, it->second );
+	}
+}
+
 //-----------------------------------------------------------------------------
 // <Driver::EnablePoll>
 // Enable polling of a value
@@ -3942,27 +3981,30 @@ bool Driver::EnablePoll
 		{
 			// update the value's pollIntensity
 			value->SetPollIntensity( _intensity );
+			value->Release();
 
-			// Add the valueid to the polling list
-			// See if the node is already in the poll list.
-			for( list<PollEntry>::iterator it = m_pollList.begin(); it != m_pollList.end(); ++it )
+			// See if the value is already in the poll list.
+			map<ValueID,PollEntry>::iterator it = m_pollList.find( _valueId );
+			if( it != m_pollList.end() )
 			{
-				if( (*it).m_id == _valueId )
+				// It is already in the poll list, so at most its period has changed.
+				if( it->second.m_intensity != _intensity )
 				{
-					// It is already in the poll list, so we have nothing to do.
-					Log::Write( LogLevel_Detail, "EnablePoll not required to do anything (value is already in the poll list)" );
-					value->Release();
-					m_pollMutex->Unlock();
-					return true;
+					it->second.m_intensity = _intensity;
+					SchedulePoll( it->first, it->second );
 				}
+				Log::Write( LogLevel_Detail, "EnablePoll not required to do anything (value is already in the poll list)" );
+				m_pollMutex->Unlock();
+				return true;
 			}
 
 			// Not in the list, so we add it
 			PollEntry pe;
-			pe.m_id = _valueId;
-			pe.m_pollCounter = value->GetPollIntensity();
-			m_pollList.push_back( pe );
-			value->Release();
+			pe.m_intensity = _intensity;
+			pe.m_due = 0;
+			pe.m_generation = 0;
+			it = m_pollList.insert( pair<ValueID,PollEntry>( _valueId, pe ) ).first;
+			SchedulePoll( it->first, it->second );
 			m_pollMutex->Unlock();
 
 			// send notification to indicate polling is enabled
@@ -4006,31 +4048,28 @@ bool Driver::DisablePoll
 	Node* node = GetNode( nodeId );
 	if( node != NULL)
 	{
-		// See if the value is already in the poll list.
-		for( list<PollEntry>::iterator it = m_pollList.begin(); it != m_pollList.end(); ++it )
+		// See if the value is in the poll list.
+		map<ValueID,PollEntry>::iterator it = m_pollList.find( _valueId );
+		if( it != m_pollList.end() )
 		{
-			if( (*it).m_id == _valueId )
-			{
-				// Found it
-				// remove it from the poll list
-				m_pollList.erase( it );
+			// remove it from the poll list, its slot in the poll queue is skipped when it comes up
+			m_pollList.erase( it );
 
-				// get the value object and reset pollIntensity to zero (indicating no polling)
-				Value* value = GetValue( _valueId );
-				if (!value)
-					continue;
+			// get the value object and reset pollIntensity to zero (indicating no polling)
+			if( Value* value = GetValue( _valueId ) )
+			{
 				value->SetPollIntensity( 0 );
 				value->Release();
-				m_pollMutex->Unlock();
-
-				// send notification to indicate polling is disabled
-				Notification* notification = new Notification( Notification::Type_PollingDisabled );
-				notification->SetHomeAndNodeIds( m_homeId, _valueId.GetNodeId() );
-				QueueNotification( notification );
-				Log::Write( LogLevel_Info, nodeId, "DisablePoll for HomeID 0x%.8x, value(cc=0x%02x,in=0x%02x,id=0x%02x)--poll list has %d items",
-						_valueId.GetHomeId(), _valueId.GetCommandClassId(), _valueId.GetIndex(), _valueId.GetInstance(), m_pollList.size() );
-				return true;
 			}
+			m_pollMutex->Unlock();
+
+			// send notification to indicate polling is disabled
+			Notification* notification = new Notification( Notification::Type_PollingDisabled );
+			notification->SetHomeAndNodeIds( m_homeId, _valueId.GetNodeId() );
+			QueueNotification( notification );
+			Log::Write( LogLevel_Info, nodeId, "DisablePoll for HomeID 0x%.8x, value(cc=0x%02x,in=0x%02x,id=0x%02x)--poll list has %d items",
+					_valueId.GetHomeId(), _valueId.GetCommandClassId(), _valueId.GetIndex(), _valueId.GetInstance(), m_pollList.size() );
+			return true;
 		}
 
 		// Not in the list
@@ -4083,22 +4122,18 @@ bool Driver::isPolled
 	Node* node = GetNode( nodeId );
 	if( node != NULL)
 	{
-
 		// See if the value is already in the poll list.
-		for( list<PollEntry>::iterator it = m_pollList.begin(); it != m_pollList.end(); ++it )
+		if( m_pollList.find( _valueId ) != m_pollList.end() )
 		{
-			if( (*it).m_id == _valueId )
+			// Found it
+			if( bPolled )
 			{
-				// Found it
-				if( bPolled )
-				{
-					m_pollMutex->Unlock();
-					return true;
-				}
-				else
-				{
-					Log::Write( LogLevel_Error, nodeId, "IsPolled setting for valueId 0x%016x is not consistent with the poll list", _valueId.GetId() );
-				}
+				m_pollMutex->Unlock();
+				return true;
+			}
+			else
+			{
+				Log::Write( LogLevel_Error, nodeId, "IsPolled setting for valueId 0x%016x is not consistent with the poll list", _valueId.GetId() );
 			}
 		}
 
@@ -4137,13 +4172,130 @@ void Driver::SetPollIntensity
 
 	Value* value = GetValue( _valueId );
 	if (!value)
+	{
+		m_pollMutex->Unlock();
 		return;
+	}
 	value->SetPollIntensity( _intensity );
-
 	value->Release();
+
+	// The intensity sets the value's poll period
+	map<ValueID,PollEntry>::iterator it = m_pollList.find( _valueId );
+	if( it != m_pollList.end() && it->second.m_intensity != _intensity )
+	{
+		it->second.m_intensity = _intensity;
+		SchedulePoll( it->first, it->second );
+	}
+
 	m_pollMutex->Unlock();
 }
 
+//-----------------------------------------------------------------------------
+// <Driver::GetPollTime>
+// Milliseconds on the poll clock.  TimeStamp differences are only 32 bits, so
+// the elapsed time is folded into m_pollClockBase every hour.
+// Must be called with m_pollMutex held.
+//-----------------------------------------------------------------------------
+int64 Driver::GetPollTime
+(
+)
+{
+	int32 elapsed = -m_pollClock.TimeRemaining();
+	if( elapsed < 0 || elapsed > 60*60*1000 )
+	{
+		// Never let the poll clock run backwards, even if the system time does
+		if( elapsed > 0 )
+		{
+			m_pollClockBase += elapsed;
+		}
+		m_pollClock.SetTime();
+		elapsed = 0;
+	}
+
+	return m_pollClockBase + elapsed;
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::GetPollPeriod>
+// Time between polls of a value with the given intensity
+//-----------------------------------------------------------------------------
+int64 Driver::GetPollPeriod
+(
+		uint8 const _intensity
+)
+{
+	int64 interval = m_pollInterval;
+	if( m_bIntervalBetweenPolls )
+	{
+		// m_pollInterval separates consecutive polls, so a pass over the whole list takes this long
+		interval *= (int64)m_pollList.size();
+	}
+	else if( interval < 100 )
+	{
+		// A legacy setting, in seconds
+		interval *= 1000;
+	}
+
+	// An intensity of n polls the value every n passes over the list
+	int64 period = interval * ( _intensity ? _intensity : 1 );
+	return ( period > 0 ) ? period : 1;
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::GetPollPhase>
+// Offset of a value's first poll into its period.  Nodes are spread across
+// the period, so that values enabled together do not all fall due at once.
+//-----------------------------------------------------------------------------
+int64 Driver::GetPollPhase
+(
+		ValueID const& _valueId,
+		int64 const _period
+)
+{
+	// 97 is odd, so consecutive node ids land far apart among the 256 slots
+	uint32 slot = ( _valueId.GetNodeId() * 97 + _valueId.GetInstance() * 13 + _valueId.GetIndex() ) & 0xff;
+	return ( _period * slot ) >> 8;
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::SchedulePoll>
+// (Re)start the poll schedule of a value from now.
+// Must be called with m_pollMutex held.
+//-----------------------------------------------------------------------------
+void Driver::SchedulePoll
+(
+		ValueID const& _valueId,
+		PollEntry& _entry
+)
+{
+	// Any slot already queued for the value is skipped from now on
+	_entry.m_generation = ++m_pollGeneration;
+	if( _entry.m_intensity == 0 )
+	{
+		// Polling is suspended
+		return;
+	}
+
+	_entry.m_due = GetPollTime() + GetPollPhase( _valueId, GetPollPeriod( _entry.m_intensity ) );
+	m_pollQueue.push( PollSlot( _entry.m_due, _entry.m_generation, _valueId ) );
+
+	// Drop the skipped slots once they outnumber the live ones
+	if( m_pollQueue.size() > 2 * m_pollList.size() + 64 )
+	{
+		priority_queue<PollSlot> pollQueue;
+		for( map<ValueID,PollEntry>::iterator it = m_pollList.begin(); it != m_pollList.end(); ++it )
+		{
+			if( it->second.m_intensity != 0 )
+			{
+				pollQueue.push( PollSlot( it->second.m_due, it->second.m_generation, it->first ) );
+			}
+		}
+		m_pollQueue = pollQueue;
+	}
+
+	m_pollEvent->Set();
+}
+
 //-----------------------------------------------------------------------------
 // <Driver::PollThreadEntryPoint>
 // Entry point of the thread for poll Z-Wave devices
@@ -4170,137 +4322,163 @@ void Driver::PollThreadProc
 		Event* _exitEvent
 )
 {
+	Wait* waitObjects[2];
+	waitObjects[0] = _exitEvent;		// Thread must exit.
+	waitObjects[1] = m_pollEvent;		// The poll schedule has changed.
+
+	int loopCount = 0;
 	while( 1 )
 	{
-		int32 pollInterval = m_pollInterval;
+		// Re-check every 500ms until there is something to poll
+		int32 timeout = 500;
 
 		if( m_awakeNodesQueried && !m_pollList.empty() )
 		{
-			// We only bother getting the lock if the pollList is not empty
-			m_pollMutex->Lock();
-
-			// Get the next value to be polled
-			PollEntry pe = m_pollList.front();
-			m_pollList.pop_front();
-			ValueID  valueId = pe.m_id;
-
-			// only execute this poll if pe.m_pollCounter == 1; otherwise decrement the counter and process the next polled value
-			if( pe.m_pollCounter != 1)
-			{
-				pe.m_pollCounter--;
-				m_pollList.push_back( pe );
-				m_pollMutex->Unlock();
-				continue;
-			}
-
-			// reset the poll counter to the full pollIntensity value and push it at the end of the list
-			// release the value object referenced; call GetNode to ensure the node objects are locked during this period
-			{
-				LockGuard LG(m_nodeMutex);
-				(void)GetNode( valueId.GetNodeId() );
-				Value* value = GetValue( valueId );
-				if (!value)
-					continue;
-				pe.m_pollCounter = value->GetPollIntensity();
-				m_pollList.push_back( pe );
-				value->Release();
-			}
-			// If the polling interval is for the whole poll list, calculate the time before the next poll,
-			// so that all polls can take place within the user-specified interval.
-			if( !m_bIntervalBetweenPolls )
-			{
-				if( pollInterval < 100 )
-				{
-					Log::Write( LogLevel_Info, "The pollInterval setting is only %d, which appears to be a legacy setting.  Multiplying by 1000 to convert to ms.", pollInterval );
-					pollInterval *= 1000;
-				}
-				pollInterval /= (int32) m_pollList.size();
-			}
-
-			{
-				LockGuard LG(m_nodeMutex);
-				// Request the state of the value from the node to which it belongs
-				if( Node* node = GetNode( valueId.GetNodeId() ) )
-				{
-					bool requestState = true;
-					if( !node->IsListeningDevice() )
-					{
-						// The device is not awake all the time.  If it is not awake, we mark it
-						// as requiring a poll.  The poll will be done next time the node wakes up.
-						if( WakeUp* wakeUp = static_cast<WakeUp*>( node->GetCommandClass( WakeUp::StaticGetCommandClassId() ) ) )
-						{
-							if( !wakeUp->IsAwake() )
-							{
-								wakeUp->SetPollRequired();
-								requestState = false;
-							}
-						}
-					}
-
-					if( requestState )
-					{
-						// Request an update of the value
-						CommandClass* cc = node->GetCommandClass( valueId.GetCommandClassId() );
-						if (cc) {
-							uint8 index = valueId.GetIndex();
-							uint8 instance = valueId.GetInstance();
-							Log::Write( LogLevel_Detail, node->m_nodeId, "Polling: %s index = %d instance = %d (poll queue has %d messages)", cc->GetCommandClassName().c_str(), index, instance, m_msgQueue[MsgQueue_Poll].size() );
-							cc->RequestValue( 0, index, instance, MsgQueue_Poll );
-						}
-					}
-
-				}
-			}
-
-			m_pollMutex->Unlock();
-
-			// Polling messages are only sent when there are no other messages waiting to be sent
-			// While this makes the polls much more variable and uncertain if some other activity dominates
-			// a send queue, that may be appropriate
-			// TODO we can have a debate about whether to test all four queues or just the Poll queue
+			// Polling messages are only sent when there are no other messages waiting to be sent,
+			// so a controller that is still working through earlier traffic (earlier polls included)
+			// is not handed any more.  Values that fall behind meanwhile skip their missed polls.
 			// Wait until the library isn't actively sending messages (or in the midst of a transaction)
-			int i32;
-			int loopCount = 0;
-			while( !m_msgQueue[MsgQueue_Poll].empty()
+			if( !m_msgQueue[MsgQueue_Poll].empty()
 					|| !m_msgQueue[MsgQueue_Send].empty()
 					|| !m_msgQueue[MsgQueue_Command].empty()
 					|| !m_msgQueue[MsgQueue_Query].empty()
 					|| m_currentMsg != NULL )
 			{
-				i32 = Wait::Single( _exitEvent, 10);		// test conditions every 10ms
-				if( i32 == 0 )
-				{
-					// Exit has been called
-					return;
-				}
+				timeout = 10;		// test conditions every 10ms
 				loopCount++;
 				if( loopCount == 3000*10 )		// 300 seconds worth of delay?  Something unusual is going on
 				{
 					Log::Write( LogLevel_Warning, "Poll queue hasn't been able to execute for 300 secs or more" );
 					Log::QueueDump();
-					//					assert( 0 );
 				}
 			}
-
-			// ready for next poll...insert the pollInterval delay
-			i32 = Wait::Single( _exitEvent, pollInterval );
-			if( i32 == 0 )
+			else
 			{
-				// Exit has been called
-				return;
+				loopCount = 0;
+				timeout = PollNextValue();
 			}
 		}
-		else		// poll list is empty or awake nodes haven't been fully queried yet
+
+		int32 i32 = Wait::Multiple( waitObjects, 2, timeout );
+		if( i32 == 0 )
+		{
+			// Exit has been called
+			return;
+		}
+		if( i32 == 1 )
+		{
+			m_pollEvent->Reset();
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::PollNextValue>
+// Poll the value with the earliest deadline, if it is due.  Returns how long
+// the poll thread can wait before anything else falls due.
+//-----------------------------------------------------------------------------
+int32 Driver::PollNextValue
+(
+)
+{
+	LockGuard LG(m_pollMutex);
+
+	// Skip the slots of values that were rescheduled or removed since they were queued
+	map<ValueID,PollEntry>::iterator it = m_pollList.end();
+	while( !m_pollQueue.empty() )
+	{
+		PollSlot const& slot = m_pollQueue.top();
+		it = m_pollList.find( slot.m_id );
+		if( it != m_pollList.end() && it->second.m_generation == slot.m_generation )
+		{
+			break;
+		}
+		m_pollQueue.pop();
+		it = m_pollList.end();
+	}
+
+	if( it == m_pollList.end() )
+	{
+		// Nothing to poll
+		return 500;
+	}
+
+	int64 now = GetPollTime();
+	int64 due = it->second.m_due;
+	if( m_bIntervalBetweenPolls && ( m_lastPollTime + m_pollInterval ) > due )
+	{
+		due = m_lastPollTime + m_pollInterval;
+	}
+	if( due > now )
+	{
+		return ( ( due - now ) < 0x7fffffff ) ? (int32)( due - now ) : 0x7fffffff;
+	}
+
+	ValueID valueId = it->first;
+	PollEntry& pe = it->second;
+	m_pollQueue.pop();
+
+	// A value that fell more than a whole period behind skips the polls it missed,
+	// instead of having them sent back to back.
+	int64 lag = now - pe.m_due;
+	int64 period = GetPollPeriod( pe.m_intensity );
+	int64 missed = lag / period;
+	m_pollSkipped += (uint32)missed;
+	pe.m_due += ( missed + 1 ) * period;
+	m_pollQueue.push( PollSlot( pe.m_due, pe.m_generation, valueId ) );
+
+	// release the value object referenced; call GetNode to ensure the node objects are locked during this period
+	LockGuard LGN(m_nodeMutex);
+	(void)GetNode( valueId.GetNodeId() );
+	Value* value = GetValue( valueId );
+	if( !value )
+	{
+		// The value is gone, so there is nothing left to poll
+		m_pollList.erase( it );
+		return 0;
+	}
+	value->Release();
+
+	m_lastPollTime = now;
+	m_pollCnt++;
+	m_pollLagTotal += (uint64)lag;
+	if( lag > m_pollLagMax )
+	{
+		m_pollLagMax = ( lag < 0xffffffff ) ? (uint32)lag : 0xffffffff;
+	}
+
+	// Request the state of the value from the node to which it belongs
+	if( Node* node = GetNode( valueId.GetNodeId() ) )
+	{
+		bool requestState = true;
+		if( !node->IsListeningDevice() )
 		{
-			// don't poll just yet, wait for the pollInterval or exit before re-checking to see if the pollList has elements
-			int32 i32 = Wait::Single( _exitEvent, 500 );
-			if( i32 == 0 )
+			// The device is not awake all the time.  If it is not awake, we mark it
+			// as requiring a poll.  The poll will be done next time the node wakes up.
+			if( WakeUp* wakeUp = static_cast<WakeUp*>( node->GetCommandClass( WakeUp::StaticGetCommandClassId() ) ) )
 			{
-				// Exit has been called
-				return;
+				if( !wakeUp->IsAwake() )
+				{
+					wakeUp->SetPollRequired();
+					requestState = false;
+				}
+			}
+		}
+
+		if( requestState )
+		{
+			// Request an update of the value
+			CommandClass* cc = node->GetCommandClass( valueId.GetCommandClassId() );
+			if (cc) {
+				uint8 index = valueId.GetIndex();
+				uint8 instance = valueId.GetInstance();
+				Log::Write( LogLevel_Detail, node->m_nodeId, "Polling: %s index = %d instance = %d (poll queue has %d messages)", cc->GetCommandClassName().c_str(), index, instance, m_msgQueue[MsgQueue_Poll].size() );
+				cc->RequestValue( 0, index, instance, MsgQueue_Poll );
 			}
 		}
 	}
+
+	return 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -5735,7 +5913,9 @@ void Driver::QueueNotification
 		Notification* _notification
 )
 {
+	m_notificationsMutex->Lock();
 	m_notifications.push_back( _notification );
+	m_notificationsMutex->Unlock();
 	m_notificationsEvent->Set();
 }
 
@@ -5747,35 +5927,66 @@ void Driver::NotifyWatchers
 (
 )
 {
-	list<Notification*>::iterator nit = m_notifications.begin();
-	while( nit != m_notifications.end() )
+	vector<Notification*> batch;
+	while( 1 )
 	{
-		Notification* notification = m_notifications.front();
-		m_notifications.pop_front();
+		// Take everything queued so far.  Anything queued after this sets the event again.
+		m_notificationsMutex->Lock();
+		m_notificationsEvent->Reset();
+		batch.swap( m_notifications );
+		m_notificationsMutex->Unlock();
 
-		/* check the any ValueID's sent as part of the Notification are still valid */
-		switch (notification->GetType()) {
-			case Notification::Type_ValueChanged:
-			case Notification::Type_ValueRefreshed:
-				if (!GetValue(notification->GetValueID())) {
-					Log::Write(LogLevel_Info, notification->GetNodeId(), "Dropping Notification as ValueID does not exist");
-					nit = m_notifications.begin();
-					delete notification;
-					continue;
+		if( batch.empty() )
+		{
+			break;
+		}
+
+		// check the any ValueID's sent as part of the Notification are still valid
+		{
+			LockGuard LG(m_nodeMutex);
+			for( vector<Notification*>::iterator nit = batch.begin(); nit != batch.end(); ++nit )
+			{
+				Notification* notification = *nit;
+				switch (notification->GetType()) {
+					case Notification::Type_ValueChanged:
+					case Notification::Type_ValueRefreshed:
+						if( Value* value = GetValue( notification->GetValueID() ) )
+						{
+							value->Release();
+						}
+						else
+						{
+							Log::Write(LogLevel_Info, notification->GetNodeId(), "Dropping Notification as ValueID does not exist");
+							delete notification;
+							*nit = NULL;
+						}
+						break;
+					default:
+						break;
 				}
-				break;
-			default:
-				break;
+			}
 		}
 
-		Log::Write(LogLevel_Detail, notification->GetNodeId(), "Notification: %s", notification->GetAsString().c_str());
+		// Only build the descriptions if they are going to be logged
+		if( Log::IsLevelLogged( LogLevel_Detail ) )
+		{
+			for( vector<Notification*>::iterator nit = batch.begin(); nit != batch.end(); ++nit )
+			{
+				if( *nit != NULL )
+				{
+					Log::Write(LogLevel_Detail, (*nit)->GetNodeId(), "Notification: %s", (*nit)->GetAsString().c_str());
+				}
+			}
+		}
 
-		Manager::Get()->NotifyWatchers( notification );
+		Manager::Get()->NotifyWatchers( batch );
 
-		delete notification;
-		nit = m_notifications.begin();
+		for( vector<Notification*>::iterator nit = batch.begin(); nit != batch.end(); ++nit )
+		{
+			delete *nit;
+		}
+		batch.clear();
 	}
-	m_notificationsEvent->Reset();
 }
 
 //-----------------------------------------------------------------------------
@@ -6452,6 +6663,10 @@ void Driver::GetDriverStatistics
 	_data->m_routedbusy = m_routedbusy;
 	_data->m_broadcastReadCnt = m_broadcastReadCnt;
 	_data->m_broadcastWriteCnt = m_broadcastWriteCnt;
+	_data->m_pollCnt = m_pollCnt;
+	_data->m_pollSkipped = m_pollSkipped;
+	_data->m_pollLagAvg = m_pollCnt ? (uint32)( m_pollLagTotal / m_pollCnt ) : 0;
+	_data->m_pollLagMax = m_pollLagMax;
 }
 
 //-----------------------------------------------------------------------------
@@ -6515,6 +6730,11 @@ void Driver::LogDriverStatistics
 	Log::Write( LogLevel_Always, "Out of frame data flow errors:  . . . . . . . . . . . . . %ld", data.m_OOFCnt );
 	Log::Write( LogLevel_Always, "Messages retransmitted: . . . . . . . . . . . . . . . . . %ld", data.m_retries );
 	Log::Write( LogLevel_Always, "Messages dropped and not delivered: . . . . . . . . . . . %ld", data.m_dropped );
+	Log::Write( LogLevel_Always, "*** Polling" );
+	Log::Write( LogLevel_Always, "Value polls sent: . . . . . . . . . . . . . . . . . . . . %ld", data.m_pollCnt );
+	Log::Write( LogLevel_Always, "Polls skipped, value more than a period overdue:  . . . . %ld", data.m_pollSkipped );
+	Log::Write( LogLevel_Always, "Average poll lag (ms): . . . . . . . . . . . . . . . . . . %ld", data.m_pollLagAvg );
+	Log::Write( LogLevel_Always, "Maximum poll lag (ms): . . . . . . . . . . . . . . . . . . %ld", data.m_pollLagMax );
 	Log::Write( LogLevel_Always, "***************************************************************************" );
 }
 
@@ -31,6 +31,8 @@
 #include <string>
 #include <map>
 #include <list>
+#include <vector>
+#include <queue>
 
 #include "Defs.h"
 #include "value_classes/ValueID.h"
@@ -348,7 +350,7 @@ namespace OpenZWave
 	//-----------------------------------------------------------------------------
 	private:
 		int32 GetPollInterval(){ return m_pollInterval ; }
-		void SetPollInterval( int32 _milliseconds, bool _bIntervalBetweenPolls ){ m_pollInterval = _milliseconds; m_bIntervalBetweenPolls = _bIntervalBetweenPolls; }
+		void SetPollInterval( int32 _milliseconds, bool _bIntervalBetweenPolls );
 		bool EnablePoll( const ValueID &_valueId, uint8 _intensity = 1 );
 		bool DisablePoll( const ValueID &_valueId );
 		bool isPolled( const ValueID &_valueId );
@@ -356,16 +358,45 @@ namespace OpenZWave
 		static void PollThreadEntryPoint( Event* _exitEvent, void* _context );
 		void PollThreadProc( Event* _exitEvent );
 
-		Thread*					m_pollThread;								// Thread for polling devices on the Z-Wave network
+		// Values are polled in deadline order.  Each value has its own period (the poll
+		// interval times its poll intensity), and a phase derived from its node so that
+		// values that are enabled together do not all fall due at once.
 		struct PollEntry
 		{
+			uint8	m_intensity;		// Copy of the value's poll intensity (0 = polling suspended)
+			int64	m_due;				// When the value is next due to be polled, on the poll clock
+			uint32	m_generation;		// Identifies the poll queue slot that is live for this value
+		};
+
+		struct PollSlot
+		{
+			int64	m_due;
+			uint32	m_generation;
 			ValueID	m_id;
-			uint8	m_pollCounter;
+
+			PollSlot( int64 _due, uint32 _generation, ValueID const& _id ): m_due( _due ), m_generation( _generation ), m_id( _id ){}
+
+			// Reversed, so that the priority queue returns the earliest deadline first
+			bool operator < ( PollSlot const& _other )const{ return m_due > _other.m_due; }
 		};
+
+		int64 GetPollTime();
+		int64 GetPollPeriod( uint8 const _intensity );
+		int64 GetPollPhase( ValueID const& _valueId, int64 const _period );
+		void SchedulePoll( ValueID const& _valueId, PollEntry& _entry );
+		int32 PollNextValue();
+
+		Thread*					m_pollThread;								// Thread for polling devices on the Z-Wave network
 OPENZWAVE_EXPORT_WARNINGS_OFF
-		list<PollEntry>			m_pollList;									// List of nodes that need to be polled
+		map<ValueID,PollEntry>	m_pollList;									// Values that need to be polled
+		priority_queue<PollSlot>	m_pollQueue;							// Poll deadlines.  Slots replaced by a later SchedulePoll are skipped when they come up
 OPENZWAVE_EXPORT_WARNINGS_ON
 		Mutex*					m_pollMutex;								// Serialize access to the polling list
+		Event*					m_pollEvent;								// Wakes the poll thread when the poll schedule changes
+		TimeStamp				m_pollClock;								// Poll clock, see GetPollTime
+		int64					m_pollClockBase;
+		int64					m_lastPollTime;								// When the last poll was sent, on the poll clock
+		uint32					m_pollGeneration;
 		int32					m_pollInterval;								// Time interval during which all nodes must be polled
 		bool					m_bIntervalBetweenPolls;					// if true, the library intersperses m_pollInterval between polls; if false, the library attempts to complete all polls within m_pollInterval
 
@@ -752,8 +783,9 @@ OPENZWAVE_EXPORT_WARNINGS_ON
 		void NotifyWatchers();												// Passes the notifications to all the registered watcher callbacks in turn.
 
 OPENZWAVE_EXPORT_WARNINGS_OFF
-		list<Notification*>		m_notifications;
+		vector<Notification*>	m_notifications;							// Notifications are queued from any thread, and delivered in batches by the driver thread
 OPENZWAVE_EXPORT_WARNINGS_ON
+		Mutex*				m_notificationsMutex;						// Serialize access to m_notifications
 		Event*				m_notificationsEvent;
 
 	//-----------------------------------------------------------------------------
@@ -783,6 +815,10 @@ OPENZWAVE_EXPORT_WARNINGS_ON
 			uint32 m_routedbusy;			// Number of messages received with routed busy status
 			uint32 m_broadcastReadCnt;		// Number of broadcasts read
 			uint32 m_broadcastWriteCnt;		// Number of broadcasts sent
+			uint32 m_pollCnt;			// Number of value polls sent
+			uint32 m_pollSkipped;			// Number of polls skipped because the value was more than a period overdue
+			uint32 m_pollLagAvg;			// Average time between a value falling due and its poll being sent (ms)
+			uint32 m_pollLagMax;			// Longest time between a value falling due and its poll being sent (ms)
 		};
 
 		void LogDriverStatistics();
@@ -812,6 +848,10 @@ OPENZWAVE_EXPORT_WARNINGS_ON
 		uint32 m_routedbusy;			// Number of messages received with routed busy status
 		uint32 m_broadcastReadCnt;		// Number of broadcasts read
 		uint32 m_broadcastWriteCnt;		// Number of broadcasts sent
+		uint32 m_pollCnt;			// Number of value polls sent
+		uint32 m_pollSkipped;			// Number of polls skipped because the value was more than a period overdue
+		uint64 m_pollLagTotal;			// Total time between values falling due and their polls being sent (ms)
+		uint32 m_pollLagMax;			// Longest time between a value falling due and its poll being sent (ms)
 		//time_t m_commandStart;	// Start time of last command
 		//time_t m_timeoutLost;		// Cumulative time lost to timeouts
 
@@ -145,6 +145,8 @@ m_notificationMutex( new Mutex() )
 	// Ensure the singleton instance is set
 	s_instance = this;
 
+	Notification::CreatePool();
+
 	// Create the log file (if enabled)
 	bool logging = false;
 	Options::Get()->GetOptionAsBool( "Logging", &logging );
@@ -180,8 +182,12 @@ m_notificationMutex( new Mutex() )
 	Options::Get()->GetOptionAsInt( "DumpTriggerLevel", &nDumpTrigger );
 
 	string logFilename = userPath + logFileNameBase;
+	bool bAsyncLogging = false;
+	Options::Get()->GetOptionAsBool( "AsyncLogging", &bAsyncLogging );
+
 	Log::Create( logFilename, bAppend, bConsoleOutput, (LogLevel) nSaveLogLevel, (LogLevel) nQueueLogLevel, (LogLevel) nDumpTrigger );
 	Log::SetLoggingState( logging );
+	Log::SetAsync( bAsyncLogging );
 
 	CommandClasses::RegisterCommandClasses();
 	Scene::ReadScenes();
@@ -213,6 +219,7 @@ Manager::~Manager
 	}
 
 	m_notificationMutex->Release();
+	Notification::DestroyPool();
 
 	// Clear the watchers list
 	while( !m_watchers.empty() )
@@ -3322,6 +3329,32 @@ void Manager::NotifyWatchers
 	m_notificationMutex->Unlock();
 }
 
+//-----------------------------------------------------------------------------
+// <Manager::NotifyWatchers>
+// Notify any watching objects of a batch of value changes
+//-----------------------------------------------------------------------------
+void Manager::NotifyWatchers
+(
+		vector<Notification*> const& _notifications
+)
+{
+	m_notificationMutex->Lock();
+	for( vector<Notification*>::const_iterator nit = _notifications.begin(); nit != _notifications.end(); ++nit )
+	{
+		if( *nit == NULL )
+		{
+			continue;
+		}
+
+		for( list<Watcher*>::iterator it = m_watchers.begin(); it != m_watchers.end(); ++it )
+		{
+			Watcher* pWatcher = *it;
+			pWatcher->m_callback( *nit, pWatcher->m_context );
+		}
+	}
+	m_notificationMutex->Unlock();
+}
+
 //-----------------------------------------------------------------------------
 //	Controller commands
 //-----------------------------------------------------------------------------
@@ -1535,6 +1535,7 @@ OPENZWAVE_EXPORT_WARNINGS_ON
 
 	private:
 		void NotifyWatchers( Notification* _notification );					// Passes the notifications to all the registered watcher callbacks in turn.
+		void NotifyWatchers( vector<Notification*> const& _notifications );	// Passes a batch of notifications to the watchers; NULL entries are skipped.
 
 		struct Watcher
 		{
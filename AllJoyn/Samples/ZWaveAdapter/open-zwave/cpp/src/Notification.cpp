@@ -28,9 +28,119 @@
 #include "Defs.h"
 #include "Notification.h"
 #include "Driver.h"
+#include "platform/Mutex.h"
 
 using namespace OpenZWave;
 
+// The number of freed notifications kept for reuse
+#define NOTIFICATION_POOL_SIZE	256
+
+// Freed notifications, linked through their first word.  The pool exists
+// while the Manager does, other notifications use the global heap.
+static Mutex* s_poolMutex = NULL;
+static void* s_poolHead = NULL;
+static uint32 s_poolCount = 0;
+
+//-----------------------------------------------------------------------------
+// <Notification::CreatePool>
+// Set up the pool of freed notifications
+//-----------------------------------------------------------------------------
+void Notification::CreatePool
+(
+)
+{
+	if( s_poolMutex == NULL )
+	{
+		s_poolMutex = new Mutex();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// <Notification::DestroyPool>
+// Free the notifications kept for reuse and the pool itself
+//-----------------------------------------------------------------------------
+void Notification::DestroyPool
+(
+)
+{
+	if( s_poolMutex == NULL )
+	{
+		return;
+	}
+
+	while( s_poolHead != NULL )
+	{
+		void* p = s_poolHead;
+		s_poolHead = *(void**)p;
+		::operator delete( p );
+	}
+	s_poolCount = 0;
+
+	s_poolMutex->Release();
+	s_poolMutex = NULL;
+}
+
+//-----------------------------------------------------------------------------
+// <Notification::operator new>
+// Reuse a freed notification if there is one
+//-----------------------------------------------------------------------------
+void* Notification::operator new
+(
+	size_t _size
+)
+{
+	void* p = NULL;
+	if( s_poolMutex != NULL && _size == sizeof(Notification) )
+	{
+		s_poolMutex->Lock();
+		p = s_poolHead;
+		if( p != NULL )
+		{
+			s_poolHead = *(void**)p;
+			--s_poolCount;
+		}
+		s_poolMutex->Unlock();
+	}
+
+	return ( p != NULL ) ? p : ::operator new( _size );
+}
+
+//-----------------------------------------------------------------------------
+// <Notification::operator delete>
+// Keep the notification for reuse, unless the pool is full
+//-----------------------------------------------------------------------------
+void Notification::operator delete
+(
+	void* _p
+)
+{
+	if( _p == NULL )
+	{
+		return;
+	}
+
+	if( s_poolMutex == NULL )
+	{
+		::operator delete( _p );
+		return;
+	}
+
+	s_poolMutex->Lock();
+	if( s_poolCount < NOTIFICATION_POOL_SIZE )
+	{
+		*(void**)_p = s_poolHead;
+		s_poolHead = _p;
+		++s_poolCount;
+		_p = NULL;
+	}
+	s_poolMutex->Unlock();
+
+	if( _p != NULL )
+	{
+		::operator delete( _p );
+	}
+}
+
 
 //-----------------------------------------------------------------------------
 // <Notification::GetAsString>
@@ -185,6 +185,12 @@ namespace OpenZWave
 		Notification( NotificationType _type ): m_type( _type ), m_byte(0), m_event(0) {}
 		~Notification(){}
 
+		// Notifications are allocated from a pool of recycled objects
+		static void* operator new( size_t _size );
+		static void operator delete( void* _p );
+		static void CreatePool();
+		static void DestroyPool();
+
 		void SetHomeAndNodeIds( uint32 const _homeId, uint8 const _nodeId ){ m_valueId = ValueID( _homeId, _nodeId ); }
 		void SetHomeNodeIdAndInstance ( uint32 const _homeId, uint8 const _nodeId, uint32 const _instance ){ m_valueId = ValueID( _homeId, _nodeId, _instance ); }
 		void SetValueId( ValueID const& _valueId ){ m_valueId = _valueId; }
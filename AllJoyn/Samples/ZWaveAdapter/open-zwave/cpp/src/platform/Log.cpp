@@ -27,8 +27,14 @@
 //-----------------------------------------------------------------------------
 #include <stdarg.h>
 
+#include <stdio.h>
+#include <string.h>
+
 #include "Defs.h"
+#include "platform/Event.h"
 #include "platform/Mutex.h"
+#include "platform/Thread.h"
+#include "platform/Wait.h"
 #include "platform/Log.h"
 
 #ifdef WIN32
@@ -64,6 +70,415 @@ char const *OpenZWave::LogLevelString[] =
 Log* Log::s_instance = NULL;
 i_LogImpl* Log::m_pImpl = NULL;
 static bool s_dologging;
+static LogLevel s_saveLevel = LogLevel_StreamDetail;	// copies of the LogImpl levels, for IsLevelLogged
+static LogLevel s_queueLevel = LogLevel_StreamDetail;
+static LogLevel s_dumpTrigger = LogLevel_StreamDetail;	// assume any level may trigger a dump until told otherwise
+
+#define LOG_RING_SIZE		512		// records in the asynchronous log ring
+#define LOG_RECORD_SIZE		1024	// same line length as the logging implementations
+
+// A record keeps the message format and a copy of its arguments, so the caller
+// does not pay for formatting.  The log thread formats it when writing it out.
+struct Log::LogRecord
+{
+	LogLevel	m_level;
+	uint8		m_nodeId;
+	bool		m_formatted;	// m_data holds the formatted text rather than a format and its arguments
+	LogTime		m_time;			// when the message was logged
+	char		m_data[LOG_RECORD_SIZE];
+};
+
+// Type of the argument a printf conversion takes
+enum LogArgType
+{
+	LogArg_None,		// %%
+	LogArg_Int,
+	LogArg_Long,
+	LogArg_LongLong,
+	LogArg_SizeT,
+	LogArg_Double,
+	LogArg_LongDouble,
+	LogArg_String,
+	LogArg_Pointer,
+	LogArg_Unsupported	// %n, wide strings and anything not parsed here
+};
+
+#define LOG_MAX_SPEC		32		// longest conversion specification handled
+
+// sprintf_s, which snprintf is renamed to on Windows, does not truncate
+#ifdef _MSC_VER
+#define LOG_SNPRINTF( _out, _size, ... )	_snprintf_s( _out, _size, _TRUNCATE, __VA_ARGS__ )
+#else
+#define LOG_SNPRINTF( _out, _size, ... )	snprintf( _out, _size, __VA_ARGS__ )
+#endif
+
+//-----------------------------------------------------------------------------
+//	<ParseConversion>
+//	Parse the conversion specification starting at the '%' at _spec.
+//	Returns its length, the type of its argument and the number of '*'
+//	width and precision arguments that come before it.
+//-----------------------------------------------------------------------------
+static size_t ParseConversion
+(
+	char const* _spec,
+	LogArgType* _type,
+	uint32* _stars
+)
+{
+	char const* p = _spec + 1;
+	*_stars = 0;
+
+	while( *p && strchr( "-+ #0'", *p ) )
+	{
+		++p;
+	}
+	if( *p == '*' )
+	{
+		++*_stars;
+		++p;
+	}
+	while( *p >= '0' && *p <= '9' )
+	{
+		++p;
+	}
+	if( *p == '.' )
+	{
+		++p;
+		if( *p == '*' )
+		{
+			++*_stars;
+			++p;
+		}
+		while( *p >= '0' && *p <= '9' )
+		{
+			++p;
+		}
+	}
+
+	LogArgType intType = LogArg_Int;
+	bool longDouble = false;
+	bool wide = false;
+	if( p[0] == 'h' )
+	{
+		p += ( p[1] == 'h' ) ? 2 : 1;
+	}
+	else if( p[0] == 'l' && p[1] == 'l' )
+	{
+		intType = LogArg_LongLong;
+		p += 2;
+	}
+	else if( p[0] == 'l' )
+	{
+		intType = LogArg_Long;
+		wide = true;
+		++p;
+	}
+	else if( p[0] == 'q' || ( p[0] == 'I' && p[1] == '6' && p[2] == '4' ) )
+	{
+		intType = LogArg_LongLong;
+		p += ( p[0] == 'q' ) ? 1 : 3;
+	}
+	else if( p[0] == 'I' && p[1] == '3' && p[2] == '2' )
+	{
+		p += 3;
+	}
+	else if( p[0] == 'z' || p[0] == 'I' )
+	{
+		intType = LogArg_SizeT;
+		++p;
+	}
+	else if( p[0] == 'L' )
+	{
+		longDouble = true;
+		++p;
+	}
+
+	switch( *p )
+	{
+		case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+			*_type = intType;
+			break;
+		case 'c':
+			*_type = wide ? LogArg_Unsupported : LogArg_Int;
+			break;
+		case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+			*_type = longDouble ? LogArg_LongDouble : LogArg_Double;
+			break;
+		case 's':
+			*_type = wide ? LogArg_Unsupported : LogArg_String;
+			break;
+		case 'p':
+			*_type = LogArg_Pointer;
+			break;
+		case '%':
+			*_type = ( p == _spec + 1 ) ? LogArg_None : LogArg_Unsupported;
+			break;
+		default:
+			*_type = LogArg_Unsupported;
+			return 0;
+	}
+
+	size_t length = p + 1 - _spec;
+	if( length >= LOG_MAX_SPEC )
+	{
+		*_type = LogArg_Unsupported;
+	}
+	return length;
+}
+
+//-----------------------------------------------------------------------------
+//	<CaptureValue>
+//	Append an argument value to a record
+//-----------------------------------------------------------------------------
+template<typename T>
+static bool CaptureValue
+(
+	char** _out,
+	char const* _end,
+	T const _value
+)
+{
+	if( (size_t)( _end - *_out ) < sizeof(T) )
+	{
+		return false;
+	}
+	memcpy( *_out, &_value, sizeof(T) );
+	*_out += sizeof(T);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+//	<CaptureMessage>
+//	Copy a message format and its arguments to a record buffer.  Returns
+//	false if the buffer is too small or the format is not supported.
+//-----------------------------------------------------------------------------
+static bool CaptureMessage
+(
+	char* _buffer,
+	size_t _size,
+	char const* _format,
+	va_list _args
+)
+{
+	size_t formatLength = strlen( _format ) + 1;
+	if( formatLength > _size )
+	{
+		return false;
+	}
+	memcpy( _buffer, _format, formatLength );
+
+	char* out = _buffer + formatLength;
+	char const* end = _buffer + _size;
+	for( char const* p = strchr( _format, '%' ); p != NULL; p = strchr( p, '%' ) )
+	{
+		LogArgType type;
+		uint32 stars;
+		size_t length = ParseConversion( p, &type, &stars );
+		if( type == LogArg_Unsupported )
+		{
+			return false;
+		}
+		p += length;
+
+		for( uint32 i = 0; i < stars; ++i )
+		{
+			if( !CaptureValue( &out, end, va_arg( _args, int ) ) )
+			{
+				return false;
+			}
+		}
+
+		bool captured = true;
+		switch( type )
+		{
+			case LogArg_Int:		captured = CaptureValue( &out, end, va_arg( _args, int ) );				break;
+			case LogArg_Long:		captured = CaptureValue( &out, end, va_arg( _args, long ) );			break;
+			case LogArg_LongLong:	captured = CaptureValue( &out, end, va_arg( _args, long long ) );		break;
+			case LogArg_SizeT:		captured = CaptureValue( &out, end, va_arg( _args, size_t ) );			break;
+			case LogArg_Double:		captured = CaptureValue( &out, end, va_arg( _args, double ) );			break;
+			case LogArg_LongDouble:	captured = CaptureValue( &out, end, va_arg( _args, long double ) );	break;
+			case LogArg_Pointer:	captured = CaptureValue( &out, end, va_arg( _args, void* ) );			break;
+			case LogArg_String:
+			{
+				// a NULL string is kept as a lone 0xff byte
+				char const* str = va_arg( _args, char const* );
+				size_t strLength = ( str != NULL ) ? strlen( str ) + 1 : 1;
+				if( (size_t)( end - out ) < strLength )
+				{
+					return false;
+				}
+				if( str != NULL )
+				{
+					memcpy( out, str, strLength );
+				}
+				else
+				{
+					*out = (char)0xff;
+				}
+				out += strLength;
+				break;
+			}
+			default:
+				break;
+		}
+		if( !captured )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+//	<FormatValue>
+//	Format a single conversion with the '*' arguments in front of its value
+//-----------------------------------------------------------------------------
+template<typename T>
+static int FormatValue
+(
+	char* _out,
+	size_t _size,
+	char const* _spec,
+	int const* _starArgs,
+	uint32 _stars,
+	T _value
+)
+{
+	switch( _stars )
+	{
+		case 0:		return LOG_SNPRINTF( _out, _size, _spec, _value );
+		case 1:		return LOG_SNPRINTF( _out, _size, _spec, _starArgs[0], _value );
+		default:	return LOG_SNPRINTF( _out, _size, _spec, _starArgs[0], _starArgs[1], _value );
+	}
+}
+
+//-----------------------------------------------------------------------------
+//	<ReadValue>
+//	Read the next argument value of a record
+//-----------------------------------------------------------------------------
+template<typename T>
+static T ReadValue
+(
+	char const** _in
+)
+{
+	T value;
+	memcpy( &value, *_in, sizeof(T) );
+	*_in += sizeof(T);
+	return value;
+}
+
+//-----------------------------------------------------------------------------
+//	<FormatRecord>
+//	Format a message captured by CaptureMessage
+//-----------------------------------------------------------------------------
+static void FormatRecord
+(
+	char const* _data,
+	char* _out,
+	size_t _size
+)
+{
+	char const* format = _data;
+	char const* in = _data + strlen( _data ) + 1;
+	size_t used = 0;
+	_out[0] = '\0';
+
+	char const* p = format;
+	while( *p && used + 1 < _size )
+	{
+		if( *p != '%' )
+		{
+			_out[used++] = *p++;
+			_out[used] = '\0';
+			continue;
+		}
+
+		LogArgType type;
+		uint32 stars;
+		size_t length = ParseConversion( p, &type, &stars );
+		char spec[LOG_MAX_SPEC];
+		memcpy( spec, p, length );
+		spec[length] = '\0';
+		p += length;
+
+		int starArgs[2] = { 0, 0 };
+		for( uint32 i = 0; i < stars; ++i )
+		{
+			starArgs[i] = ReadValue<int>( &in );
+		}
+
+		int written = 0;
+		switch( type )
+		{
+			case LogArg_None:		written = LOG_SNPRINTF( _out + used, _size - used, "%%" );										break;
+			case LogArg_Int:		written = FormatValue( _out + used, _size - used, spec, starArgs, stars, ReadValue<int>( &in ) );			break;
+			case LogArg_Long:		written = FormatValue( _out + used, _size - used, spec, starArgs, stars, ReadValue<long>( &in ) );			break;
+			case LogArg_LongLong:	written = FormatValue( _out + used, _size - used, spec, starArgs, stars, ReadValue<long long>( &in ) );		break;
+			case LogArg_SizeT:		written = FormatValue( _out + used, _size - used, spec, starArgs, stars, ReadValue<size_t>( &in ) );		break;
+			case LogArg_Double:		written = FormatValue( _out + used, _size - used, spec, starArgs, stars, ReadValue<double>( &in ) );		break;
+			case LogArg_LongDouble:	written = FormatValue( _out + used, _size - used, spec, starArgs, stars, ReadValue<long double>( &in ) );	break;
+			case LogArg_Pointer:	written = FormatValue( _out + used, _size - used, spec, starArgs, stars, ReadValue<void*>( &in ) );		break;
+			case LogArg_String:
+			{
+				char const* str = in;
+				in += ( (unsigned char)*in == 0xff ) ? 1 : strlen( in ) + 1;
+				written = FormatValue( _out + used, _size - used, spec, starArgs, stars, ( (unsigned char)*str == 0xff ) ? "(null)" : str );
+				break;
+			}
+			default:
+				break;
+		}
+
+		if( ( written < 0 ) || ( used + (size_t)written >= _size ) )
+		{
+			// truncated, as vsnprintf would
+			used += strlen( _out + used );
+			break;
+		}
+		used += (size_t)written;
+	}
+	_out[used] = '\0';
+}
+
+//-----------------------------------------------------------------------------
+//	<WriteToImpl>
+//	Pass a preformatted message to a logging implementation
+//-----------------------------------------------------------------------------
+static void WriteToImpl
+(
+	i_LogImpl* _impl,
+	LogLevel _level,
+	uint8 const _nodeId,
+	char const* _format,
+	...
+)
+{
+	va_list args;
+	va_start( args, _format );
+	_impl->Write( _level, _nodeId, _format, args );
+	va_end( args );
+}
+
+//-----------------------------------------------------------------------------
+//	<WriteToImpl>
+//	Pass a preformatted message logged at _time to a logging implementation
+//-----------------------------------------------------------------------------
+static void WriteToImpl
+(
+	i_LogImpl* _impl,
+	LogLevel _level,
+	uint8 const _nodeId,
+	LogTime const& _time,
+	char const* _format,
+	...
+)
+{
+	va_list args;
+	va_start( args, _format );
+	_impl->Write( _level, _nodeId, _time, _format, args );
+	va_end( args );
+}
 
 //-----------------------------------------------------------------------------
 //	<Log::Create>
@@ -79,6 +494,10 @@ Log* Log::Create
 	LogLevel const _dumpTrigger
 )
 {
+	s_saveLevel = _saveLevel;
+	s_queueLevel = _queueLevel;
+	s_dumpTrigger = _dumpTrigger;
+
 	if( NULL == s_instance )
 	{
 		s_instance = new Log( _filename, _bAppend, _bConsoleOutput, _saveLevel, _queueLevel, _dumpTrigger );
@@ -136,6 +555,11 @@ bool Log::SetLoggingClass
 {
 	delete m_pImpl;
 	m_pImpl = LogClass;
+
+	// We don't know which levels a custom logging class keeps
+	s_saveLevel = LogLevel_StreamDetail;
+	s_queueLevel = LogLevel_StreamDetail;
+	s_dumpTrigger = LogLevel_StreamDetail;
 	return true;
 }
 
@@ -194,7 +618,11 @@ void Log::SetLoggingState
 	if( s_instance && s_dologging && s_instance->m_pImpl )
 	{
 		s_instance->m_logMutex->Lock();
+		s_instance->DrainRing();
 		s_instance->m_pImpl->SetLoggingState( _saveLevel, _queueLevel, _dumpTrigger );
+		s_saveLevel = _saveLevel;
+		s_queueLevel = _queueLevel;
+		s_dumpTrigger = _dumpTrigger;
 		s_instance->m_logMutex->Unlock();
 	}
 
@@ -212,6 +640,23 @@ bool Log::GetLoggingState
 	return s_dologging;
 }
 
+//-----------------------------------------------------------------------------
+//	<Log::IsLevelLogged>
+//	Return true if messages of this level are saved or queued
+//-----------------------------------------------------------------------------
+bool Log::IsLevelLogged
+(
+	LogLevel _level
+)
+{
+	if( s_instance && s_dologging && s_instance->m_pImpl )
+	{
+		return( ( _level <= s_saveLevel ) || ( _level <= s_queueLevel ) );
+	}
+
+	return false;
+}
+
 //-----------------------------------------------------------------------------
 //	<Log::Write>
 //	Write to the log
@@ -225,12 +670,10 @@ void Log::Write
 {
 	if( s_instance && s_dologging && s_instance->m_pImpl )
 	{
-		s_instance->m_logMutex->Lock(); // double locks if recursive
 		va_list args;
 		va_start( args, _format );
-		s_instance->m_pImpl->Write( _level, 0, _format, args );
+		s_instance->Dispatch( _level, 0, _format, args );
 		va_end( args );
-		s_instance->m_logMutex->Unlock();
 	}
 }
 
@@ -248,14 +691,286 @@ void Log::Write
 {
 	if( s_instance && s_dologging && s_instance->m_pImpl )
 	{
-		if( _level != LogLevel_Internal )
-			s_instance->m_logMutex->Lock();
 		va_list args;
 		va_start( args, _format );
-		s_instance->m_pImpl->Write( _level, _nodeId, _format, args );
+		s_instance->Dispatch( _level, _nodeId, _format, args );
+		va_end( args );
+	}
+}
+
+//-----------------------------------------------------------------------------
+//	<Log::Dispatch>
+//	Write a message synchronously or hand it to the log thread
+//-----------------------------------------------------------------------------
+void Log::Dispatch
+(
+	LogLevel _level,
+	uint8 const _nodeId,
+	char const* _format,
+	va_list _args
+)
+{
+	if( _level == LogLevel_Internal )
+	{
+		// Only written by the implementation while it dumps its queue, with m_logMutex held
+		m_pImpl->Write( _level, _nodeId, _format, _args );
+		return;
+	}
+
+	if( ( _level > s_dumpTrigger ) && !IsLevelLogged( _level ) )
+	{
+		// The implementation would neither keep this message nor dump its queue because of it
+		return;
+	}
+
+	// LogLevel_Always messages are rare and are also written by the implementation
+	// in the middle of a queue dump, so they never go through the ring.
+	if( m_logThread && ( _level != LogLevel_Always ) )
+	{
+		if( Enqueue( _level, _nodeId, _format, _args ) )
+		{
+			return;
+		}
+
+		if( ( _level > LogLevel_Warning ) && ( _level > s_dumpTrigger ) )
+		{
+			m_ringMutex->Lock();
+			++m_dropped;
+			m_ringMutex->Unlock();
+			return;
+		}
+
+		// The ring is full and this message must not be lost: write everything out here
+	}
+
+	m_logMutex->Lock();
+	DrainRing();
+	++m_implDepth;
+	m_pImpl->Write( _level, _nodeId, _format, _args );
+	--m_implDepth;
+	m_logMutex->Unlock();
+}
+
+//-----------------------------------------------------------------------------
+//	<Log::Enqueue>
+//	Copy a message to the ring for the log thread.  Returns false, without
+//	using _args, if the ring is full.
+//-----------------------------------------------------------------------------
+bool Log::Enqueue
+(
+	LogLevel _level,
+	uint8 const _nodeId,
+	char const* _format,
+	va_list _args
+)
+{
+	LogTime now;
+	LogImpl::GetTime( &now );
+
+	m_ringMutex->Lock();
+	if( m_ringCount == LOG_RING_SIZE )
+	{
+		m_ringMutex->Unlock();
+		return false;
+	}
+
+	LogRecord& record = m_ring[( m_ringHead + m_ringCount ) % LOG_RING_SIZE];
+	record.m_level = _level;
+	record.m_nodeId = _nodeId;
+	record.m_time = now;
+	record.m_formatted = false;
+	if( _format == NULL )
+	{
+		record.m_data[0] = '\0';
+	}
+	else
+	{
+		va_list args;
+		va_copy( args, _args );
+		if( !CaptureMessage( record.m_data, sizeof(record.m_data), _format, args ) )
+		{
+			// Arguments that cannot be kept, or too long to: format them now
+			record.m_formatted = true;
+			vsnprintf( record.m_data, sizeof(record.m_data), _format, _args );
+		}
 		va_end( args );
-		if( _level != LogLevel_Internal )
-			s_instance->m_logMutex->Unlock();
+	}
+	++m_ringCount;
+	m_ringMutex->Unlock();
+
+	m_ringEvent->Set();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+//	<Log::DrainRing>
+//	Pass the queued records to the implementation.  m_logMutex must be held.
+//-----------------------------------------------------------------------------
+void Log::DrainRing
+(
+)
+{
+	if( m_ring == NULL || m_pImpl == NULL || m_implDepth > 0 )
+	{
+		// Never started, or called back from inside the implementation
+		return;
+	}
+
+	char text[LOG_RECORD_SIZE];
+	++m_implDepth;
+	while( true )
+	{
+		m_ringMutex->Lock();
+		uint32 count = m_ringCount;
+		uint32 dropped = m_dropped;
+		m_ringMutex->Unlock();
+
+		if( count == 0 )
+		{
+			if( dropped != m_droppedReported )
+			{
+				WriteToImpl( m_pImpl, LogLevel_Always, 0, "Log ring full, %u messages dropped", dropped - m_droppedReported );
+				m_droppedReported = dropped;
+			}
+			break;
+		}
+
+		// Producers only fill slots past the end of the queued records, so
+		// the head record can be written out without holding m_ringMutex.
+		LogRecord const& record = m_ring[m_ringHead];
+		if( record.m_formatted )
+		{
+			WriteToImpl( m_pImpl, record.m_level, record.m_nodeId, record.m_time, "%s", record.m_data );
+		}
+		else
+		{
+			FormatRecord( record.m_data, text, sizeof(text) );
+			WriteToImpl( m_pImpl, record.m_level, record.m_nodeId, record.m_time, "%s", text );
+		}
+
+		m_ringMutex->Lock();
+		m_ringHead = ( m_ringHead + 1 ) % LOG_RING_SIZE;
+		--m_ringCount;
+		m_ringMutex->Unlock();
+	}
+	--m_implDepth;
+}
+
+//-----------------------------------------------------------------------------
+//	<Log::SetAsync>
+//	Start or stop the log thread
+//-----------------------------------------------------------------------------
+void Log::SetAsync
+(
+	bool _async
+)
+{
+	if( NULL == s_instance )
+	{
+		return;
+	}
+
+	if( !_async )
+	{
+		s_instance->StopLogThread();
+		return;
+	}
+
+	if( NULL == s_instance->m_logThread )
+	{
+		if( NULL == s_instance->m_ring )
+		{
+			s_instance->m_ring = new LogRecord[LOG_RING_SIZE];
+		}
+		s_instance->m_logThread = new Thread( "log" );
+		s_instance->m_logThread->Start( Log::LogThreadEntryPoint, s_instance );
+	}
+}
+
+//-----------------------------------------------------------------------------
+//	<Log::GetDroppedCount>
+//	Return the number of messages dropped by the asynchronous mode
+//-----------------------------------------------------------------------------
+uint32 Log::GetDroppedCount
+(
+)
+{
+	uint32 dropped = 0;
+	if( s_instance )
+	{
+		s_instance->m_ringMutex->Lock();
+		dropped = s_instance->m_dropped;
+		s_instance->m_ringMutex->Unlock();
+	}
+	return dropped;
+}
+
+//-----------------------------------------------------------------------------
+//	<Log::StopLogThread>
+//	Stop the log thread and write out what it left in the ring
+//-----------------------------------------------------------------------------
+void Log::StopLogThread
+(
+)
+{
+	if( m_logThread )
+	{
+		Thread* logThread = m_logThread;
+		m_logThread = NULL;
+		logThread->Stop();
+		logThread->Release();
+	}
+
+	m_logMutex->Lock();
+	DrainRing();
+	m_logMutex->Unlock();
+}
+
+//-----------------------------------------------------------------------------
+//	<Log::LogThreadEntryPoint>
+//	Entry point of the log thread
+//-----------------------------------------------------------------------------
+void Log::LogThreadEntryPoint
+(
+	Event* _exitEvent,
+	void* _context
+)
+{
+	Log* log = (Log*)_context;
+	if( log )
+	{
+		log->LogThreadProc( _exitEvent );
+	}
+}
+
+//-----------------------------------------------------------------------------
+//	<Log::LogThreadProc>
+//	Write the ring out whenever records are added to it
+//-----------------------------------------------------------------------------
+void Log::LogThreadProc
+(
+	Event* _exitEvent
+)
+{
+	Wait* waitObjects[2];
+	waitObjects[0] = _exitEvent;	// Thread must exit.
+	waitObjects[1] = m_ringEvent;	// Records to write.
+
+	while( true )
+	{
+		int32 res = Wait::Multiple( waitObjects, 2 );
+
+		// Reset before draining, so records added meanwhile set the event again
+		m_ringEvent->Reset();
+
+		m_logMutex->Lock();
+		DrainRing();
+		m_logMutex->Unlock();
+
+		if( res == 0 )
+		{
+			break;
+		}
 	}
 }
 
@@ -270,7 +985,10 @@ void Log::QueueDump
 	if( s_instance && s_dologging && s_instance->m_pImpl )
 	{
 		s_instance->m_logMutex->Lock();
+		s_instance->DrainRing();
+		++s_instance->m_implDepth;
 		s_instance->m_pImpl->QueueDump();
+		--s_instance->m_implDepth;
 		s_instance->m_logMutex->Unlock();
 	}
 }
@@ -286,6 +1004,7 @@ void Log::QueueClear
 	if( s_instance && s_dologging && s_instance->m_pImpl )
 	{
 		s_instance->m_logMutex->Lock();
+		s_instance->DrainRing();
 		s_instance->m_pImpl->QueueClear();
 		s_instance->m_logMutex->Unlock();
 	}
@@ -303,6 +1022,7 @@ void Log::SetLogFileName
 	if( s_instance && s_dologging && s_instance->m_pImpl )
 	{
 		s_instance->m_logMutex->Lock();
+		s_instance->DrainRing();
 		s_instance->m_pImpl->SetLogFileName( _filename );
 		s_instance->m_logMutex->Unlock();
 	}
@@ -321,7 +1041,16 @@ Log::Log
 	LogLevel const _queueLevel,
 	LogLevel const _dumpTrigger
 ):
-	m_logMutex( new Mutex() )
+	m_logMutex( new Mutex() ),
+	m_implDepth( 0 ),
+	m_logThread( NULL ),
+	m_ringMutex( new Mutex() ),
+	m_ringEvent( new Event() ),
+	m_ring( NULL ),
+	m_ringHead( 0 ),
+	m_ringCount( 0 ),
+	m_dropped( 0 ),
+	m_droppedReported( 0 )
 {
 		if (NULL == m_pImpl)
 			m_pImpl = new LogImpl( _filename, _bAppend, _bConsoleOutput, _saveLevel, _queueLevel, _dumpTrigger );
@@ -335,6 +1064,10 @@ Log::~Log
 (
 )
 {
+	StopLogThread();
+	delete [] m_ring;
+	m_ringEvent->Release();
+	m_ringMutex->Release();
 	m_logMutex->Release();
 	delete m_pImpl;
 	m_pImpl = NULL;
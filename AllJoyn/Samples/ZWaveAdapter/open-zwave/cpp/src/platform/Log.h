@@ -37,6 +37,8 @@
 namespace OpenZWave
 {
 	class Mutex;
+	class Event;
+	class Thread;
 	extern char const *LogLevelString[];
 	enum LogLevel
 	{
@@ -55,12 +57,22 @@ namespace OpenZWave
 		LogLevel_Internal	/**< Used only within the log class (uses existing timestamp, etc.) */
 	};
 
+	/** \brief Wall clock time at which a message was logged.
+	 */
+	struct LogTime
+	{
+		int64 m_seconds;		/**< seconds since 1970-01-01 UTC */
+		uint32 m_milliseconds;
+	};
+
 	class i_LogImpl
 	{
 	public:
 		i_LogImpl() { } ;
 		virtual ~i_LogImpl() { } ;
 		virtual void Write( LogLevel _level, uint8 const _nodeId, char const* _format, va_list _args ) = 0;
+		/** Write a message logged earlier, at _time.  Implementations that stamp lines should use _time. */
+		virtual void Write( LogLevel _level, uint8 const _nodeId, LogTime const& _time, char const* _format, va_list _args ) { Write( _level, _nodeId, _format, _args ); }
 		virtual void QueueDump() = 0;
 		virtual void QueueClear() = 0;
 		virtual void SetLoggingState( LogLevel _saveLevel, LogLevel _queueLevel, LogLevel _dumpTrigger ) = 0;
@@ -128,6 +140,14 @@ namespace OpenZWave
 		*/
 		static bool GetLoggingState();
 
+		/**
+		 * \brief Determine whether a message of the given level would be written or queued.
+		 * Lets callers skip building expensive message arguments that would be thrown away.
+		 * \param _level	LogLevel of the message
+		 * \return True if a message of this level is saved or queued
+		*/
+		static bool IsLevelLogged( LogLevel _level );
+
 		/**
 		 * \brief Obtain the various logging levels.
 		 * \param _saveLevel	LogLevel of messages to write in real-time
@@ -170,6 +190,25 @@ namespace OpenZWave
 		 */
 		static void QueueDump();
 
+		/**
+		 * \brief Write log messages from a background thread instead of the calling thread.
+		 * Messages are formatted by the caller and copied to a fixed size ring that the log
+		 * thread passes on to the logging implementation in order.  When the ring is full,
+		 * messages less severe than LogLevel_Warning and the dump trigger are dropped and
+		 * counted; more severe ones make the caller write out the ring itself, so they
+		 * are never lost and queue dumps behave as in synchronous mode.
+		 * \param _async	True to use the log thread, false to write on the calling thread
+		 * \see GetDroppedCount
+		 */
+		static void SetAsync( bool _async );
+
+		/**
+		 * \brief Obtain the number of messages dropped because the asynchronous log ring was full.
+		 * \return The number of dropped messages since the log was created
+		 * \see SetAsync
+		 */
+		static uint32 GetDroppedCount();
+
 		/**
 		 * Clear the log message queue
 		 */
@@ -179,9 +218,30 @@ namespace OpenZWave
 		Log( string const& _filename, bool const _bAppend, bool const _bConsoleOutput, LogLevel _saveLevel, LogLevel _queueLevel, LogLevel _dumpTrigger );
 		~Log();
 
+		struct LogRecord;
+
+		void Dispatch( LogLevel _level, uint8 const _nodeId, char const* _format, va_list _args );
+		bool Enqueue( LogLevel _level, uint8 const _nodeId, char const* _format, va_list _args );
+		void DrainRing();
+		void StopLogThread();
+
+		static void LogThreadEntryPoint( Event* _exitEvent, void* _context );
+		void LogThreadProc( Event* _exitEvent );
+
 		static i_LogImpl*	m_pImpl;		/**< Pointer to an object that encapsulates the platform-specific logging implementation. */
 		static Log*	s_instance;
 		Mutex*		m_logMutex;
+		uint32		m_implDepth;	/**< Nesting of calls into m_pImpl by the thread holding m_logMutex */
+
+		// Asynchronous mode
+		Thread*		m_logThread;	/**< Writes the ring out; NULL in synchronous mode */
+		Mutex*		m_ringMutex;
+		Event*		m_ringEvent;	/**< Set when records are added to the ring */
+		LogRecord*	m_ring;
+		uint32		m_ringHead;
+		uint32		m_ringCount;
+		uint32		m_dropped;
+		uint32		m_droppedReported;
 	};
 } // namespace OpenZWave
 
@@ -95,9 +95,27 @@ void LogImpl::Write
 		char const* _format,
 		va_list _args
 )
+{
+	LogTime now;
+	GetTime( &now );
+	Write( _logLevel, _nodeId, now, _format, _args );
+}
+
+//-----------------------------------------------------------------------------
+//	<LogImpl::Write>
+//	Write a message that was logged at _time
+//-----------------------------------------------------------------------------
+void LogImpl::Write
+(
+		LogLevel _logLevel,
+		uint8 const _nodeId,
+		LogTime const& _time,
+		char const* _format,
+		va_list _args
+)
 {
 	// create a timestamp string
-	string timeStr = GetTimeStampString();
+	string timeStr = GetTimeStampString( _time );
 	string nodeStr = GetNodeString( _nodeId );
 	string loglevelStr = GetLogLevelString(_logLevel);
 
@@ -228,6 +246,21 @@ void LogImpl::SetLoggingState
 	m_dumpTrigger = _dumpTrigger;
 }
 
+//-----------------------------------------------------------------------------
+//	<LogImpl::GetTime>
+//	Get the current time
+//-----------------------------------------------------------------------------
+void LogImpl::GetTime
+(
+	LogTime* _time
+)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	_time->m_seconds = tv.tv_sec;
+	_time->m_milliseconds = (uint32)tv.tv_usec / 1000;
+}
+
 //-----------------------------------------------------------------------------
 //	<LogImpl::GetTimeStampString>
 //	Generate a string with formatted current time
@@ -236,17 +269,29 @@ string LogImpl::GetTimeStampString
 (
 )
 {
-	// Get a timestamp
-	struct timeval tv;
-	gettimeofday(&tv, NULL);
+	LogTime now;
+	GetTime( &now );
+	return GetTimeStampString( now );
+}
+
+//-----------------------------------------------------------------------------
+//	<LogImpl::GetTimeStampString>
+//	Generate a string with formatted time
+//-----------------------------------------------------------------------------
+string LogImpl::GetTimeStampString
+(
+	LogTime const& _time
+)
+{
+	time_t seconds = (time_t)_time.m_seconds;
 	struct tm *tm;
-	tm = localtime( &tv.tv_sec );
+	tm = localtime( &seconds );
 
 	// create a time stamp string for the log message
 	char buf[100];
 	snprintf( buf, sizeof(buf), "%04d-%02d-%02d %02d:%02d:%02d.%03d ",
 			tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday,
-			tm->tm_hour, tm->tm_min, tm->tm_sec, (int)tv.tv_usec / 1000 );
+			tm->tm_hour, tm->tm_min, tm->tm_sec, (int)_time.m_milliseconds );
 	string str = buf;
 	return str;
 }
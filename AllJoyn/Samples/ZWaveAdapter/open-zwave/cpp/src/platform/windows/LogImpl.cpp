@@ -61,6 +61,9 @@ errno_t fopen_s(FILE** pFile, const char *filename, const char *mode)
 
 using namespace OpenZWave;
 
+// FILETIME of 1970-01-01 UTC, the LogTime epoch
+#define FILETIME_UNIX_EPOCH	116444736000000000ULL
+
 //-----------------------------------------------------------------------------
 //	<LogImpl::LogImpl>
 //	Constructor
@@ -124,9 +127,27 @@ void LogImpl::Write
 	char const* _format,
 	va_list _args
 )
+{
+	LogTime now;
+	GetTime( &now );
+	Write( _logLevel, _nodeId, now, _format, _args );
+}
+
+//-----------------------------------------------------------------------------
+//	<LogImpl::Write>
+//	Write a message that was logged at _time
+//-----------------------------------------------------------------------------
+void LogImpl::Write
+(
+	LogLevel _logLevel,
+	uint8 const _nodeId,
+	LogTime const& _time,
+	char const* _format,
+	va_list _args
+)
 {
 	// create a timestamp string
-	string timeStr = GetTimeStampString();
+	string timeStr = GetTimeStampString( _time );
 	string nodeStr = GetNodeString( _nodeId );
 	string logLevelStr = GetLogLevelString(_logLevel);
 
@@ -260,6 +281,25 @@ void LogImpl::SetLoggingState
 	m_dumpTrigger = _dumpTrigger;
 }
 
+//-----------------------------------------------------------------------------
+//	<LogImpl::GetTime>
+//	Get the current time
+//-----------------------------------------------------------------------------
+void LogImpl::GetTime
+(
+	LogTime* _time
+)
+{
+	// 100ns intervals since 1601-01-01 UTC
+	FILETIME fileTime;
+	::GetSystemTimeAsFileTime( &fileTime );
+	uint64 ticks = ( ( (uint64)fileTime.dwHighDateTime ) << 32 ) | fileTime.dwLowDateTime;
+
+	ticks -= FILETIME_UNIX_EPOCH;
+	_time->m_seconds = (int64)( ticks / 10000000 );
+	_time->m_milliseconds = (uint32)( ( ticks % 10000000 ) / 10000 );
+}
+
 //-----------------------------------------------------------------------------
 //	<LogImpl::GetTimeStampAndThreadId>
 //	Generate a string with formatted current time
@@ -268,9 +308,29 @@ string LogImpl::GetTimeStampString
 (
 )
 {
-	// Get a timestamp
+	LogTime now;
+	GetTime( &now );
+	return GetTimeStampString( now );
+}
+
+//-----------------------------------------------------------------------------
+//	<LogImpl::GetTimeStampString>
+//	Generate a string with formatted time
+//-----------------------------------------------------------------------------
+string LogImpl::GetTimeStampString
+(
+	LogTime const& _time
+)
+{
+	uint64 ticks = (uint64)_time.m_seconds * 10000000 + (uint64)_time.m_milliseconds * 10000 + FILETIME_UNIX_EPOCH;
+	FILETIME fileTime;
+	fileTime.dwLowDateTime = (DWORD)ticks;
+	fileTime.dwHighDateTime = (DWORD)( ticks >> 32 );
+
+	SYSTEMTIME utcTime;
 	SYSTEMTIME time;
-	::GetLocalTime( &time );
+	::FileTimeToSystemTime( &fileTime, &utcTime );
+	::SystemTimeToTzSpecificLocalTime( NULL, &utcTime, &time );
 
 	// create a time stamp string for the log message
 	char buf[100];
@@ -46,13 +46,16 @@ namespace OpenZWave
 		~LogImpl();
 
 		void Write( LogLevel _level, uint8 const _nodeId, char const* _format, va_list _args );
+		void Write( LogLevel _level, uint8 const _nodeId, LogTime const& _time, char const* _format, va_list _args );
 		void Queue( char const* _buffer );
 		void QueueDump();
 		void QueueClear();
 		void SetLoggingState( LogLevel _saveLevel, LogLevel _queueLevel, LogLevel _dumpTrigger );
 		void SetLogFileName( const string &_filename );
 
+		static void GetTime( LogTime* _time );
 		string GetTimeStampString();
+		string GetTimeStampString( LogTime const& _time );
 		string GetNodeString( uint8 const _nodeId );
 		string GetThreadId();
 		string GetLogLevelString(LogLevel _level);